@@ -31,6 +31,26 @@ USER_OPTION(LOG_LEVEL "Log level for the application"
     LOG_LEVEL_INFO
     STRING)
 
+USER_OPTION(LOG_DEFERRED "Record log messages unformatted and output them from idle time instead of at the call site."
+    OFF
+    BOOL)
+
+USER_OPTION(LOG_DEFERRED_RECORDS "Number of messages the deferred log buffer can hold. Must be a power of two."
+    64
+    STRING)
+
+USER_OPTION(LOG_DEFERRED_PAYLOAD_SIZE "Bytes of arguments each deferred log message can hold, up to 255."
+    112
+    STRING)
+
+USER_OPTION(LOG_TRACE "Record the time spent in each stage of the applications and export it as Chrome trace JSON."
+    OFF
+    BOOL)
+
+USER_OPTION(LOG_TRACE_EVENTS "Number of spans the trace ring buffer holds. Must be a power of two."
+    1024
+    STRING)
+
 ## TensorFlow options
 USER_OPTION(TENSORFLOW_SRC_PATH "Path to the root of the TensorFlow Lite Micro sources."
     "${MLEK_DEPENDENCY_ROOT_DIR}/tensorflow"
@@ -60,10 +80,26 @@ USER_OPTION(CPU_PROFILE_ENABLED "Output CPU performance profiling information. S
     OFF
     BOOL)
 
+USER_OPTION(PROFILER_PERCENTILES "Keep a histogram per profiling counter to report P50 and P99 values. Adds about 2KiB per profiling region."
+    ON
+    BOOL)
+
+USER_OPTION(PROFILER_MAX_REGIONS "Number of profiling regions each profiler can hold."
+    4
+    STRING)
+
 USER_OPTION(USE_SINGLE_INPUT "Select if a use case should execute using a default known input file."
     OFF
     BOOL)
 
+USER_OPTION(ARENA_PLANNER_PATH "Optional. Path to an arena_planner built natively, used to work out the activation buffer size of each use case; set <use_case>_ACTIVATION_BUF_SZ to auto to use it."
+    ""
+    FILEPATH)
+
+USER_OPTION(EMBED_MODEL_BINARY "Assemble model files into the applications with .incbin instead of generating C++ arrays of their bytes."
+    OFF
+    BOOL)
+
 USER_OPTION(RESOURCES_PATH "Path to use case models that have been compiled with Vela."
     "${MLEK_ROOT}/resources_downloaded"
     PATH)
@@ -37,6 +37,10 @@ USER_OPTION(ETHOS_U_NPU_ASSUMED "Assume models will be handled by the Ethos-U wh
     ON
     BOOL)
 
+USER_OPTION(ETHOS_U_NPU_ASYNC "Run the Ethos-U operator of every model through the application's asynchronous kernel instead of TensorFlow Lite Micro's."
+    OFF
+    BOOL)
+
 USER_OPTION(ETHOS_U_NPU_TIMING_ADAPTER_SRC_PATH
     "Path to Ethos-U NPU timing adapter sources"
     "${MLEK_DEPENDENCY_ROOT_DIR}/core-platform/drivers/timing_adapter"
@@ -113,7 +113,8 @@ function(platform_custom_post_build)
         set(TEST_TARGET_NAME "${use_case}_tests")
         add_executable(${TEST_TARGET_NAME} ${TEST_SOURCES})
         target_include_directories(${TEST_TARGET_NAME} PRIVATE ${TEST_RESOURCES_INCLUDE})
-        target_link_libraries(${TEST_TARGET_NAME} PRIVATE ${UC_LIB_NAME} mlek::Catch2)
+        target_link_libraries(${TEST_TARGET_NAME} PRIVATE ${UC_LIB_NAME} log_deferred log_trace hal_camera_demosaic hal_camera_frame_file audio_gain
+                hal_file_stream_common ethosu_cache_policy core_pipe mlek::Catch2)
         target_compile_definitions(${TEST_TARGET_NAME} PRIVATE
                 "ACTIVATION_BUF_SZ=${${use_case}_ACTIVATION_BUF_SZ}"
                 TESTS)
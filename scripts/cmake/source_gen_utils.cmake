@@ -81,6 +81,10 @@ endfunction()
 #                               placed
 # @param[in]    EXPRESSIONS     C++ code expressions to add to the generated file
 # @param[in]    NAMESPACE       model name space
+# The file is only generated again when the model, the arguments or the
+# generator change; otherwise the previous one is copied, keeping its time
+# stamp so that it is not compiled again. With EMBED_MODEL_BINARY the model
+# is assembled in with .incbin rather than written out as an array.
 # NOTE: Uses python
 ##############################################################################
 function(generate_tflite_code)
@@ -108,15 +112,151 @@ function(generate_tflite_code)
         set(py_arg_exp ${py_arg_exp} --namespaces=${name})
     endforeach()
 
+    if (EMBED_MODEL_BINARY)
+        if (APPLE)
+            message(FATAL_ERROR "EMBED_MODEL_BINARY needs an ELF toolchain.")
+        endif ()
+        set(py_arg_exp ${py_arg_exp} --incbin)
+    endif ()
+
+    # Key of what the generated file depends on
+    get_filename_component(model_file_name ${ABS_MODEL_PATH} NAME)
+    file(SHA256 ${ABS_MODEL_PATH} model_hash)
+    file(SHA256 ${MLEK_SCRIPTS_DIR}/py/gen_model_cpp.py script_hash)
+    file(SHA256 ${MLEK_SCRIPTS_DIR}/py/templates/tflite.cc.template template_hash)
+    string(SHA256 gen_key "${ABS_MODEL_PATH};${model_hash};${script_hash};${template_hash};${py_arg_exp}")
+
+    # Kept next to the destination, which is cleared on every configuration
+    get_filename_component(cache_dir ${ABS_DESTINATION}/../model_cache/${model_file_name} ABSOLUTE)
+    set(cached_cc ${cache_dir}/${model_file_name}.cc)
+    set(cached_key_file ${cache_dir}/key.sha256)
+
+    set(cached_key "")
+    if (EXISTS ${cached_key_file} AND EXISTS ${cached_cc})
+        file(READ ${cached_key_file} cached_key)
+    endif ()
+
+    if (cached_key STREQUAL gen_key)
+        message(STATUS "${model_file_name} unchanged, reusing ${cached_cc}")
+    else ()
+        file(REMOVE_RECURSE ${cache_dir})
+        file(MAKE_DIRECTORY ${cache_dir})
+        execute_process(
+            COMMAND ${PYTHON} ${MLEK_SCRIPTS_DIR}/py/gen_model_cpp.py
+            --tflite_path ${ABS_MODEL_PATH}
+            --output_dir ${cache_dir} ${py_arg_exp}
+            RESULT_VARIABLE return_code
+        )
+        if (NOT return_code EQUAL "0")
+            message(FATAL_ERROR "Failed to generate model files.")
+        endif ()
+        file(WRITE ${cached_key_file} ${gen_key})
+    endif ()
+
+    # Copying keeps the time stamp of the cached file
+    file(COPY ${cached_cc} DESTINATION ${ABS_DESTINATION})
+
+    # Recorded for planning the use case's activation buffer
+    set_property(GLOBAL APPEND PROPERTY ${use_case}_MODEL_PATHS ${ABS_MODEL_PATH})
+
+    if (EMBED_MODEL_BINARY)
+        # The compiler reads the model, so changes to it must rebuild the source
+        set_source_files_properties(${ABS_DESTINATION}/${model_file_name}.cc
+            PROPERTIES OBJECT_DEPENDS ${ABS_MODEL_PATH})
+    endif ()
+endfunction()
+
+
+##############################################################################
+# This function generates a C++ header registering the operators a tflite NN
+# model uses, and no others, with an op resolver sized for them.
+# @param[in]    MODEL_PATH      path to a tflite file
+# @param[in]    DESTINATION     directory in which the output hpp must be
+#                               placed
+# @param[in]    OUTPUT_FILENAME name of the output hpp, without extension
+# @param[in]    NAMESPACE       namespace of the generated code
+# NOTE: Uses python
+##############################################################################
+function(generate_op_resolver_code)
+
+    set(multiValueArgs NAMESPACE)
+    set(oneValueArgs MODEL_PATH DESTINATION OUTPUT_FILENAME)
+    cmake_parse_arguments(PARSED "" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+    # Absolute paths for passing into python script
+    get_filename_component(ABS_MODEL_PATH ${PARSED_MODEL_PATH} ABSOLUTE)
+    get_filename_component(ABS_DESTINATION ${PARSED_DESTINATION} ABSOLUTE)
+
+    if (NOT EXISTS ${ABS_MODEL_PATH})
+        message(FATAL_ERROR "${ABS_MODEL_PATH} not found!")
+    endif ()
+
+    foreach(name ${PARSED_NAMESPACE})
+        set(py_arg_exp ${py_arg_exp} --namespaces=${name})
+    endforeach()
+
     execute_process(
-        COMMAND ${PYTHON} ${MLEK_SCRIPTS_DIR}/py/gen_model_cpp.py
+        COMMAND ${PYTHON} ${MLEK_SCRIPTS_DIR}/py/gen_op_resolver_cpp.py
         --tflite_path ${ABS_MODEL_PATH}
-        --output_dir ${ABS_DESTINATION} ${py_arg_exp}
+        --output_dir ${ABS_DESTINATION}
+        --output_file_name ${PARSED_OUTPUT_FILENAME} ${py_arg_exp}
+        RESULT_VARIABLE return_code
+    )
+    if (NOT return_code EQUAL "0")
+        message(FATAL_ERROR "Failed to generate the op resolver for ${ABS_MODEL_PATH}.")
+    endif ()
+endfunction()
+
+
+##############################################################################
+# This function generates a C++ header with the smallest activation buffer
+# the given models fit in, with the arena planner at ARENA_PLANNER_PATH.
+# The models are loaded in the order given, sharing the buffer.
+# @param[in]    MODEL_PATHS         paths to the tflite files
+# @param[in]    DESTINATION         directory in which ActivationBufferSize.hpp
+#                                   must be placed
+# @param[in]    REPORT              path of the report, with the tensor map
+# @param[in]    ARENA_SIZE          optional: configured size to compare with
+# @param[in]    WEIGHT_STAGING_SIZE optional: weight staging budget
+# @param[out]   RESULT_VARIABLE     variable set to the size, in bytes
+##############################################################################
+function(generate_arena_plan_code)
+
+    set(multiValueArgs MODEL_PATHS)
+    set(oneValueArgs DESTINATION REPORT ARENA_SIZE WEIGHT_STAGING_SIZE RESULT_VARIABLE)
+    cmake_parse_arguments(PARSED "" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+    if (NOT EXISTS ${ARENA_PLANNER_PATH})
+        message(FATAL_ERROR "Arena planner ${ARENA_PLANNER_PATH} not found!")
+    endif ()
+
+    get_filename_component(ABS_DESTINATION ${PARSED_DESTINATION} ABSOLUTE)
+    set(header ${ABS_DESTINATION}/ActivationBufferSize.hpp)
+
+    set(planner_args "")
+    if (PARSED_ARENA_SIZE)
+        list(APPEND planner_args --arena-size ${PARSED_ARENA_SIZE})
+    endif ()
+    if (PARSED_WEIGHT_STAGING_SIZE)
+        list(APPEND planner_args --staging ${PARSED_WEIGHT_STAGING_SIZE})
+    endif ()
+
+    message(STATUS "Planning the activation buffer for ${PARSED_MODEL_PATHS}")
+    execute_process(
+        COMMAND ${ARENA_PLANNER_PATH} ${planner_args}
+        --header ${header}
+        --report ${PARSED_REPORT}
+        ${PARSED_MODEL_PATHS}
         RESULT_VARIABLE return_code
     )
     if (NOT return_code EQUAL "0")
-        message(FATAL_ERROR "Failed to generate model files.")
+        message(FATAL_ERROR "Failed to plan the activation buffer for ${PARSED_MODEL_PATHS}.")
     endif ()
+
+    file(STRINGS ${header} planned REGEX "^#define ARENA_PLAN_ACTIVATION_BUF_SZ ")
+    string(REGEX MATCH "0x[0-9A-Fa-f]+" planned "${planned}")
+    math(EXPR planned "${planned}")
+    set(${PARSED_RESULT_VARIABLE} ${planned} PARENT_SCOPE)
 endfunction()
 
 
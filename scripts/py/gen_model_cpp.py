@@ -64,6 +64,12 @@ parser.add_argument(
     dest="namespaces"
 )
 
+parser.add_argument(
+    "--incbin",
+    help="Assemble the model file in with .incbin instead of writing out its bytes",
+    action="store_true"
+)
+
 parser.add_argument(
     "--license_template",
     type=str,
@@ -124,10 +130,19 @@ def main(args):
 
     hdr = GenUtils.gen_header(env, args.license_template, Path(args.tflite_path).name)
 
+    if args.incbin:
+        model_data = None
+        model_path = Path(args.tflite_path).resolve().as_posix()
+    else:
+        model_data = get_tflite_data(args.tflite_path)
+        model_path = None
+
     env \
         .get_template('tflite.cc.template') \
         .stream(common_template_header=hdr,
-                model_data=get_tflite_data(args.tflite_path),
+                model_data=model_data,
+                model_path=model_path,
+                model_symbol="_".join(args.namespaces + ["nn_model"]),
                 expressions=args.expr,
                 additional_headers=args.headers,
                 namespaces=args.namespaces).dump(str(cpp_filename))
@@ -0,0 +1,336 @@
+#  SPDX-FileCopyrightText:  Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+#  SPDX-License-Identifier: Apache-2.0
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+"""
+Utility script to generate a header registering the operators a model uses,
+and no others, with a TensorFlow Lite Micro MicroMutableOpResolver sized for
+them. This should be called as part of cmake framework, next to
+gen_model_cpp.py, so that a model using an operator TensorFlow Lite Micro does
+not provide fails to build rather than to allocate its tensors.
+"""
+import struct
+import sys
+from argparse import ArgumentParser
+from pathlib import Path
+
+from jinja2 import Environment, FileSystemLoader
+
+from gen_utils import GenUtils
+
+# pylint: disable=duplicate-code
+parser = ArgumentParser()
+
+parser.add_argument(
+    "--tflite_path",
+    help="Model (.tflite) path",
+    required=True
+)
+
+parser.add_argument(
+    "--output_dir",
+    help="Output directory for the header",
+    required=True
+)
+
+parser.add_argument(
+    "--output_file_name",
+    help="Name of the header, without extension",
+    required=True
+)
+
+parser.add_argument(
+    '-ns',
+    '--namespaces',
+    action='append',
+    default=[],
+    dest="namespaces"
+)
+
+parser.add_argument(
+    "--license_template",
+    type=str,
+    help="Header template file",
+    default="header_template.txt"
+)
+
+# pylint: enable=duplicate-code
+
+# TensorFlow Lite builtin operator codes, from the BuiltinOperator enum of
+# the schema, with the MicroMutableOpResolver method registering each one.
+BUILTIN_OPS = {
+    0: ("ADD", "AddAdd"),
+    1: ("AVERAGE_POOL_2D", "AddAveragePool2D"),
+    2: ("CONCATENATION", "AddConcatenation"),
+    3: ("CONV_2D", "AddConv2D"),
+    4: ("DEPTHWISE_CONV_2D", "AddDepthwiseConv2D"),
+    5: ("DEPTH_TO_SPACE", "AddDepthToSpace"),
+    6: ("DEQUANTIZE", "AddDequantize"),
+    8: ("FLOOR", "AddFloor"),
+    9: ("FULLY_CONNECTED", "AddFullyConnected"),
+    11: ("L2_NORMALIZATION", "AddL2Normalization"),
+    12: ("L2_POOL_2D", "AddL2Pool2D"),
+    14: ("LOGISTIC", "AddLogistic"),
+    17: ("MAX_POOL_2D", "AddMaxPool2D"),
+    18: ("MUL", "AddMul"),
+    19: ("RELU", "AddRelu"),
+    21: ("RELU6", "AddRelu6"),
+    22: ("RESHAPE", "AddReshape"),
+    23: ("RESIZE_BILINEAR", "AddResizeBilinear"),
+    25: ("SOFTMAX", "AddSoftmax"),
+    26: ("SPACE_TO_DEPTH", "AddSpaceToDepth"),
+    27: ("SVDF", "AddSvdf"),
+    28: ("TANH", "AddTanh"),
+    34: ("PAD", "AddPad"),
+    36: ("GATHER", "AddGather"),
+    37: ("BATCH_TO_SPACE_ND", "AddBatchToSpaceNd"),
+    38: ("SPACE_TO_BATCH_ND", "AddSpaceToBatchNd"),
+    39: ("TRANSPOSE", "AddTranspose"),
+    40: ("MEAN", "AddMean"),
+    41: ("SUB", "AddSub"),
+    42: ("DIV", "AddDiv"),
+    43: ("SQUEEZE", "AddSqueeze"),
+    44: ("UNIDIRECTIONAL_SEQUENCE_LSTM", "AddUnidirectionalSequenceLSTM"),
+    45: ("STRIDED_SLICE", "AddStridedSlice"),
+    47: ("EXP", "AddExp"),
+    49: ("SPLIT", "AddSplit"),
+    50: ("LOG_SOFTMAX", "AddLogSoftmax"),
+    53: ("CAST", "AddCast"),
+    54: ("PRELU", "AddPrelu"),
+    55: ("MAXIMUM", "AddMaximum"),
+    56: ("ARG_MAX", "AddArgMax"),
+    57: ("MINIMUM", "AddMinimum"),
+    58: ("LESS", "AddLess"),
+    59: ("NEG", "AddNeg"),
+    60: ("PADV2", "AddPadV2"),
+    61: ("GREATER", "AddGreater"),
+    62: ("GREATER_EQUAL", "AddGreaterEqual"),
+    63: ("LESS_EQUAL", "AddLessEqual"),
+    65: ("SLICE", "AddSlice"),
+    66: ("SIN", "AddSin"),
+    67: ("TRANSPOSE_CONV", "AddTransposeConv"),
+    70: ("EXPAND_DIMS", "AddExpandDims"),
+    71: ("EQUAL", "AddEqual"),
+    72: ("NOT_EQUAL", "AddNotEqual"),
+    73: ("LOG", "AddLog"),
+    74: ("SUM", "AddSum"),
+    75: ("SQRT", "AddSqrt"),
+    76: ("RSQRT", "AddRsqrt"),
+    77: ("SHAPE", "AddShape"),
+    79: ("ARG_MIN", "AddArgMin"),
+    82: ("REDUCE_MAX", "AddReduceMax"),
+    83: ("PACK", "AddPack"),
+    84: ("LOGICAL_OR", "AddLogicalOr"),
+    86: ("LOGICAL_AND", "AddLogicalAnd"),
+    87: ("LOGICAL_NOT", "AddLogicalNot"),
+    88: ("UNPACK", "AddUnpack"),
+    90: ("FLOOR_DIV", "AddFloorDiv"),
+    92: ("SQUARE", "AddSquare"),
+    93: ("ZEROS_LIKE", "AddZerosLike"),
+    94: ("FILL", "AddFill"),
+    95: ("FLOOR_MOD", "AddFloorMod"),
+    97: ("RESIZE_NEAREST_NEIGHBOR", "AddResizeNearestNeighbor"),
+    98: ("LEAKY_RELU", "AddLeakyRelu"),
+    99: ("SQUARED_DIFFERENCE", "AddSquaredDifference"),
+    100: ("MIRROR_PAD", "AddMirrorPad"),
+    101: ("ABS", "AddAbs"),
+    102: ("SPLIT_V", "AddSplitV"),
+    104: ("CEIL", "AddCeil"),
+    106: ("ADD_N", "AddAddN"),
+    107: ("GATHER_ND", "AddGatherNd"),
+    108: ("COS", "AddCos"),
+    111: ("ELU", "AddElu"),
+    114: ("QUANTIZE", "AddQuantize"),
+    116: ("ROUND", "AddRound"),
+    117: ("HARD_SWISH", "AddHardSwish"),
+    118: ("IF", "AddIf"),
+    119: ("WHILE", "AddWhile"),
+    123: ("SELECT_V2", "AddSelectV2"),
+    126: ("BATCH_MATMUL", "AddBatchMatMul"),
+    128: ("CUMSUM", "AddCumSum"),
+    129: ("CALL_ONCE", "AddCallOnce"),
+    130: ("BROADCAST_TO", "AddBroadcastTo"),
+    142: ("VAR_HANDLE", "AddVarHandle"),
+    143: ("READ_VARIABLE", "AddReadVariable"),
+    144: ("ASSIGN_VARIABLE", "AddAssignVariable"),
+    145: ("BROADCAST_ARGS", "AddBroadcastArgs"),
+}
+
+# Builtin code of custom operators, which are told apart by their name.
+CUSTOM_OP_CODE = 32
+
+CUSTOM_OPS = {
+    "ethos-u": "AddEthosU",
+    "TFLite_Detection_PostProcess": "AddDetectionPostprocess",
+    "CIRCULAR_BUFFER": "AddCircularBuffer",
+}
+
+
+class FlatbufferTable:
+    """
+    Read only view of a table in a flatbuffer, enough to walk the few
+    fields of the TensorFlow Lite schema needed here.
+    """
+
+    def __init__(self, buf: bytes, pos: int):
+        self.buf = buf
+        self.pos = pos
+        self.vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+        self.vtable_len = struct.unpack_from("<H", buf, self.vtable)[0]
+
+    def _field_pos(self, index: int):
+        entry = 4 + 2 * index
+        if entry >= self.vtable_len:
+            return None
+        offset = struct.unpack_from("<H", self.buf, self.vtable + entry)[0]
+        return self.pos + offset if offset else None
+
+    def scalar(self, index: int, fmt: str, default):
+        """
+        Reads a scalar field, or its default if absent.
+        """
+        pos = self._field_pos(index)
+        return struct.unpack_from(fmt, self.buf, pos)[0] if pos is not None else default
+
+    def _indirect(self, pos: int) -> int:
+        return pos + struct.unpack_from("<I", self.buf, pos)[0]
+
+    def string(self, index: int):
+        """
+        Reads a string field, or None if absent.
+        """
+        pos = self._field_pos(index)
+        if pos is None:
+            return None
+        start = self._indirect(pos)
+        length = struct.unpack_from("<I", self.buf, start)[0]
+        return self.buf[start + 4:start + 4 + length].decode("utf-8")
+
+    def tables(self, index: int) -> list:
+        """
+        Reads a vector of tables field, empty if absent.
+        """
+        pos = self._field_pos(index)
+        if pos is None:
+            return []
+        start = self._indirect(pos)
+        length = struct.unpack_from("<I", self.buf, start)[0]
+        return [FlatbufferTable(self.buf, self._indirect(start + 4 + 4 * i)) for i in range(length)]
+
+
+def get_model_ops(tflite_path: str) -> list:
+    """
+    Lists the operators used by the operators of all the subgraphs of a
+    model, in the order they are first used. Operator codes the model
+    lists but no operator uses are left out.
+
+    Argument:
+        tflite_path:    path to the tflite model.
+
+    Returns:
+        list of (builtin code, custom name) tuples
+    """
+    with open(tflite_path, 'rb') as tflite_model:
+        buf = tflite_model.read()
+
+    if len(buf) < 8 or buf[4:8] != b"TFL3":
+        raise ValueError(f"{tflite_path} is not a TensorFlow Lite model")
+
+    # Model: 1 operator_codes, 2 subgraphs
+    model = FlatbufferTable(buf, struct.unpack_from("<I", buf, 0)[0])
+    codes = []
+    for code in model.tables(1):
+        # OperatorCode: 0 deprecated_builtin_code, 1 custom_code, 3 builtin_code.
+        # Codes above 127 are only in builtin_code, older models only fill in
+        # deprecated_builtin_code.
+        builtin = max(code.scalar(0, "<b", 0), code.scalar(3, "<i", 0))
+        codes.append((builtin, code.string(1) if builtin == CUSTOM_OP_CODE else None))
+
+    used = []
+    for subgraph in model.tables(2):
+        # SubGraph: 3 operators; Operator: 0 opcode_index
+        for operator in subgraph.tables(3):
+            op = codes[operator.scalar(0, "<I", 0)]
+            if op not in used:
+                used.append(op)
+    return used
+
+
+def get_resolver_methods(ops: list) -> list:
+    """
+    Maps operators to the MicroMutableOpResolver methods registering them.
+
+    Argument:
+        ops:    list of (builtin code, custom name) tuples.
+
+    Returns:
+        list of method names
+    """
+    methods = []
+    unsupported = []
+    for builtin, custom in ops:
+        if builtin == CUSTOM_OP_CODE:
+            method = CUSTOM_OPS.get(custom)
+            name = f"custom operator {custom}"
+        else:
+            method = BUILTIN_OPS.get(builtin, (None, None))[1]
+            name = BUILTIN_OPS.get(builtin, (f"builtin operator {builtin}",))[0]
+        if method:
+            methods.append(method)
+        else:
+            unsupported.append(name)
+
+    if unsupported:
+        raise ValueError(f"Not supported by TensorFlow Lite Micro: {', '.join(unsupported)}")
+    if not methods:
+        raise ValueError("The model has no operators")
+    return methods
+
+
+def main(args):
+    """
+    Generate the op resolver header
+    @param args:    Parsed args
+    """
+    if not Path(args.tflite_path).is_file():
+        raise ValueError(f"{args.tflite_path} not found")
+
+    methods = get_resolver_methods(get_model_ops(args.tflite_path))
+
+    hpp_filename = (Path(args.output_dir) / (args.output_file_name + ".hpp")).resolve()
+    print(f"++ Listing the {len(methods)} operators of {Path(args.tflite_path).name} in\
+    {hpp_filename.name}")
+
+    hpp_filename.parent.mkdir(exist_ok=True)
+
+    env = Environment(loader=FileSystemLoader(Path(__file__).parent / 'templates'),
+                      trim_blocks=True,
+                      lstrip_blocks=True)
+    hdr = GenUtils.gen_header(env, args.license_template, Path(args.tflite_path).name)
+
+    env \
+        .get_template('op_resolver.hpp.template') \
+        .stream(common_template_header=hdr,
+                include_guard=args.output_file_name.upper() + "_HPP",
+                model_name=Path(args.tflite_path).name,
+                methods=methods,
+                namespaces=args.namespaces).dump(str(hpp_filename))
+
+
+if __name__ == '__main__':
+    try:
+        main(parser.parse_args())
+    except ValueError as err:
+        print(f"Error: {err}", file=sys.stderr)
+        sys.exit(1)
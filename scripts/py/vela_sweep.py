@@ -0,0 +1,549 @@
+#!/usr/bin/env python3
+#  SPDX-FileCopyrightText:  Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+#  SPDX-License-Identifier: Apache-2.0
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+"""
+Compile models over a matrix of Vela options, run every variant with the
+inference runner on the FVP and compare NPU cycles, AXI beats, tensor arena
+and flash sizes.
+
+Run it from the root of the repository:
+
+    python3 -m scripts.py.vela_sweep --model <model.tflite> \\
+        --fvp <FVP executable> --axf <ethos-u-inference_runner.axf>
+
+The inference runner must be built with
+`inference_runner_DYNAMIC_MEM_LOAD_ENABLED=ON` for the NPU the FVP models.
+Without `--fvp`, only the Vela estimates are compared.
+"""
+import csv
+import dataclasses
+import itertools
+import logging
+import re
+import shlex
+import subprocess
+import sys
+import threading
+import typing
+from argparse import ArgumentParser
+from dataclasses import dataclass
+from pathlib import Path
+
+from scripts.py.vela_configs import NpuConfig
+from set_up_default_resources import default_downloads_path
+from set_up_default_resources import default_npu_configs
+from set_up_default_resources import valid_npu_configs
+
+current_file_dir = Path(__file__).parent.resolve()
+default_vela_config_file = current_file_dir.parent / "vela" / "ensemble_vela.ini"
+default_dynamic_model_base = 0x90000000
+
+# Lines from the inference runner and the profiler that the sweep reads.
+arena_used_pattern = re.compile(r"Activation buffer \(a\.k\.a tensor arena\) size used: (\d+)")
+counter_pattern = re.compile(r"(NPU [A-Z0-9_ ]+): (\d+) (cycles|beats)")
+final_results_marker = "Final results:"
+end_markers = ("Inference completed.", "Inference failed.", "Failed to initialise model")
+
+
+@dataclass(frozen=True)
+class Variant:
+    """
+    A model compiled with one set of Vela options
+    """
+    model: Path
+    config: NpuConfig
+    optimise: str
+
+    @property
+    def name(self) -> str:
+        """
+        Get a name for the variant that is unique within a sweep.
+
+        :return:    The variant name.
+        """
+        arena_cache_size = self.config.arena_cache_size or "default"
+        return (f"{self.model.stem}_{self.config.config_id}_{self.config.memory_mode}_"
+                f"{self.config.system_config}_{self.optimise}_{arena_cache_size}")
+
+
+@dataclass
+class Result:
+    """
+    What was measured for a variant. Sizes are in bytes.
+    """
+    variant: Variant
+    status: str = "ok"
+    flash_size: int = 0
+    arena_size: typing.Optional[int] = None
+    npu_cycles: typing.Optional[int] = None
+    axi_beats: typing.Optional[int] = None
+    counters: typing.Dict[str, int] = dataclasses.field(default_factory=dict)
+    vela_summary: typing.Dict[str, str] = dataclasses.field(default_factory=dict)
+    pareto: bool = False
+
+    @property
+    def metrics(self) -> typing.Optional[typing.Tuple[float, int, int]]:
+        """
+        Get the values to minimise: NPU cycles, tensor arena and flash sizes.
+        Vela's estimates stand in for anything the FVP did not report.
+
+        :return:    The metrics, or None if the variant did not compile or run.
+        """
+        if self.status != "ok":
+            return None
+        cycles = self.npu_cycles
+        if cycles is None:
+            cycles = float(self.vela_summary.get("cycles_total", "inf"))
+        arena = self.arena_size
+        if arena is None:
+            arena = int(float(self.vela_summary.get("sram_memory_used", "0")) * 1024)
+        return cycles, arena, self.flash_size
+
+
+def make_variants(
+        models: typing.List[Path],
+        configs: typing.List[NpuConfig],
+        memory_modes: typing.List[str],
+        system_configs: typing.List[str],
+        optimise_strategies: typing.List[str],
+        arena_cache_sizes: typing.List[int]
+) -> typing.List[Variant]:
+    """
+    Get every combination of the options for each model.
+
+    An empty list of memory modes or system configurations keeps the value of
+    each NPU configuration. An arena cache size of 0 keeps the default.
+
+    :param models:              The models to compile.
+    :param configs:             The NPU configurations.
+    :param memory_modes:        The Vela memory modes.
+    :param system_configs:      The Vela system configurations.
+    :param optimise_strategies: The Vela optimisation strategies.
+    :param arena_cache_sizes:   The arena cache sizes.
+    :return:                    The variants.
+    """
+    variants = []
+    for model, config in itertools.product(models, configs):
+        for memory_mode, system_config, optimise, arena_cache_size in itertools.product(
+                memory_modes or [config.memory_mode],
+                system_configs or [config.system_config],
+                optimise_strategies,
+                arena_cache_sizes
+        ):
+            variant_config = dataclasses.replace(
+                config,
+                memory_mode=memory_mode,
+                system_config=system_config
+            ).overwrite_arena_cache_size(arena_cache_size)
+            variants.append(Variant(model=model, config=variant_config, optimise=optimise))
+    return variants
+
+
+def compile_variant(
+        variant: Variant,
+        vela: str,
+        config_file: Path,
+        output_dir: Path
+) -> typing.Tuple[Path, typing.Dict[str, str]]:
+    """
+    Run Vela for a variant. A variant compiled by an earlier sweep is reused.
+
+    :param variant:     The variant.
+    :param vela:        The Vela executable.
+    :param config_file: The Vela configuration file.
+    :param output_dir:  The directory for all the variants.
+    :return:            The optimised model and Vela's summary of it.
+    """
+    variant_dir = output_dir / variant.name
+    optimised_model = variant_dir / (variant.model.stem + "_vela.tflite")
+    summary_file = variant_dir / f"{variant.model.stem}_summary_{variant.config.system_config}.csv"
+
+    if optimised_model.is_file():
+        logging.info("File %s exists, skipping optimisation.", optimised_model)
+    else:
+        command = [
+            vela, str(variant.model),
+            f"--accelerator-config={variant.config.config_name}",
+            f"--optimise={variant.optimise}",
+            f"--config={config_file}",
+            f"--memory-mode={variant.config.memory_mode}",
+            f"--system-config={variant.config.system_config}",
+            f"--output-dir={variant_dir}",
+        ]
+        if variant.config.arena_cache_size:
+            command.append(f"--arena-cache-size={variant.config.arena_cache_size}")
+
+        logging.info(" ".join(command))
+        proc = subprocess.run(command, check=True, stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT, text=True)
+        logging.debug(proc.stdout)
+
+    summary = {}
+    if summary_file.is_file():
+        with open(summary_file, encoding="utf-8") as f:
+            summary = next(csv.DictReader(f), {})
+    return optimised_model, summary
+
+
+def run_on_fvp(
+        model: Path,
+        variant: Variant,
+        fvp: Path,
+        axf: Path,
+        board: str,
+        model_address: int,
+        fvp_options: typing.List[str],
+        timeout: float
+) -> typing.List[str]:
+    """
+    Run an optimised model with the inference runner on the FVP.
+
+    The application does not end the simulation, so the FVP is stopped once
+    the inference runner reports that it has finished.
+
+    :param model:           The optimised model.
+    :param variant:         The variant the model was compiled for.
+    :param fvp:             The FVP executable.
+    :param axf:             The inference runner built with dynamic model loading.
+    :param board:           Name of the board component in the FVP, e.g. "mps3_board".
+    :param model_address:   Address the inference runner reads the model from.
+    :param fvp_options:     Additional FVP command line arguments.
+    :param timeout:         Seconds to wait for the inference runner.
+    :return:                The application's output.
+    """
+    command = [
+        str(fvp), "-a", str(axf),
+        "--data", f"{model}@{model_address:#x}",
+        "-C", f"{board}.visualisation.disable-visualisation=1",
+        "-C", f"{board}.telnetterminal0.start_telnet=0",
+        "-C", f"{board}.uart0.out_file=-",
+        "-C", f"{board}.uart0.unbuffered_output=1",
+        "-C", f"ethosu.num_macs={variant.config.macs}",
+        *itertools.chain.from_iterable(shlex.split(option) for option in fvp_options),
+    ]
+    logging.info(" ".join(command))
+
+    lines = []
+    with subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                          text=True, errors="replace") as proc:
+        timer = threading.Timer(timeout, proc.kill)
+        timer.start()
+        try:
+            for line in proc.stdout:
+                line = line.rstrip()
+                logging.debug(line)
+                lines.append(line)
+                if any(marker in line for marker in end_markers):
+                    break
+        finally:
+            timer.cancel()
+            proc.kill()
+    return lines
+
+
+def parse_fvp_output(lines: typing.List[str], result: Result):
+    """
+    Read the tensor arena size and the NPU counters of the inference from the
+    inference runner's output.
+
+    Only the counters after "Final results:" are used; the ones printed later
+    belong to the inference runner's optional tests.
+
+    :param lines:   The inference runner's output.
+    :param result:  The result to fill in.
+    """
+    in_final_results = False
+    for line in lines:
+        match = arena_used_pattern.search(line)
+        if match:
+            result.arena_size = int(match.group(1))
+            continue
+
+        if final_results_marker in line:
+            in_final_results = True
+            continue
+
+        if not in_final_results:
+            continue
+
+        match = counter_pattern.search(line)
+        if match:
+            result.counters[match.group(1)] = int(match.group(2))
+        elif "Profile for" not in line and "Total number of inferences" not in line:
+            in_final_results = False
+
+    if not any("Inference completed." in line for line in lines):
+        result.status = "run failed"
+        return
+
+    cycles = result.counters.get("NPU TOTAL", result.counters.get("NPU ACTIVE"))
+    result.npu_cycles = cycles
+    beats = [value for name, value in result.counters.items() if "BEAT" in name]
+    result.axi_beats = sum(beats) if beats else None
+
+
+def mark_pareto_optimal(results: typing.List[Result]):
+    """
+    Mark the results that no other result for the same NPU beats on all of NPU
+    cycles, tensor arena size and flash size.
+
+    :param results: The results.
+    """
+    for result in results:
+        metrics = result.metrics
+        if metrics is None:
+            continue
+        result.pareto = not any(
+            other.metrics is not None
+            and other.variant.config.config_name == result.variant.config.config_name
+            and all(o <= m for o, m in zip(other.metrics, metrics))
+            and other.metrics != metrics
+            for other in results
+        )
+
+
+def print_table(results: typing.List[Result]):
+    """
+    Print the results as a table. Pareto optimal variants are marked with '*'.
+
+    :param results: The results.
+    """
+    def value(number) -> str:
+        return "-" if number is None else str(number)
+
+    header = ("", "Model", "NPU", "Memory mode", "System config", "Optimise",
+              "Arena cache", "NPU cycles", "AXI beats", "Arena", "Flash", "Status")
+    rows = [header]
+    for result in results:
+        config = result.variant.config
+        rows.append((
+            "*" if result.pareto else "",
+            result.variant.model.stem,
+            config.config_name,
+            config.memory_mode,
+            config.system_config,
+            result.variant.optimise,
+            value(config.arena_cache_size),
+            value(result.npu_cycles),
+            value(result.axi_beats),
+            value(result.arena_size),
+            value(result.flash_size or None),
+            result.status,
+        ))
+
+    widths = [max(len(row[i]) for row in rows) for i in range(len(header))]
+    for row in rows:
+        print("  ".join(cell.ljust(width) for cell, width in zip(row, widths)).rstrip())
+
+
+def write_csv(results: typing.List[Result], csv_file: Path):
+    """
+    Write the results, with every NPU counter and Vela's estimates, to a CSV file.
+
+    :param results:     The results.
+    :param csv_file:    The file to write.
+    """
+    counter_names = sorted({name for result in results for name in result.counters})
+    vela_fields = ("cycles_total", "inference_time", "sram_memory_used", "off_chip_flash_memory_used")
+
+    with open(csv_file, "w", newline="", encoding="utf-8") as f:
+        writer = csv.writer(f)
+        writer.writerow([
+            "model", "accelerator_config", "memory_mode", "system_config", "optimise",
+            "arena_cache_size", "status", "pareto_optimal", "flash_size", "arena_size",
+            "npu_cycles", "axi_beats", *counter_names, *[f"vela_{name}" for name in vela_fields]
+        ])
+        for result in results:
+            config = result.variant.config
+            writer.writerow([
+                result.variant.model, config.config_name, config.memory_mode,
+                config.system_config, result.variant.optimise, config.arena_cache_size or "",
+                result.status, int(result.pareto), result.flash_size or "",
+                result.arena_size if result.arena_size is not None else "",
+                result.npu_cycles if result.npu_cycles is not None else "",
+                result.axi_beats if result.axi_beats is not None else "",
+                *[result.counters.get(name, "") for name in counter_names],
+                *[result.vela_summary.get(name, "") for name in vela_fields]
+            ])
+
+
+def get_default_vela() -> str:
+    """
+    Get Vela from the environment set up by set_up_default_resources.py,
+    or from the PATH if there is none.
+
+    :return:    The Vela executable.
+    """
+    vela = default_downloads_path / "env" / "bin" / "vela"
+    return str(vela) if vela.is_file() else "vela"
+
+
+def main(args) -> int:
+    """
+    Run the sweep.
+
+    :param args:    The parsed command line arguments.
+    :return:        The exit code.
+    """
+    configs = []
+    for name in args.ethos_u_config_name or default_npu_configs.names:
+        config = valid_npu_configs.get_by_name(name)
+        if not config:
+            logging.error("Invalid Ethos-U configuration %s, valid ones are: %s",
+                          name, valid_npu_configs.names)
+            return 1
+        configs.append(config)
+
+    if args.fvp and not args.axf:
+        logging.error("--axf is needed to run the variants on the FVP")
+        return 1
+
+    variants = make_variants(
+        models=[model.resolve() for model in args.model],
+        configs=configs,
+        memory_modes=args.memory_mode,
+        system_configs=args.system_config,
+        optimise_strategies=args.optimise or ["Performance", "Size"],
+        arena_cache_sizes=args.arena_cache_size or [0]
+    )
+    logging.info("Sweeping %d variants", len(variants))
+
+    results = []
+    for variant in variants:
+        result = Result(variant=variant)
+        results.append(result)
+
+        try:
+            optimised_model, result.vela_summary = compile_variant(
+                variant, args.vela, args.config, args.output_dir)
+        except subprocess.CalledProcessError as err:
+            logging.warning("Vela failed for %s:\n%s", variant.name, err.stdout)
+            result.status = "vela failed"
+            continue
+        result.flash_size = optimised_model.stat().st_size
+
+        if args.fvp:
+            lines = run_on_fvp(optimised_model, variant, args.fvp, args.axf, args.fvp_board,
+                               args.model_address, args.fvp_option, args.timeout)
+            parse_fvp_output(lines, result)
+
+    mark_pareto_optimal(results)
+    print_table(results)
+    if args.csv:
+        write_csv(results, args.csv)
+    return 0
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description="Compare a model compiled with different Vela options")
+    parser.add_argument(
+        "--model",
+        help="Model to compile (can specify multiple times)",
+        type=Path,
+        action="append",
+        required=True
+    )
+    parser.add_argument(
+        "--ethos-u-config-name",
+        help=f"""NPU configurations to compile for (can specify multiple times), the default ones
+        if not given. Valid values are: {valid_npu_configs.names}""",
+        default=[],
+        action="append"
+    )
+    parser.add_argument(
+        "--memory-mode",
+        help="Vela memory mode (can specify multiple times), the NPU configuration's if not given",
+        default=[],
+        action="append"
+    )
+    parser.add_argument(
+        "--system-config",
+        help="Vela system configuration (can specify multiple times), the NPU configuration's if not given",
+        default=[],
+        action="append"
+    )
+    parser.add_argument(
+        "--optimise",
+        help="Vela optimisation strategy (can specify multiple times), both if not given",
+        choices=["Performance", "Size"],
+        default=[],
+        action="append"
+    )
+    parser.add_argument(
+        "--arena-cache-size",
+        help="Arena cache size in bytes, 0 for the default (can specify multiple times)",
+        type=int,
+        default=[],
+        action="append"
+    )
+    parser.add_argument(
+        "--config",
+        help="Vela configuration file",
+        type=Path,
+        default=default_vela_config_file
+    )
+    parser.add_argument(
+        "--vela",
+        help="Vela executable",
+        default=get_default_vela()
+    )
+    parser.add_argument(
+        "--output-dir",
+        help="Directory for the compiled variants; variants found there are not compiled again",
+        type=Path,
+        default=Path("vela_sweep")
+    )
+    parser.add_argument(
+        "--fvp",
+        help="FVP executable to run the variants on",
+        type=Path
+    )
+    parser.add_argument(
+        "--axf",
+        help="Inference runner application built with dynamic model loading",
+        type=Path
+    )
+    parser.add_argument(
+        "--fvp-board",
+        help="Name of the board component of the FVP",
+        default="mps3_board"
+    )
+    parser.add_argument(
+        "--fvp-option",
+        help="Additional FVP command line arguments, e.g. \"-C cpu0.semihosting-enable=0\" "
+             "(can specify multiple times)",
+        default=[],
+        action="append"
+    )
+    parser.add_argument(
+        "--model-address",
+        help="Address the inference runner loads the model from (DYNAMIC_MODEL_BASE)",
+        type=lambda value: int(value, 0),
+        default=default_dynamic_model_base
+    )
+    parser.add_argument(
+        "--timeout",
+        help="Seconds to wait for each run on the FVP",
+        type=float,
+        default=600
+    )
+    parser.add_argument(
+        "--csv",
+        help="CSV file to write the results to",
+        type=Path
+    )
+
+    logging.basicConfig(level=logging.INFO, format="%(levelname)s - %(message)s")
+    sys.exit(main(parser.parse_args()))
@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ARENA_PLAN_HPP
+#define ARENA_PLAN_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace arm {
+namespace app {
+
+    /** @brief  A tensor placed in the tensor arena by the memory planner. */
+    struct ArenaTensor {
+        int index;          /* Index of the tensor in the subgraph. */
+        const char* name;   /* Name from the model, never nullptr. */
+        size_t offset;      /* Offset from the start of the tensor arena. */
+        size_t bytes;       /* Size in bytes. */
+        int firstOp;        /* First operator needing the tensor. */
+        int lastOp;         /* Last operator needing the tensor. */
+    };
+
+    /**
+     * @brief   Where the tensors of a model live in the tensor arena and
+     *          between which operators they are needed. Tensors are placed
+     *          in the head of the arena; persistent data, such as the
+     *          interpreter's structures and the operators' data, goes in
+     *          its tail.
+     */
+    class ArenaPlan {
+    public:
+        /** @brief  Removes all tensors. */
+        void Clear();
+
+        /** @brief  Adds a tensor. */
+        void Add(const ArenaTensor& tensor);
+
+        /** @brief  Gets the tensors, in the order they were added. */
+        const std::vector<ArenaTensor>& GetTensors() const;
+
+        /** @brief  Gets the end of the highest tensor, from the start of the arena. */
+        size_t GetExtent() const;
+
+        /**
+         * @brief       Gets the largest total size of the tensors needed at
+         *              the same time, the least any plan can use.
+         * @param[out]  op  Optional: an operator at which it is reached.
+         * @return      Size in bytes.
+         **/
+        size_t GetPeakLiveBytes(int* op = nullptr) const;
+
+        /** @brief  Gets the bytes of the extent that the plan loses to
+         *          fragmentation: the extent less the peak live size. */
+        size_t GetFragmentation() const;
+
+        /**
+         * @brief       Looks for two tensors that are needed at the same time
+         *              and share memory, which would be a broken plan.
+         * @param[out]  first   Position of one of the tensors in the list.
+         * @param[out]  second  Position of the other.
+         * @return      true if there are such tensors.
+         **/
+        bool FindOverlap(size_t& first, size_t& second) const;
+
+    private:
+        std::vector<ArenaTensor> m_tensors{};
+    };
+
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* ARENA_PLAN_HPP */
@@ -0,0 +1,196 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CASCADE_HPP
+#define CASCADE_HPP
+
+#include <cstdint>
+#include <functional>
+
+namespace arm {
+namespace app {
+
+    /**
+     * @brief   One stage of a cascade: a model or any other detector that
+     *          produces a score.
+     */
+    class CascadeStage {
+    public:
+        virtual ~CascadeStage() = default;
+
+        /**
+         * @brief   Prepares the stage. Called before the first run, and again
+         *          after the stage has been released.
+         * @return  true if successful, false otherwise.
+         **/
+        virtual bool Init() { return true; }
+
+        /**
+         * @brief       Runs the stage once.
+         * @param[out]  score   Score of the run; the cascade compares the
+         *                      score of the first stage with its threshold.
+         * @return      true if successful, false otherwise.
+         **/
+        virtual bool Run(float& score) = 0;
+
+        /** @brief  Frees what Init set up, e.g. to gate clocks while idle. */
+        virtual void Release() {}
+    };
+
+    /** @brief  When the second stage of a cascade runs. */
+    struct CascadeConfig {
+        float threshold{0.5f};      /* First stage score at or above which the gate fires. */
+        uint32_t triggerCount{1};   /* Consecutive scores at or above the threshold needed to fire. */
+        uint32_t holdCount{0};      /* Further periods the second stage runs for after the gate fires. */
+        uint32_t releaseCount{0};   /* Idle periods after which the second stage is released, 0 for never. */
+    };
+
+    /** @brief  Time accounting of one stage, in clock ticks. */
+    struct CascadeStageStats {
+        uint32_t runs{0};           /* Number of runs. */
+        uint32_t inits{0};          /* Number of times the stage was initialised. */
+        uint64_t runTime{0};        /* Time spent running. */
+        uint64_t initTime{0};       /* Time spent initialising. */
+        uint64_t maxLatency{0};     /* Longest run. */
+
+        /** @brief  Time the stage was active for. */
+        uint64_t ActiveTime() const { return runTime + initTime; }
+
+        /** @brief  Average run time. */
+        uint64_t AverageLatency() const { return runs ? runTime / runs : 0; }
+    };
+
+    /** @brief  Power drawn by the system in each state, in any unit. */
+    struct CascadePower {
+        float idle{0};      /* Nothing running, e.g. sleeping between periods. */
+        float first{0};     /* First stage running. */
+        float second{0};    /* Second stage running or initialising. */
+    };
+
+    /**
+     * @brief   Runs a cheap first stage every period and an expensive second
+     *          stage only when the first one fires, e.g. a motion or voice
+     *          detector in front of a detection or speech model. The second
+     *          stage is initialised the first time it is needed.
+     *
+     *          The time spent in each stage is measured so that the share of
+     *          time each one is active, and from it the average power, can
+     *          be compared with running the second stage every period.
+     */
+    class Cascade {
+    public:
+        /** Returns a monotonic time in ticks, e.g. microseconds. */
+        using Clock = std::function<uint64_t()>;
+
+        /**
+         * @param[in]   first   Stage run every period.
+         * @param[in]   second  Stage run when the first one fires.
+         * @param[in]   config  Gating parameters.
+         * @param[in]   clock   Time source for the accounting.
+         **/
+        Cascade(CascadeStage& first, CascadeStage& second,
+                const CascadeConfig& config, Clock clock);
+
+        /**
+         * @brief   Runs one period: the first stage, then the second one if
+         *          the gate fires or is held open.
+         * @return  true if successful, false if a stage failed.
+         **/
+        bool Step();
+
+        /** @brief  Whether the second stage ran in the last period. */
+        bool SecondStageRan() const;
+
+        /** @brief  Score of the first stage in the last period. */
+        float LastScore() const;
+
+        /** @brief  Number of times the gate fired: the periods in which the
+         *          trigger count was reached, not those it was exceeded in. */
+        uint32_t GetFireCount() const;
+
+        /** @brief  Number of periods run. */
+        uint32_t GetPeriodCount() const;
+
+        /** @brief  Accounting of the first stage. */
+        const CascadeStageStats& GetFirstStats() const;
+
+        /** @brief  Accounting of the second stage. */
+        const CascadeStageStats& GetSecondStats() const;
+
+        /** @brief  Time from the start of the first period to the end of the last. */
+        uint64_t GetElapsedTime() const;
+
+        /**
+         * @brief       Gets the share of the elapsed time a stage was active for.
+         * @param[in]   stats   Accounting of the stage.
+         * @return      Duty cycle between 0 and 1.
+         **/
+        float DutyCycle(const CascadeStageStats& stats) const;
+
+        /**
+         * @brief       Estimates the average power over the elapsed time.
+         * @param[in]   power   Power drawn in each state.
+         * @return      Average power, in the unit of power.
+         **/
+        float EstimateAveragePower(const CascadePower& power) const;
+
+        /**
+         * @brief       Estimates the average power of running the second stage
+         *              alone every period, from its average latency.
+         * @param[in]   power   Power drawn in each state.
+         * @return      Average power, in the unit of power.
+         **/
+        float EstimateUngatedPower(const CascadePower& power) const;
+
+        /**
+         * @brief       Logs the accounting.
+         * @param[in]   ticksPerMs  Clock ticks per millisecond.
+         * @param[in]   power       If not null, also logs the power estimates.
+         **/
+        void PrintStats(uint64_t ticksPerMs, const CascadePower* power = nullptr) const;
+
+        /** @brief  Clears the accounting, keeping the state of the gate. */
+        void ResetStats();
+
+    private:
+        CascadeStage& m_first;
+        CascadeStage& m_second;
+        CascadeConfig m_config;
+        Clock m_clock;
+
+        bool m_secondReady{false};      /* Second stage initialised. */
+        bool m_secondRan{false};        /* Second stage ran in the last period. */
+        float m_lastScore{0};
+        uint32_t m_consecutive{0};      /* Consecutive scores at or above the threshold. */
+        uint32_t m_holdLeft{0};         /* Periods left with the gate held open. */
+        uint32_t m_idlePeriods{0};      /* Periods since the second stage last ran. */
+
+        uint32_t m_periods{0};
+        uint32_t m_fires{0};
+        bool m_started{false};          /* Accounting started. */
+        uint64_t m_startTime{0};
+        uint64_t m_endTime{0};
+        CascadeStageStats m_firstStats{};
+        CascadeStageStats m_secondStats{};
+
+        /** @brief  Initialises the second stage if needed and runs it. */
+        bool RunSecond();
+    };
+
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* CASCADE_HPP */
@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef IMAGE_INPUT_ADAPTER_HPP
+#define IMAGE_INPUT_ADAPTER_HPP
+
+#include "TensorFlowLiteMicro.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace arm {
+namespace app {
+namespace image {
+
+    /** @brief  How 8-bit pixel values map to the values of an input tensor. */
+    enum class PixelMapping {
+        Copy,       /* Written as they are, e.g. to uint8 tensors. */
+        ToInt8,     /* Shifted by -128, from the uint8 to the int8 range. */
+        Quantise    /* Normalised to [0, 1], then quantised with the tensor's parameters. */
+    };
+
+    /**
+     * @brief   Writes images to an input tensor, with an optional RGB to
+     *          grayscale conversion and the pixel mapping done in one pass.
+     *          The mapping of each of the 256 pixel values is worked out once,
+     *          on construction.
+     */
+    class InputAdapter {
+    public:
+        /**
+         * @brief       Constructor.
+         * @param[in]   mapping         How pixel values map to tensor values.
+         * @param[in]   quantParams     Quantisation parameters of the tensor,
+         *                              used by PixelMapping::Quantise.
+         * @param[in]   rgb2Gray        Convert images from 3 channel RGB to
+         *                              1 channel grayscale.
+         **/
+        InputAdapter(PixelMapping mapping, const QuantParams& quantParams, bool rgb2Gray);
+
+        /**
+         * @brief       Converts an image into a tensor's data.
+         * @param[in]   src         Source image, RGB if converting to grayscale.
+         * @param[in]   srcSize     Size of the source image in bytes.
+         * @param[out]  dst         Tensor data.
+         * @param[in]   dstSize     Size of the tensor data in bytes.
+         * @return      Number of bytes written, the smaller of the tensor size
+         *              and the number of source pixels.
+         **/
+        size_t Write(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) const;
+
+        /** @brief  Tensor value, as a byte, of a pixel value. */
+        uint8_t Map(uint8_t pixel) const { return this->m_lut[pixel]; }
+
+    private:
+        std::array<uint8_t, 256> m_lut{};
+        bool m_identity;
+        bool m_rgb2Gray;
+    };
+
+} /* namespace image */
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* IMAGE_INPUT_ADAPTER_HPP */
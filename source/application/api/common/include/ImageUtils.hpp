@@ -100,6 +100,16 @@ namespace image {
      **/
     void CalculateNMS(std::forward_list<Detection>& detections, int classes, float iouThreshold);
 
+    /**
+     * @brief           Calculate the Non-Maxima suppression on the given detection boxes
+     *                  without allocating memory. The boxes are reordered.
+     * @param[in,out]   detections    Array of Detection boxes.
+     * @param[in]       count         Number of Detection boxes.
+     * @param[in]       classes       Number of classes.
+     * @param[in]       iouThreshold  Intersection over union threshold.
+     **/
+    void CalculateNMS(Detection* detections, size_t count, int classes, float iouThreshold);
+
     /**
      * @brief           Helper function to convert a UINT8 image to INT8 format.
      * @param[in,out]   data            Pointer to the data start.
@@ -107,6 +117,20 @@ namespace image {
      **/
     void ConvertImgToInt8(void* data, size_t kMaxImageSize);
 
+    /**
+     * @brief       Converts an RGB pixel to grayscale.
+     * @param[in]   rgb     Pointer to the red, green and blue values.
+     * @return      Gray level.
+     **/
+    inline uint8_t RgbToGray(const uint8_t* rgb)
+    {
+        const float R = 0.299;
+        const float G = 0.587;
+        const float B = 0.114;
+        const uint32_t gray = R * rgb[0] + G * rgb[1] + B * rgb[2];
+        return gray <= UINT8_MAX ? gray : UINT8_MAX;
+    }
+
     /**
      * @brief       Converts RGB image to grayscale.
      * @param[in]   srcPtr   Pointer to RGB source image.
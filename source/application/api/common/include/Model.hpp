@@ -18,8 +18,12 @@
 #define MODEL_HPP
 
 #include "TensorFlowLiteMicro.hpp"
+#include "ArenaPlan.hpp"
+#include "NpuAsync.hpp"
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 
 namespace arm {
 namespace app {
@@ -29,11 +33,15 @@ namespace app {
      */
     class Model {
     public:
+        /** @brief  Function called when an asynchronous inference finishes,
+         *          with true if it succeeded. */
+        using InferenceCallback = std::function<void(bool success)>;
+
         /** @brief Constructor. */
         Model();
 
-        /** @brief Destructor. */
-        virtual ~Model() = default;
+        /** @brief Destructor. Drops the model's NPU cache regions. */
+        virtual ~Model();
 
         /** @brief  Gets the pointer to the model's input tensor at given input index. */
         TfLiteTensor* GetInputTensor(size_t index) const;
@@ -97,6 +105,70 @@ namespace app {
         /** @brief  Runs the inference (invokes the interpreter). */
         virtual bool RunInference();
 
+        /**
+         * @brief       Sets the backend running the Ethos-U operator. Must be
+         *              called before Init. Asynchronous inference and weight
+         *              staging need one, e.g. GetDefaultNpuBackend(). Defaults
+         *              to none, which keeps TFLM's Ethos-U operator, unless
+         *              built with ETHOS_U_NPU_ASYNC.
+         * @param[in]   backend     Backend, or nullptr to use the Ethos-U
+         *                          operator from the model's op resolver.
+         **/
+        void SetNpuBackend(NpuBackend* backend);
+
+        /**
+         * @brief       Sets how much of the tensor arena may hold copies of
+         *              the constant tensors read by the NPU, such as the
+         *              command streams and weights. Must be called before
+         *              Init. Copies help when the model is in slow memory,
+         *              e.g. external flash.
+         * @param[in]   bytes   Budget in bytes, 0 to read every tensor in place.
+         **/
+        void SetWeightStagingBudget(size_t bytes);
+
+        /** @brief  Gets the number of bytes of the arena used by staged weights. */
+        size_t GetStagedWeightsSize() const;
+
+        /**
+         * @brief       Selects whether inferences read the staged copies of
+         *              the weights or the originals, to compare the two.
+         * @param[in]   use     true to read the staged copies (default).
+         **/
+        void UseStagedWeights(bool use);
+
+        /**
+         * @brief   Checks if StartInference can return while the NPU is still
+         *          running: the model has a single Ethos-U operator and no
+         *          CPU operators after it.
+         **/
+        bool SupportsAsyncInference() const;
+
+        /**
+         * @brief       Starts an inference. Operators before the Ethos-U
+         *              operator run straight away; the call returns once the
+         *              NPU job has started. The input and output tensors must
+         *              not be accessed until the inference has finished.
+         *              Models that do not support asynchronous inference run
+         *              to completion before this returns.
+         * @param[in]   callback    Optional function called from
+         *                          PollInference or WaitForInference when
+         *                          the inference finishes.
+         * @return      true if the inference was started, false otherwise.
+         **/
+        bool StartInference(InferenceCallback callback = nullptr);
+
+        /**
+         * @brief   Checks on the inference without blocking.
+         * @return  Status of the last inference started.
+         **/
+        InferenceStatus PollInference();
+
+        /**
+         * @brief   Waits for the inference started last to finish.
+         * @return  true if it finished successfully, false otherwise.
+         **/
+        bool WaitForInference();
+
         /** @brief   Model information handler common to all models.
          *  @return  true or false based on execution success.
          **/
@@ -105,6 +177,18 @@ namespace app {
         /** @brief   Gets a pointer to the tensor arena. */
         uint8_t* GetTensorArena();
 
+        /** @brief   Gets the number of bytes of the tensor arena in use, including
+         *           by the models initialised before this one with the same allocator. */
+        size_t GetArenaUsedBytes() const;
+
+        /**
+         * @brief       Describes where the model's tensors were placed in the
+         *              tensor arena and which operators need them.
+         * @param[out]  plan    Plan, cleared first.
+         * @return      true if the model is initialised, false otherwise.
+         **/
+        bool GetArenaPlan(ArenaPlan& plan) const;
+
     protected:
         /** @brief      Gets the pointer to the NN model data array.
          *  @return     Pointer of uint8_t type.
@@ -133,16 +217,60 @@ namespace app {
         size_t GetActivationBufferSize();
 
     private:
+        /** @brief  Records the end of an inference and calls the callback. */
+        void FinishInference(bool success);
+
+        /** @brief  Counts the Ethos-U operators and finds the last one. */
+        size_t CountEthosUOperators(size_t& lastIndex) const;
+
+        /**
+         * @brief   Chooses the constant tensors of the Ethos-U operators to
+         *          stage within the budget: command streams first, as the
+         *          NPU keeps fetching them, then the largest weight tensors.
+         **/
+        void PlanWeightStaging();
+
+        /**
+         * @brief       Describes the memory used by the model's NPU jobs to
+         *              the NPU cache maintenance, so that only the input and
+         *              output tensors are maintained around jobs.
+         * @param[in]   arena       Tensor arena.
+         * @param[in]   arenaSize   Size of the tensor arena in bytes.
+         **/
+        void AddNpuCacheRegions(const uint8_t* arena, size_t arenaSize) const;
+
+        /**
+         * @brief       Drops the regions added by AddNpuCacheRegions, which no
+         *              longer describe the memory once the model is
+         *              initialised again or its arena reused.
+         **/
+        void RemoveNpuCacheRegions() const;
+
         const tflite::Model* m_pModel{nullptr};            /* Tflite model pointer. */
         std::unique_ptr<tflite::MicroInterpreter> m_pInterpreter{nullptr}; /* Tflite interpreter. */
         tflite::MicroAllocator* m_pAllocator{nullptr};     /* Tflite micro allocator. */
         bool m_inited{false};                              /* Indicates whether this object has been initialised. */
         const uint8_t* m_modelAddr{nullptr};               /* Model address */
         uint32_t m_modelSize{0};                           /* Model size */
+        const uint8_t* m_arenaAddr{nullptr};               /* Tensor arena address */
+        size_t m_arenaSize{0};                             /* Tensor arena size */
 
         std::vector<TfLiteTensor*> m_input{};              /* Model's input tensor pointers. */
         std::vector<TfLiteTensor*> m_output{};             /* Model's output tensor pointers. */
         TfLiteType m_type{kTfLiteNoType};                  /* Model's data type. */
+
+#if defined(ETHOS_U_NPU_ASYNC)
+        NpuBackend* m_npuBackend{GetDefaultNpuBackend()};  /* Backend running Ethos-U jobs. */
+#else /* defined(ETHOS_U_NPU_ASYNC) */
+        NpuBackend* m_npuBackend{nullptr};                 /* Backend running Ethos-U jobs; none uses TFLM's kernel. */
+#endif /* defined(ETHOS_U_NPU_ASYNC) */
+        NpuInvokeContext m_npuContext{};                   /* State shared with the Ethos-U operator. */
+        std::unique_ptr<NpuAsyncOpResolver> m_pOpResolver{nullptr}; /* Resolver used by the interpreter. */
+        size_t m_weightStagingBudget{0};                   /* Arena bytes for staged weights. */
+        bool m_asyncCapable{false};                        /* Inference can overlap the NPU job. */
+        InferenceStatus m_inferenceStatus{InferenceStatus::Idle}; /* Status of the last inference. */
+        InferenceCallback m_inferenceCallback{};           /* Called when the inference finishes. */
+        uint64_t m_inferenceStart{0};                      /* Trace time the inference started. */
     };
 
 } /* namespace app */
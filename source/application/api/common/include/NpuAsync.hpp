@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NPU_ASYNC_HPP
+#define NPU_ASYNC_HPP
+
+#include "TensorFlowLiteMicro.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace arm {
+namespace app {
+
+    /** @brief  Command stream and tensor addresses of one Ethos-U operator. */
+    struct NpuJob {
+        const void* commandStream{nullptr};     /* Ethos-U command stream. */
+        size_t commandStreamSize{0};            /* Command stream size in bytes. */
+        uint64_t* baseAddr{nullptr};            /* Base addresses of the operator's tensors. */
+        const size_t* baseAddrSize{nullptr};    /* Sizes of the tensors in bytes. */
+        int numBaseAddr{0};                     /* Number of base addresses. */
+    };
+
+    /** @brief  State of an inference or NPU job. */
+    enum class InferenceStatus {
+        Idle,       /* Nothing has been started. */
+        Running,    /* Started and not finished yet. */
+        Done,       /* Finished successfully. */
+        Error       /* Failed. */
+    };
+
+    /**
+     * @brief   Executes Ethos-U jobs without blocking the caller. One job
+     *          can be in flight at a time.
+     */
+    class NpuBackend {
+    public:
+        virtual ~NpuBackend() = default;
+
+        /**
+         * @brief       Starts a job and returns straight away.
+         * @param[in]   job     Job to start; the arrays must stay valid
+         *                      until the job has finished.
+         * @return      true if the job was started, false otherwise.
+         **/
+        virtual bool Start(const NpuJob& job) = 0;
+
+        /**
+         * @brief       Checks on the job started last.
+         * @param[in]   block   If true, waits until the job has finished.
+         * @return      Running while the job is in progress, then Done or Error.
+         **/
+        virtual InferenceStatus Wait(bool block) = 0;
+    };
+
+    /**
+     * @brief   Gets the backend driving the Ethos-U NPU of the platform.
+     * @return  Pointer to the backend, or nullptr if the build has no NPU.
+     **/
+    NpuBackend* GetDefaultNpuBackend();
+
+    /**
+     * @brief   Constant tensors of the Ethos-U operators to copy into the
+     *          tensor arena when the model is prepared, so that the NPU reads
+     *          them from SRAM instead of the memory holding the model.
+     */
+    struct NpuWeightStaging {
+        static constexpr int MAX_TENSORS = 8;
+
+        int tensors[MAX_TENSORS]{};     /* Indices of the tensors to copy. */
+        int numTensors{0};              /* Number of tensors to copy. */
+        int numStaged{0};               /* Number of tensors copied. */
+        size_t stagedBytes{0};          /* Bytes of the arena used by the copies. */
+        bool bypass{false};             /* Use the original tensors, e.g. to compare timings. */
+    };
+
+    /**
+     * @brief   Per-interpreter state shared with the Ethos-U operator. It is
+     *          set as the interpreter's external context.
+     */
+    struct NpuInvokeContext {
+        /* The Ethos-U has 8 address regions. */
+        static constexpr int MAX_BASE_ADDR = 8;
+
+        NpuBackend* backend{nullptr};   /* Backend running the jobs. */
+        bool deferWait{false};          /* Return from the operator once the job has started. */
+        bool jobStarted{false};         /* Set by the operator when it returns early. */
+
+        /* Addresses of the job in flight. They are kept out of the tensor
+         * arena so that the CPU writes nothing there during inferences. */
+        uint64_t baseAddr[MAX_BASE_ADDR]{};
+        size_t baseAddrSize[MAX_BASE_ADDR]{};
+
+        NpuWeightStaging staging{};     /* Constant tensors staged in the arena. */
+    };
+
+    /**
+     * @brief   Op resolver forwarding to another one, except that the
+     *          Ethos-U custom operator is provided by an implementation
+     *          that runs its job through an NpuBackend and can return
+     *          before the job has finished.
+     */
+    class NpuAsyncOpResolver : public tflite::MicroOpResolver {
+    public:
+        /**
+         * @param[in]   resolver    Resolver providing all other operators.
+         * @param[in]   enabled     If false, the Ethos-U operator is also
+         *                          taken from the wrapped resolver.
+         **/
+        NpuAsyncOpResolver(const tflite::MicroOpResolver& resolver, bool enabled);
+
+        const TFLMRegistration* FindOp(tflite::BuiltinOperator op) const override;
+        const TFLMRegistration* FindOp(const char* op) const override;
+        tflite::TfLiteBridgeBuiltinParseFunction GetOpDataParser(
+            tflite::BuiltinOperator op) const override;
+
+    private:
+        const tflite::MicroOpResolver& m_resolver;
+        bool m_enabled;
+    };
+
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* NPU_ASYNC_HPP */
@@ -0,0 +1,333 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "BaseProcessing.hpp"
+#include "Model.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#if defined(PIPELINE_THREADS)
+#include <atomic>
+#include <thread>
+#endif /* PIPELINE_THREADS */
+
+namespace arm {
+namespace app {
+
+    /** @brief  Outcome of asking a pipeline source for its next input. */
+    enum class PipelineInput {
+        Ready,      /* An input was returned. */
+        NotYet,     /* No input available yet, e.g. audio still being captured. */
+        End         /* The stream has ended. */
+    };
+
+    /** @brief  Provides the raw inputs of a pipeline, in order. */
+    class PipelineSource {
+    public:
+        virtual ~PipelineSource() = default;
+
+        /**
+         * @brief       Gets the next input, handed to the pre-processing as is.
+         * @param[out]  data    Input data; must stay valid until the next call.
+         * @param[out]  size    Size of the input data.
+         * @param[out]  index   Index of the input, e.g. of a window within a
+         *                      clip. Set to the position of the input in the
+         *                      stream before the call.
+         * @return      Whether an input was returned.
+         **/
+        virtual PipelineInput Next(const void*& data, size_t& size, size_t& index) = 0;
+    };
+
+    /** @brief  Writes the inputs of a pipeline to the input tensors. */
+    class PipelinePreProcess {
+    public:
+        virtual ~PipelinePreProcess() = default;
+
+        /**
+         * @brief       Pre-processes an input from the source.
+         * @param[in]   data    Input data.
+         * @param[in]   size    Size of the input data.
+         * @param[in]   index   Index the source gave the input.
+         * @return      true if successful, false otherwise.
+         **/
+        virtual bool DoPreProcess(const void* data, size_t size, size_t index) = 0;
+    };
+
+    /** @brief  Pre-processes the inputs of a pipeline with a BasePreProcess, without their index. */
+    class BasePreProcessStage : public PipelinePreProcess {
+    public:
+        explicit BasePreProcessStage(BasePreProcess& preProcess);
+
+        bool DoPreProcess(const void* data, size_t size, size_t index) override;
+
+    private:
+        BasePreProcess& m_preProcess;
+    };
+
+    /** @brief  Takes the results of a pipeline, in the order of the inputs. */
+    class PipelineSink {
+    public:
+        virtual ~PipelineSink() = default;
+
+        /**
+         * @brief       Called once an input has been post-processed, so the
+         *              results the post-processing wrote can be collected. The
+         *              output tensors still hold the outputs of that input.
+         * @param[in]   sequence    Position of the input in the stream, from 0.
+         * @return      true if successful, false to stop the pipeline.
+         **/
+        virtual bool Consume(uint32_t sequence) = 0;
+    };
+
+    /**
+     * @brief   Runs the inferences of a pipeline. Starting an inference may
+     *          return before it has finished, so that the pipeline can
+     *          pre-process and post-process other inputs meanwhile.
+     */
+    class PipelineInference {
+    public:
+        virtual ~PipelineInference() = default;
+
+        virtual size_t GetNumInputs() const = 0;
+        virtual size_t GetNumOutputs() const = 0;
+        virtual TfLiteTensor* GetInputTensor(size_t index) const = 0;
+        virtual TfLiteTensor* GetOutputTensor(size_t index) const = 0;
+
+        /**
+         * @brief   Starts an inference on the input tensors.
+         * @return  true if started, false otherwise.
+         **/
+        virtual bool Start() = 0;
+
+        /**
+         * @brief       Checks on the inference started last.
+         * @param[in]   block   If true, waits until it has finished.
+         * @return      Running while in progress, then Done or Error.
+         **/
+        virtual InferenceStatus Poll(bool block) = 0;
+    };
+
+    /**
+     * @brief   Runs the inferences of a model with StartInference, which
+     *          returns as soon as the NPU job has started for models that
+     *          support asynchronous inference, and runs to completion
+     *          otherwise.
+     */
+    class ModelInference : public PipelineInference {
+    public:
+        explicit ModelInference(Model& model);
+
+        size_t GetNumInputs() const override;
+        size_t GetNumOutputs() const override;
+        TfLiteTensor* GetInputTensor(size_t index) const override;
+        TfLiteTensor* GetOutputTensor(size_t index) const override;
+        bool Start() override;
+        InferenceStatus Poll(bool block) override;
+
+    protected:
+        Model& m_model;
+    };
+
+#if defined(PIPELINE_THREADS)
+    /**
+     * @brief   Runs the inferences of a model on a worker thread, so that the
+     *          CPU stages overlap with inferences on platforms with threads
+     *          but no NPU to run them asynchronously.
+     */
+    class ThreadedModelInference : public ModelInference {
+    public:
+        explicit ThreadedModelInference(Model& model);
+        ~ThreadedModelInference() override;
+
+        bool Start() override;
+        InferenceStatus Poll(bool block) override;
+
+    private:
+        std::thread m_worker;
+        std::atomic<InferenceStatus> m_status{InferenceStatus::Idle};
+    };
+#endif /* PIPELINE_THREADS */
+
+    /** @brief  Sizes of the queues between the stages of a pipeline. */
+    struct PipelineConfig {
+        size_t depth{2};    /* Pre-processed inputs waiting for inference, and outputs waiting for post-processing. */
+    };
+
+    /** @brief  Time accounting of one stage, in clock ticks. */
+    struct PipelineStageStats {
+        uint32_t runs{0};           /* Number of runs. */
+        uint64_t busyTime{0};       /* Time spent running. */
+        uint64_t maxLatency{0};     /* Longest run. */
+
+        /** @brief  Average run time. */
+        uint64_t AverageLatency() const { return runs ? busyTime / runs : 0; }
+    };
+
+    /** @brief  Accounting of a pipeline. */
+    struct PipelineStats {
+        PipelineStageStats preProcess{};
+        PipelineStageStats inference{};     /* From the start of each inference until it is seen finished. */
+        PipelineStageStats postProcess{};
+        uint32_t sourceWaits{0};            /* Times the source had no input ready. */
+        uint32_t backpressure{0};           /* Times the source was not asked as the input queue was full. */
+        uint64_t blockedTime{0};            /* Time spent waiting for inferences with nothing else to do. */
+        size_t maxInputQueue{0};            /* Most inputs waiting for inference at once. */
+        size_t maxOutputQueue{0};           /* Most outputs waiting for post-processing at once. */
+    };
+
+    /** @brief  Progress made by one step of a pipeline. */
+    enum class PipelineStatus {
+        Busy,       /* Work was done or an inference is in flight. */
+        Waiting,    /* Nothing to do until the source has an input ready. */
+        Done,       /* The source has ended and all its inputs have been consumed. */
+        Error       /* A stage failed. */
+    };
+
+    /**
+     * @brief   Streams inputs through pre-processing, inference and
+     *          post-processing, with bounded queues between the stages.
+     *
+     *          Inputs are pre-processed into a ring of staging buffers, and
+     *          copied into the input tensors when their inference starts.
+     *          Outputs are copied out of the output tensors when it finishes,
+     *          into a second ring that post-processing reads. The pre and post
+     *          processing objects keep the model's tensors: the data pointers
+     *          of the tensors are pointed at the staging buffers while they
+     *          run, which does not affect an inference in flight as kernels
+     *          use their own view of the tensors. The CPU stages can so run
+     *          while the NPU, or a worker thread, runs an inference.
+     *
+     *          When both queues are full the source is not asked for more
+     *          inputs until an inference has made room. All buffers are
+     *          allocated when the pipeline is constructed.
+     *
+     *          Stateful models, whose next input depends on the last output,
+     *          cannot be pipelined.
+     */
+    class Pipeline {
+    public:
+        /** Returns a monotonic time in ticks, e.g. CPU cycles. */
+        using Clock = std::function<uint64_t()>;
+
+        /**
+         * @param[in]   source          Provides the inputs.
+         * @param[in]   preProcess      Writes an input to the input tensors.
+         * @param[in]   inference       Runs the model.
+         * @param[in]   postProcess     Reads the output tensors.
+         * @param[in]   sink            Collects the results.
+         * @param[in]   config          Queue sizes.
+         * @param[in]   clock           Time source for the accounting; without
+         *                              one only runs are counted.
+         **/
+        Pipeline(PipelineSource& source, PipelinePreProcess& preProcess,
+                 PipelineInference& inference, BasePostProcess& postProcess,
+                 PipelineSink& sink, const PipelineConfig& config = PipelineConfig{},
+                 Clock clock = nullptr);
+
+        /**
+         * @brief   Does the next piece of work: retires a finished inference,
+         *          starts the next one, then post-processes an output or
+         *          pre-processes an input. Waits for the inference in flight
+         *          only when there is nothing else to do.
+         * @return  Progress made.
+         **/
+        PipelineStatus Step();
+
+        /**
+         * @brief   Steps until the source has ended and all its inputs have
+         *          been consumed, polling the source while it has no input.
+         * @return  true if successful, false if a stage failed.
+         **/
+        bool Run();
+
+        /**
+         * @brief   Drops inputs and outputs in the queues, e.g. to start on a
+         *          new stream. Waits for an inference in flight first.
+         **/
+        void Reset();
+
+        /** @brief  Number of inputs taken from the source since construction or reset. */
+        uint32_t GetInputCount() const;
+
+        /** @brief  Accounting since construction or the last reset of the stats. */
+        const PipelineStats& GetStats() const;
+
+        /**
+         * @brief       Logs the accounting; times only with a clock.
+         * @param[in]   ticksPerMs  Clock ticks per millisecond.
+         **/
+        void PrintStats(uint64_t ticksPerMs = 1) const;
+
+        /** @brief  Clears the accounting. */
+        void ResetStats();
+
+    private:
+        /** Fixed size queue of staging buffers. */
+        struct StagingRing {
+            std::vector<uint8_t> buffer;    /* depth slots of slotSize bytes. */
+            size_t slotSize{0};
+            size_t head{0};                 /* Slot at the front of the queue. */
+            size_t count{0};                /* Slots in the queue. */
+            uint32_t frontSequence{0};      /* Sequence of the input in the front slot. */
+
+            uint8_t* Slot(size_t index);
+        };
+
+        PipelineSource& m_source;
+        PipelinePreProcess& m_preProcess;
+        PipelineInference& m_inference;
+        BasePostProcess& m_postProcess;
+        PipelineSink& m_sink;
+        size_t m_depth;
+        Clock m_clock;
+
+        StagingRing m_inputs;
+        StagingRing m_outputs;
+        bool m_running{false};          /* Inference in flight. */
+        uint64_t m_inferenceStart{0};
+        bool m_sourceEnded{false};
+        bool m_failed{false};
+        uint32_t m_nextSequence{0};     /* Sequence of the next input from the source. */
+        PipelineStats m_stats{};
+
+        uint64_t Now() const;
+
+        /** @brief  Points the data of the tensors at a staging slot, or back. */
+        static void Redirect(const std::vector<TfLiteTensor*>& tensors, uint8_t* slot,
+                             std::vector<void*>& saved);
+        static void Restore(const std::vector<TfLiteTensor*>& tensors, const std::vector<void*>& saved);
+
+        std::vector<TfLiteTensor*> m_inputTensors;
+        std::vector<TfLiteTensor*> m_outputTensors;
+        std::vector<void*> m_savedData;
+
+        bool StartInference();
+        bool RetireInference(bool block);
+        bool PostProcessFront();
+        bool PreProcessNext(bool& progress);
+        PipelineStatus Fail(const char* what);
+    };
+
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* PIPELINE_HPP */
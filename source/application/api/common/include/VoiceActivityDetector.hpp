@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef VOICE_ACTIVITY_DETECTOR_HPP
+#define VOICE_ACTIVITY_DETECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace arm {
+namespace app {
+namespace audio {
+
+    /** @brief  Features of a block of audio used to detect voice. */
+    struct VadFeatures {
+        float energyDb{0};          /* Power without the DC offset, in dB relative to full scale, before gain. */
+        float zeroCrossingRate{0};  /* Share of consecutive samples crossing the mean. */
+    };
+
+    /** @brief  Parameters of the voice activity detector. */
+    struct VadConfig {
+        float thresholdDb{-55.f};           /* Energy below which a block is silence. */
+        float noiseMarginDb{6.f};           /* Energy above the noise floor needed, 0 to not track the floor. */
+        float noiseFloorRiseDb{0.5f};       /* Rise of the noise floor per block louder than it. */
+        float maxZeroCrossingRate{0.5f};    /* Blocks crossing the mean more often are taken as noise. */
+        uint32_t hangover{1};               /* Blocks still reported as voice after the last one with voice. */
+    };
+
+    /**
+     * @brief   Cheap energy based voice activity detector, deciding for each
+     *          block of audio whether it is worth running a model on.
+     *
+     *          A block holds voice if its energy is above a fixed threshold
+     *          and, optionally, a margin above a tracked noise floor, and it
+     *          does not cross its mean as often as broadband noise. The floor
+     *          follows quieter blocks at once and rises slowly otherwise.
+     */
+    class VoiceActivityDetector {
+    public:
+        /**
+         * @param[in]   config  Detection parameters.
+         **/
+        explicit VoiceActivityDetector(const VadConfig& config = VadConfig{});
+
+        /**
+         * @brief       Computes the features of a block in one pass over it
+         *              for the energy and one for the zero crossings.
+         * @param[in]   samples     Audio samples.
+         * @param[in]   numSamples  Number of samples.
+         * @param[in]   gain        Linear gain applied to the samples, taken
+         *                          out of the energy.
+         * @return      Features of the block.
+         **/
+        static VadFeatures ComputeFeatures(const int16_t* samples, size_t numSamples, float gain = 1.f);
+
+        /**
+         * @brief       Decides whether a block holds voice.
+         * @param[in]   samples     Audio samples.
+         * @param[in]   numSamples  Number of samples.
+         * @param[in]   gain        Linear gain applied to the samples.
+         * @return      true if the block holds voice or is within the
+         *              hangover of one that did.
+         **/
+        bool Process(const int16_t* samples, size_t numSamples, float gain = 1.f);
+
+        /**
+         * @brief       Decides whether a block holds voice from its features.
+         * @param[in]   features    Features of the block.
+         * @return      true if the block holds voice or is within the
+         *              hangover of one that did.
+         **/
+        bool Process(const VadFeatures& features);
+
+        /** @brief  Gets the features of the last block. */
+        const VadFeatures& GetLastFeatures() const;
+
+        /** @brief  Gets the tracked noise floor in dB. */
+        float GetNoiseFloorDb() const;
+
+        /** @brief  Gets the number of blocks reported as voice. */
+        uint32_t GetActiveCount() const;
+
+        /** @brief  Gets the number of blocks reported as silence. */
+        uint32_t GetSilentCount() const;
+
+        /** @brief  Clears the counters, keeping the noise floor. */
+        void ResetCounters();
+
+        /** @brief  Goes back to the initial state. */
+        void Reset();
+
+    private:
+        VadConfig m_config;
+        VadFeatures m_last{};
+        float m_noiseFloorDb;
+        uint32_t m_hangoverLeft{0};
+        uint32_t m_active{0};
+        uint32_t m_silent{0};
+    };
+
+} /* namespace audio */
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* VOICE_ACTIVITY_DETECTOR_HPP */
@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ArenaPlan.hpp"
+
+#include <algorithm>
+
+namespace arm {
+namespace app {
+
+    void ArenaPlan::Clear()
+    {
+        this->m_tensors.clear();
+    }
+
+    void ArenaPlan::Add(const ArenaTensor& tensor)
+    {
+        this->m_tensors.push_back(tensor);
+        if (!this->m_tensors.back().name) {
+            this->m_tensors.back().name = "";
+        }
+    }
+
+    const std::vector<ArenaTensor>& ArenaPlan::GetTensors() const
+    {
+        return this->m_tensors;
+    }
+
+    size_t ArenaPlan::GetExtent() const
+    {
+        size_t extent = 0;
+        for (const ArenaTensor& tensor : this->m_tensors) {
+            extent = std::max(extent, tensor.offset + tensor.bytes);
+        }
+        return extent;
+    }
+
+    size_t ArenaPlan::GetPeakLiveBytes(int* op) const
+    {
+        int lastOp = -1;
+        for (const ArenaTensor& tensor : this->m_tensors) {
+            lastOp = std::max(lastOp, tensor.lastOp);
+        }
+
+        size_t peak = 0;
+        int peakOp = 0;
+        for (int i = 0; i <= lastOp; ++i) {
+            size_t live = 0;
+            for (const ArenaTensor& tensor : this->m_tensors) {
+                if (tensor.firstOp <= i && i <= tensor.lastOp) {
+                    live += tensor.bytes;
+                }
+            }
+            if (live > peak) {
+                peak = live;
+                peakOp = i;
+            }
+        }
+
+        if (op) {
+            *op = peakOp;
+        }
+        return peak;
+    }
+
+    size_t ArenaPlan::GetFragmentation() const
+    {
+        return this->GetExtent() - this->GetPeakLiveBytes();
+    }
+
+    bool ArenaPlan::FindOverlap(size_t& first, size_t& second) const
+    {
+        for (size_t i = 0; i < this->m_tensors.size(); ++i) {
+            const ArenaTensor& a = this->m_tensors[i];
+            for (size_t j = i + 1; j < this->m_tensors.size(); ++j) {
+                const ArenaTensor& b = this->m_tensors[j];
+                const bool together = a.firstOp <= b.lastOp && b.firstOp <= a.lastOp;
+                const bool shared = a.offset < b.offset + b.bytes && b.offset < a.offset + a.bytes;
+                if (together && shared && a.bytes && b.bytes) {
+                    first = i;
+                    second = j;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+} /* namespace app */
+} /* namespace arm */
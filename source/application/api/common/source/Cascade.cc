@@ -0,0 +1,227 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Cascade.hpp"
+#include "log_macros.h"
+
+#include <cinttypes>
+#include <utility>
+
+namespace arm {
+namespace app {
+
+    Cascade::Cascade(CascadeStage& first, CascadeStage& second,
+                     const CascadeConfig& config, Clock clock)
+    :   m_first{first},
+        m_second{second},
+        m_config{config},
+        m_clock{std::move(clock)}
+    {
+        if (0 == this->m_config.triggerCount) {
+            this->m_config.triggerCount = 1;
+        }
+    }
+
+    static void AddRun(CascadeStageStats& stats, uint64_t time)
+    {
+        ++stats.runs;
+        stats.runTime += time;
+        if (time > stats.maxLatency) {
+            stats.maxLatency = time;
+        }
+    }
+
+    bool Cascade::Step()
+    {
+        const uint64_t start = this->m_clock();
+        if (!this->m_started) {
+            this->m_startTime = start;
+            this->m_started = true;
+        }
+        ++this->m_periods;
+        this->m_secondRan = false;
+
+        float score = 0;
+        const bool ok = this->m_first.Run(score);
+        this->m_endTime = this->m_clock();
+        AddRun(this->m_firstStats, this->m_endTime - start);
+        if (!ok) {
+            printf_err("First cascade stage failed.\n");
+            return false;
+        }
+        this->m_lastScore = score;
+
+        this->m_consecutive = score >= this->m_config.threshold ? this->m_consecutive + 1 : 0;
+
+        bool runSecond = false;
+        if (this->m_consecutive >= this->m_config.triggerCount) {
+            /* A run of scores above the threshold is one event. */
+            if (this->m_consecutive == this->m_config.triggerCount) {
+                ++this->m_fires;
+            }
+            this->m_holdLeft = this->m_config.holdCount;
+            runSecond = true;
+        } else if (this->m_holdLeft > 0) {
+            --this->m_holdLeft;
+            runSecond = true;
+        }
+
+        if (runSecond) {
+            this->m_idlePeriods = 0;
+            return this->RunSecond();
+        }
+
+        ++this->m_idlePeriods;
+        if (this->m_secondReady && this->m_config.releaseCount &&
+                this->m_idlePeriods >= this->m_config.releaseCount) {
+            debug("Releasing second cascade stage after %" PRIu32 " idle periods\n",
+                  this->m_idlePeriods);
+            this->m_second.Release();
+            this->m_secondReady = false;
+        }
+        return true;
+    }
+
+    bool Cascade::RunSecond()
+    {
+        if (!this->m_secondReady) {
+            const uint64_t start = this->m_clock();
+            const bool ok = this->m_second.Init();
+            this->m_endTime = this->m_clock();
+            ++this->m_secondStats.inits;
+            this->m_secondStats.initTime += this->m_endTime - start;
+            if (!ok) {
+                printf_err("Failed to initialise second cascade stage.\n");
+                return false;
+            }
+            this->m_secondReady = true;
+        }
+
+        float score = 0;
+        const uint64_t start = this->m_clock();
+        const bool ok = this->m_second.Run(score);
+        this->m_endTime = this->m_clock();
+        AddRun(this->m_secondStats, this->m_endTime - start);
+        this->m_secondRan = ok;
+        if (!ok) {
+            printf_err("Second cascade stage failed.\n");
+        }
+        return ok;
+    }
+
+    bool Cascade::SecondStageRan() const
+    {
+        return this->m_secondRan;
+    }
+
+    float Cascade::LastScore() const
+    {
+        return this->m_lastScore;
+    }
+
+    uint32_t Cascade::GetFireCount() const
+    {
+        return this->m_fires;
+    }
+
+    uint32_t Cascade::GetPeriodCount() const
+    {
+        return this->m_periods;
+    }
+
+    const CascadeStageStats& Cascade::GetFirstStats() const
+    {
+        return this->m_firstStats;
+    }
+
+    const CascadeStageStats& Cascade::GetSecondStats() const
+    {
+        return this->m_secondStats;
+    }
+
+    uint64_t Cascade::GetElapsedTime() const
+    {
+        return this->m_endTime - this->m_startTime;
+    }
+
+    float Cascade::DutyCycle(const CascadeStageStats& stats) const
+    {
+        const uint64_t elapsed = this->GetElapsedTime();
+        if (0 == elapsed) {
+            return 0;
+        }
+        return static_cast<float>(static_cast<double>(stats.ActiveTime()) / elapsed);
+    }
+
+    float Cascade::EstimateAveragePower(const CascadePower& power) const
+    {
+        const float first = this->DutyCycle(this->m_firstStats);
+        const float second = this->DutyCycle(this->m_secondStats);
+        const float idle = first + second < 1.f ? 1.f - first - second : 0.f;
+        return first * power.first + second * power.second + idle * power.idle;
+    }
+
+    float Cascade::EstimateUngatedPower(const CascadePower& power) const
+    {
+        const uint64_t elapsed = this->GetElapsedTime();
+        if (0 == elapsed || 0 == this->m_secondStats.runs) {
+            return 0;
+        }
+        /* The second stage would have run once per period, over the same time. */
+        const double busy = static_cast<double>(this->m_secondStats.AverageLatency()) * this->m_periods;
+        const float duty = busy < elapsed ? static_cast<float>(busy / elapsed) : 1.f;
+        return duty * power.second + (1.f - duty) * power.idle;
+    }
+
+    void Cascade::PrintStats(uint64_t ticksPerMs, const CascadePower* power) const
+    {
+        if (0 == ticksPerMs) {
+            ticksPerMs = 1;
+        }
+        const CascadeStageStats* stages[] = {&this->m_firstStats, &this->m_secondStats};
+        const char* names[] = {"First", "Second"};
+
+        info("Cascade: %" PRIu32 " periods over %.3f ms, gate fired %" PRIu32 " times\n",
+             this->m_periods, static_cast<double>(this->GetElapsedTime()) / ticksPerMs, this->m_fires);
+        for (int i = 0; i < 2; ++i) {
+            const CascadeStageStats& stats = *stages[i];
+            info("%s stage: %" PRIu32 " runs, average %.3f ms, max %.3f ms, "
+                 "%" PRIu32 " inits (%.3f ms), duty cycle %.2f%%\n",
+                 names[i], stats.runs,
+                 static_cast<double>(stats.AverageLatency()) / ticksPerMs,
+                 static_cast<double>(stats.maxLatency) / ticksPerMs,
+                 stats.inits, static_cast<double>(stats.initTime) / ticksPerMs,
+                 this->DutyCycle(stats) * 100.0);
+        }
+        if (power) {
+            info("Average power: %.3f gated, %.3f ungated\n",
+                 this->EstimateAveragePower(*power), this->EstimateUngatedPower(*power));
+        }
+    }
+
+    void Cascade::ResetStats()
+    {
+        this->m_periods = 0;
+        this->m_fires = 0;
+        this->m_started = false;
+        this->m_startTime = 0;
+        this->m_endTime = 0;
+        this->m_firstStats = CascadeStageStats{};
+        this->m_secondStats = CascadeStageStats{};
+    }
+
+} /* namespace app */
+} /* namespace arm */
@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ImageInputAdapter.hpp"
+
+#include "ImageUtils.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace arm {
+namespace app {
+namespace image {
+
+    static int8_t QuantisePixel(uint8_t pixel, const QuantParams& quantParams)
+    {
+        const float value = (static_cast<float>(pixel) / 255.0f) / quantParams.scale + quantParams.offset;
+        return static_cast<int8_t>(std::min<float>(INT8_MAX, std::max<float>(value, INT8_MIN)));
+    }
+
+    InputAdapter::InputAdapter(PixelMapping mapping, const QuantParams& quantParams, bool rgb2Gray)
+    :   m_identity{PixelMapping::Copy == mapping},
+        m_rgb2Gray{rgb2Gray}
+    {
+        for (size_t i = 0; i < this->m_lut.size(); ++i) {
+            const auto pixel = static_cast<uint8_t>(i);
+            int8_t value;
+            switch (mapping) {
+                case PixelMapping::Copy:
+                    this->m_lut[i] = pixel;
+                    continue;
+                case PixelMapping::ToInt8:
+                    value = static_cast<int8_t>(static_cast<int32_t>(pixel) - 128);
+                    break;
+                case PixelMapping::Quantise:
+                default:
+                    value = QuantisePixel(pixel, quantParams);
+                    break;
+            }
+            this->m_lut[i] = static_cast<uint8_t>(value);
+        }
+    }
+
+    size_t InputAdapter::Write(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) const
+    {
+        if (this->m_rgb2Gray) {
+            const size_t pixels = std::min(dstSize, srcSize / 3);
+            for (size_t i = 0; i < pixels; ++i, src += 3) {
+                dst[i] = this->m_lut[RgbToGray(src)];
+            }
+            return pixels;
+        }
+
+        const size_t pixels = std::min(dstSize, srcSize);
+        if (this->m_identity) {
+            std::memcpy(dst, src, pixels);
+        } else {
+            for (size_t i = 0; i < pixels; ++i) {
+                dst[i] = this->m_lut[src[i]];
+            }
+        }
+        return pixels;
+    }
+
+} /* namespace image */
+} /* namespace app */
+} /* namespace arm */
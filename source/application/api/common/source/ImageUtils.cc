@@ -16,7 +16,7 @@
  */
 #include "ImageUtils.hpp"
 
-#include <limits>
+#include <algorithm>
 
 namespace arm {
 namespace app {
@@ -96,6 +96,27 @@ namespace image {
         }
     }
 
+    void CalculateNMS(Detection* detections, size_t count, int classes, float iouThreshold)
+    {
+        for (int idxClass = 0; idxClass < classes; ++idxClass) {
+            std::sort(detections, detections + count, [idxClass](const Detection& prob1, const Detection& prob2) {
+                return prob1.prob[idxClass] > prob2.prob[idxClass];
+            });
+
+            for (size_t i = 0; i < count; ++i) {
+                if (detections[i].prob[idxClass] == 0) continue;
+                for (size_t j = i + 1; j < count; ++j) {
+                    if (detections[j].prob[idxClass] == 0) {
+                        continue;
+                    }
+                    if (CalculateBoxIOU(detections[i].bbox, detections[j].bbox) > iouThreshold) {
+                        detections[j].prob[idxClass] = 0;
+                    }
+                }
+            }
+        }
+    }
+
     void ConvertImgToInt8(void* data, const size_t kMaxImageSize)
     {
         auto* tmp_req_data = static_cast<uint8_t*>(data);
@@ -109,15 +130,8 @@ namespace image {
 
     void RgbToGrayscale(const uint8_t* srcPtr, uint8_t* dstPtr, const size_t dstImgSz)
     {
-        const float R = 0.299;
-        const float G = 0.587;
-        const float B = 0.114;
         for (size_t i = 0; i < dstImgSz; ++i, srcPtr += 3) {
-            uint32_t  int_gray = R * (*srcPtr) +
-                                 G * (*(srcPtr + 1)) +
-                                 B * (*(srcPtr + 2));
-            *dstPtr++ = int_gray <= std::numeric_limits<uint8_t>::max() ?
-                        int_gray : std::numeric_limits<uint8_t>::max();
+            *dstPtr++ = RgbToGray(srcPtr);
         }
     }
 
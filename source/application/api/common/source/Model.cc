@@ -16,12 +16,33 @@
  */
 #include "Model.hpp"
 #include "log_macros.h"
+#include "log_trace.h"
 
+#include "tensorflow/lite/micro/memory_helpers.h"
+
+#if defined(ARM_NPU)
+#include "ethosu_cpu_cache.h"
+#endif /* ARM_NPU */
+
+#include <algorithm>
 #include <cinttypes>
 #include <memory>
+#include <vector>
+
+static bool IsEthosUOperator(const tflite::OperatorCode* opcode)
+{
+    return (tflite::GetBuiltinCode(opcode) == tflite::BuiltinOperator_CUSTOM) &&
+           (nullptr != opcode->custom_code()) &&
+           ("ethos-u" == std::string(opcode->custom_code()->c_str()));
+}
 
 arm::app::Model::Model() : m_inited(false), m_type(kTfLiteNoType) {}
 
+arm::app::Model::~Model()
+{
+    this->RemoveNpuCacheRegions();
+}
+
 /* Initialise the model */
 bool arm::app::Model::Init(uint8_t* tensorArenaAddr,
                            uint32_t tensorArenaSize,
@@ -35,6 +56,10 @@ bool arm::app::Model::Init(uint8_t* tensorArenaAddr,
     debug("loading model from @ 0x%p\n", nnModelAddr);
     debug("model size: %" PRIu32 " bytes.\n", nnModelSize);
 
+    /* Regions from a previous Init describe tensors that are about to be
+     * allocated again; they are added back once the tensors are known. */
+    this->RemoveNpuCacheRegions();
+
     this->m_pModel = ::tflite::GetModel(nnModelAddr);
 
     if (this->m_pModel->version() != TFLITE_SCHEMA_VERSION) {
@@ -47,6 +72,8 @@ bool arm::app::Model::Init(uint8_t* tensorArenaAddr,
 
     this->m_modelAddr = nnModelAddr;
     this->m_modelSize = nnModelSize;
+    this->m_arenaAddr = tensorArenaAddr;
+    this->m_arenaSize = tensorArenaSize;
 
     /* Pull in only the operation implementations we need.
      * This relies on a complete list of all the ops needed by this graph.
@@ -76,14 +103,26 @@ bool arm::app::Model::Init(uint8_t* tensorArenaAddr,
         debug("Using existing allocator @ 0x%p\n", this->m_pAllocator);
     }
 
+    /* The Ethos-U operator is run through the NPU backend, when there is one,
+     * so that inferences can return before the NPU has finished. */
+    this->m_npuContext.backend = this->m_npuBackend;
+    this->PlanWeightStaging();
+    this->m_pOpResolver = std::make_unique<NpuAsyncOpResolver>(
+        this->GetOpResolver(), this->m_npuBackend != nullptr);
+
     this->m_pInterpreter = std::make_unique<tflite::MicroInterpreter>(
-        this->m_pModel, this->GetOpResolver(), this->m_pAllocator);
+        this->m_pModel, *this->m_pOpResolver, this->m_pAllocator);
 
     if (!this->m_pInterpreter) {
         printf_err("Failed to allocate interpreter\n");
         return false;
     }
 
+    if (kTfLiteOk != this->m_pInterpreter->SetMicroExternalContext(&this->m_npuContext)) {
+        printf_err("Failed to set interpreter context\n");
+        return false;
+    }
+
     /* Allocate memory from the tensor_arena for the model's tensors. */
     info("Allocating tensors\n");
     TfLiteStatus allocate_status = this->m_pInterpreter->AllocateTensors();
@@ -119,6 +158,25 @@ bool arm::app::Model::Init(uint8_t* tensorArenaAddr,
         this->LogInterpreterInfo();
     }
 
+    const NpuWeightStaging& staging = this->m_npuContext.staging;
+    if (staging.numTensors > 0) {
+        info("Staged %d of %d constant tensors in the arena: %zu bytes\n",
+             staging.numStaged, staging.numTensors, staging.stagedBytes);
+    }
+
+    size_t lastEthosUOp = 0;
+    const size_t nEthosUOps = this->CountEthosUOperators(lastEthosUOp);
+    this->m_asyncCapable = this->m_npuBackend && 1 == nEthosUOps &&
+        lastEthosUOp + 1 == tflite::NumSubgraphOperators(this->m_pModel, 0);
+    debug("Asynchronous inference %s\n", this->m_asyncCapable ? "supported" : "not supported");
+
+    /* The base addresses of jobs run by the NPU backend are kept out of the
+     * arena, so the CPU only writes the input tensors there. Registering the
+     * regions also cleans the weights staged in the arena out of the cache. */
+    if (this->m_npuBackend) {
+        this->AddNpuCacheRegions(tensorArenaAddr, tensorArenaSize);
+    }
+
     this->m_inited = true;
     return true;
 }
@@ -179,6 +237,14 @@ void arm::app::Model::LogInterpreterInfo()
     info("Activation buffer (a.k.a tensor arena) size used: %zu\n",
          this->m_pInterpreter->arena_used_bytes());
 
+    ArenaPlan plan;
+    if (this->GetArenaPlan(plan)) {
+        int peakOp = 0;
+        const size_t peak = plan.GetPeakLiveBytes(&peakOp);
+        info("Tensors span %zu bytes of the arena, with at most %zu bytes needed at once "
+             "(operator %d)\n", plan.GetExtent(), peak, peakOp);
+    }
+
     /* We expect there to be only one subgraph. */
     const uint32_t nOperators = tflite::NumSubgraphOperators(this->m_pModel, 0);
     info("Number of operators: %" PRIu32 "\n", nOperators);
@@ -193,7 +259,7 @@ void arm::app::Model::LogInterpreterInfo()
         const tflite::OperatorCode* opcode = opcodes->Get(op->opcode_index());
         const TFLMRegistration* reg        = nullptr;
 
-        tflite::GetRegistrationFromOpCode(opcode, this->GetOpResolver(), &reg);
+        tflite::GetRegistrationFromOpCode(opcode, *this->m_pOpResolver, &reg);
         std::string opName;
 
         if (reg) {
@@ -208,6 +274,80 @@ void arm::app::Model::LogInterpreterInfo()
     }
 }
 
+size_t arm::app::Model::GetArenaUsedBytes() const
+{
+    if (!this->m_pInterpreter) {
+        return 0;
+    }
+    return this->m_pInterpreter->arena_used_bytes();
+}
+
+bool arm::app::Model::GetArenaPlan(ArenaPlan& plan) const
+{
+    plan.Clear();
+    if (!this->m_pInterpreter || !this->m_arenaAddr) {
+        return false;
+    }
+
+    /* We expect there to be only one subgraph. */
+    const tflite::SubGraph* subgraph = this->m_pModel->subgraphs()->Get(0);
+    const auto* tensors              = subgraph->tensors();
+    const auto* operators            = subgraph->operators();
+    const int nOperators             = static_cast<int>(operators->size());
+
+    /* Lifetimes as the TFLM planner sees them: inputs are needed from the
+     * first operator and outputs until the last. */
+    std::vector<int> firstOp(tensors->size(), -1);
+    std::vector<int> lastOp(tensors->size(), -1);
+    auto use = [&](const flatbuffers::Vector<int32_t>* indices, int op) {
+        if (!indices) {
+            return;
+        }
+        for (const int32_t index : *indices) {
+            if (index < 0) {
+                continue;
+            }
+            if (firstOp[index] < 0 || op < firstOp[index]) {
+                firstOp[index] = op;
+            }
+            lastOp[index] = std::max(lastOp[index], op);
+        }
+    };
+
+    use(subgraph->inputs(), 0);
+    for (int i = 0; i < nOperators; ++i) {
+        use(operators->Get(i)->inputs(), i);
+        use(operators->Get(i)->outputs(), i);
+    }
+    use(subgraph->outputs(), std::max(nOperators - 1, 0));
+
+    for (size_t i = 0; i < tensors->size(); ++i) {
+        const tflite::Tensor* tensor = tensors->Get(i);
+        if (firstOp[i] < 0 || tensor->is_variable()) {
+            continue;
+        }
+
+        /* Constants stay in the model; only planned tensors are in the arena. */
+        const TfLiteEvalTensor* evalTensor = this->m_pInterpreter->GetTensor(static_cast<int>(i));
+        const auto* data = evalTensor ? static_cast<const uint8_t*>(evalTensor->data.data) : nullptr;
+        if (!data || data < this->m_arenaAddr || data >= this->m_arenaAddr + this->m_arenaSize) {
+            continue;
+        }
+
+        size_t bytes = 0;
+        if (kTfLiteOk != tflite::TfLiteEvalTensorByteLength(evalTensor, &bytes)) {
+            continue;
+        }
+        plan.Add({static_cast<int>(i),
+                  tensor->name() ? tensor->name()->c_str() : "",
+                  static_cast<size_t>(data - this->m_arenaAddr),
+                  bytes,
+                  firstOp[i],
+                  lastOp[i]});
+    }
+    return true;
+}
+
 bool arm::app::Model::IsInited() const
 {
     return this->m_inited;
@@ -219,42 +359,271 @@ bool arm::app::Model::IsDataSigned() const
 }
 
 bool arm::app::Model::ContainsEthosUOperator() const
+{
+    size_t lastIndex = 0;
+    return this->CountEthosUOperators(lastIndex) > 0;
+}
+
+size_t arm::app::Model::CountEthosUOperators(size_t& lastIndex) const
 {
     /* We expect there to be only one subgraph. */
     const uint32_t nOperators        = tflite::NumSubgraphOperators(this->m_pModel, 0);
     const tflite::SubGraph* subgraph = this->m_pModel->subgraphs()->Get(0);
     const auto* opcodes              = this->m_pModel->operator_codes();
+    size_t count                     = 0;
 
     /* check for custom operators */
     for (size_t i = 0; (i < nOperators); ++i) {
         const tflite::Operator* op         = subgraph->operators()->Get(i);
         const tflite::OperatorCode* opcode = opcodes->Get(op->opcode_index());
 
-        auto builtin_code = tflite::GetBuiltinCode(opcode);
-        if ((builtin_code == tflite::BuiltinOperator_CUSTOM) &&
-            (nullptr != opcode->custom_code()) &&
-            ("ethos-u" == std::string(opcode->custom_code()->c_str()))) {
-            return true;
+        if (IsEthosUOperator(opcode)) {
+            lastIndex = i;
+            ++count;
         }
     }
-    return false;
+    return count;
+}
+
+void arm::app::Model::PlanWeightStaging()
+{
+    NpuWeightStaging& staging = this->m_npuContext.staging;
+    staging = NpuWeightStaging{};
+    if (0 == this->m_weightStagingBudget) {
+        return;
+    }
+    if (!this->m_npuBackend) {
+        warn("Weight staging needs an NPU backend; see SetNpuBackend\n");
+        return;
+    }
+
+    struct Candidate {
+        int tensorIndex;
+        size_t bytes;
+        bool commandStream;
+    };
+    std::vector<Candidate> candidates;
+
+    const tflite::SubGraph* subgraph = this->m_pModel->subgraphs()->Get(0);
+    const auto* opcodes              = this->m_pModel->operator_codes();
+    const auto* buffers              = this->m_pModel->buffers();
+
+    for (const tflite::Operator* op : *subgraph->operators()) {
+        if (!IsEthosUOperator(opcodes->Get(op->opcode_index())) || !op->inputs()) {
+            continue;
+        }
+
+        /* Input 0 is the command stream and input 1 the weights and biases;
+         * the other inputs live in the arena already. */
+        for (size_t i = 0; i < std::min<size_t>(2, op->inputs()->size()); ++i) {
+            const int32_t tensorIndex = op->inputs()->Get(i);
+            if (tensorIndex < 0) {
+                continue;
+            }
+            const tflite::Tensor* tensor = subgraph->tensors()->Get(tensorIndex);
+            const tflite::Buffer* buffer = buffers ? buffers->Get(tensor->buffer()) : nullptr;
+            if (!buffer || !buffer->data() || 0 == buffer->data()->size()) {
+                continue;
+            }
+            candidates.push_back({tensorIndex, buffer->data()->size(), 0 == i});
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) {
+                         if (a.commandStream != b.commandStream) {
+                             return a.commandStream;
+                         }
+                         return a.bytes > b.bytes;
+                     });
+
+    /* Persistent buffers are rounded up to 16 bytes. */
+    size_t planned = 0;
+    for (const Candidate& c : candidates) {
+        const size_t bytes = (c.bytes + 15) & ~static_cast<size_t>(15);
+        if (staging.numTensors == NpuWeightStaging::MAX_TENSORS ||
+            planned + bytes > this->m_weightStagingBudget) {
+            continue;
+        }
+        staging.tensors[staging.numTensors++] = c.tensorIndex;
+        planned += bytes;
+    }
+    debug("Planned %zu bytes of weight staging for %zu candidates\n", planned, candidates.size());
+}
+
+void arm::app::Model::AddNpuCacheRegions(const uint8_t* arena, size_t arenaSize) const
+{
+#if defined(ARM_NPU)
+    size_t lastIndex = 0;
+    const bool npuOnly = this->CountEthosUOperators(lastIndex) ==
+                         tflite::NumSubgraphOperators(this->m_pModel, 0);
+
+    /* Weights and other constants are never written once the model is loaded. */
+    std::vector<ethosu_cache_region> regions{
+        {reinterpret_cast<uintptr_t>(this->m_modelAddr), this->m_modelSize, 0}};
+
+    /* The rest of the arena is NPU scratch when the NPU runs every operator;
+     * otherwise CPU operators read and write it too. */
+    if (arena && arenaSize) {
+        regions.push_back({reinterpret_cast<uintptr_t>(arena), arenaSize,
+                           npuOnly ? 0U : (ETHOSU_CACHE_CPU_WRITES | ETHOSU_CACHE_CPU_READS)});
+    }
+    for (const TfLiteTensor* tensor : this->m_input) {
+        regions.push_back({reinterpret_cast<uintptr_t>(tensor->data.data), tensor->bytes,
+                           ETHOSU_CACHE_CPU_WRITES});
+    }
+    for (const TfLiteTensor* tensor : this->m_output) {
+        regions.push_back({reinterpret_cast<uintptr_t>(tensor->data.data), tensor->bytes,
+                           ETHOSU_CACHE_CPU_READS});
+    }
+
+    if (ethosu_dcache_add_regions(this, regions.data(), static_cast<uint32_t>(regions.size()))) {
+        debug("Added %zu NPU cache regions\n", regions.size());
+    }
+#else  /* ARM_NPU */
+    UNUSED(arena);
+    UNUSED(arenaSize);
+#endif /* ARM_NPU */
+}
+
+void arm::app::Model::RemoveNpuCacheRegions() const
+{
+#if defined(ARM_NPU)
+    ethosu_dcache_remove_regions(this);
+#endif /* ARM_NPU */
 }
 
 bool arm::app::Model::RunInference()
 {
     bool inference_state = false;
-    if (this->m_pModel && this->m_pInterpreter) {
+    if (InferenceStatus::Running == this->m_inferenceStatus) {
+        printf_err("Asynchronous inference still running\n");
+    } else if (this->m_pModel && this->m_pInterpreter) {
+        LOG_TRACE_BEGIN(invoke);
         if (kTfLiteOk != this->m_pInterpreter->Invoke()) {
             printf_err("Invoke failed.\n");
         } else {
             inference_state = true;
         }
+        LOG_TRACE_END(invoke, LOG_TRACE_TRACK_NPU, "inference");
     } else {
         printf_err("Error: No interpreter!\n");
     }
     return inference_state;
 }
 
+void arm::app::Model::SetNpuBackend(NpuBackend* backend)
+{
+    if (this->m_pInterpreter) {
+        printf_err("NPU backend must be set before the model is initialised\n");
+        return;
+    }
+    this->m_npuBackend = backend;
+}
+
+void arm::app::Model::SetWeightStagingBudget(size_t bytes)
+{
+    if (this->m_pInterpreter) {
+        printf_err("Weight staging budget must be set before the model is initialised\n");
+        return;
+    }
+    this->m_weightStagingBudget = bytes;
+}
+
+size_t arm::app::Model::GetStagedWeightsSize() const
+{
+    return this->m_npuContext.staging.stagedBytes;
+}
+
+void arm::app::Model::UseStagedWeights(bool use)
+{
+    this->m_npuContext.staging.bypass = !use;
+}
+
+bool arm::app::Model::SupportsAsyncInference() const
+{
+    return this->m_asyncCapable;
+}
+
+bool arm::app::Model::StartInference(InferenceCallback callback)
+{
+    if (!this->m_pModel || !this->m_pInterpreter) {
+        printf_err("Error: No interpreter!\n");
+        return false;
+    }
+    if (InferenceStatus::Running == this->m_inferenceStatus) {
+        printf_err("Asynchronous inference still running\n");
+        return false;
+    }
+
+    this->m_inferenceCallback = std::move(callback);
+    this->m_npuContext.deferWait = this->m_asyncCapable;
+    this->m_npuContext.jobStarted = false;
+#if defined(LOG_TRACE_ENABLED)
+    this->m_inferenceStart = log_trace_now();
+#endif /* defined(LOG_TRACE_ENABLED) */
+
+    const TfLiteStatus status = this->m_pInterpreter->Invoke();
+    this->m_npuContext.deferWait = false;
+
+    if (kTfLiteOk != status) {
+        printf_err("Invoke failed.\n");
+        this->FinishInference(false);
+        return false;
+    }
+
+    if (this->m_npuContext.jobStarted) {
+        this->m_inferenceStatus = InferenceStatus::Running;
+    } else {
+        this->FinishInference(true);
+    }
+    return true;
+}
+
+arm::app::InferenceStatus arm::app::Model::PollInference()
+{
+    if (InferenceStatus::Running == this->m_inferenceStatus) {
+        const InferenceStatus status = this->m_npuBackend->Wait(false);
+        if (InferenceStatus::Error == status) {
+            printf_err("NPU job failed.\n");
+        }
+        if (InferenceStatus::Running != status) {
+            this->FinishInference(InferenceStatus::Done == status);
+        }
+    }
+    return this->m_inferenceStatus;
+}
+
+bool arm::app::Model::WaitForInference()
+{
+    if (InferenceStatus::Running == this->m_inferenceStatus) {
+        const InferenceStatus status = this->m_npuBackend->Wait(true);
+        if (InferenceStatus::Done != status) {
+            printf_err("NPU job failed.\n");
+        }
+        /* The callback may already have started the next inference. */
+        const bool success = InferenceStatus::Done == status;
+        this->FinishInference(success);
+        return success;
+    }
+    return InferenceStatus::Done == this->m_inferenceStatus;
+}
+
+void arm::app::Model::FinishInference(bool success)
+{
+    this->m_inferenceStatus = success ? InferenceStatus::Done : InferenceStatus::Error;
+#if defined(LOG_TRACE_ENABLED)
+    log_trace_span(LOG_TRACE_TRACK_NPU, "inference", this->m_inferenceStart, log_trace_now());
+#endif /* defined(LOG_TRACE_ENABLED) */
+
+    /* Clear the callback before calling it, so it can start the next inference. */
+    InferenceCallback callback = std::move(this->m_inferenceCallback);
+    this->m_inferenceCallback = nullptr;
+    if (callback) {
+        callback(success);
+    }
+}
+
 TfLiteTensor* arm::app::Model::GetInputTensor(size_t index) const
 {
     if (index < this->GetNumInputs()) {
@@ -0,0 +1,292 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "NpuAsync.hpp"
+#include "log_macros.h"
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/memory_helpers.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+#if defined(ARM_NPU)
+#include "ethosu_driver.h"
+#endif /* ARM_NPU */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace arm {
+namespace app {
+
+namespace {
+
+    /* Custom operator type written by Vela for Ethos-U command streams. */
+    constexpr int8_t CO_TYPE_ETHOSU = 1;
+
+    struct EthosUOpData {
+        int cmsDataSize;        /* Size of the command stream in bytes. */
+
+        /* Copies of the inputs staged in the arena, nullptr for inputs read in place. */
+        void* staged[NpuInvokeContext::MAX_BASE_ADDR + 1];
+    };
+
+    bool IsListed(const NpuWeightStaging& staging, int tensorIndex)
+    {
+        for (int i = 0; i < staging.numTensors; ++i) {
+            if (staging.tensors[i] == tensorIndex) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Copies the inputs listed for staging into persistent arena buffers, which
+     * TFLM aligns to 16 bytes as the NPU requires. Inputs that do not fit are
+     * left where they are. */
+    void StageInputs(TfLiteContext* context, TfLiteNode* node,
+                     EthosUOpData* data, NpuWeightStaging& staging)
+    {
+        tflite::MicroContext* microContext = tflite::GetMicroContext(context);
+        for (int i = 0; i < node->inputs->size; ++i) {
+            const int tensorIndex = node->inputs->data[i];
+            if (!IsListed(staging, tensorIndex)) {
+                continue;
+            }
+
+            TfLiteTensor* tensor = microContext->AllocateTempInputTensor(node, i);
+            if (!tensor) {
+                continue;
+            }
+            const void* src = tensor->data.data;
+            const size_t bytes = tensor->bytes;
+            microContext->DeallocateTempTfLiteTensor(tensor);
+
+            void* copy = context->AllocatePersistentBuffer(context, bytes);
+            if (!copy) {
+                warn("No room to stage tensor %d (%zu bytes), reading it in place\n",
+                     tensorIndex, bytes);
+                continue;
+            }
+            std::memcpy(copy, src, bytes);
+            data->staged[i] = copy;
+            ++staging.numStaged;
+            staging.stagedBytes += bytes;
+        }
+    }
+
+    void* EthosUInit(TfLiteContext* context, const char* buffer, size_t length)
+    {
+        (void)buffer;
+        (void)length;
+        return context->AllocatePersistentBuffer(context, sizeof(EthosUOpData));
+    }
+
+    TfLiteStatus EthosUPrepare(TfLiteContext* context, TfLiteNode* node)
+    {
+        TF_LITE_ENSURE(context, node->inputs->size > 0);
+        TF_LITE_ENSURE(context, node->user_data != nullptr);
+        TF_LITE_ENSURE(context, node->custom_initial_data_size > 0);
+
+        /* All tensors but the command stream need a base address. */
+        auto* data = static_cast<EthosUOpData*>(node->user_data);
+        TF_LITE_ENSURE(context,
+            node->inputs->size - 1 + node->outputs->size <= NpuInvokeContext::MAX_BASE_ADDR);
+
+        tflite::MicroContext* microContext = tflite::GetMicroContext(context);
+        TfLiteTensor* cms = microContext->AllocateTempInputTensor(node, 0);
+        TF_LITE_ENSURE(context, cms != nullptr);
+        data->cmsDataSize = cms->bytes;
+        microContext->DeallocateTempTfLiteTensor(cms);
+
+        std::fill(std::begin(data->staged), std::end(data->staged), nullptr);
+        auto* npu = static_cast<NpuInvokeContext*>(microContext->external_context());
+        if (npu) {
+            StageInputs(context, node, data, npu->staging);
+        }
+
+        return kTfLiteOk;
+    }
+
+    TfLiteStatus EthosUEval(TfLiteContext* context, TfLiteNode* node)
+    {
+        const auto* data = static_cast<const EthosUOpData*>(node->user_data);
+        auto* npu = static_cast<NpuInvokeContext*>(
+            tflite::GetMicroContext(context)->external_context());
+
+        if (!npu || !npu->backend) {
+            printf_err("No NPU backend for the Ethos-U operator\n");
+            return kTfLiteError;
+        }
+
+        const auto* customData = static_cast<const uint8_t*>(node->custom_initial_data);
+        if (flexbuffers::GetRoot(customData, node->custom_initial_data_size).AsInt8() != CO_TYPE_ETHOSU) {
+            printf_err("Custom operator is not an Ethos-U command stream\n");
+            return kTfLiteError;
+        }
+
+        uint64_t* baseAddr = npu->baseAddr;
+        size_t* baseAddrSize = npu->baseAddrSize;
+        int numBaseAddr = 0;
+
+        /* Staged copies replace the original inputs unless bypassed. */
+        auto inputData = [&](int input) {
+            if (!npu->staging.bypass && data->staged[input]) {
+                return data->staged[input];
+            }
+            return context->GetEvalTensor(context, node->inputs->data[input])->data.data;
+        };
+
+        auto addTensor = [&](int tensorIndex, const void* address) {
+            const TfLiteEvalTensor* tensor = context->GetEvalTensor(context, tensorIndex);
+            size_t typeSize = 1;
+            tflite::TfLiteTypeSizeOf(tensor->type, &typeSize);
+            baseAddr[numBaseAddr] = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address));
+            baseAddrSize[numBaseAddr] = tflite::micro::ElementCount(*tensor->dims) * typeSize;
+            ++numBaseAddr;
+        };
+
+        /* Input 0 is the command stream; the other inputs (weights, arena,
+         * fast scratch and the input tensors) and the outputs are addressed
+         * by the command stream. */
+        for (int i = 1; i < node->inputs->size; ++i) {
+            addTensor(node->inputs->data[i], inputData(i));
+        }
+        for (int i = 0; i < node->outputs->size; ++i) {
+            const int tensorIndex = node->outputs->data[i];
+            addTensor(tensorIndex, context->GetEvalTensor(context, tensorIndex)->data.data);
+        }
+
+        NpuJob job;
+        job.commandStream = inputData(0);
+        job.commandStreamSize = data->cmsDataSize;
+        job.baseAddr = baseAddr;
+        job.baseAddrSize = baseAddrSize;
+        job.numBaseAddr = numBaseAddr;
+
+        if (!npu->backend->Start(job)) {
+            printf_err("Failed to start NPU job\n");
+            return kTfLiteError;
+        }
+
+        if (npu->deferWait) {
+            npu->jobStarted = true;
+            return kTfLiteOk;
+        }
+        return npu->backend->Wait(true) == InferenceStatus::Done ? kTfLiteOk : kTfLiteError;
+    }
+
+    const TFLMRegistration* GetEthosUAsyncRegistration()
+    {
+        static TFLMRegistration registration =
+            tflite::micro::RegisterOp(EthosUInit, EthosUPrepare, EthosUEval);
+        return &registration;
+    }
+
+#if defined(ARM_NPU)
+    /* Runs jobs on the Ethos-U through the core driver's asynchronous API. */
+    class EthosUBackend : public NpuBackend {
+    public:
+        bool Start(const NpuJob& job) override
+        {
+            if (this->m_driver) {
+                printf_err("NPU job already running\n");
+                return false;
+            }
+
+            this->m_driver = ethosu_reserve_driver();
+            if (!this->m_driver) {
+                printf_err("Failed to reserve Ethos-U driver\n");
+                return false;
+            }
+
+            if (0 != ethosu_invoke_async(this->m_driver,
+                                         job.commandStream,
+                                         static_cast<int>(job.commandStreamSize),
+                                         job.baseAddr,
+                                         job.baseAddrSize,
+                                         job.numBaseAddr,
+                                         nullptr)) {
+                this->Release();
+                return false;
+            }
+            return true;
+        }
+
+        InferenceStatus Wait(bool block) override
+        {
+            if (!this->m_driver) {
+                return InferenceStatus::Idle;
+            }
+
+            /* 0 when done, 1 while running and negative on failure. */
+            const int result = ethosu_wait(this->m_driver, block);
+            if (1 == result) {
+                return InferenceStatus::Running;
+            }
+            this->Release();
+            return 0 == result ? InferenceStatus::Done : InferenceStatus::Error;
+        }
+
+    private:
+        void Release()
+        {
+            ethosu_release_driver(this->m_driver);
+            this->m_driver = nullptr;
+        }
+
+        ethosu_driver* m_driver{nullptr};
+    };
+#endif /* ARM_NPU */
+
+} /* namespace */
+
+NpuBackend* GetDefaultNpuBackend()
+{
+#if defined(ARM_NPU)
+    static EthosUBackend backend;
+    return &backend;
+#else  /* ARM_NPU */
+    return nullptr;
+#endif /* ARM_NPU */
+}
+
+NpuAsyncOpResolver::NpuAsyncOpResolver(const tflite::MicroOpResolver& resolver, bool enabled)
+    : m_resolver(resolver), m_enabled(enabled)
+{}
+
+const TFLMRegistration* NpuAsyncOpResolver::FindOp(tflite::BuiltinOperator op) const
+{
+    return this->m_resolver.FindOp(op);
+}
+
+const TFLMRegistration* NpuAsyncOpResolver::FindOp(const char* op) const
+{
+    if (this->m_enabled && 0 == std::strcmp(op, tflite::GetString_ETHOSU())) {
+        return GetEthosUAsyncRegistration();
+    }
+    return this->m_resolver.FindOp(op);
+}
+
+tflite::TfLiteBridgeBuiltinParseFunction NpuAsyncOpResolver::GetOpDataParser(
+    tflite::BuiltinOperator op) const
+{
+    return this->m_resolver.GetOpDataParser(op);
+}
+
+} /* namespace app */
+} /* namespace arm */
@@ -0,0 +1,423 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Pipeline.hpp"
+#include "log_macros.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <utility>
+
+namespace arm {
+namespace app {
+
+    BasePreProcessStage::BasePreProcessStage(BasePreProcess& preProcess)
+    :   m_preProcess{preProcess}
+    {}
+
+    bool BasePreProcessStage::DoPreProcess(const void* data, size_t size, size_t index)
+    {
+        UNUSED(index);
+        return this->m_preProcess.DoPreProcess(data, size);
+    }
+
+    ModelInference::ModelInference(Model& model)
+    :   m_model{model}
+    {}
+
+    size_t ModelInference::GetNumInputs() const
+    {
+        return this->m_model.GetNumInputs();
+    }
+
+    size_t ModelInference::GetNumOutputs() const
+    {
+        return this->m_model.GetNumOutputs();
+    }
+
+    TfLiteTensor* ModelInference::GetInputTensor(size_t index) const
+    {
+        return this->m_model.GetInputTensor(index);
+    }
+
+    TfLiteTensor* ModelInference::GetOutputTensor(size_t index) const
+    {
+        return this->m_model.GetOutputTensor(index);
+    }
+
+    bool ModelInference::Start()
+    {
+        return this->m_model.StartInference();
+    }
+
+    InferenceStatus ModelInference::Poll(bool block)
+    {
+        if (block) {
+            return this->m_model.WaitForInference() ? InferenceStatus::Done : InferenceStatus::Error;
+        }
+        return this->m_model.PollInference();
+    }
+
+#if defined(PIPELINE_THREADS)
+    ThreadedModelInference::ThreadedModelInference(Model& model)
+    :   ModelInference(model)
+    {}
+
+    ThreadedModelInference::~ThreadedModelInference()
+    {
+        if (this->m_worker.joinable()) {
+            this->m_worker.join();
+        }
+    }
+
+    bool ThreadedModelInference::Start()
+    {
+        if (this->m_worker.joinable()) {
+            this->m_worker.join();
+        }
+        this->m_status = InferenceStatus::Running;
+        this->m_worker = std::thread([this]() {
+            this->m_status = this->m_model.RunInference() ? InferenceStatus::Done : InferenceStatus::Error;
+        });
+        return true;
+    }
+
+    InferenceStatus ThreadedModelInference::Poll(bool block)
+    {
+        if (block && this->m_worker.joinable()) {
+            this->m_worker.join();
+        }
+        const InferenceStatus status = this->m_status;
+        if (InferenceStatus::Running != status && this->m_worker.joinable()) {
+            this->m_worker.join();
+        }
+        return status;
+    }
+#endif /* PIPELINE_THREADS */
+
+    /* Tensors are laid out one after the other in a staging slot, each one aligned
+     * as the tensor arena aligns them. */
+    static constexpr size_t kStagingAlignment = 16;
+
+    static size_t StagingSize(size_t bytes)
+    {
+        return (bytes + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+    }
+
+    static size_t SlotSize(const std::vector<TfLiteTensor*>& tensors)
+    {
+        size_t size = 0;
+        for (const TfLiteTensor* tensor : tensors) {
+            size += StagingSize(tensor->bytes);
+        }
+        return size;
+    }
+
+    static void AddRun(PipelineStageStats& stats, uint64_t time)
+    {
+        ++stats.runs;
+        stats.busyTime += time;
+        if (time > stats.maxLatency) {
+            stats.maxLatency = time;
+        }
+    }
+
+    uint8_t* Pipeline::StagingRing::Slot(size_t index)
+    {
+        return this->buffer.data() + index * this->slotSize;
+    }
+
+    Pipeline::Pipeline(PipelineSource& source, PipelinePreProcess& preProcess,
+                       PipelineInference& inference, BasePostProcess& postProcess,
+                       PipelineSink& sink, const PipelineConfig& config, Clock clock)
+    :   m_source{source},
+        m_preProcess{preProcess},
+        m_inference{inference},
+        m_postProcess{postProcess},
+        m_sink{sink},
+        m_depth{std::max<size_t>(config.depth, 1)},
+        m_clock{std::move(clock)}
+    {
+        for (size_t i = 0; i < inference.GetNumInputs(); ++i) {
+            this->m_inputTensors.push_back(inference.GetInputTensor(i));
+        }
+        for (size_t i = 0; i < inference.GetNumOutputs(); ++i) {
+            this->m_outputTensors.push_back(inference.GetOutputTensor(i));
+        }
+        this->m_savedData.resize(std::max(this->m_inputTensors.size(), this->m_outputTensors.size()));
+
+        this->m_inputs.slotSize = SlotSize(this->m_inputTensors);
+        this->m_inputs.buffer.resize(this->m_inputs.slotSize * this->m_depth);
+        this->m_outputs.slotSize = SlotSize(this->m_outputTensors);
+        this->m_outputs.buffer.resize(this->m_outputs.slotSize * this->m_depth);
+    }
+
+    uint64_t Pipeline::Now() const
+    {
+        return this->m_clock ? this->m_clock() : 0;
+    }
+
+    void Pipeline::Redirect(const std::vector<TfLiteTensor*>& tensors, uint8_t* slot,
+                            std::vector<void*>& saved)
+    {
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            saved[i] = tensors[i]->data.data;
+            tensors[i]->data.data = slot;
+            slot += StagingSize(tensors[i]->bytes);
+        }
+    }
+
+    void Pipeline::Restore(const std::vector<TfLiteTensor*>& tensors, const std::vector<void*>& saved)
+    {
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            tensors[i]->data.data = saved[i];
+        }
+    }
+
+    bool Pipeline::StartInference()
+    {
+        const uint8_t* slot = this->m_inputs.Slot(this->m_inputs.head);
+        for (TfLiteTensor* tensor : this->m_inputTensors) {
+            std::memcpy(tensor->data.data, slot, tensor->bytes);
+            slot += StagingSize(tensor->bytes);
+        }
+        ++this->m_inputs.frontSequence;
+        this->m_inputs.head = (this->m_inputs.head + 1) % this->m_depth;
+        --this->m_inputs.count;
+
+        this->m_inferenceStart = this->Now();
+        if (!this->m_inference.Start()) {
+            return false;
+        }
+        this->m_running = true;
+        return true;
+    }
+
+    bool Pipeline::RetireInference(bool block)
+    {
+        const InferenceStatus status = this->m_inference.Poll(block);
+        if (InferenceStatus::Running == status) {
+            return true;
+        }
+        this->m_running = false;
+        AddRun(this->m_stats.inference, this->Now() - this->m_inferenceStart);
+        if (InferenceStatus::Done != status) {
+            return false;
+        }
+
+        /* Launching only when the output queue has room keeps a slot free. */
+        uint8_t* slot = this->m_outputs.Slot((this->m_outputs.head + this->m_outputs.count) % this->m_depth);
+        for (const TfLiteTensor* tensor : this->m_outputTensors) {
+            std::memcpy(slot, tensor->data.data, tensor->bytes);
+            slot += StagingSize(tensor->bytes);
+        }
+        ++this->m_outputs.count;
+        this->m_stats.maxOutputQueue = std::max(this->m_stats.maxOutputQueue, this->m_outputs.count);
+        return true;
+    }
+
+    bool Pipeline::PostProcessFront()
+    {
+        Redirect(this->m_outputTensors, this->m_outputs.Slot(this->m_outputs.head), this->m_savedData);
+        const uint64_t start = this->Now();
+        bool ok = this->m_postProcess.DoPostProcess();
+        AddRun(this->m_stats.postProcess, this->Now() - start);
+        if (ok) {
+            ok = this->m_sink.Consume(this->m_outputs.frontSequence);
+        }
+        Restore(this->m_outputTensors, this->m_savedData);
+
+        ++this->m_outputs.frontSequence;
+        this->m_outputs.head = (this->m_outputs.head + 1) % this->m_depth;
+        --this->m_outputs.count;
+        return ok;
+    }
+
+    bool Pipeline::PreProcessNext(bool& progress)
+    {
+        if (this->m_inputs.count == this->m_depth) {
+            ++this->m_stats.backpressure;
+            return true;
+        }
+
+        const void* data = nullptr;
+        size_t size = 0;
+        size_t sourceIndex = this->m_nextSequence;
+        switch (this->m_source.Next(data, size, sourceIndex)) {
+            case PipelineInput::NotYet:
+                ++this->m_stats.sourceWaits;
+                return true;
+            case PipelineInput::End:
+                this->m_sourceEnded = true;
+                progress = true;
+                return true;
+            case PipelineInput::Ready:
+                break;
+        }
+
+        const size_t index = (this->m_inputs.head + this->m_inputs.count) % this->m_depth;
+        Redirect(this->m_inputTensors, this->m_inputs.Slot(index), this->m_savedData);
+        const uint64_t start = this->Now();
+        const bool ok = this->m_preProcess.DoPreProcess(data, size, sourceIndex);
+        AddRun(this->m_stats.preProcess, this->Now() - start);
+        Restore(this->m_inputTensors, this->m_savedData);
+        if (!ok) {
+            return false;
+        }
+
+        ++this->m_inputs.count;
+        ++this->m_nextSequence;
+        this->m_stats.maxInputQueue = std::max(this->m_stats.maxInputQueue, this->m_inputs.count);
+        progress = true;
+        return true;
+    }
+
+    PipelineStatus Pipeline::Fail(const char* what)
+    {
+        printf_err("Pipeline %s failed.\n", what);
+        this->m_failed = true;
+        return PipelineStatus::Error;
+    }
+
+    PipelineStatus Pipeline::Step()
+    {
+        if (this->m_failed) {
+            return PipelineStatus::Error;
+        }
+
+        bool progress = false;
+        if (this->m_running) {
+            if (!this->RetireInference(false)) {
+                return this->Fail("inference");
+            }
+            progress = !this->m_running;
+        }
+
+        if (!this->m_running && this->m_inputs.count > 0 && this->m_outputs.count < this->m_depth) {
+            if (!this->StartInference()) {
+                return this->Fail("inference start");
+            }
+            progress = true;
+        }
+
+        /* CPU work, while an inference may be in flight. Draining outputs first
+         * frees the slots the next inferences need. */
+        if (this->m_outputs.count > 0) {
+            if (!this->PostProcessFront()) {
+                return this->Fail("post-processing");
+            }
+            progress = true;
+        } else if (!this->m_sourceEnded) {
+            if (!this->PreProcessNext(progress)) {
+                return this->Fail("pre-processing");
+            }
+        }
+
+        if (!progress && this->m_running) {
+            const uint64_t start = this->Now();
+            if (!this->RetireInference(true)) {
+                return this->Fail("inference");
+            }
+            this->m_stats.blockedTime += this->Now() - start;
+            progress = true;
+        }
+
+        if (this->m_sourceEnded && !this->m_running &&
+            0 == this->m_inputs.count && 0 == this->m_outputs.count) {
+            return PipelineStatus::Done;
+        }
+        return progress ? PipelineStatus::Busy : PipelineStatus::Waiting;
+    }
+
+    bool Pipeline::Run()
+    {
+        for (;;) {
+            switch (this->Step()) {
+                case PipelineStatus::Done:
+                    return true;
+                case PipelineStatus::Error:
+                    return false;
+                case PipelineStatus::Busy:
+                case PipelineStatus::Waiting:
+                    break;
+            }
+        }
+    }
+
+    void Pipeline::Reset()
+    {
+        if (this->m_running) {
+            this->m_inference.Poll(true);
+            this->m_running = false;
+        }
+        this->m_inputs.head = this->m_inputs.count = 0;
+        this->m_inputs.frontSequence = 0;
+        this->m_outputs.head = this->m_outputs.count = 0;
+        this->m_outputs.frontSequence = 0;
+        this->m_sourceEnded = false;
+        this->m_failed = false;
+        this->m_nextSequence = 0;
+    }
+
+    uint32_t Pipeline::GetInputCount() const
+    {
+        return this->m_nextSequence;
+    }
+
+    const PipelineStats& Pipeline::GetStats() const
+    {
+        return this->m_stats;
+    }
+
+    void Pipeline::PrintStats(uint64_t ticksPerMs) const
+    {
+        if (0 == ticksPerMs) {
+            ticksPerMs = 1;
+        }
+        const PipelineStageStats* stages[] = {
+            &this->m_stats.preProcess, &this->m_stats.inference, &this->m_stats.postProcess};
+        const char* names[] = {"Pre-processing", "Inference", "Post-processing"};
+
+        info("Pipeline: depth %zu, %" PRIu32 " inputs\n", this->m_depth, this->m_nextSequence);
+        for (size_t i = 0; i < 3; ++i) {
+            const PipelineStageStats& stats = *stages[i];
+            if (this->m_clock) {
+                info("%s: %" PRIu32 " runs, average %.3f ms, max %.3f ms\n",
+                     names[i], stats.runs,
+                     static_cast<double>(stats.AverageLatency()) / ticksPerMs,
+                     static_cast<double>(stats.maxLatency) / ticksPerMs);
+            } else {
+                info("%s: %" PRIu32 " runs\n", names[i], stats.runs);
+            }
+        }
+        if (this->m_clock) {
+            info("Blocked on inference for %.3f ms\n",
+                 static_cast<double>(this->m_stats.blockedTime) / ticksPerMs);
+        }
+        info("Source not ready %" PRIu32 " times, held back %" PRIu32 " times; "
+             "queues peaked at %zu inputs, %zu outputs\n",
+             this->m_stats.sourceWaits, this->m_stats.backpressure,
+             this->m_stats.maxInputQueue, this->m_stats.maxOutputQueue);
+    }
+
+    void Pipeline::ResetStats()
+    {
+        this->m_stats = PipelineStats{};
+    }
+
+} /* namespace app */
+} /* namespace arm */
@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "VoiceActivityDetector.hpp"
+
+#include <cmath>
+
+namespace arm {
+namespace app {
+namespace audio {
+
+    /* Reported for blocks with no signal at all. */
+    static constexpr float SilenceDb = -120.f;
+
+    VoiceActivityDetector::VoiceActivityDetector(const VadConfig& config)
+    :   m_config{config},
+        m_noiseFloorDb{config.thresholdDb}
+    {}
+
+    VadFeatures VoiceActivityDetector::ComputeFeatures(const int16_t* samples, size_t numSamples, float gain)
+    {
+        VadFeatures features;
+        features.energyDb = SilenceDb;
+        if (!samples || numSamples < 2) {
+            return features;
+        }
+
+        int64_t sum = 0;
+        int64_t sumSquares = 0;
+        for (size_t i = 0; i < numSamples; ++i) {
+            sum += samples[i];
+            sumSquares += static_cast<int32_t>(samples[i]) * samples[i];
+        }
+
+        const double mean = static_cast<double>(sum) / numSamples;
+        const double variance = static_cast<double>(sumSquares) / numSamples - mean * mean;
+        const double fullScale = 32768.0 * 32768.0;
+        if (variance > 0 && gain > 0) {
+            const double db = 10.0 * std::log10(variance / fullScale) - 20.0 * std::log10(gain);
+            features.energyDb = db > SilenceDb ? static_cast<float>(db) : SilenceDb;
+        }
+
+        /* Crossings of the mean rather than zero, so a DC offset does not hide them. */
+        const int32_t offset = static_cast<int32_t>(std::lround(mean));
+        uint32_t crossings = 0;
+        bool above = samples[0] >= offset;
+        for (size_t i = 1; i < numSamples; ++i) {
+            const bool nowAbove = samples[i] >= offset;
+            crossings += nowAbove != above;
+            above = nowAbove;
+        }
+        features.zeroCrossingRate = static_cast<float>(crossings) / (numSamples - 1);
+        return features;
+    }
+
+    bool VoiceActivityDetector::Process(const int16_t* samples, size_t numSamples, float gain)
+    {
+        return this->Process(ComputeFeatures(samples, numSamples, gain));
+    }
+
+    bool VoiceActivityDetector::Process(const VadFeatures& features)
+    {
+        this->m_last = features;
+
+        const bool trackFloor = this->m_config.noiseMarginDb > 0;
+        bool voice = features.energyDb >= this->m_config.thresholdDb &&
+                     features.zeroCrossingRate <= this->m_config.maxZeroCrossingRate;
+        if (trackFloor) {
+            voice = voice && features.energyDb >= this->m_noiseFloorDb + this->m_config.noiseMarginDb;
+
+            if (features.energyDb < this->m_noiseFloorDb) {
+                this->m_noiseFloorDb = features.energyDb;
+            } else {
+                this->m_noiseFloorDb += this->m_config.noiseFloorRiseDb;
+                if (this->m_noiseFloorDb > features.energyDb) {
+                    this->m_noiseFloorDb = features.energyDb;
+                }
+            }
+
+            /* A lower floor would not change any decision, only slow its rise. */
+            const float lowest = this->m_config.thresholdDb - this->m_config.noiseMarginDb;
+            if (this->m_noiseFloorDb < lowest) {
+                this->m_noiseFloorDb = lowest;
+            }
+        }
+
+        bool active = voice;
+        if (voice) {
+            this->m_hangoverLeft = this->m_config.hangover;
+        } else if (this->m_hangoverLeft > 0) {
+            --this->m_hangoverLeft;
+            active = true;
+        }
+
+        if (active) {
+            ++this->m_active;
+        } else {
+            ++this->m_silent;
+        }
+        return active;
+    }
+
+    const VadFeatures& VoiceActivityDetector::GetLastFeatures() const
+    {
+        return this->m_last;
+    }
+
+    float VoiceActivityDetector::GetNoiseFloorDb() const
+    {
+        return this->m_noiseFloorDb;
+    }
+
+    uint32_t VoiceActivityDetector::GetActiveCount() const
+    {
+        return this->m_active;
+    }
+
+    uint32_t VoiceActivityDetector::GetSilentCount() const
+    {
+        return this->m_silent;
+    }
+
+    void VoiceActivityDetector::ResetCounters()
+    {
+        this->m_active = 0;
+        this->m_silent = 0;
+    }
+
+    void VoiceActivityDetector::Reset()
+    {
+        this->ResetCounters();
+        this->m_last = VadFeatures{};
+        this->m_noiseFloorDb = this->m_config.thresholdDb;
+        this->m_hangoverLeft = 0;
+    }
+
+} /* namespace audio */
+} /* namespace app */
+} /* namespace arm */
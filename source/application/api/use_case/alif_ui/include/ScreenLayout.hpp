@@ -25,6 +25,32 @@ lv_obj_t *ScreenLayoutLabelObject(int);
 lv_obj_t *ScreenLayoutTimeObject();
 lv_obj_t *ScreenLayoutLEDObject();
 
+/**
+ * @brief   Sets the text of a label, only if it has changed so that LVGL does
+ *          not redraw labels that stay the same. To be called with the lock held.
+ * @return  true if the text changed.
+ */
+bool ScreenLayoutSetText(lv_obj_t *label, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief   Shows a camera frame by writing it straight into the framebuffer,
+ *          filling the image area, instead of through the LVGL image and the
+ *          LVGL draw buffer. Nothing can be drawn over the frame. To be called
+ *          with the lock held.
+ * @param[in]   rgb     RGB888 frame.
+ * @param[in]   width   Frame width; the image area must be a whole multiple of it.
+ * @param[in]   height  Frame height.
+ * @return  false if the frame cannot be shown directly, e.g. with the display
+ *          rotated, in which case the LVGL image has to be updated instead.
+ */
+bool ScreenLayoutShowFrame(const uint8_t *rgb, int width, int height);
+
+/**
+ * @brief   Logs the time spent writing to the display since the last call.
+ * @param[in]   cpuClock    CPU clock frequency in Hz, e.g. SystemCoreClock.
+ */
+void ScreenLayoutPrintDisplayStats(uint32_t cpuClock);
+
 } /* namespace app */
 } /* namespace alif */
 
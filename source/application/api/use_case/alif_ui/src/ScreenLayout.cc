@@ -15,6 +15,11 @@
 
 #include "log_macros.h"
 
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
 extern "C" {
     LV_IMAGE_DECLARE(Alif240);
     LV_IMAGE_DECLARE(Alif240_white);
@@ -29,6 +34,7 @@ lv_obj_t *labelTime;
 lv_obj_t *imageObj;
 lv_obj_t *imageHolder;
 lv_obj_t *ledObj;
+bool directFrameFailed;
 
 };
 
@@ -233,5 +239,65 @@ lv_obj_t *ScreenLayoutLEDObject()
     return ledObj;
 }
 
+bool ScreenLayoutSetText(lv_obj_t *label, const char *fmt, ...)
+{
+    char text[96];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof text, fmt, args);
+    va_end(args);
+
+    /* LVGL redraws a label whenever its text is set, even to the same text. */
+    const char *current = lv_label_get_text(label);
+    if (current && strcmp(current, text) == 0) {
+        return false;
+    }
+    lv_label_set_text(label, text);
+    return true;
+}
+
+bool ScreenLayoutShowFrame(const uint8_t *rgb, int width, int height)
+{
+    if (directFrameFailed) {
+        return false;
+    }
+
+    lv_obj_update_layout(imageHolder);
+    const int32_t contentWidth = lv_obj_get_content_width(imageHolder);
+    const int32_t contentHeight = lv_obj_get_content_height(imageHolder);
+    const int scale = width ? contentWidth / width : 0;
+    lv_area_t coords;
+    lv_obj_get_content_coords(imageHolder, &coords);
+
+    if (scale < 1 || width * scale != contentWidth || height * scale != contentHeight ||
+        !lv_port_blit_rgb888(rgb, width, height, scale, coords.x1, coords.y1)) {
+        /* E.g. a rotated display or a zoom that is not a whole number. */
+        info("Camera frames are shown through LVGL\n");
+        directFrameFailed = true;
+        lv_obj_remove_flag(imageObj, LV_OBJ_FLAG_HIDDEN);
+        return false;
+    }
+
+    /* LVGL stops drawing the image, which would cover the frame. */
+    lv_obj_add_flag(imageObj, LV_OBJ_FLAG_HIDDEN);
+    return true;
+}
+
+void ScreenLayoutPrintDisplayStats(uint32_t cpuClock)
+{
+    lv_port_display_stats stats;
+    lv_port_get_display_stats(&stats, true);
+
+    const double cyclesPerMs = cpuClock / 1000.0;
+    info("Display: %" PRIu32 " flushes of %" PRIu32 " pixels, copying %.3f ms (max %.3f ms), "
+         "waiting for the scanline %.3f ms\n",
+         stats.flushes, stats.flush_pixels, stats.flush_copy / cyclesPerMs,
+         stats.max_flush_copy / cyclesPerMs, stats.flush_wait / cyclesPerMs);
+    if (stats.blits) {
+        info("Display: %" PRIu32 " direct frames of %" PRIu32 " pixels, writing %.3f ms\n",
+             stats.blits, stats.blit_pixels, stats.blit_copy / cyclesPerMs);
+    }
+}
+
 } /* namespace app */
 } /* namespace alif */
@@ -19,6 +19,7 @@
 
 #include "BaseProcessing.hpp"
 #include "Classifier.hpp"
+#include "ImageInputAdapter.hpp"
 
 namespace arm {
 namespace app {
@@ -49,7 +50,7 @@ namespace app {
 
     private:
         TfLiteTensor* m_inputTensor;
-        bool m_convertToInt8;
+        image::InputAdapter m_adapter;
     };
 
     /**
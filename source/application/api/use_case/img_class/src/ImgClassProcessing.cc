@@ -16,7 +16,6 @@
  */
 #include "ImgClassProcessing.hpp"
 
-#include "ImageUtils.hpp"
 #include "log_macros.h"
 
 namespace arm {
@@ -24,7 +23,7 @@ namespace app {
 
     ImgClassPreProcess::ImgClassPreProcess(TfLiteTensor* inputTensor, bool convertToInt8)
     :m_inputTensor{inputTensor},
-     m_convertToInt8{convertToInt8}
+     m_adapter{convertToInt8 ? image::PixelMapping::ToInt8 : image::PixelMapping::Copy, QuantParams{}, false}
     {}
 
     bool ImgClassPreProcess::DoPreProcess(const void* data, size_t inputSize)
@@ -34,15 +33,10 @@ namespace app {
             return false;
         }
 
-        auto input = static_cast<const uint8_t*>(data);
-
-        std::memcpy(this->m_inputTensor->data.data, input, inputSize);
+        this->m_adapter.Write(static_cast<const uint8_t*>(data), inputSize,
+                              this->m_inputTensor->data.uint8, this->m_inputTensor->bytes);
         debug("Input tensor populated \n");
 
-        if (this->m_convertToInt8) {
-            image::ConvertImgToInt8(this->m_inputTensor->data.data, this->m_inputTensor->bytes);
-        }
-
         return true;
     }
 
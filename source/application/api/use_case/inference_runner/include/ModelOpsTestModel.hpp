@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INF_RUNNER_MODEL_OPS_TESTMODEL_HPP
+#define INF_RUNNER_MODEL_OPS_TESTMODEL_HPP
+
+#include "Model.hpp"
+
+#include <tensorflow/lite/micro/micro_mutable_op_resolver.h>
+
+namespace arm {
+namespace app {
+
+    /**
+     * @brief   Test model registering only the operators of the model it is
+     *          built for, as listed from the model at build time by
+     *          generate_op_resolver_code(), rather than every operator.
+     * @tparam  NumOps  Number of operators used by the model.
+     */
+    template <int NumOps>
+    class ModelOpsTestModel : public Model {
+    public:
+        using OpResolver = tflite::MicroMutableOpResolver<NumOps>;
+
+        /** Registers the operators of the model with the resolver. */
+        using Enlister = bool (*)(OpResolver& resolver);
+
+        /**
+         * @param[in]   enlist  Generated function registering the operators,
+         *                      e.g. EnlistModelOperators.
+         **/
+        explicit ModelOpsTestModel(Enlister enlist)
+        :   m_enlist{enlist}
+        {}
+
+    protected:
+        /** @brief   Gets the reference to op resolver interface class. */
+        const tflite::MicroOpResolver& GetOpResolver() override
+        {
+            return this->m_opResolver;
+        }
+
+        /** @brief   Adds operations to the op resolver instance. */
+        bool EnlistOperations() override
+        {
+            /* Start afresh, as an operator cannot be registered twice. */
+            this->m_opResolver = OpResolver();
+            return this->m_enlist(this->m_opResolver);
+        }
+
+    private:
+        Enlister m_enlist;
+        OpResolver m_opResolver;
+    };
+
+} /* namespace app */
+} /* namespace arm */
+
+#endif /* INF_RUNNER_MODEL_OPS_TESTMODEL_HPP */
@@ -57,6 +57,26 @@ namespace app {
          **/
         bool DoPreProcess(const void* input, size_t inferenceIndex = 0) override;
 
+        /**
+         * @brief       Pre-processes an audio window that wraps around the end of a
+         *              circular buffer, so that it can be read in place.
+         * @param[in]   first           First part of the window.
+         * @param[in]   firstLen        Number of samples in the first part.
+         * @param[in]   second          Rest of the window; may be nullptr if firstLen
+         *                              covers the whole window.
+         * @param[in]   inferenceIndex  Index of the inference, used to reuse cached features.
+         * @return      true if successful, false otherwise.
+         **/
+        bool DoPreProcess(const int16_t* first, size_t firstLen, const int16_t* second,
+                          size_t inferenceIndex = 0);
+
+        /**
+         * @brief   Makes the next pre-processing compute all the features, e.g.
+         *          after strides of audio have been skipped, so that features
+         *          cached from an older window are not reused.
+         **/
+        void InvalidateFeatureCache();
+
         size_t m_audioDataWindowSize;   /* Amount of audio needed for 1 inference. */
         size_t m_audioDataStride;       /* Amount of audio to stride across if doing >1 inference in longer clips. */
 
@@ -70,6 +90,7 @@ namespace app {
         audio::SlidingWindow<const int16_t> m_mfccSlidingWindow;
         size_t m_numMfccVectorsInAudioStride;
         size_t m_numReusedMfccVectors;
+        bool m_featureCacheInvalid{false};  /* Cached features are not from the previous window. */
         std::function<void (std::vector<int16_t>&, int, bool, size_t)> m_mfccFeatureCalculator;
 
         /**
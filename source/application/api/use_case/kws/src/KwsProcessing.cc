@@ -18,6 +18,8 @@
 #include "log_macros.h"
 #include "MicroNetKwsModel.hpp"
 
+#include <algorithm>
+
 namespace arm {
 namespace app {
 
@@ -77,7 +79,9 @@ namespace app {
         this->m_mfccSlidingWindow.Reset(input);
 
         /* Cache is only usable if we have more than 1 inference to do and it's not the first inference. */
-        bool useCache = inferenceIndex > 0 && this->m_numReusedMfccVectors > 0;
+        bool useCache = inferenceIndex > 0 && this->m_numReusedMfccVectors > 0 &&
+                        !this->m_featureCacheInvalid;
+        this->m_featureCacheInvalid = false;
 
         /* Use a sliding window to calculate MFCC features frame by frame. */
         while (this->m_mfccSlidingWindow.HasNext()) {
@@ -96,6 +100,51 @@ namespace app {
         return true;
     }
 
+    bool KwsPreProcess::DoPreProcess(const int16_t* first, size_t firstLen, const int16_t* second,
+                                     size_t inferenceIndex)
+    {
+        if (first == nullptr || (firstLen < this->m_audioDataWindowSize && second == nullptr)) {
+            printf_err("Invalid audio window");
+            return false;
+        }
+
+        /* Cache is only usable if we have more than 1 inference to do and it's not the first inference. */
+        bool useCache = inferenceIndex > 0 && this->m_numReusedMfccVectors > 0 &&
+                        !this->m_featureCacheInvalid;
+        this->m_featureCacheInvalid = false;
+
+        const size_t frameLength = this->m_mfccFrameLength;
+        std::vector<int16_t> mfccFrameAudioData(frameLength);
+
+        for (size_t i = 0; i < this->m_numMfccFrames; ++i) {
+            const size_t start = i * this->m_mfccFrameStride;
+            const size_t end = start + frameLength;
+
+            /* Only frames straddling the wrap point need to be assembled from both parts. */
+            if (end <= firstLen) {
+                std::copy(first + start, first + end, mfccFrameAudioData.begin());
+            } else if (start >= firstLen) {
+                std::copy(second + (start - firstLen), second + (end - firstLen),
+                          mfccFrameAudioData.begin());
+            } else {
+                auto it = std::copy(first + start, first + firstLen, mfccFrameAudioData.begin());
+                std::copy(second, second + (end - firstLen), it);
+            }
+
+            this->m_mfccFeatureCalculator(mfccFrameAudioData, i, useCache,
+                                          this->m_numMfccVectorsInAudioStride);
+        }
+
+        debug("Input tensor populated \n");
+
+        return true;
+    }
+
+    void KwsPreProcess::InvalidateFeatureCache()
+    {
+        this->m_featureCacheInvalid = true;
+    }
+
     /**
      * @brief Generic feature calculator factory.
      *
@@ -22,7 +22,7 @@
 #include "YoloFastestModel.hpp"
 #include "BaseProcessing.hpp"
 
-#include <forward_list>
+#include <vector>
 
 namespace arm {
 namespace app {
@@ -37,7 +37,7 @@ namespace object_detection {
         float threshold = 0.5f;
         float nms = 0.45f;
         int numClasses = 1;
-        int topN = 0;
+        int topN = 0;       /* Boxes kept before NMS, highest objectness first; 0 keeps all. */
     };
 
     struct Branch {
@@ -64,6 +64,8 @@ namespace object_detection {
      * @brief   Post-processing class for Object Detection use case.
      *          Implements methods declared by BasePostProcess and anything else needed
      *          to populate result vector.
+     *          All the memory it needs is allocated on construction, so one object can
+     *          be reused for every inference without allocating on the heap.
      */
     class DetectorPostProcess : public BasePostProcess {
     public:
@@ -71,7 +73,8 @@ namespace object_detection {
          * @brief        Constructor.
          * @param[in]    outputTensor0       Pointer to the TFLite Micro output Tensor at index 0.
          * @param[in]    outputTensor1       Pointer to the TFLite Micro output Tensor at index 1.
-         * @param[out]   results             Vector of detected results.
+         * @param[out]   results             Vector of detected results. Its capacity is reserved
+         *                                   for the most results an inference can give.
          * @param[in]    postProcessParams   Struct of various parameters used in post-processing.
          **/
         explicit DetectorPostProcess(TfLiteTensor* outputTensor0,
@@ -81,38 +84,41 @@ namespace object_detection {
 
         /**
          * @brief    Should perform YOLO post-processing of the result of inference then
-         *           populate Detection result data for any later use.
+         *           populate Detection result data for any later use. The results of
+         *           the previous inference are replaced.
          * @return   true if successful, false otherwise.
          **/
         bool DoPostProcess() override;
 
+        /**
+         * @brief    Gets the most results an inference can give.
+         * @return   Number of results.
+         **/
+        size_t GetMaxResults() const;
+
     private:
         TfLiteTensor* m_outputTensor0;                                   /* Output tensor index 0 */
         TfLiteTensor* m_outputTensor1;                                   /* Output tensor index 1 */
         std::vector<object_detection::DetectionResult>& m_results;       /* Single inference results. */
         const object_detection::PostProcessParams& m_postProcessParams;  /* Post processing param struct. */
         object_detection::Network m_net;                                 /* YOLO network object. */
+        std::vector<image::Detection> m_detections;                      /* Boxes above the threshold. */
 
         /**
-         * @brief       Insert the given Detection in the list.
-         * @param[in]   detections   List of detections.
-         * @param[in]   det          Detection to be inserted.
-         **/
-        void InsertTopNDetections(std::forward_list<image::Detection>& detections, image::Detection& det);
-
-        /**
-         * @brief        Given a Network calculate the detection boxes.
+         * @brief        Given a Network calculate the detection boxes. When there are more
+         *               boxes than room for them, the ones with the highest objectness are kept.
          * @param[in]    net           Network.
          * @param[in]    imageWidth    Original image width.
          * @param[in]    imageHeight   Original image height.
          * @param[in]    threshold     Detections threshold.
-         * @param[out]   detections    Detection boxes.
+         * @param[out]   detections    Room for the detection boxes.
+         * @return       Number of detection boxes, from the start of detections.
          **/
-        void GetNetworkBoxes(object_detection::Network& net,
-                             int imageWidth,
-                             int imageHeight,
-                             float threshold,
-                             std::forward_list<image::Detection>& detections);
+        size_t GetNetworkBoxes(object_detection::Network& net,
+                               int imageWidth,
+                               int imageHeight,
+                               float threshold,
+                               std::vector<image::Detection>& detections);
     };
 
 } /* namespace app */
@@ -19,6 +19,7 @@
 
 #include "BaseProcessing.hpp"
 #include "Classifier.hpp"
+#include "ImageInputAdapter.hpp"
 
 namespace arm {
 namespace app {
@@ -51,7 +52,7 @@ namespace app {
     private:
         TfLiteTensor* m_inputTensor;
         bool m_rgb2Gray;
-        bool m_convertToInt8;
+        image::InputAdapter m_adapter;
     };
 
 } /* namespace app */
@@ -17,6 +17,7 @@
 #include "DetectorPostProcessing.hpp"
 #include "PlatformMath.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace arm {
@@ -61,6 +62,20 @@ namespace app {
                                                        ->zero_point->data[0],
                                       .size = this->m_outputTensor1->bytes}},
         .topN = postProcessParams.topN};
+
+    /* Room for every box the network can output, or for the top N. */
+    size_t maxDetections = 0;
+    for (const auto& branch : this->m_net.branches) {
+        maxDetections += branch.resolution * branch.resolution * branch.numBox;
+    }
+    if (this->m_net.topN > 0) {
+        maxDetections = std::min(maxDetections, static_cast<size_t>(this->m_net.topN));
+    }
+    this->m_detections.resize(maxDetections);
+    for (auto& det : this->m_detections) {
+        det.prob.resize(this->m_net.numClasses);
+    }
+    this->m_results.reserve(this->GetMaxResults());
     /* End init */
 }
 
@@ -70,13 +85,17 @@ bool DetectorPostProcess::DoPostProcess()
     int originalImageWidth  = m_postProcessParams.originalImageSize;
     int originalImageHeight = m_postProcessParams.originalImageSize;
 
-    std::forward_list<image::Detection> detections;
-    GetNetworkBoxes(this->m_net, originalImageWidth, originalImageHeight, m_postProcessParams.threshold, detections);
+    this->m_results.clear();
+
+    const size_t numDetections = GetNetworkBoxes(this->m_net, originalImageWidth, originalImageHeight,
+                                                 m_postProcessParams.threshold, this->m_detections);
 
     /* Do nms */
-    CalculateNMS(detections, this->m_net.numClasses, this->m_postProcessParams.nms);
+    CalculateNMS(this->m_detections.data(), numDetections, this->m_net.numClasses,
+                 this->m_postProcessParams.nms);
 
-    for (auto& it: detections) {
+    for (size_t i = 0; i < numDetections; ++i) {
+        const image::Detection& it = this->m_detections[i];
         float xMin = it.bbox.x - it.bbox.w / 2.0f;
         float xMax = it.bbox.x + it.bbox.w / 2.0f;
         float yMin = it.bbox.y - it.bbox.h / 2.0f;
@@ -117,31 +136,21 @@ bool DetectorPostProcess::DoPostProcess()
     return true;
 }
 
-void DetectorPostProcess::InsertTopNDetections(std::forward_list<image::Detection>& detections, image::Detection& det)
+size_t DetectorPostProcess::GetMaxResults() const
 {
-    std::forward_list<image::Detection>::iterator it;
-    std::forward_list<image::Detection>::iterator last_it;
-    for ( it = detections.begin(); it != detections.end(); ++it ) {
-        if(it->objectness > det.objectness)
-            break;
-        last_it = it;
-    }
-    if(it != detections.begin()) {
-        detections.emplace_after(last_it, det);
-        detections.pop_front();
-    }
+    return this->m_detections.size() * this->m_net.numClasses;
 }
 
-void DetectorPostProcess::GetNetworkBoxes(
+size_t DetectorPostProcess::GetNetworkBoxes(
         object_detection::Network& net,
         int imageWidth,
         int imageHeight,
         float threshold,
-        std::forward_list<image::Detection>& detections)
+        std::vector<image::Detection>& detections)
 {
     int numClasses = net.numClasses;
-    int num = 0;
-    auto det_objectness_comparator = [](image::Detection& pa, image::Detection& pb) {
+    size_t num = 0;
+    auto det_objectness_comparator = [](const image::Detection& pa, const image::Detection& pb) {
         return pa.objectness < pb.objectness;
     };
     for (size_t i = 0; i < net.branches.size(); ++i) {
@@ -161,7 +170,20 @@ void DetectorPostProcess::GetNetworkBoxes(
                             ) * net.branches[i].scale);
 
                     if(objectness > threshold) {
-                        image::Detection det;
+                        /* Take a free entry or, when all are taken, replace the box
+                         * with the lowest objectness if this one is at least as good. */
+                        size_t slot = num;
+                        if (num < detections.size()) {
+                            ++num;
+                        } else {
+                            slot = std::min_element(detections.begin(), detections.end(),
+                                                    det_objectness_comparator) - detections.begin();
+                            if (detections[slot].objectness > objectness) {
+                                continue;
+                            }
+                        }
+
+                        image::Detection& det = detections[slot];
                         det.objectness = objectness;
                         /* Get bbox prediction data for each anchor, each feature point */
                         int bbox_x_offset = bbox_obj_offset -4;
@@ -195,7 +217,7 @@ void DetectorPostProcess::GetNetworkBoxes(
                                     (static_cast<float>(net.branches[i].modelOutput[bbox_scores_offset + s]) -
                                     net.branches[i].zeroPoint) * net.branches[i].scale
                                     ) * objectness;
-                            det.prob.emplace_back((sig > threshold) ? sig : 0);
+                            det.prob[s] = (sig > threshold) ? sig : 0;
                         }
 
                         /* Correct_YOLO_boxes */
@@ -203,24 +225,12 @@ void DetectorPostProcess::GetNetworkBoxes(
                         det.bbox.w *= imageWidth;
                         det.bbox.y *= imageHeight;
                         det.bbox.h *= imageHeight;
-
-                        if (num < net.topN || net.topN <=0) {
-                            detections.emplace_front(det);
-                            num += 1;
-                        } else if (num == net.topN) {
-                            detections.sort(det_objectness_comparator);
-                            InsertTopNDetections(detections, det);
-                            num += 1;
-                        } else {
-                            InsertTopNDetections(detections, det);
-                        }
                     }
                 }
             }
         }
     }
-    if(num > net.topN)
-        num -=1;
+    return num;
 }
 
 } /* namespace app */
@@ -15,7 +15,6 @@
  * limitations under the License.
  */
 #include "DetectorPreProcessing.hpp"
-#include "ImageUtils.hpp"
 #include "log_macros.h"
 
 namespace arm {
@@ -24,27 +23,21 @@ namespace app {
     DetectorPreProcess::DetectorPreProcess(TfLiteTensor* inputTensor, bool rgb2Gray, bool convertToInt8)
     :   m_inputTensor{inputTensor},
         m_rgb2Gray{rgb2Gray},
-        m_convertToInt8{convertToInt8}
+        m_adapter{convertToInt8 ? image::PixelMapping::ToInt8 : image::PixelMapping::Copy, QuantParams{}, rgb2Gray}
     {}
 
     bool DetectorPreProcess::DoPreProcess(const void* data, size_t inputSize) {
         if (data == nullptr) {
             printf_err("Data pointer is null");
+            return false;
         }
 
-        auto input = static_cast<const uint8_t*>(data);
-
-        if (this->m_rgb2Gray) {
-            image::RgbToGrayscale(input, this->m_inputTensor->data.uint8, this->m_inputTensor->bytes);
-        } else {
-            std::memcpy(this->m_inputTensor->data.data, input, inputSize);
-        }
+        /* The whole tensor is converted to grayscale from an RGB input. */
+        const size_t srcSize = this->m_rgb2Gray ? this->m_inputTensor->bytes * 3 : inputSize;
+        this->m_adapter.Write(static_cast<const uint8_t*>(data), srcSize,
+                              this->m_inputTensor->data.uint8, this->m_inputTensor->bytes);
         debug("Input tensor populated \n");
 
-        if (this->m_convertToInt8) {
-            image::ConvertImgToInt8(this->m_inputTensor->data.data, this->m_inputTensor->bytes);
-        }
-
         return true;
     }
 
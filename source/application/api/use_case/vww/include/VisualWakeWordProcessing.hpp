@@ -20,6 +20,7 @@
 #include "BaseProcessing.hpp"
 #include "Model.hpp"
 #include "Classifier.hpp"
+#include "ImageInputAdapter.hpp"
 
 namespace arm {
 namespace app {
@@ -51,6 +52,7 @@ namespace app {
     private:
         TfLiteTensor* m_inputTensor;
         bool m_rgb2Gray;
+        image::InputAdapter m_adapter;
     };
 
     /**
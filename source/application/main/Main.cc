@@ -22,6 +22,7 @@
 
 #include "hal.h"                    /* our hardware abstraction api */
 #include "log_macros.h"
+#include "log_trace.h"
 #include "TensorFlowLiteMicro.hpp"  /* our inference logic api */
 
 #include <cstdio>
@@ -61,10 +62,24 @@ int main ()
 
         /* Run the application. */
         MainLoop();
+
+#if defined(LOG_TRACE_ENABLED)
+        /* Export the timeline of the run. */
+#if defined(LOG_TRACE_FILE)
+        if (log_trace_write_file(LOG_TRACE_FILE)) {
+            info("Trace written to %s\n", LOG_TRACE_FILE);
+        } else {
+            printf_err("Failed to write trace to %s\n", LOG_TRACE_FILE);
+        }
+#else /* defined(LOG_TRACE_FILE) */
+        log_trace_dump();
+#endif /* defined(LOG_TRACE_FILE) */
+#endif /* defined(LOG_TRACE_ENABLED) */
     }
 
     /* This is unreachable without errors. */
     info("program terminating...\n");
+    log_flush();
 
     /* Release platform. */
     hal_platform_release();
@@ -74,6 +74,51 @@ namespace app {
         return runInf;
     }
 
+    ProfilingInference::ProfilingInference(PipelineInference& inference, Profiler& profiler)
+    :   m_inference{inference},
+        m_profiler{profiler},
+        m_region{profiler.RegisterRegion("Inference")}
+    {}
+
+    size_t ProfilingInference::GetNumInputs() const
+    {
+        return this->m_inference.GetNumInputs();
+    }
+
+    size_t ProfilingInference::GetNumOutputs() const
+    {
+        return this->m_inference.GetNumOutputs();
+    }
+
+    TfLiteTensor* ProfilingInference::GetInputTensor(size_t index) const
+    {
+        return this->m_inference.GetInputTensor(index);
+    }
+
+    TfLiteTensor* ProfilingInference::GetOutputTensor(size_t index) const
+    {
+        return this->m_inference.GetOutputTensor(index);
+    }
+
+    bool ProfilingInference::Start()
+    {
+        this->m_profiler.StartProfiling(this->m_region);
+        if (!this->m_inference.Start()) {
+            this->m_profiler.StopProfiling();
+            return false;
+        }
+        return true;
+    }
+
+    InferenceStatus ProfilingInference::Poll(bool block)
+    {
+        const InferenceStatus status = this->m_inference.Poll(block);
+        if (InferenceStatus::Running != status) {
+            this->m_profiler.StopProfiling();
+        }
+        return status;
+    }
+
     int ReadUserInputAsInt()
     {
         char chInput[128];
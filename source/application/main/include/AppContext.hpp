@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: Copyright 2021, 2023 Arm Limited and/or its affiliates
+ * SPDX-FileCopyrightText: Copyright 2021, 2023-2024 Arm Limited and/or its affiliates
  * <open-source-office@arm.com> SPDX-License-Identifier: Apache-2.0
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
@@ -17,9 +17,13 @@
 #ifndef APP_CTX_HPP
 #define APP_CTX_HPP
 
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
+
 namespace arm {
 namespace app {
 
@@ -45,7 +49,11 @@ namespace app {
         T m_value;
     };
 
-    /* Application context class */
+    /**
+     * @brief   Application context with attributes looked up by name at run
+     *          time. Kept for compatibility; TypedContext is preferred where
+     *          a handler runs often.
+     */
     class ApplicationContext {
     public:
 
@@ -98,6 +106,138 @@ namespace app {
         std::map<std::string, std::unique_ptr<IAttribute>> m_attributes;
     };
 
+    /**
+     * @brief   Compile-time key of a TypedContext entry. Each entry is a
+     *          distinct type deriving from ContextKey, e.g.
+     *
+     *              struct Model : ContextKey<arm::app::Model&> {};
+     *
+     * @tparam  T   Type of the value. References are held as pointers, other
+     *              types are held by value in the context itself.
+     */
+    template<typename T>
+    struct ContextKey {
+        using Type = T;
+    };
+
+    namespace detail {
+
+        /* Value held by a TypedContext entry. */
+        template<typename T>
+        class ContextSlot {
+        public:
+            void Set(const T& value)
+            {
+                this->m_value = value;
+                this->m_set = true;
+            }
+
+            T& Get()
+            {
+                return this->m_value;
+            }
+
+            bool Has() const
+            {
+                return this->m_set;
+            }
+
+        private:
+            T m_value{};
+            bool m_set{false};
+        };
+
+        /* Reference held by a TypedContext entry. */
+        template<typename T>
+        class ContextSlot<T&> {
+        public:
+            void Set(T& value)
+            {
+                this->m_value = &value;
+            }
+
+            T& Get()
+            {
+                return *this->m_value;
+            }
+
+            bool Has() const
+            {
+                return this->m_value != nullptr;
+            }
+
+        private:
+            T* m_value{nullptr};
+        };
+
+        /* Position of Key in Keys; fails to compile if it is not there. */
+        template<typename Key, typename... Keys>
+        struct ContextKeyIndex;
+
+        template<typename Key, typename... Rest>
+        struct ContextKeyIndex<Key, Key, Rest...> : std::integral_constant<size_t, 0> {};
+
+        template<typename Key, typename First, typename... Rest>
+        struct ContextKeyIndex<Key, First, Rest...>
+            : std::integral_constant<size_t, 1 + ContextKeyIndex<Key, Rest...>::value> {};
+
+    } /* namespace detail */
+
+    /**
+     * @brief   Application context whose entries are fixed at compile time.
+     *          Each entry is a member of the context, so Set does not allocate
+     *          and Get is a plain member access, with types checked by the
+     *          compiler rather than cast at run time.
+     * @tparam  Keys    Keys of the entries, types deriving from ContextKey.
+     */
+    template<typename... Keys>
+    class TypedContext {
+    public:
+        /**
+         * @brief     Saves the value of an entry.
+         * @tparam    Key      Key of the entry.
+         * @param[in] value    Value to save, copied into the entry reusing its
+         *                     storage. References are saved as such and
+         *                     must outlive the context.
+         */
+        template<typename Key>
+        void Set(const typename Key::Type& value)
+        {
+            this->Slot<Key>().Set(value);
+        }
+
+        /**
+         * @brief   Gets the value of an entry, which must have been set.
+         * @tparam  Key     Key of the entry.
+         * @return  Reference to the value saved in the context.
+         */
+        template<typename Key>
+        std::remove_reference_t<typename Key::Type>& Get()
+        {
+            return this->Slot<Key>().Get();
+        }
+
+        /**
+         * @brief   Checks if the value of an entry has been set.
+         * @tparam  Key     Key of the entry.
+         * @return  true if set, false otherwise.
+         */
+        template<typename Key>
+        bool Has() const
+        {
+            return std::get<detail::ContextKeyIndex<Key, Keys...>::value>(this->m_slots).Has();
+        }
+
+    private:
+        template<typename Key>
+        detail::ContextSlot<typename Key::Type>& Slot()
+        {
+            return std::get<detail::ContextKeyIndex<Key, Keys...>::value>(this->m_slots);
+        }
+
+        std::tuple<detail::ContextSlot<typename Keys::Type>...> m_slots;
+    };
+
 } /* namespace app */
 } /* namespace arm */
 
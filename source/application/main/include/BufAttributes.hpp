@@ -46,10 +46,11 @@ extern "C" {
 #define ALIGNMENT_REQ               aligned(BYTE_ALIGNMENT)
 
 #if defined(MODEL_IN_EXT_FLASH)
-#define MODEL_SECTION               section("nn_model_ext_flash")
+#define MODEL_SECTION_NAME          "nn_model_ext_flash"
 #else
-#define MODEL_SECTION               section("nn_model")
+#define MODEL_SECTION_NAME          "nn_model"
 #endif
+#define MODEL_SECTION               section(MODEL_SECTION_NAME)
 
 /* Label section name */
 #define LABEL_SECTION               section("labels")
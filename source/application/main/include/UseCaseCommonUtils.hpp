@@ -19,6 +19,7 @@
 #define USECASE_COMMON_UTILS_HPP
 
 #include "Model.hpp"
+#include "Pipeline.hpp"
 #include "Profiler.hpp"
 #include "Classifier.hpp"
 
@@ -42,6 +43,32 @@ namespace app {
      **/
     bool RunInference(Model& model, Profiler& profiler);
 
+    /**
+     * @brief   Profiles each inference of a pipeline, from when it is started
+     *          until the pipeline sees it finished, in the region that
+     *          RunInference uses.
+     */
+    class ProfilingInference : public PipelineInference {
+    public:
+        /**
+         * @param[in]   inference   Runs the inferences.
+         * @param[in]   profiler    Reference to the initialised profiler.
+         **/
+        ProfilingInference(PipelineInference& inference, Profiler& profiler);
+
+        size_t GetNumInputs() const override;
+        size_t GetNumOutputs() const override;
+        TfLiteTensor* GetInputTensor(size_t index) const override;
+        TfLiteTensor* GetOutputTensor(size_t index) const override;
+        bool Start() override;
+        InferenceStatus Poll(bool block) override;
+
+    private:
+        PipelineInference& m_inference;
+        Profiler& m_profiler;
+        ProfilingRegionId m_region;
+    };
+
     /**
      * @brief           Read input and return as an integer.
      * @return          Integer value corresponding to the user input.
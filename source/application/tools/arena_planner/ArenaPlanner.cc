@@ -0,0 +1,464 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************\
+ *  Arena planner: loads models as the use cases do and works out the        *
+ *  smallest activation buffer (tensor arena) they fit in.                   *
+\****************************************************************************/
+
+#include "ArenaPlan.hpp"
+#include "TestModel.hpp"
+
+#include "tensorflow/lite/micro/memory_planner/linear_memory_planner.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /* TFLM aligns the arena to 16 bytes, as does ACTIVATION_BUF_ATTRIBUTE. */
+    constexpr size_t kArenaAlignment = 16;
+
+    size_t AlignUp(size_t bytes)
+    {
+        return (bytes + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+    }
+
+    /* Lets the Ethos-U operator of Vela models be prepared, with the
+     * allocations it makes on the target, without an NPU to run it. */
+    class PlanningNpuBackend : public arm::app::NpuBackend {
+    public:
+        bool Start(const arm::app::NpuJob&) override { return false; }
+        arm::app::InferenceStatus Wait(bool) override { return arm::app::InferenceStatus::Idle; }
+    };
+
+    PlanningNpuBackend planningBackend;
+
+    struct Options {
+        std::vector<std::string> models;
+        size_t arenaSize{0};            /* Configured size to compare with, 0 if none. */
+        size_t maxArenaSize{64 << 20};  /* Size of the arena the models are first planned in. */
+        size_t stagingBudget{0};        /* Weight staging budget of each model. */
+        std::string headerPath;
+        std::string reportPath;
+    };
+
+    struct ModelFile {
+        std::string path;
+        std::vector<uint8_t> data;
+    };
+
+    /* Silences stdout and stderr, where the models and TFLM log, while in scope. */
+    class Quiet {
+    public:
+        Quiet()
+        {
+            std::fflush(stdout);
+            std::fflush(stderr);
+            this->m_stdout = dup(STDOUT_FILENO);
+            this->m_stderr = dup(STDERR_FILENO);
+            const int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDERR_FILENO);
+            close(null);
+        }
+
+        ~Quiet()
+        {
+            std::fflush(stdout);
+            std::fflush(stderr);
+            dup2(this->m_stdout, STDOUT_FILENO);
+            dup2(this->m_stderr, STDERR_FILENO);
+            close(this->m_stdout);
+            close(this->m_stderr);
+        }
+
+    private:
+        int m_stdout;
+        int m_stderr;
+    };
+
+    /* Tensor arena aligned as on the target. */
+    class Arena {
+    public:
+        explicit Arena(size_t size) : m_buffer(size + kArenaAlignment), m_size(size) {}
+
+        uint8_t* Data()
+        {
+            const auto address = reinterpret_cast<uintptr_t>(this->m_buffer.data());
+            return this->m_buffer.data() + (AlignUp(address) - address);
+        }
+
+        size_t Size() const { return this->m_size; }
+
+    private:
+        std::vector<uint8_t> m_buffer;
+        size_t m_size;
+    };
+
+    /**
+     * @brief   Initialises the models one after another in the same arena, the
+     *          later ones with the allocator of the first, as use cases running
+     *          more than one model do.
+     * @param[in]   allocator   Allocator to use, or nullptr for the one Model
+     *                          creates, with TFLM's default greedy planner.
+     **/
+    bool LoadModels(const std::vector<ModelFile>& files, Arena& arena,
+                    tflite::MicroAllocator* allocator, size_t stagingBudget,
+                    std::vector<std::unique_ptr<arm::app::TestModel>>& models)
+    {
+        models.clear();
+        for (const ModelFile& file : files) {
+            auto model = std::make_unique<arm::app::TestModel>();
+            model->SetNpuBackend(&planningBackend);
+            model->SetWeightStagingBudget(stagingBudget);
+            if (!model->Init(arena.Data(), arena.Size(), file.data.data(), file.data.size(),
+                             models.empty() ? allocator : models.front()->GetAllocator())) {
+                return false;
+            }
+            models.push_back(std::move(model));
+        }
+        return true;
+    }
+
+    bool Fits(const std::vector<ModelFile>& files, size_t arenaSize, size_t stagingBudget)
+    {
+        Arena arena{arenaSize};
+        std::vector<std::unique_ptr<arm::app::TestModel>> models;
+        Quiet quiet;
+        return LoadModels(files, arena, nullptr, stagingBudget, models);
+    }
+
+    /* The planner needs temporary memory in the arena while planning, so the
+     * smallest arena that works can be larger than the bytes used after. */
+    size_t FindMinimalArena(const std::vector<ModelFile>& files, size_t used, size_t maxSize,
+                            size_t stagingBudget)
+    {
+        size_t low = AlignUp(used);
+        if (Fits(files, low, stagingBudget)) {
+            return low;
+        }
+        size_t high = maxSize & ~(kArenaAlignment - 1);
+        while (high - low > kArenaAlignment) {
+            const size_t middle = AlignUp(low + (high - low) / 2);
+            if (Fits(files, middle, stagingBudget)) {
+                high = middle;
+            } else {
+                low = middle;
+            }
+        }
+        return high;
+    }
+
+    /* Arena bytes used with TFLM's linear planner, which never reuses memory. */
+    size_t UsedWithLinearPlanner(const std::vector<ModelFile>& files, size_t arenaSize,
+                                 size_t stagingBudget)
+    {
+        Arena arena{arenaSize};
+        tflite::LinearMemoryPlanner planner;
+        std::vector<std::unique_ptr<arm::app::TestModel>> models;
+        Quiet quiet;
+        tflite::MicroAllocator* allocator =
+            tflite::MicroAllocator::Create(arena.Data(), arena.Size(), &planner);
+        if (!allocator || !LoadModels(files, arena, allocator, stagingBudget, models)) {
+            return 0;
+        }
+        return models.back()->GetArenaUsedBytes();
+    }
+
+    struct OperatorCount {
+        size_t npu{0};
+        size_t cpu{0};
+    };
+
+    OperatorCount CountOperators(const ModelFile& file)
+    {
+        OperatorCount count;
+        const tflite::Model* model = tflite::GetModel(file.data.data());
+        const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+        for (const tflite::Operator* op : *subgraph->operators()) {
+            const tflite::OperatorCode* opcode = model->operator_codes()->Get(op->opcode_index());
+            if (tflite::GetBuiltinCode(opcode) == tflite::BuiltinOperator_CUSTOM &&
+                opcode->custom_code() &&
+                0 == std::strcmp(opcode->custom_code()->c_str(), tflite::GetString_ETHOSU())) {
+                ++count.npu;
+            } else {
+                ++count.cpu;
+            }
+        }
+        return count;
+    }
+
+    std::string BaseName(const std::string& path)
+    {
+        const size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    struct Result {
+        std::vector<arm::app::ArenaPlan> plans;
+        std::vector<OperatorCount> operators;
+        size_t used{0};         /* Bytes used with the greedy planner. */
+        size_t linearUsed{0};   /* Bytes used with the linear planner, 0 if it failed. */
+        size_t minimal{0};      /* Smallest arena the models fit in. */
+    };
+
+    void WriteReport(std::FILE* out, const Options& options, const std::vector<ModelFile>& files,
+                     const Result& result, bool withTensors)
+    {
+        for (size_t m = 0; m < files.size(); ++m) {
+            const arm::app::ArenaPlan& plan = result.plans[m];
+            int peakOp = 0;
+            const size_t peak = plan.GetPeakLiveBytes(&peakOp);
+            const size_t extent = plan.GetExtent();
+
+            std::fprintf(out, "%s: %zu operators (%zu on the NPU), %zu tensors in the arena\n",
+                         BaseName(files[m].path).c_str(),
+                         result.operators[m].npu + result.operators[m].cpu,
+                         result.operators[m].npu, plan.GetTensors().size());
+
+            if (withTensors) {
+                std::fprintf(out, "  %6s  %-10s  %10s  %-11s  %s\n",
+                             "Tensor", "Offset", "Bytes", "Operators", "Name");
+                for (const arm::app::ArenaTensor& tensor : plan.GetTensors()) {
+                    char ops[24];
+                    std::snprintf(ops, sizeof(ops), "%d-%d", tensor.firstOp, tensor.lastOp);
+                    std::fprintf(out, "  %6d  0x%08zX  %10zu  %-11s  %s\n",
+                                 tensor.index, tensor.offset, tensor.bytes, ops, tensor.name);
+                }
+            }
+
+            std::fprintf(out, "  Head: tensors span %zu bytes, at most %zu bytes are needed at once "
+                              "(operator %d): %zu bytes (%.1f%%) lost to fragmentation\n",
+                         extent, peak, peakOp, extent - peak,
+                         extent ? 100.0 * (extent - peak) / extent : 0.0);
+        }
+
+        /* Models sharing an allocator share the head too. */
+        size_t extent = 0;
+        for (const arm::app::ArenaPlan& plan : result.plans) {
+            extent = std::max(extent, plan.GetExtent());
+        }
+        std::fprintf(out, "Arena used: %zu bytes with the greedy planner", result.used);
+        if (result.linearUsed) {
+            std::fprintf(out, ", %zu bytes with the linear planner", result.linearUsed);
+        }
+        std::fprintf(out, "\n");
+        std::fprintf(out, "  Tail: %zu bytes of persistent data and operator scratch buffers\n",
+                     result.used > extent ? result.used - extent : 0);
+        std::fprintf(out, "Minimal ACTIVATION_BUF_SZ: %zu (0x%zX) bytes\n",
+                     result.minimal, result.minimal);
+
+        if (options.arenaSize) {
+            if (options.arenaSize < result.minimal) {
+                std::fprintf(out, "Configured ACTIVATION_BUF_SZ: %zu bytes, %zu bytes too small\n",
+                             options.arenaSize, result.minimal - options.arenaSize);
+            } else {
+                std::fprintf(out, "Configured ACTIVATION_BUF_SZ: %zu bytes, %zu bytes unused\n",
+                             options.arenaSize, options.arenaSize - result.minimal);
+            }
+        }
+
+        size_t cpuOperators = 0;
+        for (const OperatorCount& count : result.operators) {
+            cpuOperators += count.cpu;
+        }
+        if (cpuOperators) {
+            std::fprintf(out, "Note: %zu operators run on the CPU. Their scratch buffers were sized "
+                              "by this host's kernels, which may differ from the target's.\n",
+                         cpuOperators);
+        }
+    }
+
+    bool WriteHeader(const std::string& path, const std::vector<ModelFile>& files,
+                     const Result& result)
+    {
+        std::FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return false;
+        }
+        std::fprintf(out, "/* Generated by arena_planner; do not edit. */\n");
+        std::fprintf(out, "#ifndef ACTIVATION_BUFFER_SIZE_HPP\n#define ACTIVATION_BUFFER_SIZE_HPP\n\n");
+        std::fprintf(out, "/* Planned for:");
+        for (const ModelFile& file : files) {
+            std::fprintf(out, " %s", BaseName(file.path).c_str());
+        }
+        std::fprintf(out, " */\n");
+        std::fprintf(out, "#define ARENA_PLAN_ACTIVATION_BUF_SZ    0x%08zX  /* Smallest arena the models fit in. */\n",
+                     result.minimal);
+        std::fprintf(out, "#define ARENA_PLAN_USED_BYTES           %zu  /* Bytes used after allocation. */\n",
+                     result.used);
+        std::fprintf(out, "\n#endif /* ACTIVATION_BUFFER_SIZE_HPP */\n");
+        std::fclose(out);
+        return true;
+    }
+
+    bool ReadModel(const std::string& path, ModelFile& file)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "Failed to open %s\n", path.c_str());
+            return false;
+        }
+        file.path = path;
+        file.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (file.data.empty() || tflite::GetModel(file.data.data())->version() != TFLITE_SCHEMA_VERSION) {
+            std::fprintf(stderr, "%s is not a supported tflite model\n", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool ParseSize(const char* text, size_t& size)
+    {
+        char* end = nullptr;
+        const unsigned long long value = std::strtoull(text, &end, 0);
+        if (!end || *end != '\0') {
+            return false;
+        }
+        size = static_cast<size_t>(value);
+        return true;
+    }
+
+    void PrintUsage(const char* name)
+    {
+        std::printf("Usage: %s [options] model.tflite [model.tflite...]\n"
+                    "Works out the smallest activation buffer the models fit in. More than\n"
+                    "one model share the buffer, initialised in the order given.\n\n"
+                    "  --arena-size BYTES   Configured ACTIVATION_BUF_SZ to compare with\n"
+                    "  --staging BYTES      Weight staging budget of each model\n"
+                    "  --max-arena BYTES    Largest arena to try (default 64 MiB)\n"
+                    "  --header FILE        Write a header defining ARENA_PLAN_ACTIVATION_BUF_SZ\n"
+                    "  --report FILE        Write the report, with the tensor map, to a file\n",
+                    name);
+    }
+
+    bool ParseArguments(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "-h" || arg == "--help") {
+                return false;
+            } else if (arg == "--arena-size" && hasValue) {
+                if (!ParseSize(argv[++i], options.arenaSize)) {
+                    return false;
+                }
+            } else if (arg == "--staging" && hasValue) {
+                if (!ParseSize(argv[++i], options.stagingBudget)) {
+                    return false;
+                }
+            } else if (arg == "--max-arena" && hasValue) {
+                if (!ParseSize(argv[++i], options.maxArenaSize)) {
+                    return false;
+                }
+            } else if (arg == "--header" && hasValue) {
+                options.headerPath = argv[++i];
+            } else if (arg == "--report" && hasValue) {
+                options.reportPath = argv[++i];
+            } else if (arg.rfind("--", 0) == 0) {
+                std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+                return false;
+            } else {
+                options.models.push_back(arg);
+            }
+        }
+        return !options.models.empty();
+    }
+
+} /* namespace */
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<ModelFile> files(options.models.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!ReadModel(options.models[i], files[i])) {
+            return 1;
+        }
+    }
+
+    /* Plan in a large arena first, as the use case would, with the models logging
+     * only if that fails. */
+    Result result;
+    {
+        Arena arena{options.maxArenaSize};
+        std::vector<std::unique_ptr<arm::app::TestModel>> models;
+        bool loaded;
+        {
+            Quiet quiet;
+            loaded = LoadModels(files, arena, nullptr, options.stagingBudget, models);
+        }
+        if (!loaded) {
+            LoadModels(files, arena, nullptr, options.stagingBudget, models);
+            std::fprintf(stderr, "Failed to load the models in a %zu byte arena\n", arena.Size());
+            return 1;
+        }
+
+        for (size_t i = 0; i < models.size(); ++i) {
+            arm::app::ArenaPlan plan;
+            models[i]->GetArenaPlan(plan);
+            size_t first = 0;
+            size_t second = 0;
+            if (plan.FindOverlap(first, second)) {
+                std::fprintf(stderr, "%s: tensors %d and %d overlap\n", files[i].path.c_str(),
+                             plan.GetTensors()[first].index, plan.GetTensors()[second].index);
+                return 1;
+            }
+            result.plans.push_back(std::move(plan));
+            result.operators.push_back(CountOperators(files[i]));
+        }
+        result.used = models.back()->GetArenaUsedBytes();
+    }
+
+    result.linearUsed = UsedWithLinearPlanner(files, options.maxArenaSize, options.stagingBudget);
+    result.minimal = FindMinimalArena(files, result.used, options.maxArenaSize, options.stagingBudget);
+
+    WriteReport(stdout, options, files, result, false);
+
+    if (!options.reportPath.empty()) {
+        std::FILE* report = std::fopen(options.reportPath.c_str(), "w");
+        if (!report) {
+            std::fprintf(stderr, "Failed to write %s\n", options.reportPath.c_str());
+            return 1;
+        }
+        WriteReport(report, options, files, result, true);
+        std::fclose(report);
+    }
+
+    if (!options.headerPath.empty() && !WriteHeader(options.headerPath, files, result)) {
+        return 1;
+    }
+    return 0;
+}
@@ -15,6 +15,7 @@
  **/
 
 #include "audio_data.h"
+#include "audio_ring.h"
 
 #include <stdint.h>
 #include <stddef.h>
@@ -46,4 +47,19 @@
 
 #define hal_set_audio_gain(gain_db) set_audio_gain(gain_db)
 
+#define hal_get_audio_stats(stats)      get_audio_stats(stats)
+
+#define hal_set_audio_stats_logging(enable) set_audio_stats_logging(enable)
+
+/**
+ * @brief circular audio buffer, see audio_ring.h.
+ */
+#define hal_audio_ring_init(ring, buf, slot_len, n_slots) audio_ring_init(ring, buf, slot_len, n_slots)
+
+#define hal_audio_ring_start(ring)      audio_ring_start(ring)
+
+#define hal_audio_ring_wait(ring)       audio_ring_wait(ring)
+
+#define hal_audio_ring_get_window(ring, len, window) audio_ring_get_window(ring, len, window)
+
 #endif // HAL_DATA_H
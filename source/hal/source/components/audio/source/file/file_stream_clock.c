@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hal_audio_file.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NANOSECONDS_IN_SECOND   (1000000000ULL)
+
+#if !defined(HAL_FILE_STREAM_REALTIME)
+#define HAL_FILE_STREAM_REALTIME (0)
+#endif /* HAL_FILE_STREAM_REALTIME */
+
+bool hal_file_stream_realtime(void)
+{
+    const char* env = getenv(HAL_FILE_STREAM_REALTIME_ENV);
+    if (env && env[0] != '\0') {
+        return atoi(env) != 0;
+    }
+    return HAL_FILE_STREAM_REALTIME != 0;
+}
+
+uint64_t hal_file_stream_time_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * NANOSECONDS_IN_SECOND + (uint64_t)now.tv_nsec;
+}
+
+void hal_file_stream_sleep_until(uint64_t deadline_ns)
+{
+    struct timespec deadline;
+    deadline.tv_sec = (time_t)(deadline_ns / NANOSECONDS_IN_SECOND);
+    deadline.tv_nsec = (long)(deadline_ns % NANOSECONDS_IN_SECOND);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+        /* Interrupted by a signal; keep waiting. */
+    }
+}
@@ -0,0 +1,322 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hal_audio.h"
+#include "hal_audio_file.h"
+#include "log_macros.h"
+#include "wav_reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(HAL_AUDIO_FILE_PATH)
+#define HAL_AUDIO_FILE_PATH ""
+#endif /* HAL_AUDIO_FILE_PATH */
+
+#if !defined(HAL_AUDIO_FILE_CHUNK_MS)
+#define HAL_AUDIO_FILE_CHUNK_MS (500)
+#endif /* HAL_AUDIO_FILE_CHUNK_MS */
+
+/* Number of chunks the emulated device can hold before it starts dropping data. */
+#define HAL_AUDIO_FILE_DEVICE_CHUNKS (2)
+
+typedef struct hal_audio_device_ {
+    char name[32];
+    hal_audio_format format;
+    hal_audio_mode mode;
+    hal_audio_status status;
+    wav_reader reader;
+    int16_t* buffer;            /* Buffer handed back to the caller. */
+    uint32_t buffer_elements;   /* Capacity of the buffer in samples. */
+    bool own_buffer;            /* Buffer was allocated by this device. */
+    uint32_t chunk_frames;      /* Frames returned per call in continuous mode. */
+    uint64_t stream_pos;        /* Frames consumed since start, including loops. */
+    uint64_t start_ns;          /* Time stamp at which the device was started. */
+    bool realtime;
+    hal_audio_file_stats stats;
+} hal_audio_dev;
+
+static hal_audio_dev dev;
+
+static void hal_audio_free_buffer(void)
+{
+    if (dev.own_buffer) {
+        free(dev.buffer);
+    }
+    dev.buffer = NULL;
+    dev.buffer_elements = 0;
+    dev.own_buffer = false;
+}
+
+static bool hal_audio_alloc_buffer(uint32_t n_elements)
+{
+    if (dev.buffer && dev.buffer_elements >= n_elements) {
+        return true;
+    }
+    hal_audio_free_buffer();
+    dev.buffer = (int16_t*)malloc(n_elements * sizeof(int16_t));
+    if (!dev.buffer) {
+        printf_err("Failed to allocate audio buffer\n");
+        return false;
+    }
+    dev.buffer_elements = n_elements;
+    dev.own_buffer = true;
+    return true;
+}
+
+static void hal_audio_reset(void)
+{
+    wav_reader_close(&dev.reader);
+    hal_audio_free_buffer();
+    memset(&dev.stats, 0, sizeof(dev.stats));
+    dev.status = HAL_AUDIO_STATUS_INVALID;
+    strncpy(dev.name, "WAV file stream", sizeof(dev.name));
+    dev.format = HAL_AUDIO_FORMAT_INVALID;
+    dev.mode = HAL_AUDIO_MODE_INVALID;
+    dev.chunk_frames = 0;
+    dev.stream_pos = 0;
+}
+
+static const char* hal_audio_file_path(void)
+{
+    const char* path = getenv(HAL_AUDIO_FILE_ENV);
+    if (path && path[0] != '\0') {
+        return path;
+    }
+    return HAL_AUDIO_FILE_PATH;
+}
+
+static void hal_audio_print_stats(void)
+{
+    info("Audio stream: %" PRIu64 " buffers, %" PRIu64 " samples delivered, "
+         "%" PRIu64 " samples dropped in %" PRIu32 " overruns, %" PRIu32 " waits, "
+         "%" PRIu32 " loops\n",
+         dev.stats.buffers_delivered, dev.stats.samples_delivered,
+         dev.stats.samples_dropped, dev.stats.overruns, dev.stats.waits,
+         dev.stats.loops);
+}
+
+bool hal_audio_init(void)
+{
+    hal_audio_reset();
+    const char* path = hal_audio_file_path();
+    info("Initialising audio interface: %s (%s)\n", dev.name, path);
+    if (path[0] == '\0') {
+        printf_err("No audio file given; set %s\n", HAL_AUDIO_FILE_ENV);
+        return false;
+    }
+    return wav_reader_open(&dev.reader, path);
+}
+
+bool hal_audio_configure(const hal_audio_mode mode,
+                         const hal_audio_format stream_format)
+{
+    if (!(HAL_AUDIO_STATUS_INVALID == dev.status || HAL_AUDIO_STATUS_STOPPED == dev.status)) {
+        return false;
+    }
+
+    if (!dev.reader.file) {
+        printf_err("Audio file not open\n");
+        return false;
+    }
+
+    const uint32_t n_channels = GET_AUDIO_NUM_CHANNELS(stream_format);
+    if (GET_AUDIO_SAMPLING_RATE(stream_format) != dev.reader.sampling_rate ||
+        (n_channels != 1 && n_channels != dev.reader.num_channels)) {
+        printf_err("Unsupported audio format\n");
+        return false;
+    }
+
+    dev.mode = mode;
+    dev.format = stream_format;
+    dev.status = HAL_AUDIO_STATUS_STOPPED;
+    dev.realtime = hal_file_stream_realtime();
+    if (!dev.chunk_frames) {
+        dev.chunk_frames = (dev.reader.sampling_rate * HAL_AUDIO_FILE_CHUNK_MS) / 1000;
+    }
+    return true;
+}
+
+bool hal_audio_set_buffer(uint8_t* buffer, const uint32_t size)
+{
+    const uint32_t n_channels = GET_AUDIO_NUM_CHANNELS(dev.format);
+    if (HAL_AUDIO_STATUS_RUNNING == dev.status || !buffer || !n_channels ||
+        size < n_channels * sizeof(int16_t)) {
+        return false;
+    }
+
+    hal_audio_free_buffer();
+    dev.buffer = (int16_t*)buffer;
+    dev.buffer_elements = size / sizeof(int16_t);
+    dev.chunk_frames = dev.buffer_elements / n_channels;
+    return true;
+}
+
+bool hal_audio_start(void)
+{
+    if (dev.status == HAL_AUDIO_STATUS_STOPPED) {
+        memset(&dev.stats, 0, sizeof(dev.stats));
+        dev.stream_pos = 0;
+        wav_reader_seek(&dev.reader, 0);
+        dev.start_ns = hal_file_stream_time_ns();
+        dev.status = HAL_AUDIO_STATUS_RUNNING;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief   Reads frames into the device buffer, wrapping around the
+ *          end of the file if looping is enabled.
+ */
+static uint32_t hal_audio_read_frames(uint32_t n_frames)
+{
+    const uint32_t n_channels = GET_AUDIO_NUM_CHANNELS(dev.format);
+    uint32_t total = 0;
+
+    while (total < n_frames) {
+        int16_t* dst = dev.buffer + total * n_channels;
+        const uint32_t n_read = (n_channels == 1) ?
+            wav_reader_read_mono(&dev.reader, dst, n_frames - total) :
+            wav_reader_read_interleaved(&dev.reader, dst, n_frames - total);
+        total += n_read;
+
+        if (dev.reader.position >= dev.reader.total_frames) {
+#if defined(HAL_AUDIO_LOOP)
+            wav_reader_seek(&dev.reader, 0);
+            ++dev.stats.loops;
+#else
+            break;
+#endif /* HAL_AUDIO_LOOP */
+        } else if (n_read == 0) {
+            printf_err("Failed to read audio frames: %s\n",
+                       ferror(dev.reader.file) ? "read error" : "file truncated");
+            break;
+        }
+    }
+    dev.stream_pos += total;
+    return total;
+}
+
+/**
+ * @brief   Emulates a device that keeps capturing while the consumer is
+ *          busy: waits for the next chunk to become available and skips
+ *          data the device would have overwritten.
+ */
+static void hal_audio_pace(void)
+{
+    const uint64_t rate = dev.reader.sampling_rate;
+    const uint64_t chunk_end = dev.stream_pos + dev.chunk_frames;
+    const uint64_t elapsed_frames =
+        ((hal_file_stream_time_ns() - dev.start_ns) * rate) / 1000000000ULL;
+
+    if (elapsed_frames < chunk_end) {
+        ++dev.stats.waits;
+        hal_file_stream_sleep_until(dev.start_ns + (chunk_end * 1000000000ULL) / rate);
+        return;
+    }
+
+    const uint64_t capacity = (uint64_t)dev.chunk_frames * HAL_AUDIO_FILE_DEVICE_CHUNKS;
+    if (elapsed_frames > dev.stream_pos + capacity) {
+        /* Drop whole chunks so that the stream stays aligned to chunk boundaries. */
+        const uint64_t behind = elapsed_frames - (dev.stream_pos + capacity);
+        const uint64_t dropped = ((behind + dev.chunk_frames - 1) / dev.chunk_frames) * dev.chunk_frames;
+        uint64_t target = dev.stream_pos + dropped;
+        const uint64_t total = dev.reader.total_frames;
+
+#if defined(HAL_AUDIO_LOOP)
+        dev.stats.loops += (uint32_t)(target / total - dev.stream_pos / total);
+        wav_reader_seek(&dev.reader, (uint32_t)(target % total));
+#else
+        if (target > total) {
+            target = total;
+        }
+        wav_reader_seek(&dev.reader, (uint32_t)target);
+#endif /* HAL_AUDIO_LOOP */
+        dev.stats.samples_dropped += target - dev.stream_pos;
+        ++dev.stats.overruns;
+        dev.stream_pos = target;
+    }
+}
+
+const int16_t* hal_audio_get_captured_frame(uint32_t* n_elements)
+{
+    const uint32_t n_channels = GET_AUDIO_NUM_CHANNELS(dev.format);
+    uint32_t n_frames = dev.chunk_frames;
+    *n_elements = 0;
+
+    if (dev.status != HAL_AUDIO_STATUS_RUNNING) {
+        return NULL;
+    }
+
+    if (dev.mode == HAL_AUDIO_MODE_SINGLE_BURST) {
+        /* Single burst hands over the whole clip, like the static sample device. */
+        n_frames = dev.reader.total_frames;
+        wav_reader_seek(&dev.reader, 0);
+        dev.stream_pos = 0;
+    } else if (dev.realtime) {
+        hal_audio_pace();
+    }
+
+    if (!hal_audio_alloc_buffer(n_frames * n_channels)) {
+        dev.status = HAL_AUDIO_STATUS_ERROR;
+        return NULL;
+    }
+
+    const uint32_t n_read = hal_audio_read_frames(n_frames);
+    if (n_read == 0 || dev.mode == HAL_AUDIO_MODE_SINGLE_BURST) {
+        dev.status = HAL_AUDIO_STATUS_STOPPED;
+    }
+    if (n_read == 0) {
+        hal_audio_print_stats();
+        return NULL;
+    }
+
+    ++dev.stats.buffers_delivered;
+    dev.stats.samples_delivered += n_read;
+    *n_elements = n_read * n_channels;
+    return dev.buffer;
+}
+
+bool hal_audio_stop(void)
+{
+    if (dev.status == HAL_AUDIO_STATUS_RUNNING) {
+        dev.status = HAL_AUDIO_STATUS_STOPPED;
+        hal_audio_print_stats();
+    }
+    return true;
+}
+
+hal_audio_status hal_audio_get_status(void)
+{
+    return dev.status;
+}
+
+void hal_audio_release(void)
+{
+    hal_audio_reset();
+}
+
+const char* hal_audio_get_device_name(void)
+{
+    return dev.name;
+}
+
+void hal_audio_file_get_stats(hal_audio_file_stats* stats)
+{
+    *stats = dev.stats;
+}
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HAL_AUDIO_FILE_H
+#define HAL_AUDIO_FILE_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // defined(__cplusplus)
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**< Environment variable overriding the WAV file to stream from. */
+#define HAL_AUDIO_FILE_ENV          "MLEK_AUDIO_FILE"
+
+/**< Environment variable overriding the real-time pacing (0 or 1). */
+#define HAL_FILE_STREAM_REALTIME_ENV "MLEK_HAL_FILE_REALTIME"
+
+/**< Streaming statistics for the file backed audio devices. */
+typedef struct hal_audio_file_stats_ {
+    uint64_t buffers_delivered;     /* Number of buffers handed to the consumer. */
+    uint64_t samples_delivered;     /* Number of samples handed to the consumer. */
+    uint64_t samples_dropped;       /* Samples lost because the consumer fell behind (real-time only). */
+    uint32_t overruns;              /* Number of times samples were dropped. */
+    uint32_t waits;                 /* Number of times the consumer had to wait for data (real-time only). */
+    uint32_t loops;                 /* Number of times the file was rewound. */
+} hal_audio_file_stats;
+
+/**
+ * @brief   Gets the statistics for the hal_audio_* file stream.
+ * @param[out]  stats   Statistics collected since the device was started.
+ */
+void hal_audio_file_get_stats(hal_audio_file_stats* stats);
+
+/**
+ * @brief   Gets the statistics for the hal_get_audio_data file stream.
+ * @param[out]  stats   Statistics collected since the device was initialised.
+ */
+void audio_file_get_stats(hal_audio_file_stats* stats);
+
+/**
+ * @brief   Resolves whether file streams should be paced in real time.
+ * @return  true for real-time pacing, false for as-fast-as-possible.
+ */
+bool hal_file_stream_realtime(void);
+
+/**
+ * @brief   Gets a monotonic time stamp.
+ * @return  Time in nanoseconds.
+ */
+uint64_t hal_file_stream_time_ns(void);
+
+/**
+ * @brief   Sleeps until the given monotonic time stamp.
+ * @param[in]   deadline_ns     Time to wait for, in nanoseconds.
+ */
+void hal_file_stream_sleep_until(uint64_t deadline_ns);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+#endif /* HAL_AUDIO_FILE_H */
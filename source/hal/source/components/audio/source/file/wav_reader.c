@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "wav_reader.h"
+#include "log_macros.h"
+
+#include <string.h>
+
+#define WAV_FORMAT_PCM          (1)
+#define WAV_FORMAT_EXTENSIBLE   (0xFFFE)
+#define WAV_READ_CHUNK_FRAMES   (256)
+
+static uint32_t read_le32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool wav_reader_open(wav_reader* reader, const char* path)
+{
+    uint8_t header[12];
+    bool fmt_found = false;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->file = fopen(path, "rb");
+    if (!reader->file) {
+        printf_err("Failed to open %s\n", path);
+        return false;
+    }
+
+    if (fread(header, 1, sizeof(header), reader->file) != sizeof(header) ||
+        memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        printf_err("%s is not a RIFF/WAVE file\n", path);
+        wav_reader_close(reader);
+        return false;
+    }
+
+    /* Walk the chunk list until we get to the data chunk. */
+    for (;;) {
+        uint8_t chunk[8];
+        if (fread(chunk, 1, sizeof(chunk), reader->file) != sizeof(chunk)) {
+            printf_err("No data chunk found in %s\n", path);
+            wav_reader_close(reader);
+            return false;
+        }
+        const uint32_t chunk_size = read_le32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (chunk_size < sizeof(fmt) ||
+                fread(fmt, 1, sizeof(fmt), reader->file) != sizeof(fmt)) {
+                break;
+            }
+            const uint16_t format = read_le16(fmt);
+            const uint16_t bits = read_le16(fmt + 14);
+            reader->num_channels = read_le16(fmt + 2);
+            reader->sampling_rate = read_le32(fmt + 4);
+            if ((format != WAV_FORMAT_PCM && format != WAV_FORMAT_EXTENSIBLE) || bits != 16 ||
+                reader->num_channels == 0) {
+                printf_err("%s: only 16-bit PCM is supported\n", path);
+                break;
+            }
+            fmt_found = true;
+            /* Skip the remainder of the chunk (chunks are word aligned). */
+            fseek(reader->file, (long)(chunk_size - sizeof(fmt) + (chunk_size & 1)), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!fmt_found) {
+                break;
+            }
+            reader->data_offset = ftell(reader->file);
+            reader->total_frames = chunk_size / (reader->num_channels * sizeof(int16_t));
+            reader->position = 0;
+            if (reader->total_frames == 0) {
+                /* Nothing to stream, and looping over it would never end. */
+                printf_err("%s has no audio data\n", path);
+                wav_reader_close(reader);
+                return false;
+            }
+            return true;
+        } else {
+            fseek(reader->file, (long)(chunk_size + (chunk_size & 1)), SEEK_CUR);
+        }
+    }
+
+    printf_err("Malformed WAV file %s\n", path);
+    wav_reader_close(reader);
+    return false;
+}
+
+void wav_reader_close(wav_reader* reader)
+{
+    if (reader->file) {
+        fclose(reader->file);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+bool wav_reader_seek(wav_reader* reader, uint32_t frame)
+{
+    if (!reader->file) {
+        return false;
+    }
+    if (frame > reader->total_frames) {
+        frame = reader->total_frames;
+    }
+    const long offset = reader->data_offset +
+                        (long)frame * (long)(reader->num_channels * sizeof(int16_t));
+    if (fseek(reader->file, offset, SEEK_SET) != 0) {
+        return false;
+    }
+    reader->position = frame;
+    return true;
+}
+
+uint32_t wav_reader_read_interleaved(wav_reader* reader, int16_t* dst, uint32_t n_frames)
+{
+    if (!reader->file) {
+        return 0;
+    }
+    const uint32_t remaining = reader->total_frames - reader->position;
+    if (n_frames > remaining) {
+        n_frames = remaining;
+    }
+    const size_t n_read = fread(dst, sizeof(int16_t) * reader->num_channels,
+                                n_frames, reader->file);
+    reader->position += (uint32_t)n_read;
+    return (uint32_t)n_read;
+}
+
+uint32_t wav_reader_read_mono(wav_reader* reader, int16_t* dst, uint32_t n_samples)
+{
+    if (reader->num_channels == 1) {
+        return wav_reader_read_interleaved(reader, dst, n_samples);
+    }
+
+    int16_t chunk[WAV_READ_CHUNK_FRAMES * 8];
+    const uint32_t chunk_frames = sizeof(chunk) / sizeof(chunk[0]) / reader->num_channels;
+    uint32_t total = 0;
+
+    if (reader->num_channels > 8) {
+        printf_err("Unsupported number of channels: %" PRIu32 "\n", reader->num_channels);
+        return 0;
+    }
+
+    while (total < n_samples) {
+        uint32_t to_read = n_samples - total;
+        if (to_read > chunk_frames) {
+            to_read = chunk_frames;
+        }
+        const uint32_t n_read = wav_reader_read_interleaved(reader, chunk, to_read);
+        for (uint32_t i = 0; i < n_read; ++i) {
+            int32_t sum = 0;
+            for (uint32_t c = 0; c < reader->num_channels; ++c) {
+                sum += chunk[i * reader->num_channels + c];
+            }
+            dst[total + i] = (int16_t)(sum / (int32_t)reader->num_channels);
+        }
+        total += n_read;
+        if (n_read < to_read) {
+            break;
+        }
+    }
+    return total;
+}
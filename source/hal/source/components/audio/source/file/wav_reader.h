@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef WAV_READER_H
+#define WAV_READER_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // defined(__cplusplus)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**< Minimal reader for 16-bit PCM RIFF/WAVE files. */
+typedef struct wav_reader_ {
+    FILE* file;
+    uint32_t sampling_rate;
+    uint32_t num_channels;
+    uint32_t total_frames;      /* Number of (multi-channel) sample frames in the file. */
+    uint32_t position;          /* Current frame position. */
+    long data_offset;           /* Byte offset of the first sample in the file. */
+} wav_reader;
+
+/**
+ * @brief       Opens a WAV file and parses its header.
+ * @param[out]  reader  Reader instance to initialise.
+ * @param[in]   path    Path to the WAV file.
+ * @return      true if the file is a 16-bit PCM WAV file with at least one
+ *              frame of data, false otherwise.
+ */
+bool wav_reader_open(wav_reader* reader, const char* path);
+
+/**
+ * @brief       Closes the reader.
+ * @param[in]   reader  Reader instance.
+ */
+void wav_reader_close(wav_reader* reader);
+
+/**
+ * @brief       Moves the read position to the given frame.
+ * @param[in]   reader  Reader instance.
+ * @param[in]   frame   Frame index to move to (clamped to the end of the file).
+ * @return      true if successful, false otherwise.
+ */
+bool wav_reader_seek(wav_reader* reader, uint32_t frame);
+
+/**
+ * @brief       Reads mono samples from the file, down-mixing multi-channel
+ *              data by averaging the channels.
+ * @param[in]   reader      Reader instance.
+ * @param[out]  dst         Destination for the mono samples.
+ * @param[in]   n_samples   Maximum number of samples to read.
+ * @return      Number of samples read; less than requested at the end of file.
+ */
+uint32_t wav_reader_read_mono(wav_reader* reader, int16_t* dst, uint32_t n_samples);
+
+/**
+ * @brief       Reads interleaved samples without any channel conversion.
+ * @param[in]   reader      Reader instance.
+ * @param[out]  dst         Destination buffer.
+ * @param[in]   n_frames    Maximum number of frames to read.
+ * @return      Number of frames read; less than requested at the end of file.
+ */
+uint32_t wav_reader_read_interleaved(wav_reader* reader, int16_t* dst, uint32_t n_frames);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+#endif /* WAV_READER_H */
@@ -42,4 +42,19 @@ void audio_preprocessing(int16_t *data, int len);
 /* Set fixed microphone gain */
 void set_audio_gain(float gain_db);
 
+/* Statistics of the last buffer run through audio_preprocessing, in q15 units */
+typedef struct audio_stats_ {
+    uint32_t buffers;       /* Number of buffers preprocessed */
+    uint16_t in_absmax;     /* Peak magnitude before gain */
+    int16_t in_mean;        /* Mean before gain */
+    uint16_t out_absmax;    /* Peak magnitude after gain */
+    int16_t out_mean;       /* Mean after gain */
+    float gain;             /* Linear gain applied */
+} audio_stats;
+
+void get_audio_stats(audio_stats *stats);
+
+/* Print the statistics of every preprocessed buffer - off by default */
+void set_audio_stats_logging(bool enable);
+
 #endif // AUDIO_DATA_H
@@ -0,0 +1,36 @@
+/* Copyright (C) 2024 Alif Semiconductor - All Rights Reserved.
+ * Use, distribution and modification of this code is permitted under the
+ * terms stated in the Alif Semiconductor Software License Agreement
+ *
+ * You should have received a copy of the Alif Semiconductor Software
+ * License Agreement with this file. If not, please write to:
+ * contact@alifsemi.com, or visit: https://alifsemi.com/license
+ *
+ */
+
+#ifndef AUDIO_GAIN_H
+#define AUDIO_GAIN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_GAIN_MAX 10000.0f // 80dB
+//#define AUDIO_GAIN_MAX_INC_PER_STRIDE 1.05925373f // 0.5dB, so 1dB per second
+#define AUDIO_GAIN_MAX_INC_PER_STRIDE 1.12201845f // 1dB, so 2dB per second
+
+/* Automatic gain for the next buffer, given the peak magnitude of its input (1.0 is
+ * full scale). Aims for full scale, up to AUDIO_GAIN_MAX. The gain is reduced
+ * immediately if necessary to avoid clipping, but only increased slowly. */
+float audio_gain_auto(float current_gain, float in_absmax);
+
+/* Mean of `len` samples adding up to `sum`; 0 for an empty buffer. */
+int32_t audio_gain_mean(int64_t sum, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_GAIN_H
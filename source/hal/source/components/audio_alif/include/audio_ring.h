@@ -0,0 +1,66 @@
+/* Copyright (C) 2024 Alif Semiconductor - All Rights Reserved.
+ * Use, distribution and modification of this code is permitted under the
+ * terms stated in the Alif Semiconductor Software License Agreement
+ *
+ * You should have received a copy of the Alif Semiconductor Software
+ * License Agreement with this file. If not, please write to:
+ * contact@alifsemi.com, or visit: https://alifsemi.com/license
+ *
+ */
+
+#ifndef AUDIO_RING_H
+#define AUDIO_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Circular audio buffer fed by get_audio_data().
+ *
+ * The buffer is divided into slots of one stride each. The microphone fills
+ * one slot while the application reads a window made of the most recently
+ * completed slots, so that no audio has to be moved between inferences.
+ */
+typedef struct audio_ring_ {
+    int16_t *buffer;
+    int slot_len;           /* Samples per slot. */
+    int n_slots;
+    uint32_t filled;        /* Slots completed since init; filled % n_slots is being captured. */
+    bool capturing;
+    uint64_t capture_start; /* Trace time the slot being captured started. */
+} audio_ring;
+
+/**
+ * Window of audio in the ring. When the window wraps around the end of the
+ * buffer, it continues at `second`.
+ */
+typedef struct audio_ring_window_ {
+    const int16_t *first;
+    int first_len;
+    const int16_t *second;  /* NULL if the window does not wrap. */
+    int second_len;
+} audio_ring_window;
+
+/* Sets up a ring over `buffer`, which must hold slot_len * n_slots samples. Buffer is cleared. */
+int audio_ring_init(audio_ring *ring, int16_t *buffer, int slot_len, int n_slots);
+
+/* Starts capturing into the next slot, if not already capturing. */
+int audio_ring_start(audio_ring *ring);
+
+/* Waits for the slot being captured, starts capturing into the next one and then
+ * runs audio_preprocessing() on the completed slot. Returns error indication - 0 for success */
+int audio_ring_wait(audio_ring *ring);
+
+/* Gets the latest `len` samples, ending with the last completed slot. The window may not
+ * overlap the slot being captured, so len must not exceed (n_slots - 1) * slot_len. */
+bool audio_ring_get_window(const audio_ring *ring, int len, audio_ring_window *window);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_RING_H
@@ -21,6 +21,8 @@
 #endif
 
 #include "audio_data.h"
+#include "audio_gain.h"
+#include "log_macros.h"
 #include "mic_listener.h"
 #include "platform_drivers.h"
 
@@ -52,9 +54,6 @@ static int32_t srshr(int32_t n, unsigned shift)
 
 #define AUDIO_MICS  AUDIO_LR_MIX
 
-#define MAX_GAIN 10000.0f // 80dB
-//#define MAX_GAIN_INC_PER_STRIDE 1.05925373f // 0.5dB, so 1dB per second
-#define MAX_GAIN_INC_PER_STRIDE 1.12201845f // 1dB, so 2dB per second
 
 // Define with number of raw samples to store, for debugging
 //#define STORE_AUDIO (16000*10)
@@ -86,7 +85,7 @@ static audio_callback_t user_audio_callback =  NULL;
 static int audio_current_rec_buf;
 
 static int32_t current_dc = 0;
-static float current_gain = MAX_GAIN;
+static float current_gain = AUDIO_GAIN_MAX;
 static bool auto_gain = true;
 
 static int16_t * restrict user_ptr;
@@ -94,6 +93,19 @@ static int user_length;
 static atomic_int audio_received;
 static atomic_int audio_async_error;
 
+// Input statistics of the transfer in progress, gathered while copying from the record buffer,
+// and of the last completed transfer. Values are in audio_rec_t units after DC removal.
+#define AUDIO_REC_TO_Q15_SHIFT (AUDIO_REC_WIDTH - 16)
+static uint32_t rec_absmax;
+static int64_t rec_sum;
+static const int16_t *completed_ptr;
+static int completed_len;
+static uint32_t completed_absmax;
+static int64_t completed_sum;
+
+static audio_stats preproc_stats;
+static bool stats_logging = false;
+
 
 static void audio_start_next_rx(int data_to_go)
 {
@@ -118,6 +130,7 @@ static void copy_audio_rec_to_in(float16_t * __RESTRICT in, const audio_rec_t *
 #else
     int32_t sum = 0;
 #endif
+    uint32_t absmax = 0;
     int samples_to_go = len;
 #if ENABLE_MVE_COPY_AUDIO_REC_TO_IN
     while (samples_to_go >= 8) {
@@ -146,6 +159,9 @@ static void copy_audio_rec_to_in(float16_t * __RESTRICT in, const audio_rec_t *
         // when converting to float16)
         mono.val[0] = vqsubq(mono.val[0], offset);
         mono.val[1] = vqsubq(mono.val[1], offset);
+        // Track the peak for the gain control
+        absmax = vmaxavq(absmax, mono.val[0]);
+        absmax = vmaxavq(absmax, mono.val[1]);
         // Convert to float32, in range -1,+1, so as not to overflow float16
         float32x4x2_t mono_f32 = { vcvtq_n(mono.val[0], 31), vcvtq_n(mono.val[1], 31) };
         // Convert to float16 and pack
@@ -170,6 +186,8 @@ static void copy_audio_rec_to_in(float16_t * __RESTRICT in, const audio_rec_t *
         // Subtract the current DC offset (necessary to not lose accuracy
         // when converting to float16)
         mono = vqsubq(mono, offset);
+        // Track the peak for the gain control
+        absmax = vmaxavq((uint16_t) absmax, mono);
         // Convert to float16, in range -1,+1
         float16x8_t mono_f16 = vcvtq_n(mono, 15);
 #endif // AUDIO_REC_WIDTH
@@ -196,6 +214,11 @@ static void copy_audio_rec_to_in(float16_t * __RESTRICT in, const audio_rec_t *
         // Subtract the current DC offset (necessary to not lose accuracy
         // when converting to float16)
         mono = __QSUB(mono, offset);
+        // Track the peak for the gain control
+        uint32_t mono_abs = mono < 0 ? -(uint32_t) mono : (uint32_t) mono;
+        if (mono_abs > absmax) {
+            absmax = mono_abs;
+        }
         // Convert to float32, in range -1,+1, so as not to overflow float16
 #if AUDIO_REC_WIDTH == 32
         float mono_f32 = mono * 0x1p-31f;
@@ -207,6 +230,11 @@ static void copy_audio_rec_to_in(float16_t * __RESTRICT in, const audio_rec_t *
         input += 2;
         samples_to_go -= 1;
     }
+    // Accumulate statistics of the transfer, as seen after DC removal
+    if (absmax > rec_absmax) {
+        rec_absmax = absmax;
+    }
+    rec_sum += sum - (int64_t) offset * len;
     // Update the DC offset based on the mean of this buffer
     int32_t mean = (int32_t) (sum / len);
     current_dc = (current_dc / 8) * 7 + mean / 8;
@@ -231,6 +259,12 @@ static void voice_data_cb(uint32_t event)
     }
 #endif
     copy_audio_rec_to_in((float16_t *) user_ptr + audio_received, audio_rec[!audio_current_rec_buf], samples);
+    if (new_total >= user_length) {
+        completed_ptr = user_ptr;
+        completed_len = user_length;
+        completed_absmax = rec_absmax;
+        completed_sum = rec_sum;
+    }
     audio_received = new_total;
     if (audio_received >= user_length || audio_async_error) {
         if (user_audio_callback) {
@@ -276,6 +310,8 @@ int get_audio_data(int16_t *data, int len)
 {
     user_ptr = data;
     user_length = len;
+    rec_absmax = 0;
+    rec_sum = 0;
     audio_received = 0;
     audio_async_error = 0;
     audio_start_next_rx(user_length);
@@ -286,13 +322,21 @@ int get_audio_data(int16_t *data, int len)
 int wait_for_audio(void)
 {
     while (audio_received < user_length && audio_async_error == 0) {
+        // Output pending log messages while the microphone fills the buffer
+        if (log_drain_one() != 0) {
+            continue;
+        }
         __WFE();
     }
     return audio_async_error;
 }
 
-static void convert_to_s16_from_f16_with_gain(void *ptr, int length, float16_t gain)
+// Applies the gain and converts back to int16_t in place, measuring the result on the way
+static void convert_to_s16_from_f16_with_gain(void *ptr, int length, float16_t gain,
+                                              uint16_t *out_absmax, int64_t *out_sum)
 {
+    uint16_t absmax = 0;
+    int64_t sum = 0;
     while (length > 0) {
 #if __ARM_FEATURE_MVE & 2
         // Check whether we're doing 8 or fewer
@@ -303,6 +347,9 @@ static void convert_to_s16_from_f16_with_gain(void *ptr, int length, float16_t g
         fp = vmulq_x(fp, gain, p);
         // Convert back to int16_t, rescaling for q15 (can't specify rounding with rescale)
         int16x8_t data = vcvtq_x_n_s16_f16(fp, 15, p);
+        // Measure the output
+        absmax = vmaxavq_p(absmax, data, p);
+        sum += vaddvq_p(data, p);
         // Store back up to 8 samples
         vst1q_p_s16(ptr, data, p);
         ptr = (int16_t *) ptr + 8;
@@ -310,12 +357,21 @@ static void convert_to_s16_from_f16_with_gain(void *ptr, int length, float16_t g
 #else
         float16_t fp = *(float16_t *) ptr;
         fp *= gain;
-        int16_t data = (int16_t) (fp * 0x1p15f);
+        float scaled = (float) fp * 0x1p15f;
+        // Saturate as the vector conversion does
+        int16_t data = scaled >= INT16_MAX ? INT16_MAX : scaled <= INT16_MIN ? INT16_MIN : (int16_t) scaled;
+        uint16_t data_abs = data < 0 ? (uint16_t) -(int32_t) data : (uint16_t) data;
+        if (data_abs > absmax) {
+            absmax = data_abs;
+        }
+        sum += data;
         *(int16_t *) ptr = data;
         ptr = (int16_t *) ptr + 1;
         length -= 1;
 #endif
     }
+    *out_absmax = absmax;
+    *out_sum = sum;
 }
 
 
@@ -332,29 +388,54 @@ void set_audio_gain(float gain_db)
 
 /* Reads the input in float16 format
  * Adjusts gain up or down, attempting to get full-scale input
- * Applies
+ * Applies the gain while converting to int16_t
+ *
+ * Input statistics of a buffer filled by get_audio_data are gathered while
+ * it is received, so the data is only passed over once here.
  */
 void audio_preprocessing(int16_t *audio, int samples)
 {
     float16_t *audio_fp = (float16_t *) audio;
-    float16_t audio_mean, audio_absmax;
+    float16_t audio_absmax;
 
-    arm_mean_f16(audio_fp, samples, &audio_mean);
-    arm_absmax_no_idx_f16(audio_fp, samples, &audio_absmax);
-    //if (audio_absmax == INT16_MIN) audio_absmax = INT16_MAX; // CMSIS-DSP issue #66
-    printf("Original sample stats: absmax = %ld, mean = %ld\n", lround(32768*audio_absmax), lround(32768*audio_mean));
+    if (audio == completed_ptr && samples == completed_len) {
+        audio_absmax = (float16_t) ((float) completed_absmax * (1.0f / (1U << (AUDIO_REC_WIDTH - 1))));
+        uint32_t in_absmax_q15 = completed_absmax >> AUDIO_REC_TO_Q15_SHIFT;
+        preproc_stats.in_absmax = in_absmax_q15 > 0x8000 ? 0x8000 : (uint16_t) in_absmax_q15;
+        preproc_stats.in_mean = (int16_t) (audio_gain_mean(completed_sum, samples) >> AUDIO_REC_TO_Q15_SHIFT);
+    } else {
+        // Not a buffer we captured - measure it
+        float16_t audio_mean;
+        arm_mean_f16(audio_fp, samples, &audio_mean);
+        arm_absmax_no_idx_f16(audio_fp, samples, &audio_absmax);
+        preproc_stats.in_absmax = (uint16_t) lroundf(32768 * (float) audio_absmax);
+        preproc_stats.in_mean = (int16_t) lroundf(32768 * (float) audio_mean);
+    }
 
     if (auto_gain) {
-        // Rescale to full range  while converting to integer
-        float new_gain = fmin(1.0f / audio_absmax, MAX_GAIN);
-        // Reduce gain immediately if necessary to avoid clipping, or increase slowly
-        current_gain = fmin(new_gain, current_gain * MAX_GAIN_INC_PER_STRIDE);
+        // Rescale to full range while converting to integer
+        current_gain = audio_gain_auto(current_gain, (float) audio_absmax);
     }
-    convert_to_s16_from_f16_with_gain(audio, samples, current_gain);
 
-    q15_t audio_mean_q15, audio_absmax_q15;
-    arm_mean_q15(audio, samples, &audio_mean_q15);
-    arm_absmax_no_idx_q15(audio, samples, &audio_absmax_q15);
-    if (audio_absmax_q15 == INT16_MIN) audio_absmax_q15 = INT16_MAX; // CMSIS-DSP issue #66
-    printf("Normalized sample stats: absmax = %d, mean = %d (gain = %.0f dB)\n", audio_absmax_q15, audio_mean_q15, 20 * log10f(current_gain) );
+    int64_t out_sum;
+    convert_to_s16_from_f16_with_gain(audio, samples, current_gain, &preproc_stats.out_absmax, &out_sum);
+    preproc_stats.out_mean = (int16_t) audio_gain_mean(out_sum, samples);
+    preproc_stats.gain = current_gain;
+    preproc_stats.buffers++;
+
+    if (stats_logging) {
+        info("Original sample stats: absmax = %u, mean = %d\n", preproc_stats.in_absmax, preproc_stats.in_mean);
+        info("Normalized sample stats: absmax = %u, mean = %d (gain = %.0f dB)\n",
+             preproc_stats.out_absmax, preproc_stats.out_mean, 20 * log10f(current_gain));
+    }
+}
+
+void get_audio_stats(audio_stats *stats)
+{
+    *stats = preproc_stats;
+}
+
+void set_audio_stats_logging(bool enable)
+{
+    stats_logging = enable;
 }
@@ -0,0 +1,256 @@
+/* Copyright (C) 2022-2024 Alif Semiconductor - All Rights Reserved.
+ * Use, distribution and modification of this code is permitted under the
+ * terms stated in the Alif Semiconductor Software License Agreement
+ *
+ * You should have received a copy of the Alif Semiconductor Software
+ * License Agreement with this file. If not, please write to:
+ * contact@alifsemi.com, or visit: https://alifsemi.com/license
+ *
+ */
+
+/* Native implementation of the audio_data.h API streaming from a WAV file.
+ * Transfers complete at the file's sampling rate when real-time pacing is
+ * enabled, or immediately otherwise. Samples arriving while no transfer is
+ * pending are dropped, as they would be with the microphone driver. */
+
+#include "audio_data.h"
+#include "audio_gain.h"
+#include "hal_audio_file.h"
+#include "log_macros.h"
+#include "wav_reader.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(HAL_AUDIO_FILE_PATH)
+#define HAL_AUDIO_FILE_PATH ""
+#endif /* HAL_AUDIO_FILE_PATH */
+
+static wav_reader reader;
+static bool realtime;
+static uint64_t start_ns;
+static uint64_t stream_pos;         /* Frames delivered or dropped since init. */
+static int16_t *user_ptr;
+static int user_length;
+static int audio_received;
+static uint64_t transfer_start;     /* Stream position of the pending transfer. */
+static audio_callback_t user_audio_callback = NULL;
+static float fixed_gain = NAN;
+static hal_audio_file_stats stats;
+static audio_stats preproc_stats;
+static bool stats_logging = false;
+
+static uint64_t elapsed_frames(void)
+{
+    return ((hal_file_stream_time_ns() - start_ns) * reader.sampling_rate) / 1000000000ULL;
+}
+
+/* Returns the number of samples read, or -1 if the file could not be read. */
+static int read_samples(int16_t *dst, int len)
+{
+    int total = 0;
+    while (total < len) {
+        const uint32_t n_read = wav_reader_read_mono(&reader, dst + total, (uint32_t)(len - total));
+        if (n_read == 0 && reader.position < reader.total_frames) {
+            printf_err("Failed to read audio samples: %s\n",
+                       ferror(reader.file) ? "read error" : "file truncated");
+            return -1;
+        }
+        total += (int) n_read;
+        if (reader.position >= reader.total_frames) {
+#if defined(HAL_AUDIO_LOOP)
+            wav_reader_seek(&reader, 0);
+            ++stats.loops;
+#else
+            break;
+#endif /* HAL_AUDIO_LOOP */
+        }
+    }
+    return total;
+}
+
+static void skip_samples(uint64_t n)
+{
+    const uint64_t target = reader.position + n;
+#if defined(HAL_AUDIO_LOOP)
+    stats.loops += (uint32_t)(target / reader.total_frames);
+    wav_reader_seek(&reader, (uint32_t)(target % reader.total_frames));
+#else
+    wav_reader_seek(&reader, target > reader.total_frames ? reader.total_frames : (uint32_t)target);
+#endif /* HAL_AUDIO_LOOP */
+}
+
+void audio_set_callback(audio_callback_t callback)
+{
+    user_audio_callback = callback;
+}
+
+int audio_init(int sampling_rate)
+{
+    const char *path = getenv(HAL_AUDIO_FILE_ENV);
+    if (!path || path[0] == '\0') {
+        path = HAL_AUDIO_FILE_PATH;
+    }
+    if (!wav_reader_open(&reader, path)) {
+        return -1;
+    }
+    if (reader.sampling_rate != (uint32_t) sampling_rate) {
+        printf_err("%s: sampling rate %" PRIu32 " does not match %d\n",
+                   path, reader.sampling_rate, sampling_rate);
+        wav_reader_close(&reader);
+        return -1;
+    }
+    info("Streaming audio from %s\n", path);
+    memset(&stats, 0, sizeof(stats));
+    realtime = hal_file_stream_realtime();
+    start_ns = hal_file_stream_time_ns();
+    stream_pos = 0;
+    user_length = 0;
+    audio_received = 0;
+    return 0;
+}
+
+int audio_uninit()
+{
+    info("Audio stream: %" PRIu64 " buffers, %" PRIu64 " samples delivered, "
+         "%" PRIu64 " samples dropped in %" PRIu32 " overruns, %" PRIu32 " waits, "
+         "%" PRIu32 " loops\n",
+         stats.buffers_delivered, stats.samples_delivered,
+         stats.samples_dropped, stats.overruns, stats.waits, stats.loops);
+    wav_reader_close(&reader);
+    return 0;
+}
+
+int get_audio_samples_received(void)
+{
+    if (realtime && audio_received < user_length) {
+        const uint64_t now = elapsed_frames();
+        const uint64_t avail = now > transfer_start ? now - transfer_start : 0;
+        return avail < (uint64_t) user_length ? (int) avail : user_length;
+    }
+    return audio_received;
+}
+
+int get_audio_data(int16_t *data, int len)
+{
+    if (!reader.file) {
+        return -1;
+    }
+    user_ptr = data;
+    user_length = len;
+    audio_received = 0;
+
+    if (realtime) {
+        /* Anything captured since the last transfer finished has been lost. */
+        const uint64_t now = elapsed_frames();
+        if (now > stream_pos) {
+            const uint64_t dropped = now - stream_pos;
+            skip_samples(dropped);
+            stats.samples_dropped += dropped;
+            ++stats.overruns;
+            stream_pos = now;
+        }
+    }
+    transfer_start = stream_pos;
+    return 0;
+}
+
+int wait_for_audio(void)
+{
+    if (!reader.file || !user_ptr) {
+        return -1;
+    }
+    if (audio_received >= user_length) {
+        return 0;
+    }
+
+    if (realtime) {
+        const uint64_t end = transfer_start + (uint64_t) user_length;
+        if (elapsed_frames() < end) {
+            ++stats.waits;
+            hal_file_stream_sleep_until(start_ns + (end * 1000000000ULL) / reader.sampling_rate);
+        }
+    }
+
+    const int n_read = read_samples(user_ptr, user_length);
+    if (n_read < 0) {
+        if (user_audio_callback) {
+            user_audio_callback((uint32_t) n_read);
+        }
+        return n_read;
+    }
+    stream_pos += (uint64_t) n_read;
+    audio_received = n_read;
+    ++stats.buffers_delivered;
+    stats.samples_delivered += (uint64_t) n_read;
+
+    const int err = (n_read < user_length) ? -1 : 0;
+    if (err) {
+        info("End of audio stream\n");
+    }
+    if (user_audio_callback) {
+        user_audio_callback((uint32_t) err);
+    }
+    return err;
+}
+
+void audio_preprocessing(int16_t *data, int len)
+{
+    /* Data is already 16-bit PCM; only a fixed gain needs applying.
+     * Statistics before and after are gathered in the same pass. */
+    const float gain = isnan(fixed_gain) ? 1.0f : fixed_gain;
+    uint16_t in_absmax = 0, out_absmax = 0;
+    int64_t in_sum = 0, out_sum = 0;
+
+    for (int i = 0; i < len; ++i) {
+        const int32_t in = data[i];
+        float v = in * gain;
+        v = v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v);
+        const int32_t out = (int32_t) v;
+        data[i] = (int16_t) out;
+
+        in_sum += in;
+        out_sum += out;
+        if ((uint16_t) abs(in) > in_absmax) {
+            in_absmax = (uint16_t) abs(in);
+        }
+        if ((uint16_t) abs(out) > out_absmax) {
+            out_absmax = (uint16_t) abs(out);
+        }
+    }
+
+    preproc_stats.buffers++;
+    preproc_stats.in_absmax = in_absmax;
+    preproc_stats.in_mean = (int16_t) audio_gain_mean(in_sum, len);
+    preproc_stats.out_absmax = out_absmax;
+    preproc_stats.out_mean = (int16_t) audio_gain_mean(out_sum, len);
+    preproc_stats.gain = gain;
+
+    if (stats_logging) {
+        info("Original sample stats: absmax = %u, mean = %d\n",
+             preproc_stats.in_absmax, preproc_stats.in_mean);
+        info("Normalized sample stats: absmax = %u, mean = %d (gain = %.0f dB)\n",
+             preproc_stats.out_absmax, preproc_stats.out_mean, 20 * log10f(gain));
+    }
+}
+
+void set_audio_gain(float gain_db)
+{
+    fixed_gain = isnan(gain_db) ? NAN : powf(10.0f, gain_db / 20.0f);
+}
+
+void get_audio_stats(audio_stats *out)
+{
+    *out = preproc_stats;
+}
+
+void set_audio_stats_logging(bool enable)
+{
+    stats_logging = enable;
+}
+
+void audio_file_get_stats(hal_audio_file_stats *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,26 @@
+/* Copyright (C) 2024 Alif Semiconductor - All Rights Reserved.
+ * Use, distribution and modification of this code is permitted under the
+ * terms stated in the Alif Semiconductor Software License Agreement
+ *
+ * You should have received a copy of the Alif Semiconductor Software
+ * License Agreement with this file. If not, please write to:
+ * contact@alifsemi.com, or visit: https://alifsemi.com/license
+ *
+ */
+
+#include "audio_gain.h"
+
+#include <math.h>
+
+float audio_gain_auto(float current_gain, float in_absmax)
+{
+    // Rescale to full range; silence gets the maximum gain
+    float new_gain = in_absmax > 0 ? fminf(1.0f / in_absmax, AUDIO_GAIN_MAX) : AUDIO_GAIN_MAX;
+    // Reduce gain immediately if necessary to avoid clipping, or increase slowly
+    return fminf(new_gain, current_gain * AUDIO_GAIN_MAX_INC_PER_STRIDE);
+}
+
+int32_t audio_gain_mean(int64_t sum, int len)
+{
+    return len > 0 ? (int32_t) (sum / len) : 0;
+}
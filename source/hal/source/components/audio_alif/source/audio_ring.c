@@ -0,0 +1,100 @@
+/* Copyright (C) 2024 Alif Semiconductor - All Rights Reserved.
+ * Use, distribution and modification of this code is permitted under the
+ * terms stated in the Alif Semiconductor Software License Agreement
+ *
+ * You should have received a copy of the Alif Semiconductor Software
+ * License Agreement with this file. If not, please write to:
+ * contact@alifsemi.com, or visit: https://alifsemi.com/license
+ *
+ */
+
+#include "audio_ring.h"
+#include "audio_data.h"
+#include "log_trace.h"
+
+#include <string.h>
+
+static int16_t *audio_ring_slot(const audio_ring *ring, uint32_t slot)
+{
+    return ring->buffer + (slot % ring->n_slots) * ring->slot_len;
+}
+
+int audio_ring_init(audio_ring *ring, int16_t *buffer, int slot_len, int n_slots)
+{
+    if (!buffer || slot_len <= 0 || n_slots < 2) {
+        return -1;
+    }
+    ring->buffer = buffer;
+    ring->slot_len = slot_len;
+    ring->n_slots = n_slots;
+    ring->filled = 0;
+    ring->capturing = false;
+    ring->capture_start = 0;
+    memset(buffer, 0, (size_t)slot_len * n_slots * sizeof(int16_t));
+    return 0;
+}
+
+int audio_ring_start(audio_ring *ring)
+{
+    if (ring->capturing) {
+        return 0;
+    }
+#if defined(LOG_TRACE_ENABLED)
+    ring->capture_start = log_trace_now();
+#endif /* defined(LOG_TRACE_ENABLED) */
+    int err = get_audio_data(audio_ring_slot(ring, ring->filled), ring->slot_len);
+    ring->capturing = (err == 0);
+    return err;
+}
+
+int audio_ring_wait(audio_ring *ring)
+{
+    if (!ring->capturing) {
+        return -1;
+    }
+    int err = wait_for_audio();
+    ring->capturing = false;
+    if (err) {
+        return err;
+    }
+#if defined(LOG_TRACE_ENABLED)
+    log_trace_span(LOG_TRACE_TRACK_AUDIO, "stride", ring->capture_start, log_trace_now());
+#endif /* defined(LOG_TRACE_ENABLED) */
+
+    int16_t *completed = audio_ring_slot(ring, ring->filled);
+    ring->filled++;
+
+    // start receiving the next slot immediately before preprocessing, so as not to lose anything
+    err = audio_ring_start(ring);
+
+    LOG_TRACE_BEGIN(preprocessing);
+    audio_preprocessing(completed, ring->slot_len);
+    LOG_TRACE_END(preprocessing, LOG_TRACE_TRACK_CPU, "audio gain");
+    return err;
+}
+
+bool audio_ring_get_window(const audio_ring *ring, int len, audio_ring_window *window)
+{
+    if (len <= 0 || len > (ring->n_slots - 1) * ring->slot_len) {
+        return false;
+    }
+
+    const int total = ring->n_slots * ring->slot_len;
+    int end = (int)(ring->filled % ring->n_slots) * ring->slot_len;
+    if (end == 0) {
+        end = total;
+    }
+    const int start = end - len;
+    if (start >= 0) {
+        window->first = ring->buffer + start;
+        window->first_len = len;
+        window->second = NULL;
+        window->second_len = 0;
+    } else {
+        window->first = ring->buffer + total + start;
+        window->first_len = -start;
+        window->second = ring->buffer;
+        window->second_len = end;
+    }
+    return true;
+}
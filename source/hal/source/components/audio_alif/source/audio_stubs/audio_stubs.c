@@ -52,3 +52,13 @@ void set_audio_gain(float gain_db)
 {
     (void) gain_db;
 }
+
+void get_audio_stats(audio_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void set_audio_stats_logging(bool enable)
+{
+    (void) enable;
+}
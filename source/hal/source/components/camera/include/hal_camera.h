@@ -47,6 +47,21 @@ typedef enum hal_camera_status_ {
     HAL_CAMERA_STATUS_INVALID
 } hal_cam_status;
 
+/**< Frame delivered by the camera in continuous mode */
+typedef struct hal_camera_frame_ {
+    const uint8_t* data;    /* Pointer to the frame data; valid until the next frame is requested. */
+    uint32_t size;          /* Bytes occupied by the frame. */
+    uint32_t sequence;      /* Capture sequence number, starting at 0 when the camera is started. */
+    uint32_t dropped;       /* Frames captured but never delivered since the previous frame. */
+} hal_camera_frame;
+
+/**
+ * @brief   Callback invoked when a new frame has been captured. May be
+ *          called from interrupt context.
+ * @param[in]   sequence    Sequence number of the captured frame.
+ */
+typedef void (*hal_camera_frame_ready_callback)(uint32_t sequence);
+
 /**
 * @brief  Initialises the camera interface.
 * @return true if successful, false otherwise.
@@ -87,6 +102,23 @@ bool hal_camera_start(void);
  */
 const uint8_t* hal_camera_get_captured_frame(uint32_t* size);
 
+/**
+ *  @brief Gets the next captured frame. In continuous mode, the device keeps
+ *         capturing into its spare buffers while the caller works on the
+ *         returned frame, and the most recent completed frame is returned;
+ *         older frames are dropped. In single frame mode, this captures and
+ *         returns one frame.
+ *  @param[out] frame   Frame information; data is NULL on failure.
+ *  @return     true if a frame was returned, false otherwise.
+ */
+bool hal_camera_get_frame(hal_camera_frame* frame);
+
+/**
+ *  @brief Registers a callback to be notified when frames are captured.
+ *  @param[in]  callback    Function to call, or NULL to remove it.
+ */
+void hal_camera_set_frame_ready_callback(hal_camera_frame_ready_callback callback);
+
 /**
  * @brief  Stops the camera device.
  * @return true if successful, false otherwise.
@@ -29,6 +29,9 @@
 #define CAMERA_MODE_SNAPSHOT 	0x0011
 
 
+/* Called from the camera interrupt when a frame capture has completed. */
+typedef void (*camera_event_callback)(void);
+
 int32_t camera_init(uint8_t *buffer);
 void camera_uninit();
 void camera_start(uint32_t mode);
@@ -36,5 +39,8 @@ int32_t camera_gain(uint32_t gain);
 int32_t camera_vsync(uint32_t timeout_ms);
 int32_t camera_wait();
 bool camera_image_ready();
+void camera_capture_frame(uint8_t *buffer);
+void camera_stop();
+void camera_set_event_callback(camera_event_callback callback);
 
 #endif /* CAMERA_H_ */
@@ -14,12 +14,20 @@
 #include <stdint.h>
 #include <RTE_Device.h>
 #include "tiff.h"
+#include "ccm.h"
 
 #define RGB_BYTES 		3
 #define RGBA_BYTES 		4
 #define RGB565_BYTES	2
 #define PIXEL_BYTES 	1
 
+// Demosaic only the part of a Bayer frame that is cropped and scaled to the
+// requested size, rather than converting the full frame first. Disable to get
+// the full frame RGB image in rgb_image for debugging.
+#ifndef CIMAGE_ROI_DEMOSAIC
+#define CIMAGE_ROI_DEMOSAIC     (1)
+#endif
+
 // Camera dimensions
 #if RTE_MT9M114_CAMERA_SENSOR_MIPI_ENABLE
 
@@ -46,16 +54,26 @@
 #define CIMAGE_COLOR_CORRECTION (1)
 #define CIMAGE_SW_GAIN_CONTROL  (1)
 #define CIMAGE_USE_RGB565       (0)
+#if CIMAGE_ROI_DEMOSAIC
+#define CIMAGE_RGB_WIDTH_MAX    (320)
+#define CIMAGE_RGB_HEIGHT_MAX   (320)
+#else
 #define CIMAGE_RGB_WIDTH_MAX    CIMAGE_X
 #define CIMAGE_RGB_HEIGHT_MAX   CIMAGE_Y
+#endif // CIMAGE_ROI_DEMOSAIC
 #elif RTE_ARX3A0_CAMERA_SENSOR_ENABLE // REV A RTE
 #define CIMAGE_X                (560)
 #define CIMAGE_Y                (560)
 #define CIMAGE_COLOR_CORRECTION (1)
 #define CIMAGE_SW_GAIN_CONTROL  (1)
 #define CIMAGE_USE_RGB565       (0)
+#if CIMAGE_ROI_DEMOSAIC
+#define CIMAGE_RGB_WIDTH_MAX    (320)
+#define CIMAGE_RGB_HEIGHT_MAX   (320)
+#else
 #define CIMAGE_RGB_WIDTH_MAX    CIMAGE_X
 #define CIMAGE_RGB_HEIGHT_MAX   CIMAGE_Y
+#endif // CIMAGE_ROI_DEMOSAIC
 #elif !defined(RTE_Device_CPI)
 #define CIMAGE_X                (0)
 #define CIMAGE_Y                (0)
@@ -78,6 +96,8 @@ extern uint32_t exposure_under_count, exposure_low_count, exposure_high_count, e
 int frame_crop(const void *input_fb, uint32_t ip_row_size, uint32_t ip_col_size, uint32_t row_start, uint32_t col_start, void *output_fb, uint32_t op_row_size, uint32_t op_col_size, uint32_t bpp);
 int crop_and_interpolate(uint8_t *image, uint32_t srcWidth, uint32_t srcHeight, uint8_t *dstImage, uint32_t dstWidth, uint32_t dstHeight, uint32_t bpp);
 void white_balance(int width, int height, const uint8_t *sp, uint8_t *dp);
+void set_white_balance_gains(float red, float green, float blue);
+const ccm_params *get_color_correction(void);
 int bayer_to_RGB(uint8_t *src, uint8_t *dest);
 
 const uint8_t *get_image_data(int ml_width, int ml_height, tiff_header_t tiff_header, uint8_t *image_data, int image_size, uint8_t *raw_image);
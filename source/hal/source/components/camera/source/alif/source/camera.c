@@ -49,6 +49,7 @@ static const ARM_DRIVER_CPI * const camera = &Driver_CPI;
 static uint8_t* buf              = 0;
 static atomic_int image_received = 0;
 static bool init_done = false;
+static camera_event_callback event_callback = NULL;
 
 static void CameraEventHandler(uint32_t event)
 {
@@ -56,6 +57,9 @@ static void CameraEventHandler(uint32_t event)
 
     // only capture stopped event is configured to cause interrupt
     image_received = 1;
+    if (event_callback) {
+        event_callback();
+    }
 }
 
 int32_t camera_init(uint8_t* buffer)
@@ -133,6 +137,22 @@ void camera_start(uint32_t mode)
     }
 }
 
+void camera_capture_frame(uint8_t* buffer)
+{
+    image_received = 0;
+    camera->CaptureFrame(buffer);
+}
+
+void camera_stop()
+{
+    camera->Stop();
+}
+
+void camera_set_event_callback(camera_event_callback callback)
+{
+    event_callback = callback;
+}
+
 int32_t camera_gain(uint32_t gain)
 {
     return camera->Control(CPI_CAMERA_SENSOR_GAIN, gain);
@@ -17,6 +17,7 @@
  */
 #include "hal_camera.h"
 #include "log_macros.h"
+#include "log_trace.h"
 #include "RTE_Components.h"
 #include "RTE_Device.h"
 #include "image_processing.h"
@@ -36,7 +37,8 @@
 #endif
 
 /* Camera fills the raw_image buffer.
- * Bayer->RGB conversion transfers into the rgb_image buffer.
+ * Bayer->RGB conversion transfers into the rgb_image buffer. With CIMAGE_ROI_DEMOSAIC
+ * only the crop window is converted, scaled straight to the requested size.
  * With MT9M114 camera this can be a RGB565 to RGB conversion.
  * Following steps (crop, interpolate, colour correct) all occur in the rgb_image buffer in-place.
  */
@@ -45,9 +47,31 @@ static struct {
 	uint8_t image_data[CIMAGE_RGB_WIDTH_MAX * CIMAGE_RGB_HEIGHT_MAX * RGB_BYTES];
 } rgb_image __attribute__((section(".bss.camera_frame_bayer_to_rgb_buf")));
 
-static uint8_t raw_image[CIMAGE_X * CIMAGE_Y + CIMAGE_USE_RGB565 * CIMAGE_X * CIMAGE_Y]
+#if !defined(CAMERA_CAPTURE_BUFFERS)
+#define CAMERA_CAPTURE_BUFFERS (2)
+#endif /* CAMERA_CAPTURE_BUFFERS */
+
+/* Size of one raw frame, rounded up so that every buffer stays cache line aligned. */
+#define RAW_IMAGE_SIZE  (((CIMAGE_X * CIMAGE_Y + CIMAGE_USE_RGB565 * CIMAGE_X * CIMAGE_Y) + 31) & ~31)
+
+/* In continuous mode the camera captures into one raw buffer while a
+ * completed frame in another is being converted for the application.
+ * Single frame mode only uses the first buffer.
+ */
+static uint8_t raw_image[CAMERA_CAPTURE_BUFFERS][RAW_IMAGE_SIZE]
     __attribute__((aligned(32),section(".bss.camera_frame_buf")));
 
+typedef enum raw_buf_state_ {
+    RAW_BUF_FREE,       /* Available for capture. */
+    RAW_BUF_CAPTURING,  /* Owned by the camera controller. */
+    RAW_BUF_READY,      /* Holds a completed frame not yet taken by the application. */
+    RAW_BUF_IN_USE      /* Being converted for the application. */
+} raw_buf_state;
+
+typedef struct raw_buf_ {
+    volatile raw_buf_state state;
+    volatile uint32_t sequence;
+} raw_buf;
 
 typedef struct hal_camera_device_ {
     char name[32];
@@ -58,12 +82,136 @@ typedef struct hal_camera_device_ {
     uint8_t *output_buffer;
     hal_cam_clr_format format;
     hal_cam_mode mode;
-    hal_cam_status status;
+    volatile hal_cam_status status;
+    raw_buf raw[CAMERA_CAPTURE_BUFFERS];
+    volatile int capturing;             /* Index of the buffer being captured, or -1 if stalled. */
+    volatile bool capture_armed;        /* A capture is programmed and its completion not yet handled. */
+    volatile uint32_t next_sequence;
+    volatile uint32_t dropped;          /* Frames dropped since the last delivered frame. */
+    volatile uint64_t capture_start;    /* Trace time the current capture started. */
+    hal_camera_frame_ready_callback ready_callback;
 } hal_cam_dev;
 
 /**< Static device used in this file. */
 static hal_cam_dev s_cam_dev;
 
+static uint32_t hal_camera_lock(void)
+{
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static void hal_camera_unlock(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Starts capturing into a free buffer. If all buffers hold frames,
+ *          the oldest completed frame is overwritten. Must be called with
+ *          interrupts masked.
+ */
+static void hal_camera_capture_next(void)
+{
+    if (s_cam_dev.capture_armed) {
+        /* Already capturing; a second capture would overwrite the first. */
+        return;
+    }
+
+    int next = -1;
+    for (int i = 0; i < CAMERA_CAPTURE_BUFFERS; ++i) {
+        if (s_cam_dev.raw[i].state == RAW_BUF_FREE) {
+            next = i;
+            break;
+        }
+    }
+
+    if (next < 0) {
+        for (int i = 0; i < CAMERA_CAPTURE_BUFFERS; ++i) {
+            if (s_cam_dev.raw[i].state == RAW_BUF_READY &&
+                (next < 0 || (int32_t)(s_cam_dev.raw[i].sequence - s_cam_dev.raw[next].sequence) < 0)) {
+                next = i;
+            }
+        }
+        if (next >= 0) {
+            ++s_cam_dev.dropped;
+        }
+    }
+
+    s_cam_dev.capturing = next;
+    if (next < 0) {
+        /* Only possible with a single buffer; restarted once it is released. */
+        return;
+    }
+
+    s_cam_dev.raw[next].state = RAW_BUF_CAPTURING;
+    s_cam_dev.capture_armed = true;
+#if defined(LOG_TRACE_ENABLED)
+    s_cam_dev.capture_start = log_trace_now();
+#endif /* defined(LOG_TRACE_ENABLED) */
+#ifndef USE_FAKE_CAMERA
+    camera_capture_frame(raw_image[next]);
+#endif
+}
+
+/**
+ * @brief   Frame completion handler for continuous mode, called from the
+ *          camera interrupt.
+ */
+static void hal_camera_frame_done(void)
+{
+    const int done = s_cam_dev.capturing;
+    if (s_cam_dev.mode != HAL_CAMERA_MODE_CONTINUOUS ||
+        s_cam_dev.status != HAL_CAMERA_STATUS_RUNNING || done < 0 ||
+        !s_cam_dev.capture_armed) {
+        /* Spurious or repeated completion: nothing was armed, so do not re-arm. */
+        return;
+    }
+    s_cam_dev.capture_armed = false;
+
+#if defined(LOG_TRACE_ENABLED)
+    log_trace_span(LOG_TRACE_TRACK_CAMERA, "capture", s_cam_dev.capture_start, log_trace_now());
+#endif /* defined(LOG_TRACE_ENABLED) */
+
+    const uint32_t sequence = s_cam_dev.next_sequence++;
+    s_cam_dev.raw[done].sequence = sequence;
+    s_cam_dev.raw[done].state = RAW_BUF_READY;
+    hal_camera_capture_next();
+
+    if (s_cam_dev.ready_callback) {
+        s_cam_dev.ready_callback(sequence);
+    }
+}
+
+/**
+ * @brief   Takes the most recent completed frame, dropping older ones.
+ *          Must be called with interrupts masked.
+ * @return  Index of the buffer, or -1 if no frame is ready.
+ */
+static int hal_camera_take_newest(void)
+{
+    int newest = -1;
+    for (int i = 0; i < CAMERA_CAPTURE_BUFFERS; ++i) {
+        if (s_cam_dev.raw[i].state == RAW_BUF_READY &&
+            (newest < 0 || (int32_t)(s_cam_dev.raw[i].sequence - s_cam_dev.raw[newest].sequence) > 0)) {
+            newest = i;
+        }
+    }
+    if (newest < 0) {
+        return newest;
+    }
+
+    for (int i = 0; i < CAMERA_CAPTURE_BUFFERS; ++i) {
+        if (i != newest && s_cam_dev.raw[i].state == RAW_BUF_READY) {
+            s_cam_dev.raw[i].state = RAW_BUF_FREE;
+            ++s_cam_dev.dropped;
+        }
+    }
+    s_cam_dev.raw[newest].state = RAW_BUF_IN_USE;
+    return newest;
+}
+
 /**
  * @brief   Resets the camera device.
  */
@@ -77,7 +225,10 @@ static void hal_camera_reset(void)
     s_cam_dev.output_buffer = NULL;
     s_cam_dev.format = HAL_CAMERA_COLOUR_FORMAT_INVALID;
     s_cam_dev.mode = HAL_CAMERA_MODE_INVALID;
+    s_cam_dev.capturing = -1;
+    s_cam_dev.capture_armed = false;
 #ifndef USE_FAKE_CAMERA
+    camera_set_event_callback(NULL);
     camera_uninit();
 #endif
 }
@@ -88,7 +239,7 @@ bool hal_camera_init(void)
     info("Initialising camera interface: %s\n", s_cam_dev.name);
 #ifndef USE_FAKE_CAMERA
     int32_t err = 0;
-    err = camera_init(raw_image);
+    err = camera_init(raw_image[0]);
 	if (err != 0) {
         printf_err("Failed to initialise camera driver: %ld\n", err);
 		while(1) {
@@ -98,6 +249,7 @@ bool hal_camera_init(void)
 			sleep_or_wait_msec(300);
 		}
 	}
+    camera_set_event_callback(hal_camera_frame_done);
 	DEBUG_PRINTF("Camera initialized... \n");
     BOARD_LED1_Control(BOARD_LED_STATE_HIGH);
 #endif
@@ -115,11 +267,6 @@ bool hal_camera_configure(const uint32_t width,
         return false;
     }
 
-    if (HAL_CAMERA_MODE_CONTINUOUS == mode) {
-        printf_err("Only single shot mode is supported\n");
-        return false;
-    }
-
     s_cam_dev.frame_width = width;
     s_cam_dev.frame_height = height;
     s_cam_dev.mode = mode;
@@ -164,6 +311,20 @@ bool hal_camera_start(void)
         return false;
     }
 
+    if (s_cam_dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+        for (int i = 0; i < CAMERA_CAPTURE_BUFFERS; ++i) {
+            s_cam_dev.raw[i].state = RAW_BUF_FREE;
+        }
+        s_cam_dev.next_sequence = 0;
+        s_cam_dev.dropped = 0;
+
+        const uint32_t primask = hal_camera_lock();
+        s_cam_dev.status = HAL_CAMERA_STATUS_RUNNING;
+        hal_camera_capture_next();
+        hal_camera_unlock(primask);
+        return true;
+    }
+
 #ifndef USE_FAKE_CAMERA
     camera_start(CAMERA_MODE_SNAPSHOT);
 #endif
@@ -180,6 +341,10 @@ static hal_cam_status wait_for_capture(void)
 #ifndef USE_FAKE_CAMERA
     /* Wait for video input frame */
     while ( hal_camera_get_status() != HAL_CAMERA_STATUS_STOPPED) {
+        /* Output pending log messages while the frame is captured */
+        if (log_drain_one() != 0) {
+            continue;
+        }
         __WFE();
     }
 #else
@@ -189,18 +354,119 @@ static hal_cam_status wait_for_capture(void)
     return s_cam_dev.status;
 }
 
+/**
+ * @brief   Waits for a completed frame in continuous mode and converts it
+ *          into the output buffer. The camera keeps capturing into the
+ *          other buffers meanwhile.
+ */
+static bool hal_camera_get_continuous_frame(hal_camera_frame* frame)
+{
+    int idx;
+    uint32_t primask;
+
+    LOG_TRACE_BEGIN(wait);
+    for (;;) {
+        primask = hal_camera_lock();
+        idx = hal_camera_take_newest();
+        if (idx >= 0) {
+            frame->dropped = s_cam_dev.dropped;
+            s_cam_dev.dropped = 0;
+        }
+#ifdef USE_FAKE_CAMERA
+        else {
+            /* No sensor interrupt: complete the pending capture right away. */
+            hal_camera_frame_done();
+        }
+#endif
+        hal_camera_unlock(primask);
+
+        if (idx >= 0) {
+            break;
+        }
+        if (s_cam_dev.status != HAL_CAMERA_STATUS_RUNNING) {
+            return false;
+        }
+        /* Output pending log messages while the next frame is captured */
+        if (log_drain_one() != 0) {
+            continue;
+        }
+#ifndef USE_FAKE_CAMERA
+        __WFE();
+#endif
+    }
+    LOG_TRACE_END(wait, LOG_TRACE_TRACK_CPU, "wait for frame");
+
+    frame->sequence = s_cam_dev.raw[idx].sequence;
+    /* Drop stale lines of the completed frame only; the camera is writing
+     * another buffer meanwhile. */
+    SCB_InvalidateDCache_by_Addr(raw_image[idx], RAW_IMAGE_SIZE);
+    frame->data = get_image_data(s_cam_dev.frame_width, s_cam_dev.frame_height, rgb_image.tiff_header, s_cam_dev.output_buffer, s_cam_dev.output_buffer_size, raw_image[idx]);
+
+    /* The raw frame is no longer needed once converted. */
+    primask = hal_camera_lock();
+    s_cam_dev.raw[idx].state = RAW_BUF_FREE;
+    if (s_cam_dev.capturing < 0 && s_cam_dev.status == HAL_CAMERA_STATUS_RUNNING) {
+        hal_camera_capture_next();
+    }
+    hal_camera_unlock(primask);
+
+    if (!frame->data) {
+        return false;
+    }
+    frame->size = s_cam_dev.bytes_per_frame;
+    return true;
+}
+
+bool hal_camera_get_frame(hal_camera_frame* frame)
+{
+    memset(frame, 0, sizeof(*frame));
+
+    if (s_cam_dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+        if (s_cam_dev.status != HAL_CAMERA_STATUS_RUNNING) {
+            return false;
+        }
+        return hal_camera_get_continuous_frame(frame);
+    }
+
+    if (!hal_camera_start()) {
+        return false;
+    }
+    frame->data = hal_camera_get_captured_frame(&frame->size);
+    if (!frame->data) {
+        return false;
+    }
+    frame->sequence = s_cam_dev.next_sequence++;
+    if (s_cam_dev.ready_callback) {
+        s_cam_dev.ready_callback(frame->sequence);
+    }
+    return true;
+}
+
+void hal_camera_set_frame_ready_callback(hal_camera_frame_ready_callback callback)
+{
+    s_cam_dev.ready_callback = callback;
+}
+
 const uint8_t* hal_camera_get_captured_frame(uint32_t* size)
 {
     const uint8_t* buffer = NULL;
     *size = 0;
+    if (s_cam_dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+        hal_camera_frame frame;
+        if (hal_camera_get_frame(&frame)) {
+            *size = frame.size;
+            buffer = frame.data;
+        }
+        return buffer;
+    }
     if (s_cam_dev.status == HAL_CAMERA_STATUS_RUNNING) {
         const hal_cam_status status = wait_for_capture();
         if (HAL_CAMERA_STATUS_ERROR == status) {
             printf_err("Error reported\n");
             return buffer;
         }
-        SCB_CleanInvalidateDCache();
-        buffer = get_image_data(s_cam_dev.frame_width, s_cam_dev.frame_height, rgb_image.tiff_header, s_cam_dev.output_buffer, s_cam_dev.output_buffer_size, raw_image);
+        SCB_InvalidateDCache_by_Addr(raw_image[0], RAW_IMAGE_SIZE);
+        buffer = get_image_data(s_cam_dev.frame_width, s_cam_dev.frame_height, rgb_image.tiff_header, s_cam_dev.output_buffer, s_cam_dev.output_buffer_size, raw_image[0]);
         *size = s_cam_dev.bytes_per_frame;
     }
     return buffer;
@@ -210,6 +476,13 @@ bool hal_camera_stop(void)
 {
     if (s_cam_dev.status == HAL_CAMERA_STATUS_RUNNING) {
         s_cam_dev.status = HAL_CAMERA_STATUS_STOPPED;
+#ifndef USE_FAKE_CAMERA
+        if (s_cam_dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+            camera_stop();
+        }
+#endif
+        s_cam_dev.capturing = -1;
+        s_cam_dev.capture_armed = false;
     }
 
     return true;
@@ -217,6 +490,9 @@ bool hal_camera_stop(void)
 
 hal_cam_status hal_camera_get_status(void)
 {
+    if (s_cam_dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+        return s_cam_dev.status;
+    }
 #ifndef USE_FAKE_CAMERA
     if (camera_image_ready()) {
         s_cam_dev.status = HAL_CAMERA_STATUS_STOPPED;
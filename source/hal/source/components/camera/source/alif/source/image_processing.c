@@ -39,7 +39,9 @@
 #include <inttypes.h>
 #include "image_processing.h"
 #include "bayer.h"
+#include "demosaic.h"
 #include "log_macros.h"
+#include "log_trace.h"
 
 #include "timer_alif.h"
 #include "RTE_Components.h"
@@ -58,6 +60,16 @@
 #endif
 
 #define BAYER_FORMAT DC1394_COLOR_FILTER_GRBG
+#define BAYER_TILE   DEMOSAIC_TILE_GRBG
+
+#ifndef CIMAGE_DEMOSAIC_METHOD
+#define CIMAGE_DEMOSAIC_METHOD DEMOSAIC_SIMPLE
+#endif
+
+// Exposure thresholds for the auto gain: low is < 20%, high is >= 80%
+// after gamma.
+#define EXPOSURE_THRESH_LOW     9
+#define EXPOSURE_THRESH_HIGH    154
 
 int frame_crop(const void *input_fb,
 		       uint32_t ip_row_size,
@@ -427,6 +439,7 @@ int crop_and_interpolate( uint8_t *image,
         abort();
     }
     tprof2 = Get_SysTick_Cycle_Count32();
+    LOG_TRACE_BEGIN(crop);
     // What are dimensions that maintain aspect ratio?
     calculate_crop_dims(srcWidth, srcHeight, dstWidth, dstHeight, &cropWidth, &cropHeight);
     // Now crop to that dimension, in place
@@ -443,11 +456,14 @@ int crop_and_interpolate( uint8_t *image,
 
     if( res < 0 ) { return res; }
     tprof2 = Get_SysTick_Cycle_Count32() - tprof2;
+    LOG_TRACE_END(crop, LOG_TRACE_TRACK_CPU, "crop");
 
     tprof3 = Get_SysTick_Cycle_Count32();
+    LOG_TRACE_BEGIN(resize);
     // Finally, interpolate down to desired dimensions, in place or to destination buffer
     int result = resize_image(image, cropWidth, cropHeight, dstImage, dstWidth, dstHeight, bpp/8);
     tprof3 = Get_SysTick_Cycle_Count32() - tprof3;
+    LOG_TRACE_END(resize, LOG_TRACE_TRACK_CPU, "resize");
     return result;
 }
 
@@ -474,7 +490,7 @@ static int32_t log_gain_to_api(float gain)
 }
 
 #if CIMAGE_SW_GAIN_CONTROL
-static void process_autogain(void)
+static void process_autogain(const demosaic_exposure *exposure)
 {
     /* Simple "auto-exposure" algorithm. We work a single "gain" value
      * and leave it up to the camera driver how this is produced through
@@ -485,7 +501,7 @@ static void process_autogain(void)
      * and low pixels hit a target.
      *
      * The definition of "low" and "high" pixels has quite an effect on the
-     * end result - this is set over in bayer2rgb.c, which does the analysis.
+     * end result - this is set by the EXPOSURE_THRESH_xxx values above.
      * It gives us 4 counts for high/low (>80% / <20%) pixels and over/under-
      * exposed (255 or 0).
      *
@@ -518,8 +534,12 @@ static void process_autogain(void)
 
     /* Rescale high-low difference in pixel counts so that it's
      * in range [-1..+1], regardless of image size */
-    float high_proportion = (exposure_high_count + overunder_weight * exposure_over_count) * (1.0f / (CIMAGE_X * CIMAGE_Y));
-    float low_proportion = (exposure_low_count + overunder_weight * exposure_under_count) * (1.0f / (CIMAGE_X * CIMAGE_Y));
+    if (exposure->pixels == 0) {
+        return;
+    }
+    const float scale = 1.0f / exposure->pixels;
+    float high_proportion = (exposure->high + overunder_weight * exposure->over) * scale;
+    float low_proportion = (exposure->low + overunder_weight * exposure->under) * scale;
     float highlow_difference = high_proportion - low_proportion;
     float error = highlow_difference - target_highlow_difference;
 
@@ -601,6 +621,47 @@ const uint8_t *get_image_data(int ml_width, int ml_height, tiff_header_t tiff_he
 #endif
 
 #if !CIMAGE_USE_RGB565
+    const demosaic_frame frame = {
+        .data = raw_image, .width = CIMAGE_X, .height = CIMAGE_Y, .tile = BAYER_TILE
+    };
+#if CIMAGE_SW_GAIN_CONTROL
+    demosaic_exposure exposure;
+#endif
+#endif
+
+#if !CIMAGE_USE_RGB565 && CIMAGE_ROI_DEMOSAIC
+    if (ml_width * ml_height * RGB_BYTES > image_size) {
+        printf_err("Requested image does not fit to RGB buffer.\n");
+        return NULL;
+    }
+    uint32_t crop_width, crop_height;
+    calculate_crop_dims(CIMAGE_X, CIMAGE_Y, ml_width, ml_height, &crop_width, &crop_height);
+    const int crop_x = (CIMAGE_X - crop_width) / 2;
+    const int crop_y = (CIMAGE_Y - crop_height) / 2;
+    // Two demosaiced rows of the crop window
+    static uint8_t demosaic_rows[(CIMAGE_X + 1) * RGB_BYTES * 2];
+#if CIMAGE_COLOR_CORRECTION
+    const ccm_params *ccm = get_color_correction();
+#else
+    const ccm_params *ccm = NULL;
+#endif
+    tprof1 = Get_SysTick_Cycle_Count32();
+    LOG_TRACE_BEGIN(demosaic);
+    // RGB conversion, cropping, scaling and color correction in one pass over the crop window
+    if (demosaic_crop_resize(&frame, CIMAGE_DEMOSAIC_METHOD,
+                             crop_x, crop_y, crop_width, crop_height,
+                             image_data, ml_width, ml_height, ccm, demosaic_rows) != 0) {
+        printf_err("Demosaic failed\n");
+        return NULL;
+    }
+    tprof1 = Get_SysTick_Cycle_Count32() - tprof1;
+    LOG_TRACE_END(demosaic, LOG_TRACE_TRACK_CPU, "demosaic, crop and resize");
+    tprof2 = tprof3 = tprof4 = 0;
+#if CIMAGE_SW_GAIN_CONTROL
+    demosaic_exposure_stats(&frame, crop_x, crop_y, crop_width, crop_height,
+                            EXPOSURE_THRESH_LOW, EXPOSURE_THRESH_HIGH, &exposure);
+#endif
+#elif !CIMAGE_USE_RGB565
     /* TIFF image can be dumped in Arm Development Studio using the command
      *
      *     dump value camera.tiff rgb_image
@@ -609,15 +670,21 @@ const uint8_t *get_image_data(int ml_width, int ml_height, tiff_header_t tiff_he
      */
     write_tiff_header(&tiff_header, CIMAGE_X, CIMAGE_Y);
     tprof1 = Get_SysTick_Cycle_Count32();
+    LOG_TRACE_BEGIN(demosaic);
     // RGB conversion and frame resize
-    dc1394_bayer_Simple(raw_image, image_data, CIMAGE_X, CIMAGE_Y, BAYER_FORMAT);
+    demosaic_image(&frame, CIMAGE_DEMOSAIC_METHOD, image_data);
     tprof1 = Get_SysTick_Cycle_Count32() - tprof1;
+    LOG_TRACE_END(demosaic, LOG_TRACE_TRACK_CPU, "demosaic");
+#if CIMAGE_SW_GAIN_CONTROL
+    demosaic_exposure_stats(&frame, 0, 0, CIMAGE_X, CIMAGE_Y,
+                            EXPOSURE_THRESH_LOW, EXPOSURE_THRESH_HIGH, &exposure);
+#endif
 #endif
 
 #ifndef USE_FAKE_CAMERA
 #if CIMAGE_SW_GAIN_CONTROL
-    // Use pixel analysis from bayer_to_RGB to adjust gain
-    process_autogain();
+    // Use the exposure statistics of the raw frame to adjust gain
+    process_autogain(&exposure);
 #endif
 #endif
 
@@ -630,7 +697,7 @@ const uint8_t *get_image_data(int ml_width, int ml_height, tiff_header_t tiff_he
     crop_and_interpolate(raw_image, CIMAGE_X, CIMAGE_Y,
                          image_data, ml_width, ml_height,
                          RGB565_BYTES * 8);
-#else
+#elif !CIMAGE_ROI_DEMOSAIC
     if (ml_width > CIMAGE_X || ml_height > CIMAGE_Y) {
         printf_err("Requested image can't be processed in place\n");
         return NULL;
@@ -641,11 +708,13 @@ const uint8_t *get_image_data(int ml_width, int ml_height, tiff_header_t tiff_he
     // Rewrite the TIFF header for the new size
     write_tiff_header(&tiff_header, ml_width, ml_height);
 
-#if CIMAGE_COLOR_CORRECTION
+#if CIMAGE_COLOR_CORRECTION && (CIMAGE_USE_RGB565 || !CIMAGE_ROI_DEMOSAIC)
     tprof4 = Get_SysTick_Cycle_Count32();
+    LOG_TRACE_BEGIN(white_balance);
     // Color correction for white balance
     white_balance(ml_width, ml_height, image_data, image_data);
     tprof4 = Get_SysTick_Cycle_Count32() - tprof4;
+    LOG_TRACE_END(white_balance, LOG_TRACE_TRACK_CPU, "white balance");
 #endif
     return image_data;
 }
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ccm.h"
+
+#include <stddef.h>
+
+#if (__ARM_FEATURE_MVE & 1) && \
+    (defined(__clang__) || !defined(__GNUC__) || (__GNUC__ > 12) || (__GNUC__ == 12 && __GNUC_MINOR__ >= 2))
+#define CCM_MVE (1)
+#include <arm_mve.h>
+#else
+#define CCM_MVE (0)
+#endif
+
+/*
+ * Each channel is computed as the vector code does with 16-bit lanes: the
+ * input is scaled by 2^7 and multiplied by the Q12 coefficient with a
+ * rounding doubling multiply-high (VQRDMULH), giving a Q4 product. Products
+ * are summed with saturation, then rounded and saturated to 8 bits
+ * (VQRSHRUNB) to index the table. Signed right shifts are arithmetic.
+ */
+static inline int32_t sat_s16(int32_t v)
+{
+    return v < INT16_MIN ? INT16_MIN : (v > INT16_MAX ? INT16_MAX : v);
+}
+
+static inline uint8_t ccm_channel(const ccm_params* params, int out, const int32_t in[3])
+{
+    int32_t acc = 0;
+    for (int i = 0; i < 3; ++i) {
+        acc = sat_s16(acc + ((in[i] * params->coeff[out][i] + 128) >> 8));
+    }
+    acc = (acc + 8) >> 4;
+    return params->lut[acc < 0 ? 0 : (acc > 255 ? 255 : acc)];
+}
+
+static inline void ccm_pixel(const ccm_params* params, const int32_t in[3], uint8_t* dst)
+{
+    const uint8_t r = ccm_channel(params, 0, in);
+    const uint8_t g = ccm_channel(params, 1, in);
+    const uint8_t b = ccm_channel(params, 2, in);
+    dst[0] = r;
+    dst[1] = g;
+    dst[2] = b;
+}
+
+static inline void rgb565_expand(uint16_t v, int32_t rgb[3])
+{
+    const int32_t r = v >> 11;
+    const int32_t g = (v >> 5) & 0x3F;
+    const int32_t b = v & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void ccm_init(ccm_params* params, const float matrix[3][3],
+              const float gains[3], const uint8_t lut[256])
+{
+    for (int out = 0; out < 3; ++out) {
+        for (int in = 0; in < 3; ++in) {
+            const float c = matrix[out][in] * (gains ? gains[in] : 1.0f) * (1 << CCM_FRAC_BITS);
+            const float rounded = c < 0 ? c - 0.5f : c + 0.5f;
+            params->coeff[out][in] = (int16_t)(rounded < INT16_MIN ? INT16_MIN :
+                                               (rounded > INT16_MAX ? INT16_MAX : rounded));
+        }
+    }
+    for (int i = 0; i < 256; ++i) {
+        params->lut[i] = lut ? lut[i] : (uint8_t)i;
+    }
+}
+
+void ccm_apply_rgb888_reference(const ccm_params* params, const uint8_t* src, uint8_t* dst, int pixels)
+{
+    for (int i = 0; i < pixels; ++i, src += 3, dst += 3) {
+        const int32_t in[3] = {src[0], src[1], src[2]};
+        ccm_pixel(params, in, dst);
+    }
+}
+
+void ccm_apply_rgb565_reference(const ccm_params* params, const uint16_t* src, uint8_t* dst, int pixels)
+{
+    for (int i = 0; i < pixels; ++i, dst += 3) {
+        int32_t in[3];
+        rgb565_expand(src[i], in);
+        ccm_pixel(params, in, dst);
+    }
+}
+
+#if CCM_MVE
+static inline uint16x8_t ccm_channel_mve(const ccm_params* params, int out,
+                                         int16x8_t r, int16x8_t g, int16x8_t b,
+                                         mve_pred16_t p)
+{
+    int16x8_t acc = vqrdmulhq_n_s16(r, params->coeff[out][0]);
+    acc = vqaddq_s16(acc, vqrdmulhq_n_s16(g, params->coeff[out][1]));
+    acc = vqaddq_s16(acc, vqrdmulhq_n_s16(b, params->coeff[out][2]));
+    /* Bottom bytes hold the result, top bytes stay zero to form the index. */
+    const uint16x8_t index = vreinterpretq_u16_u8(vqrshrunbq_n_s16(vdupq_n_u8(0), acc, 4));
+    return vldrbq_gather_offset_z_u16(params->lut, index, p);
+}
+
+/* Inputs are 8-bit values in 16-bit lanes. */
+static inline void ccm_store_mve(const ccm_params* params,
+                                 uint16x8_t r, uint16x8_t g, uint16x8_t b,
+                                 uint8_t* dst, uint16x8_t offsets, mve_pred16_t p)
+{
+    const int16x8_t rs = vreinterpretq_s16_u16(vshlq_n_u16(r, 7));
+    const int16x8_t gs = vreinterpretq_s16_u16(vshlq_n_u16(g, 7));
+    const int16x8_t bs = vreinterpretq_s16_u16(vshlq_n_u16(b, 7));
+    /* Compute all channels before storing, so the conversion works in place. */
+    const uint16x8_t r_out = ccm_channel_mve(params, 0, rs, gs, bs, p);
+    const uint16x8_t g_out = ccm_channel_mve(params, 1, rs, gs, bs, p);
+    const uint16x8_t b_out = ccm_channel_mve(params, 2, rs, gs, bs, p);
+    vstrbq_scatter_offset_p_u16(dst + 0, offsets, r_out, p);
+    vstrbq_scatter_offset_p_u16(dst + 1, offsets, g_out, p);
+    vstrbq_scatter_offset_p_u16(dst + 2, offsets, b_out, p);
+}
+#endif /* CCM_MVE */
+
+void ccm_apply_rgb888(const ccm_params* params, const uint8_t* src, uint8_t* dst, int pixels)
+{
+#if CCM_MVE
+    const uint16x8_t offsets = vmulq_n_u16(vidupq_n_u16(0, 1), 3);
+    for (; pixels > 0; pixels -= 8, src += 3 * 8, dst += 3 * 8) {
+        const mve_pred16_t p = vctp16q(pixels);
+        const uint16x8_t r = vldrbq_gather_offset_z_u16(src + 0, offsets, p);
+        const uint16x8_t g = vldrbq_gather_offset_z_u16(src + 1, offsets, p);
+        const uint16x8_t b = vldrbq_gather_offset_z_u16(src + 2, offsets, p);
+        ccm_store_mve(params, r, g, b, dst, offsets, p);
+    }
+#else
+    ccm_apply_rgb888_reference(params, src, dst, pixels);
+#endif /* CCM_MVE */
+}
+
+void ccm_apply_rgb565(const ccm_params* params, const uint16_t* src, uint8_t* dst, int pixels)
+{
+#if CCM_MVE
+    const uint16x8_t offsets = vmulq_n_u16(vidupq_n_u16(0, 1), 3);
+    for (; pixels > 0; pixels -= 8, src += 8, dst += 3 * 8) {
+        const mve_pred16_t p = vctp16q(pixels);
+        const uint16x8_t v = vldrhq_z_u16(src, p);
+        const uint16x8_t r5 = vshrq_n_u16(v, 11);
+        const uint16x8_t g6 = vandq_u16(vshrq_n_u16(v, 5), vdupq_n_u16(0x3F));
+        const uint16x8_t b5 = vandq_u16(v, vdupq_n_u16(0x1F));
+        /* Replicate the top bits into the bottom to cover 0..255. */
+        const uint16x8_t r = vorrq_u16(vshlq_n_u16(r5, 3), vshrq_n_u16(r5, 2));
+        const uint16x8_t g = vorrq_u16(vshlq_n_u16(g6, 2), vshrq_n_u16(g6, 4));
+        const uint16x8_t b = vorrq_u16(vshlq_n_u16(b5, 3), vshrq_n_u16(b5, 2));
+        ccm_store_mve(params, r, g, b, dst, offsets, p);
+    }
+#else
+    ccm_apply_rgb565_reference(params, src, dst, pixels);
+#endif /* CCM_MVE */
+}
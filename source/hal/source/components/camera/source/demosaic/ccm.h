@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HAL_CAMERA_CCM_H
+#define HAL_CAMERA_CCM_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // defined(__cplusplus)
+
+#include <stdint.h>
+
+/**< Fractional bits of the matrix coefficients. */
+#define CCM_FRAC_BITS   (12)
+
+/**< Colour correction in fixed point: white balance gains, a 3x3 matrix and
+ *   an output look-up table (usually gamma) applied in a single pass. */
+typedef struct ccm_params_ {
+    int16_t coeff[3][3];    /* Q12 matrix with the gains folded in, [output][input]. */
+    uint8_t lut[256];       /* Applied to each output channel. */
+} ccm_params;
+
+/**
+ * @brief   Prepares fixed-point colour correction parameters.
+ * @param[out]  params  Parameters to fill in.
+ * @param[in]   matrix  Colour matrix, matrix[output][input], channels in RGB
+ *                      order. Coefficients are limited to [-8, 8).
+ * @param[in]   gains   White balance gains applied to the input channels
+ *                      before the matrix, or NULL for none.
+ * @param[in]   lut     Table applied to each output channel after the
+ *                      matrix, or NULL for none.
+ */
+void ccm_init(ccm_params* params, const float matrix[3][3],
+              const float gains[3], const uint8_t lut[256]);
+
+/**
+ * @brief   Colour corrects RGB888 pixels. Uses the MVE implementation when
+ *          available; src and dst may be the same buffer.
+ * @param[in]   params  Parameters from ccm_init().
+ * @param[in]   src     Input, pixels * 3 bytes.
+ * @param[out]  dst     Output, pixels * 3 bytes.
+ * @param[in]   pixels  Number of pixels.
+ */
+void ccm_apply_rgb888(const ccm_params* params, const uint8_t* src, uint8_t* dst, int pixels);
+
+/**
+ * @brief   Colour corrects RGB565 pixels (blue in the least significant
+ *          bits), producing RGB888. Uses the MVE implementation when
+ *          available.
+ * @param[out]  dst     Output, pixels * 3 bytes.
+ */
+void ccm_apply_rgb565(const ccm_params* params, const uint16_t* src, uint8_t* dst, int pixels);
+
+/**
+ * @brief   Portable scalar implementations of the functions above, bit exact
+ *          with the vector code.
+ */
+void ccm_apply_rgb888_reference(const ccm_params* params, const uint8_t* src, uint8_t* dst, int pixels);
+void ccm_apply_rgb565_reference(const ccm_params* params, const uint16_t* src, uint8_t* dst, int pixels);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+#endif /* HAL_CAMERA_CCM_H */
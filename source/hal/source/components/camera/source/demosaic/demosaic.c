@@ -0,0 +1,497 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "demosaic.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#if (__ARM_FEATURE_MVE & 1) && \
+    (defined(__clang__) || !defined(__GNUC__) || (__GNUC__ > 12) || (__GNUC__ == 12 && __GNUC_MINOR__ >= 2))
+#define DEMOSAIC_MVE (1)
+#include <arm_mve.h>
+#else
+#define DEMOSAIC_MVE (0)
+#endif
+
+/* Kind of sample at a position of the pattern. */
+typedef enum {
+    CFA_R,
+    CFA_G_IN_R_ROW,
+    CFA_G_IN_B_ROW,
+    CFA_B
+} cfa_kind;
+
+/* Kinds at (0,0), (1,0), (0,1), (1,1) for each tile. */
+static const uint8_t cfa_kinds[4][4] = {
+    [DEMOSAIC_TILE_RGGB] = {CFA_R, CFA_G_IN_R_ROW, CFA_G_IN_B_ROW, CFA_B},
+    [DEMOSAIC_TILE_GBRG] = {CFA_G_IN_B_ROW, CFA_B, CFA_R, CFA_G_IN_R_ROW},
+    [DEMOSAIC_TILE_GRBG] = {CFA_G_IN_R_ROW, CFA_R, CFA_B, CFA_G_IN_B_ROW},
+    [DEMOSAIC_TILE_BGGR] = {CFA_B, CFA_G_IN_B_ROW, CFA_G_IN_R_ROW, CFA_R},
+};
+
+static inline cfa_kind cfa_kind_at(const demosaic_frame* frame, int x, int y)
+{
+    return (cfa_kind)cfa_kinds[frame->tile][((y & 1) << 1) | (x & 1)];
+}
+
+static inline bool cfa_is_green(cfa_kind kind)
+{
+    return kind == CFA_G_IN_R_ROW || kind == CFA_G_IN_B_ROW;
+}
+
+/* Rows containing red samples have red as their non-green colour. */
+static inline bool cfa_row_is_red(const demosaic_frame* frame, int y)
+{
+    const cfa_kind kind = cfa_kind_at(frame, 0, y);
+    return kind == CFA_R || kind == CFA_G_IN_R_ROW;
+}
+
+static inline uint8_t clamp_u8(int32_t v)
+{
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/* Margin of samples each method needs around a pixel, other than SIMPLE. */
+#define DEMOSAIC_MARGIN (2)
+
+/*
+ * Per-pixel kernels. `p` points at the sample for the pixel and `s` is the
+ * row stride, so that the neighbours are p[-s], p[1] and so on. Signed
+ * right shifts are arithmetic, as for the vector code.
+ */
+static void kernel_simple(const uint8_t* p, int s, cfa_kind kind, bool row_is_red, uint8_t rgb[3])
+{
+    uint32_t row_colour, other_colour;
+    if (cfa_is_green(kind)) {
+        rgb[1] = (uint8_t)((p[0] + p[s + 1] + 1) >> 1);
+        row_colour = p[1];
+        other_colour = p[s];
+    } else {
+        rgb[1] = (uint8_t)((p[1] + p[s] + 1) >> 1);
+        row_colour = p[0];
+        other_colour = p[s + 1];
+    }
+    rgb[0] = (uint8_t)(row_is_red ? row_colour : other_colour);
+    rgb[2] = (uint8_t)(row_is_red ? other_colour : row_colour);
+}
+
+static void kernel_bilinear(const uint8_t* p, int s, cfa_kind kind, bool row_is_red, uint8_t rgb[3])
+{
+    uint32_t row_colour, other_colour;
+    if (cfa_is_green(kind)) {
+        rgb[1] = p[0];
+        row_colour = (p[-1] + p[1] + 1) >> 1;
+        other_colour = (p[-s] + p[s] + 1) >> 1;
+    } else {
+        rgb[1] = (uint8_t)((p[-s] + p[s] + p[-1] + p[1] + 2) >> 2);
+        row_colour = p[0];
+        other_colour = (p[-s - 1] + p[-s + 1] + p[s - 1] + p[s + 1] + 2) >> 2;
+    }
+    rgb[0] = (uint8_t)(row_is_red ? row_colour : other_colour);
+    rgb[2] = (uint8_t)(row_is_red ? other_colour : row_colour);
+}
+
+static void kernel_edge_aware(const uint8_t* p, int s, cfa_kind kind, bool row_is_red, uint8_t rgb[3])
+{
+    const int32_t c = p[0];
+    const int32_t w = p[-1], e = p[1], ww = p[-2], ee = p[2];
+    const int32_t n = p[-s], so = p[s], nn = p[-2 * s], ss = p[2 * s];
+    const int32_t diag = p[-s - 1] + p[-s + 1] + p[s - 1] + p[s + 1];
+    int32_t row_colour, other_colour;
+
+    if (cfa_is_green(kind)) {
+        rgb[1] = (uint8_t)c;
+        row_colour = (10 * c + 8 * (w + e) - 2 * (ww + ee) - 2 * diag + (nn + ss) + 8) >> 4;
+        other_colour = (10 * c + 8 * (n + so) - 2 * (nn + ss) - 2 * diag + (ww + ee) + 8) >> 4;
+    } else {
+        const int32_t grad_h = (w > e ? w - e : e - w) + (2 * c - ww - ee < 0 ? ww + ee - 2 * c : 2 * c - ww - ee);
+        const int32_t grad_v = (n > so ? n - so : so - n) + (2 * c - nn - ss < 0 ? nn + ss - 2 * c : 2 * c - nn - ss);
+        const int32_t green_h = (2 * (w + e) + 2 * c - ww - ee + 2) >> 2;
+        const int32_t green_v = (2 * (n + so) + 2 * c - nn - ss + 2) >> 2;
+        int32_t green;
+        if (grad_h < grad_v) {
+            green = green_h;
+        } else if (grad_v < grad_h) {
+            green = green_v;
+        } else {
+            green = (green_h + green_v + 1) >> 1;
+        }
+        rgb[1] = clamp_u8(green);
+        row_colour = c;
+        other_colour = (12 * c + 4 * diag - 3 * (nn + ss + ww + ee) + 8) >> 4;
+    }
+    rgb[0] = clamp_u8(row_is_red ? row_colour : other_colour);
+    rgb[2] = clamp_u8(row_is_red ? other_colour : row_colour);
+}
+
+/* Mirrors a coordinate into [0, size) without repeating the edge, which keeps the Bayer phase. */
+static inline int mirror(int v, int size)
+{
+    if (v < 0) {
+        return -v;
+    }
+    if (v >= size) {
+        return 2 * (size - 1) - v;
+    }
+    return v;
+}
+
+static void demosaic_pixel(const demosaic_frame* frame, demosaic_method method,
+                           int x, int y, uint8_t rgb[3])
+{
+    const cfa_kind kind = cfa_kind_at(frame, x, y);
+    const bool row_is_red = cfa_row_is_red(frame, y);
+
+    if (method == DEMOSAIC_SIMPLE) {
+        if (x >= frame->width - 1 || y >= frame->height - 1) {
+            rgb[0] = rgb[1] = rgb[2] = 0;
+        } else {
+            kernel_simple(frame->data + y * frame->width + x, frame->width, kind, row_is_red, rgb);
+        }
+        return;
+    }
+
+    const uint8_t* p;
+    int stride;
+    uint8_t patch[(2 * DEMOSAIC_MARGIN + 1) * (2 * DEMOSAIC_MARGIN + 1)];
+
+    if (x >= DEMOSAIC_MARGIN && x < frame->width - DEMOSAIC_MARGIN &&
+        y >= DEMOSAIC_MARGIN && y < frame->height - DEMOSAIC_MARGIN) {
+        stride = frame->width;
+        p = frame->data + y * stride + x;
+    } else {
+        stride = 2 * DEMOSAIC_MARGIN + 1;
+        for (int dy = -DEMOSAIC_MARGIN; dy <= DEMOSAIC_MARGIN; ++dy) {
+            const uint8_t* row = frame->data + mirror(y + dy, frame->height) * frame->width;
+            for (int dx = -DEMOSAIC_MARGIN; dx <= DEMOSAIC_MARGIN; ++dx) {
+                patch[(dy + DEMOSAIC_MARGIN) * stride + dx + DEMOSAIC_MARGIN] = row[mirror(x + dx, frame->width)];
+            }
+        }
+        p = patch + DEMOSAIC_MARGIN * stride + DEMOSAIC_MARGIN;
+    }
+
+    if (method == DEMOSAIC_BILINEAR) {
+        kernel_bilinear(p, stride, kind, row_is_red, rgb);
+    } else {
+        kernel_edge_aware(p, stride, kind, row_is_red, rgb);
+    }
+}
+
+static bool demosaic_row_valid(const demosaic_frame* frame, demosaic_method method,
+                               int y, int x_start, int x_end, const uint8_t* rgb)
+{
+    return frame && frame->data && rgb &&
+        frame->width > DEMOSAIC_MARGIN && frame->height > DEMOSAIC_MARGIN &&
+        (unsigned)frame->tile <= DEMOSAIC_TILE_BGGR &&
+        (unsigned)method <= DEMOSAIC_EDGE_AWARE &&
+        y >= 0 && y < frame->height &&
+        x_start >= 0 && x_start <= x_end && x_end <= frame->width;
+}
+
+int demosaic_row_reference(const demosaic_frame* frame, demosaic_method method,
+                           int y, int x_start, int x_end, uint8_t* rgb)
+{
+    if (!demosaic_row_valid(frame, method, y, x_start, x_end, rgb)) {
+        return -1;
+    }
+    for (int x = x_start; x < x_end; ++x, rgb += 3) {
+        demosaic_pixel(frame, method, x, y, rgb);
+    }
+    return 0;
+}
+
+#if DEMOSAIC_MVE
+/*
+ * The vector code works on 8 consecutive pixels in 16-bit lanes. Pixels
+ * alternate between green and non-green, so both formulas are evaluated
+ * and the result is selected per lane.
+ */
+static inline uint16x8_t mve_load(const uint8_t* p, mve_pred16_t pred)
+{
+    return vldrbq_z_u16(p, pred);
+}
+
+static inline int16x8_t mve_load_s(const uint8_t* p, mve_pred16_t pred)
+{
+    return vreinterpretq_s16_u16(vldrbq_z_u16(p, pred));
+}
+
+static inline uint16x8_t mve_clamp_u8(int16x8_t v)
+{
+    v = vmaxq_s16(v, vdupq_n_s16(0));
+    v = vminq_s16(v, vdupq_n_s16(255));
+    return vreinterpretq_u16_s16(v);
+}
+
+static void demosaic_row_mve(const demosaic_frame* frame, demosaic_method method,
+                             int y, int x_start, int x_end, uint8_t* rgb)
+{
+    const int s = frame->width;
+    const bool row_is_red = cfa_row_is_red(frame, y);
+    /* Lanes 0, 2, 4, 6 hold the pixels with the same phase as x_start. */
+    const mve_pred16_t start_phase = 0x3333;
+    const mve_pred16_t green = cfa_is_green(cfa_kind_at(frame, x_start, y)) ?
+        start_phase : (mve_pred16_t)~start_phase;
+    const uint16x8_t offsets = vmulq_n_u16(vidupq_n_u16(0, 1), 3);
+
+    const uint8_t* p = frame->data + y * s + x_start;
+    for (int n = x_end - x_start; n > 0; n -= 8, p += 8, rgb += 24) {
+        const mve_pred16_t pred = vctp16q(n);
+        uint16x8_t g, row_colour, other_colour;
+
+        if (method == DEMOSAIC_SIMPLE) {
+            const uint16x8_t a = mve_load(p, pred);
+            const uint16x8_t b = mve_load(p + 1, pred);
+            const uint16x8_t c = mve_load(p + s, pred);
+            const uint16x8_t d = mve_load(p + s + 1, pred);
+            g = vpselq_u16(vrhaddq_u16(a, d), vrhaddq_u16(b, c), green);
+            row_colour = vpselq_u16(b, a, green);
+            other_colour = vpselq_u16(c, d, green);
+        } else if (method == DEMOSAIC_BILINEAR) {
+            const uint16x8_t c = mve_load(p, pred);
+            const uint16x8_t w = mve_load(p - 1, pred);
+            const uint16x8_t e = mve_load(p + 1, pred);
+            const uint16x8_t n = mve_load(p - s, pred);
+            const uint16x8_t so = mve_load(p + s, pred);
+            const uint16x8_t cross = vrshrq_n_u16(vaddq_u16(vaddq_u16(n, so), vaddq_u16(w, e)), 2);
+            const uint16x8_t diag = vrshrq_n_u16(
+                vaddq_u16(vaddq_u16(mve_load(p - s - 1, pred), mve_load(p - s + 1, pred)),
+                          vaddq_u16(mve_load(p + s - 1, pred), mve_load(p + s + 1, pred))), 2);
+            g = vpselq_u16(c, cross, green);
+            row_colour = vpselq_u16(vrhaddq_u16(w, e), c, green);
+            other_colour = vpselq_u16(vrhaddq_u16(n, so), diag, green);
+        } else {
+            const int16x8_t c = mve_load_s(p, pred);
+            const int16x8_t w = mve_load_s(p - 1, pred);
+            const int16x8_t e = mve_load_s(p + 1, pred);
+            const int16x8_t ww = mve_load_s(p - 2, pred);
+            const int16x8_t ee = mve_load_s(p + 2, pred);
+            const int16x8_t n = mve_load_s(p - s, pred);
+            const int16x8_t so = mve_load_s(p + s, pred);
+            const int16x8_t nn = mve_load_s(p - 2 * s, pred);
+            const int16x8_t ss = mve_load_s(p + 2 * s, pred);
+            const int16x8_t diag = vaddq_s16(vaddq_s16(mve_load_s(p - s - 1, pred), mve_load_s(p - s + 1, pred)),
+                                             vaddq_s16(mve_load_s(p + s - 1, pred), mve_load_s(p + s + 1, pred)));
+            const int16x8_t c2 = vaddq_s16(c, c);
+            const int16x8_t h_outer = vaddq_s16(ww, ee);
+            const int16x8_t v_outer = vaddq_s16(nn, ss);
+            const int16x8_t h_inner = vaddq_s16(w, e);
+            const int16x8_t v_inner = vaddq_s16(n, so);
+
+            /* Green at red/blue samples, along the smoother direction. */
+            const int16x8_t h_laplace = vsubq_s16(c2, h_outer);
+            const int16x8_t v_laplace = vsubq_s16(c2, v_outer);
+            const int16x8_t grad_h = vaddq_s16(vabdq_s16(w, e), vabsq_s16(h_laplace));
+            const int16x8_t grad_v = vaddq_s16(vabdq_s16(n, so), vabsq_s16(v_laplace));
+            const int16x8_t green_h = vrshrq_n_s16(vaddq_s16(vaddq_s16(h_inner, h_inner), h_laplace), 2);
+            const int16x8_t green_v = vrshrq_n_s16(vaddq_s16(vaddq_s16(v_inner, v_inner), v_laplace), 2);
+            int16x8_t g_interp = vrhaddq_s16(green_h, green_v);
+            g_interp = vpselq_s16(green_v, g_interp, vcmpltq_s16(grad_v, grad_h));
+            g_interp = vpselq_s16(green_h, g_interp, vcmpltq_s16(grad_h, grad_v));
+
+            /* Red/blue at green samples: 10C + 8(in line) - 2(in line, outer) - 2 diag + (across, outer). */
+            const int16x8_t c10_diag = vsubq_s16(vmulq_n_s16(c, 10), vaddq_s16(diag, diag));
+            const int16x8_t along_row = vaddq_s16(vaddq_s16(c10_diag, vmulq_n_s16(h_inner, 8)),
+                                                  vsubq_s16(v_outer, vaddq_s16(h_outer, h_outer)));
+            const int16x8_t along_col = vaddq_s16(vaddq_s16(c10_diag, vmulq_n_s16(v_inner, 8)),
+                                                  vsubq_s16(h_outer, vaddq_s16(v_outer, v_outer)));
+            /* Blue at red and red at blue: 12C + 4 diag - 3(outer). */
+            const int16x8_t across = vsubq_s16(vaddq_s16(vmulq_n_s16(c, 12), vmulq_n_s16(diag, 4)),
+                                               vmulq_n_s16(vaddq_s16(h_outer, v_outer), 3));
+
+            g = vpselq_u16(vreinterpretq_u16_s16(c), mve_clamp_u8(g_interp), green);
+            row_colour = vpselq_u16(mve_clamp_u8(vrshrq_n_s16(along_row, 4)), vreinterpretq_u16_s16(c), green);
+            other_colour = vpselq_u16(mve_clamp_u8(vrshrq_n_s16(along_col, 4)),
+                                      mve_clamp_u8(vrshrq_n_s16(across, 4)), green);
+        }
+
+        vstrbq_scatter_offset_p_u16(rgb, offsets, row_is_red ? row_colour : other_colour, pred);
+        vstrbq_scatter_offset_p_u16(rgb + 1, offsets, g, pred);
+        vstrbq_scatter_offset_p_u16(rgb + 2, offsets, row_is_red ? other_colour : row_colour, pred);
+    }
+}
+#endif /* DEMOSAIC_MVE */
+
+int demosaic_row(const demosaic_frame* frame, demosaic_method method,
+                 int y, int x_start, int x_end, uint8_t* rgb)
+{
+#if DEMOSAIC_MVE
+    if (!demosaic_row_valid(frame, method, y, x_start, x_end, rgb)) {
+        return -1;
+    }
+
+    /* Range where the kernels need no border handling. */
+    const int margin = (method == DEMOSAIC_SIMPLE) ? 0 : DEMOSAIC_MARGIN;
+    const int x_lo = margin;
+    const int x_hi = (method == DEMOSAIC_SIMPLE) ? frame->width - 1 : frame->width - margin;
+    const bool row_inside = (method == DEMOSAIC_SIMPLE) ?
+        (y < frame->height - 1) : (y >= margin && y < frame->height - margin);
+
+    if (!row_inside || x_end <= x_lo || x_start >= x_hi) {
+        return demosaic_row_reference(frame, method, y, x_start, x_end, rgb);
+    }
+
+    const int vec_start = x_start > x_lo ? x_start : x_lo;
+    const int vec_end = x_end < x_hi ? x_end : x_hi;
+    demosaic_row_reference(frame, method, y, x_start, vec_start, rgb);
+    demosaic_row_mve(frame, method, y, vec_start, vec_end, rgb + (vec_start - x_start) * 3);
+    demosaic_row_reference(frame, method, y, vec_end, x_end, rgb + (vec_end - x_start) * 3);
+    return 0;
+#else
+    return demosaic_row_reference(frame, method, y, x_start, x_end, rgb);
+#endif /* DEMOSAIC_MVE */
+}
+
+int demosaic_image(const demosaic_frame* frame, demosaic_method method, uint8_t* rgb)
+{
+    if (!frame) {
+        return -1;
+    }
+    for (int y = 0; y < frame->height; ++y) {
+        if (demosaic_row(frame, method, y, 0, frame->width, rgb + y * frame->width * 3) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int demosaic_crop_resize(const demosaic_frame* frame, demosaic_method method,
+                         int crop_x, int crop_y, int crop_width, int crop_height,
+                         uint8_t* rgb, int dst_width, int dst_height,
+                         const ccm_params* ccm, uint8_t* scratch)
+{
+#define FRAC_BITS 14
+    const uint32_t FRAC_VAL = (1 << FRAC_BITS);
+    const uint32_t FRAC_MASK = (FRAC_VAL - 1);
+
+    if (!frame || !rgb || !scratch ||
+        crop_x < 0 || crop_y < 0 || crop_width < 1 || crop_height < 2 ||
+        dst_width < 1 || dst_height < 1 ||
+        crop_x > frame->width - crop_width || crop_y > frame->height - crop_height) {
+        return -1;
+    }
+
+    /* The filter reads one column past the crop window when available. */
+    const int cols = (crop_x + crop_width < frame->width) ? crop_width + 1 : crop_width;
+    uint8_t* rows[2] = {scratch, scratch + cols * 3};
+    int row_index[2] = {-1, -1};
+
+    const uint32_t src_x_frac = (crop_width * FRAC_VAL) / dst_width;
+    const uint32_t src_y_frac = (crop_height * FRAC_VAL) / dst_height;
+
+    // start at 1/2 pixel in to account for integer downsampling which might miss pixels
+    uint32_t src_y_accum = FRAC_VAL / 2;
+    for (int y = 0; y < dst_height; y++) {
+        const int ty = crop_y + (int)(src_y_accum >> FRAC_BITS);
+        const int ty1 = (ty + 1 < frame->height) ? ty + 1 : ty;
+        const uint32_t y_frac = src_y_accum & FRAC_MASK;
+        const uint32_t ny_frac = FRAC_VAL - y_frac;
+        src_y_accum += src_y_frac;
+
+        /* Keep the two source rows around; moving down by one row reuses the lower one. */
+        if (row_index[1] == ty) {
+            uint8_t* tmp = rows[0];
+            rows[0] = rows[1];
+            rows[1] = tmp;
+            row_index[0] = ty;
+            row_index[1] = -1;
+        }
+        for (int i = 0; i < 2; i++) {
+            const int want = i ? ty1 : ty;
+            if (row_index[i] != want) {
+                if (i == 1 && row_index[0] == want) {
+                    memcpy(rows[1], rows[0], cols * 3);
+                } else if (demosaic_row(frame, method, want, crop_x, crop_x + cols, rows[i]) != 0) {
+                    return -1;
+                }
+                row_index[i] = want;
+            }
+        }
+
+        const uint8_t* top = rows[0];
+        const uint8_t* bottom = rows[1];
+        uint32_t src_x_accum = FRAC_VAL / 2;
+        for (int x = 0; x < dst_width; x++) {
+            const int tx = (int)(src_x_accum >> FRAC_BITS);
+            const int tx1 = (tx + 1 < cols) ? tx + 1 : tx;
+            const uint32_t x_frac = src_x_accum & FRAC_MASK;
+            const uint32_t nx_frac = FRAC_VAL - x_frac;
+            src_x_accum += src_x_frac;
+
+            for (int color = 0; color < 3; color++) {
+                const uint32_t t = ((top[tx * 3 + color] * nx_frac) +
+                                    (top[tx1 * 3 + color] * x_frac) + FRAC_VAL / 2) >> FRAC_BITS;
+                const uint32_t b = ((bottom[tx * 3 + color] * nx_frac) +
+                                    (bottom[tx1 * 3 + color] * x_frac) + FRAC_VAL / 2) >> FRAC_BITS;
+                *rgb++ = (uint8_t)(((t * ny_frac) + (b * y_frac) + FRAC_VAL / 2) >> FRAC_BITS);
+            }
+        }
+        if (ccm) {
+            ccm_apply_rgb888(ccm, rgb - dst_width * 3, rgb - dst_width * 3, dst_width);
+        }
+    }
+#undef FRAC_BITS
+    return 0;
+}
+
+void demosaic_exposure_stats(const demosaic_frame* frame,
+                             int x, int y, int width, int height,
+                             uint8_t low_threshold, uint8_t high_threshold,
+                             demosaic_exposure* stats)
+{
+    uint32_t pairs = 0, under = 0, not_low = 0, high = 0, over = 0;
+    const int n_pairs = width / 2;
+
+    for (int row = y; row < y + height; ++row) {
+        const uint8_t* p = frame->data + row * frame->width + x;
+        int left = n_pairs;
+#if DEMOSAIC_MVE
+        /* Even samples in the bottom half of each 16-bit lane, odd in the top. */
+        for (; left > 0; left -= 8, p += 16) {
+            const mve_pred16_t pred = vctp16q(left);
+            const uint8x16_t v = vld1q_z_u8(p, vctp8q(2 * left));
+            const uint16x8_t even = vmovlbq_u8(v);
+            const uint16x8_t odd = vmovltq_u8(v);
+            const uint16x8_t max = vmaxq_u16(even, odd);
+            const uint16x8_t min = vminq_u16(even, odd);
+            const uint16x8_t one = vdupq_n_u16(1);
+            high = vaddvaq_p_u16(high, one, vcmpcsq_m_n_u16(max, high_threshold, pred));
+            over = vaddvaq_p_u16(over, one, vcmpeqq_m_n_u16(max, 255, pred));
+            not_low = vaddvaq_p_u16(not_low, one, vcmpcsq_m_n_u16(min, low_threshold, pred));
+            under = vaddvaq_p_u16(under, one, vcmpeqq_m_n_u16(min, 0, pred));
+        }
+        left = 0;
+#endif /* DEMOSAIC_MVE */
+        for (; left > 0; --left, p += 2) {
+            const uint8_t max = p[0] > p[1] ? p[0] : p[1];
+            const uint8_t min = p[0] < p[1] ? p[0] : p[1];
+            high += max >= high_threshold;
+            over += max == 255;
+            not_low += min >= low_threshold;
+            under += min == 0;
+        }
+        pairs += n_pairs;
+    }
+
+    stats->pixels = pairs * 2;
+    stats->under = under * 2;
+    stats->low = (pairs - not_low) * 2;
+    stats->high = high * 2;
+    stats->over = over * 2;
+}
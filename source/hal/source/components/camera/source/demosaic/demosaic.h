@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HAL_CAMERA_DEMOSAIC_H
+#define HAL_CAMERA_DEMOSAIC_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // defined(__cplusplus)
+
+#include <stdint.h>
+
+#include "ccm.h"
+
+/**< Colour of the top-left 2x2 block of the Bayer pattern, in reading order. */
+typedef enum demosaic_tile_ {
+    DEMOSAIC_TILE_RGGB,
+    DEMOSAIC_TILE_GBRG,
+    DEMOSAIC_TILE_GRBG,
+    DEMOSAIC_TILE_BGGR
+} demosaic_tile;
+
+typedef enum demosaic_method_ {
+    /* Each pixel from the 2x2 block to its bottom right, as dc1394_bayer_Simple.
+     * The last row and column are black. */
+    DEMOSAIC_SIMPLE,
+    /* Missing colours are the average of the nearest samples of that colour. */
+    DEMOSAIC_BILINEAR,
+    /* Green is interpolated along the direction with the smaller gradient
+     * (Hamilton-Adams), red and blue use gradient-corrected linear
+     * interpolation (Malvar-He-Cutler). */
+    DEMOSAIC_EDGE_AWARE
+} demosaic_method;
+
+/**< Bayer frame, 8 bits per sample, rows packed without padding. */
+typedef struct demosaic_frame_ {
+    const uint8_t* data;
+    int width;
+    int height;
+    demosaic_tile tile;
+} demosaic_frame;
+
+/**< Exposure statistics in raw pixels. Samples are taken as horizontal pairs:
+ *   a pair is high/over if either sample is, and low/under likewise. */
+typedef struct demosaic_exposure_ {
+    uint32_t pixels;    /* Pixels covered by the statistics. */
+    uint32_t under;     /* Pixels in pairs containing a 0. */
+    uint32_t low;       /* Pixels in pairs with a sample below the low threshold. */
+    uint32_t high;      /* Pixels in pairs with a sample at or above the high threshold. */
+    uint32_t over;      /* Pixels in pairs containing a 255. */
+} demosaic_exposure;
+
+/**
+ * @brief   Converts part of one row of a Bayer frame to RGB888. Uses the MVE
+ *          implementation when available.
+ * @param[in]   frame       Source frame.
+ * @param[in]   method      Demosaic algorithm.
+ * @param[in]   y           Row to convert.
+ * @param[in]   x_start     First column to convert.
+ * @param[in]   x_end       One past the last column to convert.
+ * @param[out]  rgb         Output, (x_end - x_start) * 3 bytes.
+ * @return  0 on success, -1 for invalid arguments.
+ */
+int demosaic_row(const demosaic_frame* frame, demosaic_method method,
+                 int y, int x_start, int x_end, uint8_t* rgb);
+
+/**
+ * @brief   Portable scalar implementation of demosaic_row(), used for image
+ *          borders and as the reference for the vector code.
+ */
+int demosaic_row_reference(const demosaic_frame* frame, demosaic_method method,
+                           int y, int x_start, int x_end, uint8_t* rgb);
+
+/**
+ * @brief   Converts a full Bayer frame to RGB888.
+ * @param[out]  rgb     Output, width * height * 3 bytes.
+ * @return  0 on success, -1 for invalid arguments.
+ */
+int demosaic_image(const demosaic_frame* frame, demosaic_method method, uint8_t* rgb);
+
+/**
+ * @brief   Converts only a crop window of a Bayer frame, scaling it to
+ *          dst_width x dst_height RGB888 with bilinear interpolation. The
+ *          result matches demosaic_image() followed by cropping and
+ *          resizing with 14-bit fixed point steps starting half a pixel in.
+ * @param[in]   ccm         Colour correction applied to each output row while
+ *                          it is in cache, or NULL for none.
+ * @param[in]   scratch     Two rows of the crop window: (crop_width + 1) * 6 bytes.
+ * @return  0 on success, -1 for invalid arguments.
+ */
+int demosaic_crop_resize(const demosaic_frame* frame, demosaic_method method,
+                         int crop_x, int crop_y, int crop_width, int crop_height,
+                         uint8_t* rgb, int dst_width, int dst_height,
+                         const ccm_params* ccm, uint8_t* scratch);
+
+/**
+ * @brief   Gathers exposure statistics over a window of a Bayer frame,
+ *          separately from demosaicing.
+ * @param[in]   low_threshold   Samples below this are low.
+ * @param[in]   high_threshold  Samples at or above this are high.
+ * @param[out]  stats           Statistics for the window.
+ */
+void demosaic_exposure_stats(const demosaic_frame* frame,
+                             int x, int y, int width, int height,
+                             uint8_t low_threshold, uint8_t high_threshold,
+                             demosaic_exposure* stats);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+#endif /* HAL_CAMERA_DEMOSAIC_H */
@@ -0,0 +1,175 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "frame_file.h"
+#include "log_macros.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+/**< Index conversion parsed from a pattern. */
+typedef struct frame_file_conversion_ {
+    const char* end;            /* First character after the conversion. */
+    bool zero_pad;
+    bool left_align;
+    uint32_t width;
+} frame_file_conversion;
+
+/**
+ * @brief   Parses the conversion starting at a '%' character.
+ * @return  true for "%%" or a supported index conversion; conv->end is NULL
+ *          for "%%".
+ */
+static bool frame_file_parse_conversion(const char* p, frame_file_conversion* conv)
+{
+    memset(conv, 0, sizeof(*conv));
+    ++p;
+    if (*p == '%') {
+        return true;
+    }
+    for (; *p == '0' || *p == '-'; ++p) {
+        conv->zero_pad |= (*p == '0');
+        conv->left_align |= (*p == '-');
+    }
+    for (; *p >= '0' && *p <= '9'; ++p) {
+        conv->width = conv->width * 10 + (uint32_t)(*p - '0');
+        if (conv->width > 32) {
+            return false;
+        }
+    }
+    if (*p != 'u' && *p != 'd' && *p != 'i') {
+        return false;
+    }
+    conv->end = p + 1;
+    return true;
+}
+
+int frame_file_pattern_check(const char* path)
+{
+    int conversions = 0;
+    for (const char* p = path; *p != '\0'; ++p) {
+        if (*p != '%') {
+            continue;
+        }
+        frame_file_conversion conv;
+        if (!frame_file_parse_conversion(p, &conv)) {
+            return -1;
+        }
+        if (conv.end) {
+            ++conversions;
+            p = conv.end - 1;
+        } else {
+            ++p;    /* Skip the second '%' of "%%". */
+        }
+    }
+    return conversions > 1 ? -1 : conversions;
+}
+
+bool frame_file_pattern_name(char* dst, size_t dst_size, const char* pattern, uint32_t index)
+{
+    size_t n = 0;
+    for (const char* p = pattern; *p != '\0'; ++p) {
+        char field[48];
+        size_t field_len = 1;
+        field[0] = *p;
+
+        if (*p == '%') {
+            frame_file_conversion conv;
+            if (!frame_file_parse_conversion(p, &conv)) {
+                return false;
+            }
+            if (!conv.end) {
+                ++p;
+            } else {
+                char digits[12];
+                const size_t n_digits = (size_t)snprintf(digits, sizeof(digits), "%" PRIu32, index);
+                const size_t pad = conv.width > n_digits ? conv.width - n_digits : 0;
+                const char fill = (conv.zero_pad && !conv.left_align) ? '0' : ' ';
+                if (conv.left_align) {
+                    memcpy(field, digits, n_digits);
+                    memset(field + n_digits, fill, pad);
+                } else {
+                    memset(field, fill, pad);
+                    memcpy(field + pad, digits, n_digits);
+                }
+                field_len = pad + n_digits;
+                p = conv.end - 1;
+            }
+        }
+
+        if (n + field_len >= dst_size) {
+            return false;
+        }
+        memcpy(dst + n, field, field_len);
+        n += field_len;
+    }
+    if (n >= dst_size) {
+        return false;
+    }
+    dst[n] = '\0';
+    return true;
+}
+
+/** Reads an unsigned decimal PPM header field, skipping whitespace and comments. */
+static bool ppm_read_field(FILE* f, uint32_t* value)
+{
+    int c = fgetc(f);
+    while (c == '#' || c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = fgetc(f);
+            }
+        }
+        c = fgetc(f);
+    }
+    if (c < '0' || c > '9') {
+        return false;
+    }
+    *value = 0;
+    while (c >= '0' && c <= '9') {
+        if (*value > (UINT32_MAX - 9) / 10) {
+            return false;
+        }
+        *value = *value * 10 + (uint32_t)(c - '0');
+        c = fgetc(f);
+    }
+    /* Exactly one whitespace character separates the header from the data. */
+    return c != EOF;
+}
+
+frame_file_ppm_status frame_file_read_ppm_header(FILE* f, uint32_t* width, uint32_t* height)
+{
+    char magic[2];
+    uint32_t maxval;
+    const size_t n_magic = fread(magic, 1, sizeof(magic), f);
+    if (n_magic == 0) {
+        return FRAME_FILE_PPM_END;
+    }
+    if (n_magic != sizeof(magic) || magic[0] != 'P' || magic[1] != '6' ||
+        !ppm_read_field(f, width) || !ppm_read_field(f, height) ||
+        !ppm_read_field(f, &maxval) || maxval != 255) {
+        printf_err("Unsupported PPM frame; only 8-bit P6 is supported\n");
+        return FRAME_FILE_PPM_INVALID;
+    }
+    /* Keeps width * height * 3 within 32 bits for the callers. */
+    if (*width == 0 || *height == 0 || *width > 0xFFFF || *height > 0xFFFF ||
+        (uint64_t)*width * *height * 3 > UINT32_MAX) {
+        printf_err("Invalid PPM frame size: %" PRIu32 "x%" PRIu32 "\n", *width, *height);
+        return FRAME_FILE_PPM_INVALID;
+    }
+    return FRAME_FILE_PPM_OK;
+}
@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef FRAME_FILE_H
+#define FRAME_FILE_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // defined(__cplusplus)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**< Result of reading a PPM image header. */
+typedef enum frame_file_ppm_status_ {
+    FRAME_FILE_PPM_OK = 0,      /* Header read; the pixel data follows. */
+    FRAME_FILE_PPM_END,         /* No more images in the file. */
+    FRAME_FILE_PPM_INVALID,     /* Not an 8-bit binary (P6) PPM image. */
+} frame_file_ppm_status;
+
+/**
+ * @brief       Checks a frame file path for a printf-style index conversion.
+ * @details     A pattern holds exactly one decimal conversion (%u, %d or %i,
+ *              with an optional 0 or - flag and a width), e.g.
+ *              "frames/img_%04u.ppm". Any other '%' must be written as "%%".
+ * @param[in]   path    Frame file path or pattern.
+ * @return      1 for a pattern, 0 for a plain path with no conversions and
+ *              -1 if the path has unsupported or more than one conversion.
+ */
+int frame_file_pattern_check(const char* path);
+
+/**
+ * @brief       Builds the name of a file in a pattern sequence. The pattern
+ *              is expanded here rather than used as a format string.
+ * @param[out]  dst         Destination for the file name.
+ * @param[in]   dst_size    Size of the destination, in bytes.
+ * @param[in]   pattern     Pattern accepted by frame_file_pattern_check.
+ * @param[in]   index       Index of the file in the sequence.
+ * @return      true if the name fits in the destination, false otherwise.
+ */
+bool frame_file_pattern_name(char* dst, size_t dst_size, const char* pattern, uint32_t index);
+
+/**
+ * @brief       Reads the header of the next PPM image in a file.
+ * @param[in]   f       File positioned at the start of an image.
+ * @param[out]  width   Image width in pixels.
+ * @param[out]  height  Image height in pixels.
+ * @return      FRAME_FILE_PPM_OK if the file is positioned at the pixel data
+ *              of a non-empty 8-bit P6 image, FRAME_FILE_PPM_END at the end of
+ *              the file and FRAME_FILE_PPM_INVALID otherwise.
+ */
+frame_file_ppm_status frame_file_read_ppm_header(FILE* f, uint32_t* width, uint32_t* height);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+#endif /* FRAME_FILE_H */
@@ -0,0 +1,500 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hal_camera.h"
+#include "hal_camera_file.h"
+#include "frame_file.h"
+#include "hal_audio_file.h"     /* File stream clock helpers. */
+#include "log_macros.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(HAL_CAMERA_FILE_PATH)
+#define HAL_CAMERA_FILE_PATH ""
+#endif /* HAL_CAMERA_FILE_PATH */
+
+#if !defined(HAL_CAMERA_FILE_FPS)
+#define HAL_CAMERA_FILE_FPS (30)
+#endif /* HAL_CAMERA_FILE_FPS */
+
+#if !defined(HAL_CAMERA_FILE_WIDTH)
+#define HAL_CAMERA_FILE_WIDTH (0)
+#endif /* HAL_CAMERA_FILE_WIDTH */
+
+#if !defined(HAL_CAMERA_FILE_HEIGHT)
+#define HAL_CAMERA_FILE_HEIGHT (0)
+#endif /* HAL_CAMERA_FILE_HEIGHT */
+
+#define PATH_MAX_LEN (512)
+
+/**< Source frame encodings, chosen from the file extension. */
+typedef enum hal_cam_file_format_ {
+    HAL_CAMERA_FILE_PPM = 0,    /* Binary PPM (P6), one or more images per file. */
+    HAL_CAMERA_FILE_RGB888,     /* Headerless packed RGB888 frames. */
+    HAL_CAMERA_FILE_BAYER,      /* Headerless 8-bit GRBG Bayer frames. */
+} hal_cam_file_format;
+
+typedef struct hal_camera_device_ {
+    char name[32];
+    char path[PATH_MAX_LEN];
+    bool is_pattern;            /* Path is a printf-style pattern with one frame per file. */
+    hal_cam_file_format file_format;
+    FILE* file;
+    uint32_t file_index;        /* Index of the open file for patterns. */
+    uint32_t src_width;
+    uint32_t src_height;
+    uint8_t* src_frame;         /* Raw source frame as read from disk. */
+    uint32_t src_frame_cap;
+    uint32_t frame_width;
+    uint32_t frame_height;
+    uint32_t bytes_per_frame;
+    uint8_t* output_buffer;
+    bool own_buffer;
+    hal_cam_clr_format format;
+    hal_cam_mode mode;
+    hal_cam_status status;
+    bool realtime;
+    uint32_t fps;
+    uint64_t start_ns;
+    uint64_t frame_pos;         /* Frames consumed or dropped since start. */
+    hal_camera_file_stats stats;
+    hal_camera_frame_ready_callback ready_callback;
+} hal_cam_dev;
+
+static hal_cam_dev dev;
+
+static void hal_camera_close_file(void)
+{
+    if (dev.file) {
+        fclose(dev.file);
+        dev.file = NULL;
+    }
+}
+
+static void hal_camera_reset(void)
+{
+    hal_camera_close_file();
+    if (dev.own_buffer) {
+        free(dev.output_buffer);
+    }
+    free(dev.src_frame);
+    memset(&dev, 0, sizeof(dev));
+    dev.status = HAL_CAMERA_STATUS_INVALID;
+    strncpy(dev.name, "Frame file stream", sizeof(dev.name));
+    dev.format = HAL_CAMERA_COLOUR_FORMAT_INVALID;
+    dev.mode = HAL_CAMERA_MODE_INVALID;
+}
+
+static const char* env_or_default(const char* env, const char* fallback)
+{
+    const char* value = getenv(env);
+    return (value && value[0] != '\0') ? value : fallback;
+}
+
+static hal_cam_file_format format_from_path(const char* path)
+{
+    const char* ext = strrchr(path, '.');
+    if (ext && (strcmp(ext, ".bayer") == 0 || strcmp(ext, ".raw8") == 0)) {
+        return HAL_CAMERA_FILE_BAYER;
+    }
+    if (ext && (strcmp(ext, ".rgb") == 0 || strcmp(ext, ".raw") == 0)) {
+        return HAL_CAMERA_FILE_RGB888;
+    }
+    return HAL_CAMERA_FILE_PPM;
+}
+
+/**
+ * @brief   Opens the next file for pattern sources, or rewinds the
+ *          single file once the end is reached.
+ * @return  true if a file is ready to be read from.
+ */
+static bool hal_camera_open_next(bool rewind)
+{
+    hal_camera_close_file();
+    if (rewind) {
+        dev.file_index = 0;
+    }
+
+    if (dev.is_pattern) {
+        char name[PATH_MAX_LEN];
+        if (!frame_file_pattern_name(name, sizeof(name), dev.path, dev.file_index)) {
+            return false;
+        }
+        dev.file = fopen(name, "rb");
+        ++dev.file_index;
+    } else {
+        dev.file = fopen(dev.path, "rb");
+    }
+    return dev.file != NULL;
+}
+
+static bool hal_camera_ensure_src(uint32_t width, uint32_t height, uint32_t bpp)
+{
+    const uint32_t size = width * height * bpp;
+    if (size > dev.src_frame_cap) {
+        uint8_t* p = (uint8_t*)realloc(dev.src_frame, size);
+        if (!p) {
+            printf_err("Failed to allocate source frame\n");
+            return false;
+        }
+        dev.src_frame = p;
+        dev.src_frame_cap = size;
+    }
+    dev.src_width = width;
+    dev.src_height = height;
+    return true;
+}
+
+/** Reads one frame from the current file; returns false at end of file. */
+static bool hal_camera_read_frame_from_file(void)
+{
+    if (!dev.file) {
+        return false;
+    }
+
+    if (dev.file_format == HAL_CAMERA_FILE_PPM) {
+        uint32_t w, h;
+        if (frame_file_read_ppm_header(dev.file, &w, &h) != FRAME_FILE_PPM_OK ||
+            !hal_camera_ensure_src(w, h, 3)) {
+            return false;
+        }
+        return fread(dev.src_frame, 1, w * h * 3, dev.file) == w * h * 3;
+    }
+
+    const uint32_t bpp = (dev.file_format == HAL_CAMERA_FILE_BAYER) ? 1 : 3;
+    const size_t size = (size_t)dev.src_width * dev.src_height * bpp;
+    return fread(dev.src_frame, 1, size, dev.file) == size;
+}
+
+/** Reads the next frame in the sequence, rewinding if looping is enabled. */
+static bool hal_camera_read_next_frame(void)
+{
+    if (hal_camera_read_frame_from_file()) {
+        return true;
+    }
+
+    if (dev.is_pattern && hal_camera_open_next(false) && hal_camera_read_frame_from_file()) {
+        return true;
+    }
+
+#if defined(HAL_CAMERA_LOOP)
+    if (hal_camera_open_next(true) && hal_camera_read_frame_from_file()) {
+        ++dev.stats.loops;
+        return true;
+    }
+#endif /* HAL_CAMERA_LOOP */
+    return false;
+}
+
+/** Fetches the RGB value of a source pixel, demosaicing Bayer data on the fly. */
+static void hal_camera_src_pixel(uint32_t x, uint32_t y, uint8_t rgb[3])
+{
+    if (dev.file_format != HAL_CAMERA_FILE_BAYER) {
+        const uint8_t* p = dev.src_frame + (y * dev.src_width + x) * 3;
+        rgb[0] = p[0];
+        rgb[1] = p[1];
+        rgb[2] = p[2];
+        return;
+    }
+
+    /* Simple 2x2 demosaic of the enclosing GRBG quad. */
+    const uint32_t qx = x & ~1u;
+    const uint32_t qy = y & ~1u;
+    const uint8_t* p = dev.src_frame + qy * dev.src_width + qx;
+    const uint8_t* n = (qy + 1 < dev.src_height) ? p + dev.src_width : p;
+    const uint32_t dx = (qx + 1 < dev.src_width) ? 1 : 0;
+    rgb[0] = p[dx];
+    rgb[1] = (uint8_t)((p[0] + n[dx] + 1) >> 1);
+    rgb[2] = n[0];
+}
+
+/** Scales the source frame (nearest neighbour) into the output buffer. */
+static void hal_camera_convert_frame(void)
+{
+    uint8_t* d = dev.output_buffer;
+    for (uint32_t y = 0; y < dev.frame_height; ++y) {
+        const uint32_t sy = (uint32_t)(((uint64_t)y * dev.src_height) / dev.frame_height);
+        for (uint32_t x = 0; x < dev.frame_width; ++x) {
+            const uint32_t sx = (uint32_t)(((uint64_t)x * dev.src_width) / dev.frame_width);
+            uint8_t rgb[3];
+            hal_camera_src_pixel(sx, sy, rgb);
+            if (dev.format == HAL_CAMERA_COLOUR_FORMAT_RGB565) {
+                const uint16_t v = (uint16_t)(((rgb[0] & 0xF8) << 8) |
+                                              ((rgb[1] & 0xFC) << 3) | (rgb[2] >> 3));
+                memcpy(d, &v, sizeof(v));
+                d += 2;
+            } else {
+                d[0] = rgb[0];
+                d[1] = rgb[1];
+                d[2] = rgb[2];
+                d += 3;
+            }
+        }
+    }
+}
+
+bool hal_camera_init(void)
+{
+    hal_camera_reset();
+    const char* path = env_or_default(HAL_CAMERA_FILE_ENV, HAL_CAMERA_FILE_PATH);
+    info("Initialising camera interface: %s (%s)\n", dev.name, path);
+    if (path[0] == '\0') {
+        printf_err("No frame file given; set %s\n", HAL_CAMERA_FILE_ENV);
+        return false;
+    }
+    /* The path is expanded by frame_file_pattern_name, never used as a format string. */
+    const int conversions = frame_file_pattern_check(path);
+    if (conversions < 0) {
+        printf_err("Invalid frame file pattern %s; use one %%u, %%d or %%i "
+                   "conversion and write any other '%%' as '%%%%'\n", path);
+        return false;
+    }
+    if (conversions == 0) {
+        /* Plain path; only "%%" escapes to expand. */
+        if (!frame_file_pattern_name(dev.path, sizeof(dev.path), path, 0)) {
+            printf_err("Frame file path is too long: %s\n", path);
+            return false;
+        }
+    } else {
+        strncpy(dev.path, path, sizeof(dev.path) - 1);
+    }
+    dev.is_pattern = conversions == 1;
+    dev.file_format = format_from_path(dev.path);
+    dev.fps = (uint32_t)atoi(env_or_default(HAL_CAMERA_FILE_FPS_ENV, ""));
+    if (dev.fps == 0) {
+        dev.fps = HAL_CAMERA_FILE_FPS;
+    }
+
+    if (!hal_camera_open_next(true)) {
+        printf_err("Failed to open %s\n", dev.path);
+        return false;
+    }
+    return true;
+}
+
+bool hal_camera_configure(const uint32_t width,
+                          const uint32_t height,
+                          const hal_cam_mode mode,
+                          const hal_cam_clr_format colour_format)
+{
+    if (HAL_CAMERA_STATUS_RUNNING == dev.status) {
+        printf_err("Camera is running; configuration failed\n");
+        return false;
+    }
+
+    if (mode != HAL_CAMERA_MODE_SINGLE_FRAME && mode != HAL_CAMERA_MODE_CONTINUOUS) {
+        printf_err("Unsupported camera mode\n");
+        return false;
+    }
+
+    switch (colour_format) {
+        case HAL_CAMERA_COLOUR_FORMAT_RGB888:
+            dev.bytes_per_frame = width * height * 3;
+            break;
+        case HAL_CAMERA_COLOUR_FORMAT_RGB565:
+            dev.bytes_per_frame = width * height * 2;
+            break;
+        default:
+            printf_err("Unsupported colour format\n");
+            return false;
+    }
+
+    if (dev.file_format != HAL_CAMERA_FILE_PPM) {
+        /* Headerless frames need their size from the configuration. */
+        uint32_t src_w = HAL_CAMERA_FILE_WIDTH ? HAL_CAMERA_FILE_WIDTH : width;
+        uint32_t src_h = HAL_CAMERA_FILE_HEIGHT ? HAL_CAMERA_FILE_HEIGHT : height;
+        const char* size = getenv(HAL_CAMERA_FILE_SIZE_ENV);
+        if (size && sscanf(size, "%" SCNu32 "x%" SCNu32, &src_w, &src_h) != 2) {
+            printf_err("Invalid %s: %s\n", HAL_CAMERA_FILE_SIZE_ENV, size);
+            return false;
+        }
+        const uint32_t bpp = (dev.file_format == HAL_CAMERA_FILE_BAYER) ? 1 : 3;
+        if (!hal_camera_ensure_src(src_w, src_h, bpp)) {
+            return false;
+        }
+    }
+
+    dev.frame_width = width;
+    dev.frame_height = height;
+    dev.mode = mode;
+    dev.format = colour_format;
+    dev.realtime = hal_file_stream_realtime();
+    dev.status = HAL_CAMERA_STATUS_STOPPED;
+
+    if (!dev.output_buffer || dev.own_buffer) {
+        if (dev.own_buffer) {
+            free(dev.output_buffer);
+        }
+        dev.output_buffer = (uint8_t*)malloc(dev.bytes_per_frame);
+        dev.own_buffer = true;
+        if (!dev.output_buffer) {
+            printf_err("Failed to allocate frame buffer\n");
+            hal_camera_reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hal_camera_set_buffer(uint8_t* buffer, const uint32_t size)
+{
+    if (!buffer || size < dev.bytes_per_frame) {
+        printf_err("Buffer size is too small\n");
+        return false;
+    }
+    if (dev.own_buffer) {
+        free(dev.output_buffer);
+    }
+    dev.output_buffer = buffer;
+    dev.own_buffer = false;
+    return true;
+}
+
+bool hal_camera_start(void)
+{
+    if (dev.status != HAL_CAMERA_STATUS_STOPPED) {
+        return false;
+    }
+    if (dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+        memset(&dev.stats, 0, sizeof(dev.stats));
+        dev.frame_pos = 0;
+        dev.start_ns = hal_file_stream_time_ns();
+    }
+    dev.status = HAL_CAMERA_STATUS_RUNNING;
+    return true;
+}
+
+/**
+ * @brief   Emulates a sensor producing frames at a fixed rate: waits for the
+ *          next frame to be exposed and skips frames that were overwritten
+ *          while the consumer was busy.
+ * @return  false if the sequence ended while skipping frames.
+ */
+static bool hal_camera_pace(void)
+{
+    const uint64_t elapsed = hal_file_stream_time_ns() - dev.start_ns;
+    const uint64_t due = (elapsed * dev.fps) / 1000000000ULL;
+
+    if (due < dev.frame_pos) {
+        ++dev.stats.waits;
+        hal_file_stream_sleep_until(dev.start_ns + (dev.frame_pos * 1000000000ULL) / dev.fps);
+        return true;
+    }
+
+    /* The most recently completed frame is delivered; older ones are lost. */
+    if (due > dev.frame_pos) {
+        ++dev.stats.overruns;
+        while (dev.frame_pos < due) {
+            if (!hal_camera_read_next_frame()) {
+                return false;
+            }
+            ++dev.frame_pos;
+            ++dev.stats.frames_dropped;
+        }
+    }
+    return true;
+}
+
+const uint8_t* hal_camera_get_captured_frame(uint32_t* size)
+{
+    *size = 0;
+    if (dev.status != HAL_CAMERA_STATUS_RUNNING) {
+        return NULL;
+    }
+
+    if (dev.mode == HAL_CAMERA_MODE_CONTINUOUS && dev.realtime && !hal_camera_pace()) {
+        dev.status = HAL_CAMERA_STATUS_STOPPED;
+        return NULL;
+    }
+
+    if (!hal_camera_read_next_frame()) {
+        info("End of frame sequence\n");
+        hal_camera_stop();
+        return NULL;
+    }
+    ++dev.frame_pos;
+    ++dev.stats.frames_delivered;
+
+    if (dev.mode == HAL_CAMERA_MODE_SINGLE_FRAME) {
+        dev.status = HAL_CAMERA_STATUS_STOPPED;
+    }
+
+    hal_camera_convert_frame();
+    *size = dev.bytes_per_frame;
+    return dev.output_buffer;
+}
+
+bool hal_camera_get_frame(hal_camera_frame* frame)
+{
+    memset(frame, 0, sizeof(*frame));
+    if (dev.mode == HAL_CAMERA_MODE_SINGLE_FRAME && !hal_camera_start()) {
+        return false;
+    }
+
+    const uint64_t dropped_before = dev.stats.frames_dropped;
+    frame->data = hal_camera_get_captured_frame(&frame->size);
+    if (!frame->data) {
+        return false;
+    }
+    frame->sequence = (uint32_t)(dev.frame_pos - 1);
+    frame->dropped = (uint32_t)(dev.stats.frames_dropped - dropped_before);
+    if (dev.ready_callback) {
+        dev.ready_callback(frame->sequence);
+    }
+    return true;
+}
+
+void hal_camera_set_frame_ready_callback(hal_camera_frame_ready_callback callback)
+{
+    dev.ready_callback = callback;
+}
+
+bool hal_camera_stop(void)
+{
+    if (dev.status == HAL_CAMERA_STATUS_RUNNING) {
+        dev.status = HAL_CAMERA_STATUS_STOPPED;
+        if (dev.mode == HAL_CAMERA_MODE_CONTINUOUS) {
+            info("Camera stream: %" PRIu64 " frames delivered, %" PRIu64 " dropped in "
+                 "%" PRIu32 " overruns, %" PRIu32 " waits, %" PRIu32 " loops\n",
+                 dev.stats.frames_delivered, dev.stats.frames_dropped,
+                 dev.stats.overruns, dev.stats.waits, dev.stats.loops);
+        }
+    }
+    return true;
+}
+
+hal_cam_status hal_camera_get_status(void)
+{
+    return dev.status;
+}
+
+void hal_camera_release(void)
+{
+    hal_camera_reset();
+}
+
+const char* hal_camera_get_device_name(void)
+{
+    return dev.name;
+}
+
+void hal_camera_file_get_stats(hal_camera_file_stats* stats)
+{
+    *stats = dev.stats;
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef HAL_CAMERA_FILE_H
+#define HAL_CAMERA_FILE_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif // defined(__cplusplus)
+
+#include <stdint.h>
+
+/**< Environment variable overriding the frame file or printf-style pattern. */
+#define HAL_CAMERA_FILE_ENV         "MLEK_CAMERA_FILE"
+
+/**< Environment variable overriding the raw/Bayer frame size, as "WxH". */
+#define HAL_CAMERA_FILE_SIZE_ENV    "MLEK_CAMERA_FILE_SIZE"
+
+/**< Environment variable overriding the continuous mode frame rate. */
+#define HAL_CAMERA_FILE_FPS_ENV     "MLEK_CAMERA_FILE_FPS"
+
+/**< Streaming statistics for the file backed camera device. */
+typedef struct hal_camera_file_stats_ {
+    uint64_t frames_delivered;  /* Frames handed to the consumer. */
+    uint64_t frames_dropped;    /* Frames skipped because the consumer fell behind (real-time only). */
+    uint32_t overruns;          /* Number of times frames were dropped. */
+    uint32_t waits;             /* Number of times the consumer waited for a frame (real-time only). */
+    uint32_t loops;             /* Number of times the sequence was rewound. */
+} hal_camera_file_stats;
+
+/**
+ * @brief   Gets the statistics for the file backed camera stream.
+ * @param[out]  stats   Statistics collected since the device was started.
+ */
+void hal_camera_file_get_stats(hal_camera_file_stats* stats);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+#endif /* HAL_CAMERA_FILE_H */
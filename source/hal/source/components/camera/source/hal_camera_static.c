@@ -29,6 +29,8 @@ typedef struct hal_camera_device_ {
     hal_cam_clr_format format;
     hal_cam_mode mode;
     hal_cam_status status;
+    uint32_t sequence;
+    hal_camera_frame_ready_callback ready_callback;
 } hal_cam_dev;
 
 static hal_cam_dev dev;
@@ -69,11 +71,6 @@ bool hal_camera_configure(const uint32_t width,
         return false;
     }
 
-    if (HAL_CAMERA_MODE_CONTINUOUS == mode) {
-        printf_err("Only single shot mode is supported\n");
-        return false;
-    }
-
     dev.frame_width = width;
     dev.frame_height = height;
     dev.mode = mode;
@@ -112,6 +109,7 @@ bool hal_camera_start(void)
 {
     if (dev.status == HAL_CAMERA_STATUS_STOPPED) {
         dev.status = HAL_CAMERA_STATUS_RUNNING;
+        dev.sequence = 0;
         return true;
     }
     return false;
@@ -122,7 +120,11 @@ const uint8_t* hal_camera_get_captured_frame(uint32_t* size)
     static uint32_t idx = 0;
     const uint8_t* buffer = NULL;
     *size = 0;
-    if (hal_camera_get_status() == HAL_CAMERA_STATUS_STOPPED) {
+    /* In continuous mode every call delivers the next sample image. */
+    if (dev.mode == HAL_CAMERA_MODE_CONTINUOUS && dev.status != HAL_CAMERA_STATUS_RUNNING) {
+        return buffer;
+    }
+    if (dev.mode == HAL_CAMERA_MODE_CONTINUOUS || hal_camera_get_status() == HAL_CAMERA_STATUS_STOPPED) {
         if (idx >= get_sample_n_elements()) {
 #if defined(HAL_CAMERA_LOOP)
             idx = 0;
@@ -139,6 +141,28 @@ const uint8_t* hal_camera_get_captured_frame(uint32_t* size)
     return buffer;
 }
 
+bool hal_camera_get_frame(hal_camera_frame* frame)
+{
+    memset(frame, 0, sizeof(*frame));
+    if (dev.mode == HAL_CAMERA_MODE_SINGLE_FRAME && !hal_camera_start()) {
+        return false;
+    }
+    frame->data = hal_camera_get_captured_frame(&frame->size);
+    if (!frame->data) {
+        return false;
+    }
+    frame->sequence = dev.sequence++;
+    if (dev.ready_callback) {
+        dev.ready_callback(frame->sequence);
+    }
+    return true;
+}
+
+void hal_camera_set_frame_ready_callback(hal_camera_frame_ready_callback callback)
+{
+    dev.ready_callback = callback;
+}
+
 bool hal_camera_stop(void)
 {
     if (dev.status == HAL_CAMERA_STATUS_RUNNING) {
@@ -151,7 +175,7 @@ hal_cam_status hal_camera_get_status(void)
 {
     /* Reading the status simulates a device finishing
      * frame capture. */
-    if (dev.status == HAL_CAMERA_STATUS_RUNNING) {
+    if (dev.status == HAL_CAMERA_STATUS_RUNNING && dev.mode != HAL_CAMERA_MODE_CONTINUOUS) {
         hal_camera_stop();
     }
     return dev.status;
@@ -30,6 +30,8 @@ typedef struct hal_camera_device_ {
     hal_cam_clr_format format;
     hal_cam_mode mode;
     hal_cam_status status;
+    uint32_t sequence;
+    hal_camera_frame_ready_callback ready_callback;
 } hal_cam_dev;
 
 /**< Static device used in this file. */
@@ -53,6 +55,7 @@ static void hal_camera_reset(void)
     s_vsi_dev.bytes_per_frame = 0;
     s_vsi_dev.format = HAL_CAMERA_COLOUR_FORMAT_INVALID;
     s_vsi_dev.mode = HAL_CAMERA_MODE_INVALID;
+    s_vsi_dev.sequence = 0;
     VideoDrv_Uninitialize();
 }
 
@@ -208,6 +211,35 @@ const uint8_t* hal_camera_get_captured_frame(uint32_t* size)
     return buffer;
 }
 
+bool hal_camera_get_frame(hal_camera_frame* frame)
+{
+    memset(frame, 0, sizeof(*frame));
+
+    /* Only single shot capture is supported by the VSI video driver, so
+     * the previous frame is released and a new capture triggered here. */
+    if (s_vsi_dev.status == HAL_CAMERA_STATUS_STOPPED) {
+        VideoDrv_ReleaseFrame(VIDEO_DRV_IN0);
+    }
+    if (!hal_camera_start()) {
+        return false;
+    }
+
+    frame->data = hal_camera_get_captured_frame(&frame->size);
+    if (!frame->data) {
+        return false;
+    }
+    frame->sequence = s_vsi_dev.sequence++;
+    if (s_vsi_dev.ready_callback) {
+        s_vsi_dev.ready_callback(frame->sequence);
+    }
+    return true;
+}
+
+void hal_camera_set_frame_ready_callback(hal_camera_frame_ready_callback callback)
+{
+    s_vsi_dev.ready_callback = callback;
+}
+
 bool hal_camera_stop(void)
 {
     if (s_vsi_dev.status == HAL_CAMERA_STATUS_RUNNING) {
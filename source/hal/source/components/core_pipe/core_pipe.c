@@ -0,0 +1,255 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core_pipe.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#define CORE_PIPE_VERSION   (1U)
+
+/* Shared memory layout, one cache line each: the header written once by the
+ * sender, the head index written by the sender and the tail index written
+ * by the receiver, followed by the slots. */
+#define HEAD_OFFSET     (1 * CORE_PIPE_LINE_SIZE)
+#define TAIL_OFFSET     (2 * CORE_PIPE_LINE_SIZE)
+#define SLOTS_OFFSET    (3 * CORE_PIPE_LINE_SIZE)
+
+typedef struct pipe_header_ {
+    uint16_t id;            /* CORE_PIPE_ID, where MHU payloads keep their id. */
+    uint16_t version;
+    uint32_t n_slots;
+    uint32_t slot_size;
+} pipe_header;
+
+/* Takes the first line of each slot. */
+typedef struct slot_desc_ {
+    uint32_t type;
+    uint32_t arg;
+    uint32_t seq;
+    uint32_t size;
+    uint32_t is_ref;        /* Payload is at ref rather than in the slot. */
+    uint32_t reserved;
+    uint64_t ref;
+} slot_desc;
+
+_Static_assert(sizeof(pipe_header) <= CORE_PIPE_LINE_SIZE, "Header must fit a cache line");
+_Static_assert(sizeof(slot_desc) <= CORE_PIPE_LINE_SIZE, "Descriptor must fit a cache line");
+
+static void clean(const core_pipe_ops* ops, const void* p, size_t bytes)
+{
+    if (ops && ops->clean && bytes) {
+        ops->clean(p, bytes);
+    }
+}
+
+static void invalidate(const core_pipe_ops* ops, const void* p, size_t bytes)
+{
+    if (ops && ops->invalidate && bytes) {
+        ops->invalidate(p, bytes);
+    }
+}
+
+static volatile uint32_t* head_index(const core_pipe* pipe)
+{
+    return (volatile uint32_t*)(pipe->shared + HEAD_OFFSET);
+}
+
+static volatile uint32_t* tail_index(const core_pipe* pipe)
+{
+    return (volatile uint32_t*)(pipe->shared + TAIL_OFFSET);
+}
+
+/* The indexes run freely and wrap at 2^32, which maps every index to the
+ * same slot as the one before it plus one only if n_slots divides 2^32. */
+static bool valid_slot_count(uint32_t n_slots)
+{
+    return 0 != n_slots && 0 == (n_slots & (n_slots - 1));
+}
+
+static uint8_t* slot_at(const core_pipe* pipe, uint32_t index)
+{
+    return pipe->shared + SLOTS_OFFSET +
+           (index & (pipe->n_slots - 1)) * CORE_PIPE_SLOT_STRIDE(pipe->slot_size);
+}
+
+/* Reads the index written by the other core. */
+static uint32_t read_index(const core_pipe* pipe, volatile uint32_t* index)
+{
+    invalidate(pipe->ops, (const void*)index, CORE_PIPE_LINE_SIZE);
+    const uint32_t value = *index;
+    atomic_thread_fence(memory_order_acquire);
+    return value;
+}
+
+/* Writes an index after everything it covers has been written. */
+static void write_index(const core_pipe* pipe, volatile uint32_t* index, uint32_t value)
+{
+    atomic_thread_fence(memory_order_release);
+    *index = value;
+    clean(pipe->ops, (const void*)index, CORE_PIPE_LINE_SIZE);
+}
+
+int core_pipe_create(core_pipe* pipe, void* mem, size_t mem_size,
+                     uint32_t n_slots, uint32_t slot_size, const core_pipe_ops* ops)
+{
+    if (!pipe || !mem || !valid_slot_count(n_slots) ||
+        0 != ((uintptr_t)mem & (CORE_PIPE_LINE_SIZE - 1)) ||
+        mem_size < CORE_PIPE_MEM_SIZE((size_t)n_slots, (size_t)slot_size)) {
+        return -1;
+    }
+
+    pipe->shared = (uint8_t*)mem;
+    pipe->n_slots = n_slots;
+    pipe->slot_size = slot_size;
+    pipe->ops = ops;
+
+    memset(mem, 0, SLOTS_OFFSET);
+    pipe_header* header = (pipe_header*)mem;
+    header->id = CORE_PIPE_ID;
+    header->version = CORE_PIPE_VERSION;
+    header->n_slots = n_slots;
+    header->slot_size = slot_size;
+    atomic_thread_fence(memory_order_release);
+    clean(ops, mem, SLOTS_OFFSET);
+    return 0;
+}
+
+bool core_pipe_is_pipe(const void* mem, const core_pipe_ops* ops)
+{
+    if (!mem || 0 != ((uintptr_t)mem & (CORE_PIPE_LINE_SIZE - 1))) {
+        return false;
+    }
+    invalidate(ops, mem, CORE_PIPE_LINE_SIZE);
+    const pipe_header* header = (const pipe_header*)mem;
+    return CORE_PIPE_ID == header->id && CORE_PIPE_VERSION == header->version &&
+           valid_slot_count(header->n_slots);
+}
+
+int core_pipe_attach(core_pipe* pipe, void* mem, const core_pipe_ops* ops)
+{
+    if (!pipe || !core_pipe_is_pipe(mem, ops)) {
+        return -1;
+    }
+    const pipe_header* header = (const pipe_header*)mem;
+    pipe->shared = (uint8_t*)mem;
+    pipe->n_slots = header->n_slots;
+    pipe->slot_size = header->slot_size;
+    pipe->ops = ops;
+    return 0;
+}
+
+void* core_pipe_acquire(core_pipe* pipe)
+{
+    const uint32_t head = *head_index(pipe);
+    if (head - read_index(pipe, tail_index(pipe)) >= pipe->n_slots) {
+        return NULL;
+    }
+    return slot_at(pipe, head) + CORE_PIPE_LINE_SIZE;
+}
+
+/* Fills in the descriptor of the next slot and publishes it. */
+static bool publish(core_pipe* pipe, uint32_t type, uint32_t size, uint32_t arg, const void* ref)
+{
+    const uint32_t head = *head_index(pipe);
+    if (head - read_index(pipe, tail_index(pipe)) >= pipe->n_slots) {
+        return false;
+    }
+
+    uint8_t* slot = slot_at(pipe, head);
+    slot_desc* desc = (slot_desc*)slot;
+    desc->type = type;
+    desc->arg = arg;
+    desc->seq = head;
+    desc->size = size;
+    desc->is_ref = ref ? 1 : 0;
+    desc->reserved = 0;
+    desc->ref = (uint64_t)(uintptr_t)ref;
+
+    clean(pipe->ops, slot, CORE_PIPE_LINE_SIZE);
+    clean(pipe->ops, ref ? ref : slot + CORE_PIPE_LINE_SIZE, size);
+    write_index(pipe, head_index(pipe), head + 1);
+
+    if (pipe->ops && pipe->ops->notify) {
+        pipe->ops->notify(pipe->shared, pipe->ops->notify_ctx);
+    }
+    return true;
+}
+
+bool core_pipe_publish(core_pipe* pipe, uint32_t type, uint32_t size, uint32_t arg)
+{
+    if (size > pipe->slot_size) {
+        return false;
+    }
+    return publish(pipe, type, size, arg, NULL);
+}
+
+bool core_pipe_send(core_pipe* pipe, uint32_t type, const void* data, uint32_t size, uint32_t arg)
+{
+    if (size > pipe->slot_size) {
+        return false;
+    }
+    void* payload = core_pipe_acquire(pipe);
+    if (!payload) {
+        return false;
+    }
+    if (size) {
+        memcpy(payload, data, size);
+    }
+    return publish(pipe, type, size, arg, NULL);
+}
+
+bool core_pipe_send_ref(core_pipe* pipe, uint32_t type, const void* data, uint32_t size, uint32_t arg)
+{
+    if (!data) {
+        return false;
+    }
+    return publish(pipe, type, size, arg, data);
+}
+
+bool core_pipe_receive(core_pipe* pipe, core_pipe_msg* msg)
+{
+    const uint32_t tail = *tail_index(pipe);
+    if (read_index(pipe, head_index(pipe)) == tail) {
+        return false;
+    }
+
+    const uint8_t* slot = slot_at(pipe, tail);
+    invalidate(pipe->ops, slot, CORE_PIPE_LINE_SIZE);
+    const slot_desc* desc = (const slot_desc*)slot;
+
+    msg->type = desc->type;
+    msg->arg = desc->arg;
+    msg->seq = desc->seq;
+    msg->size = desc->size;
+    msg->data = desc->is_ref ? (const void*)(uintptr_t)desc->ref : slot + CORE_PIPE_LINE_SIZE;
+    invalidate(pipe->ops, msg->data, msg->size);
+    return true;
+}
+
+void core_pipe_release(core_pipe* pipe)
+{
+    const uint32_t tail = *tail_index(pipe);
+    if (read_index(pipe, head_index(pipe)) == tail) {
+        return;
+    }
+    write_index(pipe, tail_index(pipe), tail + 1);
+}
+
+uint32_t core_pipe_pending(core_pipe* pipe)
+{
+    return read_index(pipe, head_index(pipe)) - read_index(pipe, tail_index(pipe));
+}
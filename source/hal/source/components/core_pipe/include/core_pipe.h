@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CORE_PIPE_H
+#define CORE_PIPE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * One-way message pipe between two cores sharing memory.
+ *
+ * The shared memory holds a ring of slots, each made of a descriptor and a
+ * payload area. The sending core fills a slot in place and publishes it,
+ * which rings the other core's doorbell; the receiving core reads the
+ * slot in place and releases it. Each side only ever writes its own cache
+ * lines: the sender the slots and the head index, the receiver the tail
+ * index. Send messages both ways with two pipes.
+ */
+
+#define CORE_PIPE_LINE_SIZE     (32U)       /**< Cache line size in bytes. */
+#define CORE_PIPE_ID            (0x5049U)   /**< First 16 bits of the shared memory. */
+
+/** Bytes taken by each slot for the given payload size. */
+#define CORE_PIPE_SLOT_STRIDE(slot_size) \
+    (CORE_PIPE_LINE_SIZE + (((slot_size) + CORE_PIPE_LINE_SIZE - 1) & ~(CORE_PIPE_LINE_SIZE - 1)))
+
+/** Bytes of shared memory needed for a pipe. */
+#define CORE_PIPE_MEM_SIZE(n_slots, slot_size) \
+    (3 * CORE_PIPE_LINE_SIZE + (n_slots) * CORE_PIPE_SLOT_STRIDE(slot_size))
+
+/** Memory operations of one core. */
+typedef struct core_pipe_ops_ {
+    /* Cache maintenance, NULL if the shared memory is not cached. */
+    void (*clean)(const void* p, size_t bytes);
+    void (*invalidate)(const void* p, size_t bytes);
+
+    /* Rings the other core's doorbell, NULL if the other core polls. */
+    void (*notify)(void* shared, void* ctx);
+    void* notify_ctx;
+} core_pipe_ops;
+
+/** Message as seen by the receiving core. */
+typedef struct core_pipe_msg_ {
+    uint32_t type;      /**< Application defined. */
+    uint32_t arg;       /**< Application defined. */
+    uint32_t seq;       /**< Counts the messages sent, from 0. */
+    uint32_t size;      /**< Payload size in bytes. */
+    const void* data;   /**< Payload, valid until the message is released. */
+} core_pipe_msg;
+
+/** View of a pipe from one core. */
+typedef struct core_pipe_ {
+    uint8_t* shared;            /**< Shared memory. */
+    uint32_t n_slots;
+    uint32_t slot_size;         /**< Payload bytes per slot. */
+    const core_pipe_ops* ops;
+} core_pipe;
+
+/**
+ * @brief       Sets up a pipe in shared memory, on the sending core.
+ * @param[out]  pipe        Pipe to initialise.
+ * @param[in]   mem         Shared memory, aligned to CORE_PIPE_LINE_SIZE.
+ * @param[in]   mem_size    Size of the memory, at least CORE_PIPE_MEM_SIZE(n_slots, slot_size).
+ * @param[in]   n_slots     Number of messages that can be in flight, a power of two.
+ * @param[in]   slot_size   Maximum payload size of messages copied into the pipe.
+ * @param[in]   ops         Memory operations of this core.
+ * @return      0 if successful, -1 if the memory or number of slots is not suitable.
+ */
+int core_pipe_create(core_pipe* pipe, void* mem, size_t mem_size,
+                     uint32_t n_slots, uint32_t slot_size, const core_pipe_ops* ops);
+
+/**
+ * @brief       Opens a pipe created by the other core, on the receiving core.
+ * @param[out]  pipe    Pipe to initialise.
+ * @param[in]   mem     Shared memory passed to core_pipe_create().
+ * @param[in]   ops     Memory operations of this core.
+ * @return      0 if successful, -1 if there is no pipe in the memory.
+ */
+int core_pipe_attach(core_pipe* pipe, void* mem, const core_pipe_ops* ops);
+
+/**
+ * @brief       Checks if memory holds a pipe, e.g. to tell pipe doorbells
+ *              apart from other messages.
+ */
+bool core_pipe_is_pipe(const void* mem, const core_pipe_ops* ops);
+
+/**
+ * @brief       Gets the payload area of the next slot to fill in place.
+ * @return      Payload area of slot_size bytes, NULL if the pipe is full.
+ */
+void* core_pipe_acquire(core_pipe* pipe);
+
+/**
+ * @brief       Publishes the slot returned by core_pipe_acquire() and rings
+ *              the doorbell.
+ * @return      true if published, false if the pipe is full or size is
+ *              larger than the slot.
+ */
+bool core_pipe_publish(core_pipe* pipe, uint32_t type, uint32_t size, uint32_t arg);
+
+/**
+ * @brief       Copies a payload into the next slot and publishes it.
+ * @return      true if sent, false if the pipe is full or size is larger
+ *              than the slot.
+ */
+bool core_pipe_send(core_pipe* pipe, uint32_t type, const void* data, uint32_t size, uint32_t arg);
+
+/**
+ * @brief       Publishes a message whose payload stays in a buffer of the
+ *              sender, for payloads too large to copy. The buffer must be
+ *              addressable by the other core at the same address, start on
+ *              a cache line and not be written until the message is
+ *              released.
+ * @return      true if sent, false if the pipe is full.
+ */
+bool core_pipe_send_ref(core_pipe* pipe, uint32_t type, const void* data, uint32_t size, uint32_t arg);
+
+/**
+ * @brief       Gets the oldest message without removing it.
+ * @param[out]  msg     Message; its payload must not be written.
+ * @return      true if there is a message, false if the pipe is empty.
+ */
+bool core_pipe_receive(core_pipe* pipe, core_pipe_msg* msg);
+
+/** @brief  Removes the oldest message, giving its slot back to the sender. */
+void core_pipe_release(core_pipe* pipe);
+
+/** @brief  Gets the number of messages published and not yet released. */
+uint32_t core_pipe_pending(core_pipe* pipe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORE_PIPE_H */
@@ -11,6 +11,7 @@
 #ifndef LV_PORT_H_
 #define LV_PORT_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "lvgl.h"
 
@@ -31,6 +32,41 @@ typedef lv_color16_t lvgl_pixel_t;
 
 uint32_t lv_port_get_ticks(void);
 
+/** Accounting of the writes to the LCD framebuffer, in CPU cycles. */
+typedef struct {
+    uint32_t flushes;           /* Areas flushed from the LVGL draw buffer. */
+    uint32_t flush_pixels;      /* Pixels flushed. */
+    uint64_t flush_wait;        /* Time areas waited for the scanline to move away. */
+    uint64_t flush_copy;        /* Time spent copying flushed areas. */
+    uint32_t max_flush_copy;    /* Longest copy of a flushed area. */
+    uint32_t blits;             /* Images written directly, see lv_port_blit_rgb888. */
+    uint32_t blit_pixels;       /* Framebuffer pixels written directly. */
+    uint64_t blit_copy;         /* Time spent writing images directly. */
+} lv_port_display_stats;
+
+/**
+ * @brief   Gets the accounting of the writes to the framebuffer since the last reset.
+ * @param[out] stats   Accounting.
+ * @param[in]  reset   Whether to start over.
+ **/
+void lv_port_get_display_stats(lv_port_display_stats *stats, bool reset);
+
+/**
+ * @brief   Writes an RGB888 image straight into the LCD framebuffer, in its native
+ *          format and scaled up by an integer factor, without going through LVGL.
+ *          LVGL must not draw over the area, or it will overwrite the image.
+ *          To be called with the lock held.
+ * @param[in] src      RGB888 image.
+ * @param[in] width    Image width in pixels.
+ * @param[in] height   Image height in pixels.
+ * @param[in] scale    Number of framebuffer pixels per image pixel, in each direction.
+ * @param[in] x        Screen position of the top left corner.
+ * @param[in] y        Screen position of the top left corner.
+ * @return  true if written, false if the image does not fit on the screen or the
+ *          display is rotated.
+ **/
+bool lv_port_blit_rgb888(const uint8_t *src, int width, int height, int scale, int32_t x, int32_t y);
+
 /**
  * @brief   Initialise LVGL and the display. Clears the display if called a second time,
  *          so can be used from a use case to remove the default GLCD canvas.
@@ -18,6 +18,8 @@
 #include "LCD_panel.h"
 #include "Driver_CDC200.h"
 #include "lv_port.h"
+#include "log_trace.h"
+#include "timer_alif.h"
 
 #define MY_DISP_HOR_RES RTE_PANEL_HACTIVE_TIME
 #define MY_DISP_VER_RES RTE_PANEL_VACTIVE_LINE
@@ -42,6 +44,13 @@ static uint32_t lv_last_timer_handler_trigger;
 static atomic_uint_fast32_t lv_ticks;
 
 static atomic_char pending_flush; // 0 = no pending flush, 1 = flush pending, 2 = flush in progress
+#if defined(LOG_TRACE_ENABLED)
+static uint64_t pending_flush_start;
+#endif
+static uint64_t pending_flush_cycles;
+
+/* Updated from the LCD interrupt as well as from the application. */
+static lv_port_display_stats display_stats;
 
 #if ROTATE_DISPLAY != 0
 static lvgl_pixel_t rotation_buf[MY_DISP_BUFFER];
@@ -49,6 +58,10 @@ static lvgl_pixel_t rotation_buf[MY_DISP_BUFFER];
 
 static void lv_display_flush(lv_display_t  * restrict disp, const lv_area_t * restrict area, uint8_t * restrict px_map)
 {
+    const uint64_t copy_start = Get_SysTick_Cycle_Count();
+    display_stats.flush_wait += copy_start - pending_flush_cycles;
+    display_stats.flush_pixels += lv_area_get_size(area);
+
 #if LV_COLOR_DEPTH == 32
     uint32_t * restrict buf = (uint32_t * restrict)px_map;
 #else
@@ -105,6 +118,16 @@ static void lv_display_flush(lv_display_t  * restrict disp, const lv_area_t * re
     }
 #endif
 
+    const uint32_t copy_time = (uint32_t)(Get_SysTick_Cycle_Count() - copy_start);
+    display_stats.flushes++;
+    display_stats.flush_copy += copy_time;
+    if (copy_time > display_stats.max_flush_copy) {
+        display_stats.max_flush_copy = copy_time;
+    }
+
+#if defined(LOG_TRACE_ENABLED)
+    log_trace_span(LOG_TRACE_TRACK_DISPLAY, "flush", pending_flush_start, log_trace_now());
+#endif
     pending_flush = 0;
     lv_display_flush_ready(disp);
 }
@@ -149,6 +172,10 @@ static void lv_display_flush_async(lv_display_t * restrict disp, const lv_area_t
     pending_flush_disp = disp;
     pending_flush_area = *area;
     pending_flush_px_max = px_map;
+#if defined(LOG_TRACE_ENABLED)
+    pending_flush_start = log_trace_now();
+#endif
+    pending_flush_cycles = Get_SysTick_Cycle_Count();
     pending_flush = 1;
 
     /* And then do it immediately if we can, being race-free with the display interrupt which
@@ -237,6 +264,66 @@ void lv_port_disp_init(void)
     lv_inited = true;
 }
 
+void lv_port_get_display_stats(lv_port_display_stats *stats, bool reset)
+{
+    /* The LCD interrupt flushes, and is not masked by the lock. */
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = display_stats;
+    if (reset) {
+        memset(&display_stats, 0, sizeof display_stats);
+    }
+    __set_PRIMASK(primask);
+}
+
+bool lv_port_blit_rgb888(const uint8_t *src, int width, int height, int scale, int32_t x, int32_t y)
+{
+#if ROTATE_DISPLAY != 0
+    if (lv_display_get_rotation(lv_display_get_default()) != LV_DISPLAY_ROTATION_0) {
+        return false;
+    }
+#endif
+    if (scale < 1 || x < 0 || y < 0 ||
+        x + width * scale > MY_DISP_HOR_RES || y + height * scale > MY_DISP_VER_RES) {
+        return false;
+    }
+
+    const uint64_t copy_start = Get_SysTick_Cycle_Count();
+    const size_t row_bytes = (size_t)width * scale * sizeof lcd_image[0][0];
+    for (int sy = 0; sy < height; sy++) {
+        uint8_t *restrict dst = lcd_image[y + sy * scale][x];
+        for (int sx = 0; sx < width; sx++, src += 3) {
+#if LV_COLOR_DEPTH == 32
+            /* The framebuffer holds blue, green then red. */
+            for (int k = 0; k < scale; k++) {
+                *dst++ = src[2];
+                *dst++ = src[1];
+                *dst++ = src[0];
+            }
+#else
+            const uint16_t rgb565 = ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+            for (int k = 0; k < scale; k++) {
+                *dst++ = (uint8_t)rgb565;
+                *dst++ = (uint8_t)(rgb565 >> 8);
+            }
+#endif
+        }
+        /* Repeat the row for the vertical scaling. */
+        for (int k = 1; k < scale; k++) {
+            memcpy(lcd_image[y + sy * scale + k][x], lcd_image[y + sy * scale][x], row_bytes);
+        }
+    }
+
+    const uint64_t copy_time = Get_SysTick_Cycle_Count() - copy_start;
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    display_stats.blits++;
+    display_stats.blit_pixels += (uint32_t)(width * scale) * (uint32_t)(height * scale);
+    display_stats.blit_copy += copy_time;
+    __set_PRIMASK(primask);
+    return true;
+}
+
 static atomic_bool locked;
 
 uint32_t lv_port_lock(void)
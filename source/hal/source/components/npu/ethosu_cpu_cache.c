@@ -33,6 +33,8 @@
 #include "ethosu_driver.h"          /* Arm Ethos-U driver header */
 #include "log_macros.h"             /* Logging macros */
 
+#include <inttypes.h>
+
 bool __attribute__((weak)) ethosu_area_needs_flush_dcache(const uint32_t *p, size_t bytes)
 {
     UNUSED(p);
@@ -56,63 +58,142 @@ bool __attribute__((weak)) ethosu_area_needs_invalidate_dcache(const uint32_t *p
 #endif
 }
 
-void ethosu_flush_dcache(const uint64_t *base_addr, const size_t *base_addr_size, int num_base_addr)
+#ifndef ETHOSU_CACHE_BY_ADDRESS_LIMIT
+/* Cleaning by address costs a few cycles per line; beyond the size of the
+ * cache, working through the whole cache by set and way is cheaper. */
+#define ETHOSU_CACHE_BY_ADDRESS_LIMIT   (32U * 1024U)
+#endif /* ETHOSU_CACHE_BY_ADDRESS_LIMIT */
+
+static ethosu_cache_policy s_policy = {.num_regions = 0, .by_address_limit = ETHOSU_CACHE_BY_ADDRESS_LIMIT};
+static uint32_t s_maintenance_cycles = 0;
+
+static inline uint32_t get_cycle_count(void)
 {
-    bool need_flush = false;
-    for (int i = 0; i < num_base_addr; i++) {
-        if (ethosu_area_needs_flush_dcache((void *)base_addr[i], base_addr_size[i])) {
-            need_flush = true;
-            break;
-        }
-    }
+#if defined (__PMU_PRESENT) && (__PMU_PRESENT == 1U)
+    return ARM_PMU_Get_CCNTR();
+#else
+    return 0;
+#endif
+}
+
+static bool needs_clean(const void *p, size_t bytes)
+{
+    return ethosu_area_needs_flush_dcache(p, bytes);
+}
+
+static bool needs_invalidate(const void *p, size_t bytes)
+{
+    return ethosu_area_needs_invalidate_dcache(p, bytes);
+}
+
+static void clean(const void *p, size_t bytes)
+{
+    trace("Cleaning data cache @ %p, %zu bytes\n", p, bytes);
+    SCB_CleanDCache_by_Addr((volatile void *)p, (int32_t)bytes);
+}
+
+static void clean_invalidate(const void *p, size_t bytes)
+{
+    trace("Invalidating data cache @ %p, %zu bytes\n", p, bytes);
+    SCB_CleanInvalidateDCache_by_Addr((volatile void *)p, (int32_t)bytes);
+}
+
+static void clean_all(void)
+{
+    /**
+     * @note This function is called from the Arm Ethos-U NPU driver for
+     *       every region a job accesses, including RO memory which does
+     *       not need cache maintenance. When the regions are not known
+     *       (see ethosu_dcache_add_regions), or maintaining them by address
+     *       would cost more, the whole cache is cleaned instead.
+     *
+     *       If the neural network to be executed is completely falling
+     *       onto the NPU, consider disabling the data cache altogether
+     *       for the duration of the inference to further reduce the cache
+     *       maintenance burden in these functions.
+     */
+    trace("Cleaning data cache\n");
+    SCB_CleanDCache();
+}
+
+static void clean_invalidate_all(void)
+{
+    trace("Invalidating data cache\n");
+    /* Not safe to simply invalidate without cleaning unless we know there are no write-back areas in the system */
+    SCB_CleanInvalidateDCache();
+}
 
-    if (need_flush) {
-
-        /**
-         * @note We could choose to call the `SCB_CleanDCache_by_Addr` function
-         *       here, but the sizes which this function is called for, can
-         *       cause unnecessary delays. It's worth noting that this function
-         *       is called from the Arm Ethos-U NPU drive repeatedly for each
-         *       region it accesses. This could even be RO memory which does
-         *       not need cache maintenance, along with parts of the input and
-         *       output tensors which rightly need to be cleaned. Therefore, to
-         *       reduce overhead of repeated calls for large memory sizes, we
-         *       call the clean and invalidation functions for whole cache.
-         *
-         *       If the neural network to be executed is completely falling
-         *       onto the NPU, consider disabling the data cache altogether
-         *       for the duration of the inference to further reduce the cache
-         *       maintenance burden in these functions.
-         */
-
-        /** Clean the cache */
-        trace("Cleaning data cache\n");
-        SCB_CleanDCache();
-    } else {
+static const ethosu_cache_ops s_cache_ops = {
+    .needs_clean = needs_clean,
+    .needs_invalidate = needs_invalidate,
+    .clean = clean,
+    .clean_invalidate = clean_invalidate,
+    .clean_all = clean_all,
+    .clean_invalidate_all = clean_invalidate_all,
+};
+
+void ethosu_flush_dcache(const uint64_t *base_addr, const size_t *base_addr_size, int num_base_addr)
+{
+    const uint32_t start = get_cycle_count();
+    if (ETHOSU_CACHE_ACTION_NONE == ethosu_cache_policy_flush(
+            &s_policy, &s_cache_ops, base_addr, base_addr_size, num_base_addr)) {
         __DSB();
     }
+    s_maintenance_cycles += get_cycle_count() - start;
 }
 
 void ethosu_invalidate_dcache(const uint64_t *base_addr, const size_t *base_addr_size, int num_base_addr)
 {
-    bool need_flush = false;
-    for (int i = 0; i < num_base_addr; i++) {
-        if (ethosu_area_needs_invalidate_dcache((void *)base_addr[i], base_addr_size[i])) {
-            need_flush = true;
-            break;
-        }
+    const uint32_t start = get_cycle_count();
+    if (ETHOSU_CACHE_ACTION_NONE == ethosu_cache_policy_invalidate(
+            &s_policy, &s_cache_ops, base_addr, base_addr_size, num_base_addr)) {
+        __DSB();
     }
+    s_maintenance_cycles += get_cycle_count() - start;
+}
 
-    if (need_flush) {
-        /**
-         * See note in ethosu_flush_dcache function for why we clean the whole
-         * cache instead of calling it for specific addresses.
-         **/
-        trace("Invalidating data cache\n");
-        /* Not safe to simply invalidate without cleaning unless we know there are no write-back areas in the system */
+bool ethosu_dcache_add_regions(const void *owner, const ethosu_cache_region *regions, uint32_t num)
+{
+    const bool added = ethosu_cache_policy_add_regions(&s_policy, owner, regions, num);
+    if (!added) {
+        warn("No room for %" PRIu32 " NPU cache regions, maintaining the whole cache\n", num);
+        ethosu_dcache_clear_regions();
+    }
+#if defined (__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    if (SCB->CCR & SCB_CCR_DC_Msk) {
         SCB_CleanInvalidateDCache();
+    }
+#endif
+    return added;
+}
 
-    } else {
-        __DSB();
+void ethosu_dcache_remove_regions(const void *owner)
+{
+    const uint32_t removed = ethosu_cache_policy_remove_regions(&s_policy, owner);
+    if (removed) {
+        debug("Removed %" PRIu32 " NPU cache regions\n", removed);
     }
 }
+
+void ethosu_dcache_clear_regions(void)
+{
+    ethosu_cache_policy_init(&s_policy, ETHOSU_CACHE_BY_ADDRESS_LIMIT);
+}
+
+void ethosu_dcache_enable_cycle_counter(void)
+{
+#if defined (__PMU_PRESENT) && (__PMU_PRESENT == 1U)
+    ARM_PMU_Enable();
+    ARM_PMU_CNTR_Enable(PMU_CNTENSET_CCNTR_ENABLE_Msk);
+#endif
+}
+
+uint32_t ethosu_dcache_get_maintenance_cycles(void)
+{
+    return s_maintenance_cycles;
+}
+
+void ethosu_dcache_reset_maintenance_cycles(void)
+{
+    s_maintenance_cycles = 0;
+}
@@ -131,8 +131,15 @@ void ethosu_pmu_init(void)
     counters->npu_derived_counters[0].unit = unit_cycles;
 #endif /* ETHOSU_DERIVED_NCOUNTERS >= 1 */
 
-    /* Enable PMU. */
+#if ETHOSU_DERIVED_NCOUNTERS >= 2
+    /* CPU cycles spent in data cache maintenance around NPU jobs. */
+    counters->npu_derived_counters[1].name = "NPU CACHE MAINTENANCE";
+    counters->npu_derived_counters[1].unit = unit_cycles;
+#endif /* ETHOSU_DERIVED_NCOUNTERS >= 2 */
+
+    /* Enable PMU, and the CPU cycle counter timing cache maintenance. */
     ETHOSU_PMU_Enable(&ethosu_drv);
+    ethosu_dcache_enable_cycle_counter();
 
     for (i = 0; i < ETHOSU_USED_PMU_NCOUNTERS; ++i) {
         ETHOSU_PMU_Set_EVTYPER(&ethosu_drv, i, counters->npu_evt_counters[i].event_type);
@@ -166,6 +173,7 @@ void ethosu_pmu_reset_counters(void)
     /* Reset all cycle and event counters. */
     ETHOSU_PMU_CYCCNT_Reset(&ethosu_drv);
     ETHOSU_PMU_EVCNTR_ALL_Reset(&ethosu_drv);
+    ethosu_dcache_reset_maintenance_cycles();
 }
 
 /**
@@ -198,6 +206,10 @@ ethosu_pmu_counters ethosu_get_pmu_counters(void)
     }
 #endif /* ETHOSU_DERIVED_NCOUNTERS >= 1 */
 
+#if ETHOSU_DERIVED_NCOUNTERS >= 2
+    counters->npu_derived_counters[1].counter_value = ethosu_dcache_get_maintenance_cycles();
+#endif /* ETHOSU_DERIVED_NCOUNTERS >= 2 */
+
     return *counters;
 }
 
@@ -29,6 +29,8 @@
 #ifndef ETHOSU_CPU_CACHE
 #define ETHOSU_CPU_CACHE
 
+#include "ethosu_cache_policy.h"
+
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -76,4 +78,49 @@ void ethosu_flush_dcache(const uint64_t *base_addr, const size_t *base_addr_size
  */
 void ethosu_invalidate_dcache(const uint64_t *base_addr, const size_t *base_addr_size, int num_base_addr);
 
+/**
+ * @brief   Registers memory regions accessed by NPU jobs with the CPU use of
+ *          each, so that jobs touching only registered regions maintain just
+ *          the lines the CPU writes or reads instead of the whole cache. The
+ *          whole data cache is cleaned and invalidated here, so data written
+ *          by the CPU before the call (model loading, initialisation) needs
+ *          no further maintenance.
+ * @param[in]   owner       Owner of the regions, e.g. the model they describe.
+ * @param[in]   regions     Regions to add to those already registered.
+ * @param[in]   num         Number of regions.
+ * @return      true if the regions were added. If there is no room, all
+ *              regions are dropped and jobs maintain the whole cache.
+ */
+bool ethosu_dcache_add_regions(const void* owner, const ethosu_cache_region* regions, uint32_t num);
+
+/**
+ * @brief   Drops the regions registered by an owner, before the memory they
+ *          describe is used differently, e.g. when a model is initialised
+ *          again or its arena is given to another model.
+ * @param[in]   owner   Owner passed to ethosu_dcache_add_regions.
+ */
+void ethosu_dcache_remove_regions(const void* owner);
+
+/**
+ * @brief   Drops all registered regions; jobs maintain the whole cache.
+ */
+void ethosu_dcache_clear_regions(void);
+
+/**
+ * @brief   Starts the CPU cycle counter used to time cache maintenance. Part
+ *          of the PMU setup, see ethosu_pmu_init().
+ */
+void ethosu_dcache_enable_cycle_counter(void);
+
+/**
+ * @brief   Gets the CPU cycles spent maintaining the cache for NPU jobs.
+ * @return  Cycles since the last reset, or 0 if the CPU has no cycle counter.
+ */
+uint32_t ethosu_dcache_get_maintenance_cycles(void);
+
+/**
+ * @brief   Resets the count of cache maintenance cycles.
+ */
+void ethosu_dcache_reset_maintenance_cycles(void);
+
 #endif /* ETHOSU_CPU_CACHE */
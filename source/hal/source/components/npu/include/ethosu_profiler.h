@@ -26,7 +26,7 @@
     #define ETHOSU_USED_PMU_NCOUNTERS   (5U)    /**< Number of actual PMU counters we want to display */
 #endif /* defined(ETHOSU85) */
 
-#define ETHOSU_DERIVED_NCOUNTERS    (1U)    /**< Number of counters derived from event counters */
+#define ETHOSU_DERIVED_NCOUNTERS    (2U)    /**< Number of counters derived from event counters or kept by software */
 
 #if ETHOSU_PMU_NCOUNTERS < ETHOSU_USED_PMU_NCOUNTERS
     #error "NPU PMU expects a minimum of 4 available event triggered counters!"
@@ -0,0 +1,207 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ethosu_cache_policy.h"
+
+#define LINE_MASK ((uintptr_t)ETHOSU_CACHE_LINE_SIZE - 1)
+
+typedef void (*range_op)(const void* p, size_t bytes);
+typedef bool (*area_check)(const void* p, size_t bytes);
+
+/**
+ * @brief   Checks that every byte of [start, end) is in a registered region,
+ *          so the access flags describe all CPU use of the area.
+ */
+static bool area_covered(const ethosu_cache_policy* policy, uintptr_t start, uintptr_t end)
+{
+    uintptr_t cur = start;
+    while (cur < end) {
+        uintptr_t next = cur;
+        for (uint32_t i = 0; i < policy->num_regions; ++i) {
+            const ethosu_cache_region* r = &policy->regions[i];
+            const uintptr_t r_end = r->base + r->size;
+            if (r->base <= cur && r_end > next) {
+                next = r_end;
+            }
+        }
+        if (next == cur) {
+            return false;
+        }
+        cur = next;
+    }
+    return true;
+}
+
+/**
+ * @brief   Goes through the parts of [start, end) in regions with the given
+ *          access flag, extended to whole cache lines, and applies op to
+ *          them if it is not NULL.
+ * @return  Number of bytes selected.
+ */
+static size_t select_ranges(const ethosu_cache_policy* policy, uint32_t access,
+                            uintptr_t start, uintptr_t end, range_op op)
+{
+    size_t total = 0;
+    for (uint32_t i = 0; i < policy->num_regions; ++i) {
+        const ethosu_cache_region* r = &policy->regions[i];
+        if (!(r->access & access)) {
+            continue;
+        }
+        uintptr_t lo = r->base > start ? r->base : start;
+        uintptr_t hi = r->base + r->size < end ? r->base + r->size : end;
+        if (lo >= hi) {
+            continue;
+        }
+        lo &= ~LINE_MASK;
+        hi = (hi + LINE_MASK) & ~LINE_MASK;
+        if (op) {
+            op((const void*)lo, hi - lo);
+        }
+        total += hi - lo;
+    }
+    return total;
+}
+
+static ethosu_cache_action maintain(const ethosu_cache_policy* policy,
+                                    uint32_t access,
+                                    area_check needs,
+                                    range_op by_address,
+                                    void (*whole_cache)(void),
+                                    const uint64_t* base_addr,
+                                    const size_t* base_addr_size,
+                                    int num_base_addr)
+{
+    bool needed = false;
+    bool whole = false;
+    size_t total = 0;
+
+    /* First pass: decide between nothing, ranges or the whole cache. */
+    for (int i = 0; i < num_base_addr; ++i) {
+        const uintptr_t start = (uintptr_t)base_addr[i];
+        const size_t size = base_addr_size[i];
+        if (0 == size || (needs && !needs((const void*)start, size))) {
+            continue;
+        }
+        needed = true;
+        if (!area_covered(policy, start, start + size)) {
+            whole = true;
+            break;
+        }
+        total += select_ranges(policy, access, start, start + size, NULL);
+    }
+
+    if (!needed) {
+        return ETHOSU_CACHE_ACTION_NONE;
+    }
+    if (whole || total > policy->by_address_limit) {
+        whole_cache();
+        return ETHOSU_CACHE_ACTION_WHOLE_CACHE;
+    }
+    if (0 == total) {
+        return ETHOSU_CACHE_ACTION_NONE;
+    }
+
+    for (int i = 0; i < num_base_addr; ++i) {
+        const uintptr_t start = (uintptr_t)base_addr[i];
+        const size_t size = base_addr_size[i];
+        if (0 == size || (needs && !needs((const void*)start, size))) {
+            continue;
+        }
+        select_ranges(policy, access, start, start + size, by_address);
+    }
+    return ETHOSU_CACHE_ACTION_BY_ADDRESS;
+}
+
+void ethosu_cache_policy_init(ethosu_cache_policy* policy, size_t by_address_limit)
+{
+    policy->num_regions = 0;
+    policy->by_address_limit = by_address_limit;
+}
+
+static bool region_registered(const ethosu_cache_policy* policy, const void* owner,
+                              const ethosu_cache_region* region)
+{
+    for (uint32_t i = 0; i < policy->num_regions; ++i) {
+        const ethosu_cache_region* r = &policy->regions[i];
+        if (policy->owners[i] == owner &&
+            r->base == region->base && r->size == region->size && r->access == region->access) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ethosu_cache_policy_add_regions(ethosu_cache_policy* policy,
+                                     const void* owner,
+                                     const ethosu_cache_region* regions,
+                                     uint32_t num)
+{
+    /* Registering the same model again adds nothing. */
+    uint32_t num_new = 0;
+    for (uint32_t i = 0; i < num; ++i) {
+        if (!region_registered(policy, owner, &regions[i])) {
+            ++num_new;
+        }
+    }
+    if (num_new > ETHOSU_CACHE_MAX_REGIONS - policy->num_regions) {
+        return false;
+    }
+    for (uint32_t i = 0; i < num; ++i) {
+        if (!region_registered(policy, owner, &regions[i])) {
+            policy->owners[policy->num_regions] = owner;
+            policy->regions[policy->num_regions++] = regions[i];
+        }
+    }
+    return true;
+}
+
+uint32_t ethosu_cache_policy_remove_regions(ethosu_cache_policy* policy, const void* owner)
+{
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < policy->num_regions; ++i) {
+        if (policy->owners[i] != owner) {
+            policy->owners[kept] = policy->owners[i];
+            policy->regions[kept++] = policy->regions[i];
+        }
+    }
+    const uint32_t removed = policy->num_regions - kept;
+    policy->num_regions = kept;
+    return removed;
+}
+
+ethosu_cache_action ethosu_cache_policy_flush(const ethosu_cache_policy* policy,
+                                              const ethosu_cache_ops* ops,
+                                              const uint64_t* base_addr,
+                                              const size_t* base_addr_size,
+                                              int num_base_addr)
+{
+    return maintain(policy, ETHOSU_CACHE_CPU_WRITES, ops->needs_clean,
+                    ops->clean, ops->clean_all,
+                    base_addr, base_addr_size, num_base_addr);
+}
+
+ethosu_cache_action ethosu_cache_policy_invalidate(const ethosu_cache_policy* policy,
+                                                   const ethosu_cache_ops* ops,
+                                                   const uint64_t* base_addr,
+                                                   const size_t* base_addr_size,
+                                                   int num_base_addr)
+{
+    /* Lines are cleaned as well: a line at the edge of a range may hold
+     * dirty CPU data next to the NPU output. */
+    return maintain(policy, ETHOSU_CACHE_CPU_READS, ops->needs_invalidate,
+                    ops->clean_invalidate, ops->clean_invalidate_all,
+                    base_addr, base_addr_size, num_base_addr);
+}
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ETHOSU_CACHE_POLICY_H
+#define ETHOSU_CACHE_POLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ETHOSU_CACHE_MAX_REGIONS    (16U)   /**< Maximum number of registered regions. */
+#define ETHOSU_CACHE_LINE_SIZE      (32U)   /**< Data cache line size in bytes. */
+
+/* CPU access to a region, which decides the maintenance needed around NPU jobs.
+ * A region with neither flag (weights, NPU scratch) is never maintained. */
+#define ETHOSU_CACHE_CPU_WRITES     (1U << 0)   /**< Written by the CPU: cleaned before jobs. */
+#define ETHOSU_CACHE_CPU_READS      (1U << 1)   /**< Read by the CPU: invalidated after jobs. */
+
+/** Memory region known to be accessed by NPU jobs. */
+typedef struct ethosu_cache_region_ {
+    uintptr_t base;     /**< Start address. */
+    size_t size;        /**< Size in bytes. */
+    uint32_t access;    /**< ETHOSU_CACHE_CPU_* flags. */
+} ethosu_cache_region;
+
+/** Registered regions. */
+typedef struct ethosu_cache_policy_ {
+    ethosu_cache_region regions[ETHOSU_CACHE_MAX_REGIONS];
+    const void* owners[ETHOSU_CACHE_MAX_REGIONS];   /**< Owner of each region. */
+    uint32_t num_regions;
+    size_t by_address_limit;    /**< Above this many bytes, the whole cache is maintained. */
+} ethosu_cache_policy;
+
+/** Cache operations used by the policy. */
+typedef struct ethosu_cache_ops_ {
+    /* Optional pre-checks, see ethosu_area_needs_flush_dcache(). NULL means always. */
+    bool (*needs_clean)(const void* p, size_t bytes);
+    bool (*needs_invalidate)(const void* p, size_t bytes);
+
+    void (*clean)(const void* p, size_t bytes);
+    void (*clean_invalidate)(const void* p, size_t bytes);
+    void (*clean_all)(void);
+    void (*clean_invalidate_all)(void);
+} ethosu_cache_ops;
+
+/** Maintenance performed for a job. */
+typedef enum ethosu_cache_action_ {
+    ETHOSU_CACHE_ACTION_NONE,           /**< Nothing needed. */
+    ETHOSU_CACHE_ACTION_BY_ADDRESS,     /**< Only the selected ranges. */
+    ETHOSU_CACHE_ACTION_WHOLE_CACHE     /**< The whole data cache. */
+} ethosu_cache_action;
+
+/**
+ * @brief       Initialises a policy with no regions. Without regions, every
+ *              job maintains the whole cache.
+ * @param[out]  policy              Policy to initialise.
+ * @param[in]   by_address_limit    Maximum number of bytes maintained by
+ *                                  address; larger amounts use the whole
+ *                                  cache operation instead.
+ */
+void ethosu_cache_policy_init(ethosu_cache_policy* policy, size_t by_address_limit);
+
+/**
+ * @brief       Adds regions to the policy, all of them or none.
+ * @param[in]   policy      Policy to update.
+ * @param[in]   owner       Owner of the regions, e.g. the model they describe.
+ *                          Regions the owner has already added are skipped.
+ * @param[in]   regions     Regions to add. Regions may overlap: the access
+ *                          flags of all regions covering an address apply.
+ * @param[in]   num         Number of regions.
+ * @return      true if the regions were added, false if there is no room.
+ */
+bool ethosu_cache_policy_add_regions(ethosu_cache_policy* policy,
+                                     const void* owner,
+                                     const ethosu_cache_region* regions,
+                                     uint32_t num);
+
+/**
+ * @brief       Removes the regions added by an owner, e.g. before the memory
+ *              they describe is reused.
+ * @param[in]   policy      Policy to update.
+ * @param[in]   owner       Owner passed to ethosu_cache_policy_add_regions.
+ * @return      Number of regions removed.
+ */
+uint32_t ethosu_cache_policy_remove_regions(ethosu_cache_policy* policy, const void* owner);
+
+/**
+ * @brief       Cleans what the CPU has written to the areas a job is about
+ *              to access. Areas not fully covered by registered regions
+ *              are handled by cleaning the whole cache.
+ * @param[in]   policy          Registered regions.
+ * @param[in]   ops             Cache operations.
+ * @param[in]   base_addr       Base addresses of the job's areas.
+ * @param[in]   base_addr_size  Sizes of the areas in bytes.
+ * @param[in]   num_base_addr   Number of areas.
+ * @return      Maintenance performed.
+ */
+ethosu_cache_action ethosu_cache_policy_flush(const ethosu_cache_policy* policy,
+                                              const ethosu_cache_ops* ops,
+                                              const uint64_t* base_addr,
+                                              const size_t* base_addr_size,
+                                              int num_base_addr);
+
+/**
+ * @brief       Invalidates what the CPU will read from the areas a job has
+ *              written. Areas not fully covered by registered regions are
+ *              handled by cleaning and invalidating the whole cache.
+ * @return      Maintenance performed.
+ */
+ethosu_cache_action ethosu_cache_policy_invalidate(const ethosu_cache_policy* policy,
+                                                   const ethosu_cache_ops* ops,
+                                                   const uint64_t* base_addr,
+                                                   const size_t* base_addr_size,
+                                                   int num_base_addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ETHOSU_CACHE_POLICY_H */
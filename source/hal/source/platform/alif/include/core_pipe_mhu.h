@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CORE_PIPE_MHU_H
+#define CORE_PIPE_MHU_H
+
+#include "core_pipe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Pipes between the RTSS-HE and RTSS-HP cores. Each core creates the pipe
+ * it sends on in its own memory; every message published rings the other
+ * core's MHU doorbell with the global address of the pipe, and the other
+ * core attaches to the pipe on the first doorbell. Ringing the doorbell
+ * waits for the MHU acknowledgement, so messages are published from
+ * thread context only.
+ */
+
+/** Message types used between the applications. */
+#define CORE_PIPE_MSG_KEYWORD   (1U)    /**< core_pipe_keyword, then the audio samples. */
+
+/** Keyword spotted on one core, with the audio it was spotted in. */
+typedef struct core_pipe_keyword_ {
+    char label[32];
+    float score;
+    uint32_t sample_rate;
+    uint32_t num_samples;   /**< int16_t samples following this header. */
+} core_pipe_keyword;
+
+/** Called, in interrupt context, when the other core has published messages. */
+typedef void (*core_pipe_mhu_handler)(core_pipe* rx);
+
+/**
+ * @brief       Creates the pipe to the other core.
+ * @param[in]   mem         Memory for the pipe, aligned to CORE_PIPE_LINE_SIZE,
+ *                          that the other core can access at its global address.
+ * @param[in]   mem_size    Size of the memory in bytes.
+ * @param[in]   n_slots     Number of messages that can be in flight, a power of two.
+ * @param[in]   slot_size   Maximum payload size in bytes.
+ * @return      Pipe to send on, NULL on failure.
+ */
+core_pipe* core_pipe_mhu_create_tx(void* mem, size_t mem_size, uint32_t n_slots, uint32_t slot_size);
+
+/** @brief  Gets the pipe to the other core, NULL if not created. */
+core_pipe* core_pipe_mhu_tx(void);
+
+/** @brief  Gets the pipe from the other core, NULL until its first doorbell. */
+core_pipe* core_pipe_mhu_rx(void);
+
+/**
+ * @brief   Sets the function handling messages from the other core.
+ *          init_trigger_rx() sets one that acts on the "go" and "stop"
+ *          keywords and drops everything else.
+ */
+void core_pipe_mhu_set_rx_handler(core_pipe_mhu_handler handler);
+
+/**
+ * @brief       Handles an MHU message if it is a pipe doorbell. To be called
+ *              first by the MHU receive callback.
+ * @param[in]   data    Data of the MHU message.
+ * @return      true if the message was a doorbell, false otherwise.
+ */
+bool core_pipe_mhu_doorbell(void* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CORE_PIPE_MHU_H */
@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core_pipe_mhu.h"
+
+#include "log_macros.h"
+#include "RTE_Components.h"
+#include "services_lib_bare_metal.h"
+#include "services_lib_protocol.h"
+#include "sys_utils.h"
+
+#include CMSIS_device_header
+
+#if defined(M55_HE) || defined(RTSS_HE)
+extern uint32_t hp_comms_handle;
+#define OTHER_CORE_HANDLE hp_comms_handle
+#else
+extern uint32_t he_comms_handle;
+#define OTHER_CORE_HANDLE he_comms_handle
+#endif
+
+static core_pipe s_tx;
+static core_pipe s_rx;
+static bool s_tx_created;
+static bool s_rx_attached;
+static core_pipe_mhu_handler s_rx_handler;
+
+#if defined (__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+static void clean(const void* p, size_t bytes)
+{
+    SCB_CleanDCache_by_Addr((volatile void*)p, (int32_t)bytes);
+}
+
+static void invalidate(const void* p, size_t bytes)
+{
+    SCB_InvalidateDCache_by_Addr((volatile void*)p, (int32_t)bytes);
+}
+#endif /* __DCACHE_PRESENT */
+
+static void ring_doorbell(void* shared, void* ctx)
+{
+    (void)ctx;
+
+    /* The other core gets the pipe's global address as the message data. */
+    if (SERVICES_REQ_SUCCESS != SERVICES_send_msg(OTHER_CORE_HANDLE, LocalToGlobal(shared))) {
+        printf_err("Pipe doorbell not acknowledged\n");
+    }
+}
+
+static const core_pipe_ops s_tx_ops = {
+#if defined (__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    clean,
+    invalidate,
+#else
+    NULL,
+    NULL,
+#endif /* __DCACHE_PRESENT */
+    ring_doorbell,
+    NULL,
+};
+
+static const core_pipe_ops s_rx_ops = {
+#if defined (__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    clean,
+    invalidate,
+#else
+    NULL,
+    NULL,
+#endif /* __DCACHE_PRESENT */
+    NULL,
+    NULL,
+};
+
+core_pipe* core_pipe_mhu_create_tx(void* mem, size_t mem_size, uint32_t n_slots, uint32_t slot_size)
+{
+    if (0 != core_pipe_create(&s_tx, mem, mem_size, n_slots, slot_size, &s_tx_ops)) {
+        printf_err("Failed to create pipe to the other core\n");
+        return NULL;
+    }
+    s_tx_created = true;
+    return &s_tx;
+}
+
+core_pipe* core_pipe_mhu_tx(void)
+{
+    return s_tx_created ? &s_tx : NULL;
+}
+
+core_pipe* core_pipe_mhu_rx(void)
+{
+    return s_rx_attached ? &s_rx : NULL;
+}
+
+void core_pipe_mhu_set_rx_handler(core_pipe_mhu_handler handler)
+{
+    s_rx_handler = handler;
+}
+
+bool core_pipe_mhu_doorbell(void* data)
+{
+    if (!core_pipe_is_pipe(data, &s_rx_ops)) {
+        return false;
+    }
+
+    /* The other core may have created its pipe again since the last doorbell. */
+    if (!s_rx_attached || s_rx.shared != (uint8_t*)data) {
+        s_rx_attached = (0 == core_pipe_attach(&s_rx, data, &s_rx_ops));
+    }
+    if (s_rx_attached && s_rx_handler) {
+        s_rx_handler(&s_rx);
+    }
+    return true;
+}
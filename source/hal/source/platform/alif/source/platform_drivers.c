@@ -30,6 +30,7 @@
 #include "platform_drivers.h"
 
 #include "log_macros.h"     /* Logging functions */
+#include "log_trace.h"      /* Timeline tracing */
 #include "peripheral_memmap.h"
 #include "fault_handler.h"
 #include <string.h>         /* For strncpy */
@@ -50,6 +51,9 @@
 #include "sys_utils.h"
 #include "sys_clocks.h"
 #include "app_mem_regions.h"
+#ifdef SE_SERVICES_SUPPORT
+#include "core_pipe_mhu.h"
+#endif
 
 #include CMSIS_device_header
 
@@ -99,6 +103,10 @@ static void MHU_msg_received(void* data);
 // IPC callback
 static void ipc_rx_callback(void *data)
 {
+    if (core_pipe_mhu_doorbell(data)) {
+        return;
+    }
+
     m55_data_payload_t* payload = (m55_data_payload_t*)data;
     char *st = (char*)payload->msg;
     uint16_t id = payload->id;
@@ -313,6 +321,9 @@ int platform_init(void)
     if (0 != Init_SysTick()) {
         printf("Failed to initialise system tick config\n");
     }
+#if defined(LOG_TRACE_ENABLED)
+    log_trace_set_clock(Get_SysTick_Cycle_Count, GetSystemCoreClock());
+#endif /* defined(LOG_TRACE_ENABLED) */
 
 #ifndef USE_SEMIHOSTING
     /* Forces retarget code to be included in build */
@@ -432,9 +443,14 @@ const char* platform_name(void)
     return s_platform_name;
 }
 
+#ifdef SE_SERVICES_SUPPORT
+static void keyword_pipe_received(core_pipe* rx);
+#endif
+
 void init_trigger_rx(void)
 {
 #ifdef SE_SERVICES_SUPPORT
+    core_pipe_mhu_set_rx_handler(keyword_pipe_received);
     services_init(MHU_msg_received);
 #endif
 
@@ -458,8 +474,39 @@ static bool last_btn2 = false;
 #endif
 
 #ifdef SE_SERVICES_SUPPORT
+static void keyword_received(const char* label)
+{
+    if (!strcmp(label, "go")) {
+        // Enter continuous inference mode
+        do_inference_once = false;
+    }
+    if (!strcmp(label, "stop")) {
+        // Enter single shot inference mode
+        do_inference_once = true;
+    }
+}
+
+// Keywords sent with their audio over the pipe from the other core
+static void keyword_pipe_received(core_pipe* rx)
+{
+    core_pipe_msg msg;
+    while (core_pipe_receive(rx, &msg)) {
+        if (CORE_PIPE_MSG_KEYWORD == msg.type && msg.size >= sizeof(core_pipe_keyword)) {
+            const core_pipe_keyword* keyword = msg.data;
+            char label[sizeof(keyword->label) + 1] = {0};
+            memcpy(label, keyword->label, sizeof(keyword->label));
+            keyword_received(label);
+        }
+        core_pipe_release(rx);
+    }
+}
+
 static void MHU_msg_received(void* data)
 {
+    if (core_pipe_mhu_doorbell(data)) {
+        return;
+    }
+
     m55_data_payload_t* payload = data;
 
     __DMB();
@@ -467,14 +514,7 @@ static void MHU_msg_received(void* data)
     switch(payload->id)
     {
         case 2:
-            if (!strcmp(payload->msg, "go")) {
-                // Enter continuous inference mode
-               do_inference_once = false;
-            }
-            if (!strcmp(payload->msg, "stop")) {
-                // Enter single shot inference mode
-               do_inference_once = true;
-            }
+            keyword_received(payload->msg);
             break;
         case 3:
             break;
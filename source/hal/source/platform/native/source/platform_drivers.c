@@ -16,13 +16,28 @@
  */
 
 #include "platform_drivers.h"
+#include "log_trace.h"
 
 #include <string.h>
+#include <time.h>
 
 static const char* s_platform_name = "native";
 
+#if defined(LOG_TRACE_ENABLED)
+/** Trace clock in nanoseconds. */
+static uint64_t platform_trace_clock(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+#endif /* defined(LOG_TRACE_ENABLED) */
+
 int platform_init(void)
 {
+#if defined(LOG_TRACE_ENABLED)
+    log_trace_set_clock(platform_trace_clock, 1000000000u);
+#endif /* defined(LOG_TRACE_ENABLED) */
     return 0;
 }
 
@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com> SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ML_EMBEDDED_CORE_LOG_DEFERRED_H
+#define ML_EMBEDDED_CORE_LOG_DEFERRED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define LOG_DEFERRED_PRINTF_FORMAT(fmt_idx, args_idx) \
+    __attribute__((format(printf, fmt_idx, args_idx)))
+#else
+#define LOG_DEFERRED_PRINTF_FORMAT(fmt_idx, args_idx)
+#endif /* __GNUC__ */
+
+/**
+ * @brief   Sink receiving rendered log lines.
+ * @param[in]   text    Null terminated line, including the level prefix.
+ * @param[in]   len     Length of the line in characters.
+ */
+typedef void (*log_deferred_sink)(const char* text, size_t len);
+
+/**
+ * @brief   Records a log message without formatting it. The format string
+ *          pointer and the raw argument values are copied into a lock-free
+ *          ring buffer; strings passed for %s are copied by value.
+ *          Safe to call from interrupt handlers. If the ring buffer is
+ *          full the message is dropped and counted.
+ * @param[in]   level   Log level (LOG_LEVEL_xxx) used to pick the prefix.
+ * @param[in]   fmt     printf format string; must have static storage duration.
+ */
+void log_deferred_write(int level, const char* fmt, ...) LOG_DEFERRED_PRINTF_FORMAT(2, 3);
+
+/**
+ * @brief   Formats and outputs up to max_records pending messages. Intended
+ *          to be called from idle time; not re-entrant, a nested call
+ *          returns 0 straight away.
+ * @param[in]   max_records     Maximum number of messages to output.
+ * @return  Number of messages output.
+ */
+size_t log_deferred_drain(size_t max_records);
+
+/**
+ * @brief   Outputs all pending messages.
+ */
+void log_deferred_flush(void);
+
+/**
+ * @brief   Sets the sink for rendered lines. NULL restores the default,
+ *          which writes to stdout.
+ */
+void log_deferred_set_sink(log_deferred_sink sink);
+
+/**
+ * @brief   Gets the number of messages dropped because the ring buffer was
+ *          full since the last drain.
+ */
+uint32_t log_deferred_get_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ML_EMBEDDED_CORE_LOG_DEFERRED_H */
@@ -38,42 +38,60 @@ extern "C" {
 #define UNUSED(x) ((void)(x))
 #endif /* #if !defined(UNUSED) */
 
-#if (LOG_LEVEL == LOG_LEVEL_TRACE)
-#define trace(...)      \
-    printf("TRACE - "); \
+#if defined(LOG_DEFERRED)
+/* Messages are recorded unformatted and output by log_deferred_drain().
+ * Errors are output straight away, after any pending messages. */
+#include "log_deferred.h"
+
+#define LOG_EMIT(level, prefix, ...) log_deferred_write(level, __VA_ARGS__)
+#define LOG_EMIT_ERROR(...) \
+    log_deferred_flush();   \
+    printf("ERROR - ");     \
     printf(__VA_ARGS__)
+
+/* Outputs one pending message, for use while waiting on hardware.
+ * Evaluates to the number of messages output. */
+#define log_drain_one() log_deferred_drain(1)
+
+/* Outputs all pending messages, e.g. at the end of a frame or before exiting. */
+#define log_flush() log_deferred_flush()
+#else
+#define log_drain_one() ((size_t)0)
+#define log_flush()
+#define LOG_EMIT(level, prefix, ...) \
+    printf(prefix);                  \
+    printf(__VA_ARGS__)
+#define LOG_EMIT_ERROR(...) \
+    printf("ERROR - ");     \
+    printf(__VA_ARGS__)
+#endif /* LOG_DEFERRED */
+
+#if (LOG_LEVEL == LOG_LEVEL_TRACE)
+#define trace(...) LOG_EMIT(LOG_LEVEL_TRACE, "TRACE - ", __VA_ARGS__)
 #else
 #define trace(...)
 #endif /* LOG_LEVEL == LOG_LEVEL_TRACE */
 
 #if (LOG_LEVEL <= LOG_LEVEL_DEBUG)
-#define debug(...)      \
-    printf("DEBUG - "); \
-    printf(__VA_ARGS__)
+#define debug(...) LOG_EMIT(LOG_LEVEL_DEBUG, "DEBUG - ", __VA_ARGS__)
 #else
 #define debug(...)
 #endif /* LOG_LEVEL > LOG_LEVEL_TRACE */
 
 #if (LOG_LEVEL <= LOG_LEVEL_INFO)
-#define info(...)      \
-    printf("INFO - "); \
-    printf(__VA_ARGS__)
+#define info(...) LOG_EMIT(LOG_LEVEL_INFO, "INFO - ", __VA_ARGS__)
 #else
 #define info(...)
 #endif /* LOG_LEVEL > LOG_LEVEL_DEBUG */
 
 #if (LOG_LEVEL <= LOG_LEVEL_WARN)
-#define warn(...)      \
-    printf("WARN - "); \
-    printf(__VA_ARGS__)
+#define warn(...) LOG_EMIT(LOG_LEVEL_WARN, "WARN - ", __VA_ARGS__)
 #else
 #define warn(...)
 #endif /* LOG_LEVEL > LOG_LEVEL_INFO */
 
 #if (LOG_LEVEL <= LOG_LEVEL_ERROR)
-#define printf_err(...) \
-    printf("ERROR - "); \
-    printf(__VA_ARGS__)
+#define printf_err(...) LOG_EMIT_ERROR(__VA_ARGS__)
 #else
 #define printf_err(...)
 #endif /* LOG_LEVEL > LOG_LEVEL_INFO */
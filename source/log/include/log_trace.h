@@ -0,0 +1,177 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com> SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ML_EMBEDDED_CORE_LOG_TRACE_H
+#define ML_EMBEDDED_CORE_LOG_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Rows of the timeline; spans on different tracks may overlap. */
+typedef enum {
+    LOG_TRACE_TRACK_CPU,        /* Work done by the application core. */
+    LOG_TRACE_TRACK_CAMERA,     /* Frame capture by the camera controller. */
+    LOG_TRACE_TRACK_AUDIO,      /* Audio capture. */
+    LOG_TRACE_TRACK_NPU,        /* Inferences run by the NPU. */
+    LOG_TRACE_TRACK_DISPLAY,    /* Transfers to the display. */
+    LOG_TRACE_TRACKS
+} log_trace_track;
+
+/**
+ * @brief   Time source of the tracer, returning a monotonic time in ticks.
+ */
+typedef uint64_t (*log_trace_clock)(void);
+
+/**
+ * @brief   Receives the exported trace, a piece at a time.
+ * @param[in]   text    Piece of the trace, not null terminated.
+ * @param[in]   len     Length of the piece in characters.
+ * @param[in]   ctx     Context passed to the export function.
+ */
+typedef void (*log_trace_writer)(const char* text, size_t len, void* ctx);
+
+/**
+ * @brief   Sets the time source. Spans are only recorded once it is set,
+ *          which platforms do at initialisation.
+ * @param[in]   clock               Time source, NULL to stop recording.
+ * @param[in]   ticks_per_second    Rate of the time source.
+ */
+void log_trace_set_clock(log_trace_clock clock, uint32_t ticks_per_second);
+
+/**
+ * @brief   Gets the current time, 0 if there is no time source.
+ */
+uint64_t log_trace_now(void);
+
+/**
+ * @brief   Records a span. The span is copied into a fixed ring buffer,
+ *          overwriting the oldest one when it is full. Safe to call from
+ *          interrupt handlers.
+ * @param[in]   track   Row of the timeline the span belongs to.
+ * @param[in]   name    Name of the span; must have static storage duration.
+ * @param[in]   start   Time the span started, from log_trace_now().
+ * @param[in]   end     Time the span ended, from log_trace_now().
+ */
+void log_trace_span(log_trace_track track, const char* name, uint64_t start, uint64_t end);
+
+/**
+ * @brief   Writes the recorded spans, oldest first, as a Chrome trace event
+ *          JSON document, which chrome://tracing and Perfetto open. Spans
+ *          must not be recorded meanwhile.
+ * @param[in]   write   Receives the document a piece at a time.
+ * @param[in]   ctx     Passed on to write.
+ * @return  Number of spans written.
+ */
+size_t log_trace_export(log_trace_writer write, void* ctx);
+
+/**
+ * @brief   Writes the Chrome trace JSON document to stdout, e.g. the UART,
+ *          between "--- trace start ---" and "--- trace end ---" lines.
+ */
+void log_trace_dump(void);
+
+/**
+ * @brief   Writes the Chrome trace JSON document to a file.
+ * @param[in]   path    Path of the file.
+ * @return  true if successful, false otherwise.
+ */
+bool log_trace_write_file(const char* path);
+
+/**
+ * @brief   Gets the number of spans held, at most the ring buffer size.
+ */
+size_t log_trace_count(void);
+
+/**
+ * @brief   Whether the ring buffer is full, so that the next span recorded
+ *          overwrites the oldest one.
+ */
+bool log_trace_full(void);
+
+/**
+ * @brief   Forgets all recorded spans.
+ */
+void log_trace_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ * Tracing macros. Without LOG_TRACE_ENABLED they compile to nothing.
+ * LOG_TRACE_BEGIN declares a variable holding the start time, which the
+ * matching LOG_TRACE_END in the same scope reads:
+ *
+ *     LOG_TRACE_BEGIN(resize);
+ *     ...
+ *     LOG_TRACE_END(resize, LOG_TRACE_TRACK_CPU, "resize");
+ */
+#if defined(LOG_TRACE_ENABLED)
+
+#define LOG_TRACE_BEGIN(var)                const uint64_t log_trace_start_##var = log_trace_now()
+#define LOG_TRACE_END(var, track, name)     log_trace_span((track), (name), log_trace_start_##var, log_trace_now())
+#define LOG_TRACE_DUMP_WHEN_FULL()          do { if (log_trace_full()) { log_trace_dump(); log_trace_clear(); } } while (0)
+
+#else /* defined(LOG_TRACE_ENABLED) */
+
+#define LOG_TRACE_BEGIN(var)                do {} while (0)
+#define LOG_TRACE_END(var, track, name)     do {} while (0)
+#define LOG_TRACE_DUMP_WHEN_FULL()          do {} while (0)
+
+#endif /* defined(LOG_TRACE_ENABLED) */
+
+#if defined(__cplusplus)
+
+/**
+ * @brief   Records a span on the CPU track from its construction to the end
+ *          of its scope.
+ */
+class LogTraceScope {
+public:
+    explicit LogTraceScope(const char* name)
+    :   m_name{name},
+        m_start{log_trace_now()}
+    {}
+
+    ~LogTraceScope()
+    {
+        log_trace_span(LOG_TRACE_TRACK_CPU, m_name, m_start, log_trace_now());
+    }
+
+    LogTraceScope(const LogTraceScope&) = delete;
+    LogTraceScope& operator=(const LogTraceScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_start;
+};
+
+#if defined(LOG_TRACE_ENABLED)
+#define LOG_TRACE_SCOPE_CONCAT_(a, b)       a##b
+#define LOG_TRACE_SCOPE_CONCAT(a, b)        LOG_TRACE_SCOPE_CONCAT_(a, b)
+#define LOG_TRACE_SCOPE(name)               const LogTraceScope LOG_TRACE_SCOPE_CONCAT(log_trace_scope_, __LINE__){name}
+#else /* defined(LOG_TRACE_ENABLED) */
+#define LOG_TRACE_SCOPE(name)               do {} while (0)
+#endif /* defined(LOG_TRACE_ENABLED) */
+
+#endif /* defined(__cplusplus) */
+
+#endif /* ML_EMBEDDED_CORE_LOG_TRACE_H */
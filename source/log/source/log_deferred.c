@@ -0,0 +1,542 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com> SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "log_deferred.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef LOG_DEFERRED_RECORDS
+#define LOG_DEFERRED_RECORDS (64)
+#endif /* LOG_DEFERRED_RECORDS */
+
+/* Room for the largest message in the tree: a Profiler statistics line with
+ * a 41 character counter name, its unit and six 8-byte values (103 bytes).
+ * A record is then 128 bytes on 32-bit targets. Longer messages are cut and
+ * end with "...". */
+#ifndef LOG_DEFERRED_PAYLOAD_SIZE
+#define LOG_DEFERRED_PAYLOAD_SIZE (112)
+#endif /* LOG_DEFERRED_PAYLOAD_SIZE */
+
+#ifndef LOG_DEFERRED_LINE_MAX
+#define LOG_DEFERRED_LINE_MAX (256)
+#endif /* LOG_DEFERRED_LINE_MAX */
+
+/* Sequence numbers wrap at 2^32, which keeps slot indices consistent only for powers of two. */
+_Static_assert((LOG_DEFERRED_RECORDS & (LOG_DEFERRED_RECORDS - 1)) == 0,
+               "LOG_DEFERRED_RECORDS must be a power of two");
+_Static_assert(LOG_DEFERRED_PAYLOAD_SIZE <= UINT8_MAX, "LOG_DEFERRED_PAYLOAD_SIZE too large");
+
+/** Kinds of argument a conversion specification consumes. */
+typedef enum {
+    LOG_ARG_NONE,
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LONG_LONG,
+    LOG_ARG_INTMAX,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LONG_DOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER,
+} log_arg_kind;
+
+/** One parsed conversion specification, e.g. "%-*.3lu". */
+typedef struct {
+    const char* start;      /* Points at the '%'. */
+    size_t len;             /* Length of the specification. */
+    bool star_width;        /* Width is taken from an int argument. */
+    bool star_precision;    /* Precision is taken from an int argument. */
+    log_arg_kind kind;
+} log_spec;
+
+typedef struct {
+    atomic_uint_least32_t seq;  /* Stored minus the slot index, see log_load_seq(). */
+    const char* fmt;
+    uint8_t level;
+    uint8_t size;               /* Payload bytes used. */
+    bool truncated;             /* Not all arguments fitted in the payload. */
+    uint8_t payload[LOG_DEFERRED_PAYLOAD_SIZE];
+} log_record;
+
+/*
+ * Bounded multi-producer, single-consumer queue. A slot is free for the
+ * producer at position pos when its sequence is pos, holds a message once
+ * it is pos + 1 and becomes free again for pos + RECORDS after the drain.
+ * Sequences are stored minus the slot index so that a zero initialised
+ * ring is valid without an init call.
+ */
+static struct {
+    log_record slots[LOG_DEFERRED_RECORDS];
+    atomic_uint_least32_t head;
+    uint32_t tail;
+    atomic_uint_least32_t dropped;
+    atomic_flag draining;
+    log_deferred_sink sink;
+} ring = { .draining = ATOMIC_FLAG_INIT };
+
+static const char* const level_prefix[] = {
+    "TRACE - ", "DEBUG - ", "INFO - ", "WARN - ", "ERROR - "
+};
+
+/** strnlen, which is not part of C11. */
+static size_t log_strnlen(const char* str, size_t max_len)
+{
+    const char* nul = (const char*)memchr(str, '\0', max_len);
+    return nul ? (size_t)(nul - str) : max_len;
+}
+
+static uint32_t log_load_seq(log_record* record, uint32_t pos)
+{
+    return (uint32_t)atomic_load_explicit(&record->seq, memory_order_acquire) +
+        (pos % LOG_DEFERRED_RECORDS);
+}
+
+static void log_store_seq(log_record* record, uint32_t pos, uint32_t seq)
+{
+    atomic_store_explicit(&record->seq, seq - (pos % LOG_DEFERRED_RECORDS), memory_order_release);
+}
+
+/**
+ * @brief   Parses the specification following a '%'. Returns false at the
+ *          end of the string.
+ */
+static bool log_next_spec(const char** cursor, log_spec* spec)
+{
+    const char* p = strchr(*cursor, '%');
+    if (!p) {
+        return false;
+    }
+
+    memset(spec, 0, sizeof(*spec));
+    spec->start = p++;
+
+    while (*p && strchr("-+ #0", *p)) {
+        ++p;
+    }
+    if (*p == '*') {
+        spec->star_width = true;
+        ++p;
+    }
+    while (*p >= '0' && *p <= '9') {
+        ++p;
+    }
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            spec->star_precision = true;
+            ++p;
+        }
+        while (*p >= '0' && *p <= '9') {
+            ++p;
+        }
+    }
+
+    log_arg_kind integer = LOG_ARG_INT;
+    bool long_double = false;
+    switch (*p) {
+        case 'h':
+            p += (p[1] == 'h') ? 2 : 1;
+            break;
+        case 'l':
+            integer = (p[1] == 'l') ? LOG_ARG_LONG_LONG : LOG_ARG_LONG;
+            p += (p[1] == 'l') ? 2 : 1;
+            break;
+        case 'j': integer = LOG_ARG_INTMAX; ++p; break;
+        case 'z': integer = LOG_ARG_SIZE; ++p; break;
+        case 't': integer = LOG_ARG_PTRDIFF; ++p; break;
+        case 'L': long_double = true; ++p; break;
+        default: break;
+    }
+
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            spec->kind = integer;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec->kind = long_double ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->kind = LOG_ARG_STRING;
+            break;
+        case 'p':
+        case 'n':
+            spec->kind = LOG_ARG_POINTER;
+            break;
+        case '\0':
+            /* Incomplete specification, printed literally. */
+            spec->len = (size_t)(p - spec->start);
+            *cursor = p;
+            return true;
+        default:
+            /* "%%" and unknown conversions take no argument. */
+            break;
+    }
+
+    ++p;
+    spec->len = (size_t)(p - spec->start);
+    *cursor = p;
+    return true;
+}
+
+/**
+ * @brief   Copies the arguments described by the format string into the
+ *          record payload. Returns false if they did not all fit.
+ */
+static bool log_pack_args(log_record* record, const char* fmt, va_list args)
+{
+    uint8_t* out = record->payload;
+    const uint8_t* const end = record->payload + sizeof(record->payload);
+    log_spec spec;
+
+#define LOG_PACK(type, value)                       \
+    do {                                            \
+        type v_ = (value);                          \
+        if (out + sizeof(v_) > end) {               \
+            return false;                           \
+        }                                           \
+        memcpy(out, &v_, sizeof(v_));               \
+        out += sizeof(v_);                          \
+        record->size = (uint8_t)(out - record->payload); \
+    } while (0)
+
+    while (log_next_spec(&fmt, &spec)) {
+        if (spec.star_width) {
+            LOG_PACK(int, va_arg(args, int));
+        }
+        if (spec.star_precision) {
+            LOG_PACK(int, va_arg(args, int));
+        }
+
+        switch (spec.kind) {
+            case LOG_ARG_INT: LOG_PACK(int, va_arg(args, int)); break;
+            case LOG_ARG_LONG: LOG_PACK(long, va_arg(args, long)); break;
+            case LOG_ARG_LONG_LONG: LOG_PACK(long long, va_arg(args, long long)); break;
+            case LOG_ARG_INTMAX: LOG_PACK(intmax_t, va_arg(args, intmax_t)); break;
+            case LOG_ARG_SIZE: LOG_PACK(size_t, va_arg(args, size_t)); break;
+            case LOG_ARG_PTRDIFF: LOG_PACK(ptrdiff_t, va_arg(args, ptrdiff_t)); break;
+            case LOG_ARG_DOUBLE: LOG_PACK(double, va_arg(args, double)); break;
+            case LOG_ARG_LONG_DOUBLE: LOG_PACK(long double, va_arg(args, long double)); break;
+            case LOG_ARG_POINTER: LOG_PACK(void*, va_arg(args, void*)); break;
+            case LOG_ARG_STRING: {
+                const char* str = va_arg(args, const char*);
+                if (!str) {
+                    str = "(null)";
+                }
+                const size_t space = (size_t)(end - out);
+                if (space == 0) {
+                    return false;
+                }
+                size_t len = log_strnlen(str, space);
+                if (len < space) {
+                    memcpy(out, str, len + 1);
+                } else {
+                    /* Keep what fits and mark the cut. */
+                    len = space - 1;
+                    memcpy(out, str, len);
+                    memcpy(out + len - (len < 3 ? len : 3), "...", len < 3 ? len : 3);
+                    out[len] = '\0';
+                }
+                out += len + 1;
+                record->size = (uint8_t)(out - record->payload);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+#undef LOG_PACK
+    return true;
+}
+
+void log_deferred_write(int level, const char* fmt, ...)
+{
+    uint32_t pos = atomic_load_explicit(&ring.head, memory_order_relaxed);
+    log_record* record;
+
+    for (;;) {
+        record = &ring.slots[pos % LOG_DEFERRED_RECORDS];
+        const int32_t diff = (int32_t)(log_load_seq(record, pos) - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring.head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* Slot still holds a message from the previous lap: ring is full. */
+            atomic_fetch_add_explicit(&ring.dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&ring.head, memory_order_relaxed);
+        }
+    }
+
+    record->fmt = fmt;
+    record->level = (uint8_t)level;
+    record->size = 0;
+
+    va_list args;
+    va_start(args, fmt);
+    record->truncated = !log_pack_args(record, fmt, args);
+    va_end(args);
+
+    log_store_seq(record, pos, pos + 1);
+}
+
+static void log_append(char* line, size_t size, size_t* pos, const char* text, size_t len)
+{
+    if (*pos + len >= size) {
+        len = size - 1 - *pos;
+    }
+    memcpy(line + *pos, text, len);
+    *pos += len;
+    line[*pos] = '\0';
+}
+
+static void log_append_formatted(size_t size, size_t* pos, int written)
+{
+    if (written > 0) {
+        *pos += (size_t)written;
+        if (*pos >= size) {
+            *pos = size - 1;
+        }
+    }
+}
+
+/**
+ * @brief   Copies a specification into buf, replacing '*' by the width or
+ *          precision that was recorded for it.
+ */
+static void log_resolve_spec(const log_spec* spec, int width, int precision,
+                             char* buf, size_t size)
+{
+    size_t n = 0;
+    bool after_dot = false;
+    for (size_t i = 0; i < spec->len && n + 1 < size; ++i) {
+        const char c = spec->start[i];
+        if (c == '*') {
+            const int written = snprintf(buf + n, size - n, "%d", after_dot ? precision : width);
+            n += (written > 0) ? (size_t)written : 0;
+            if (n >= size) {
+                n = size - 1;
+            }
+        } else {
+            after_dot = after_dot || (c == '.');
+            buf[n++] = c;
+        }
+    }
+    buf[n] = '\0';
+}
+
+/**
+ * @brief   Formats a recorded message into line. Arguments missing from a
+ *          truncated record end the line with "...".
+ */
+static void log_render(const log_record* record, char* line, size_t size)
+{
+    const uint8_t* in = record->payload;
+    const uint8_t* const end = record->payload + record->size;
+    const char* fmt = record->fmt;
+    const char* literal = fmt;
+    size_t pos = 0;
+    log_spec spec;
+    char spec_buf[32];
+
+    const size_t n_levels = sizeof(level_prefix) / sizeof(level_prefix[0]);
+    const char* prefix = level_prefix[record->level < n_levels ? record->level : n_levels - 1];
+    log_append(line, size, &pos, prefix, strlen(prefix));
+
+#define LOG_UNPACK(type, var)                       \
+    type var;                                       \
+    do {                                            \
+        if (in + sizeof(var) > end) {               \
+            goto truncated;                         \
+        }                                           \
+        memcpy(&var, in, sizeof(var));              \
+        in += sizeof(var);                          \
+    } while (0)
+
+    while (log_next_spec(&fmt, &spec)) {
+        log_append(line, size, &pos, literal, (size_t)(spec.start - literal));
+        literal = fmt;
+        if (record->truncated && in >= end && spec.kind != LOG_ARG_NONE) {
+            goto truncated;
+        }
+
+        int width = 0;
+        int precision = 0;
+        if (spec.star_width) {
+            LOG_UNPACK(int, w);
+            width = w;
+        }
+        if (spec.star_precision) {
+            LOG_UNPACK(int, p);
+            precision = p;
+        }
+        log_resolve_spec(&spec, width, precision, spec_buf, sizeof(spec_buf));
+
+        char* const out = line + pos;
+        const size_t space = size - pos;
+        switch (spec.kind) {
+            case LOG_ARG_INT: {
+                LOG_UNPACK(int, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_LONG: {
+                LOG_UNPACK(long, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_LONG_LONG: {
+                LOG_UNPACK(long long, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_INTMAX: {
+                LOG_UNPACK(intmax_t, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_SIZE: {
+                LOG_UNPACK(size_t, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_PTRDIFF: {
+                LOG_UNPACK(ptrdiff_t, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_DOUBLE: {
+                LOG_UNPACK(double, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_LONG_DOUBLE: {
+                LOG_UNPACK(long double, v);
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                break;
+            }
+            case LOG_ARG_POINTER: {
+                LOG_UNPACK(void*, v);
+                /* %n would write through a pointer that may no longer be valid. */
+                if (spec.start[spec.len - 1] == 'p') {
+                    log_append_formatted(size, &pos, snprintf(out, space, spec_buf, v));
+                }
+                break;
+            }
+            case LOG_ARG_STRING: {
+                if (in >= end) {
+                    goto truncated;
+                }
+                /* Strings are stored null terminated; anything else is corrupt. */
+                const char* str = (const char*)in;
+                const size_t len = log_strnlen(str, (size_t)(end - in));
+                if (len == (size_t)(end - in)) {
+                    goto truncated;
+                }
+                in += len + 1;
+                log_append_formatted(size, &pos, snprintf(out, space, spec_buf, str));
+                break;
+            }
+            default:
+                if (spec.len >= 2 && spec.start[spec.len - 1] == '%') {
+                    log_append(line, size, &pos, "%", 1);
+                } else {
+                    log_append(line, size, &pos, spec.start, spec.len);
+                }
+                break;
+        }
+    }
+#undef LOG_UNPACK
+
+    log_append(line, size, &pos, literal, strlen(literal));
+    return;
+
+truncated:
+    log_append(line, size, &pos, "...\n", 4);
+}
+
+static void log_default_sink(const char* text, size_t len)
+{
+    fwrite(text, 1, len, stdout);
+}
+
+size_t log_deferred_drain(size_t max_records)
+{
+    static char line[LOG_DEFERRED_LINE_MAX];
+    static log_record record;
+
+    if (atomic_flag_test_and_set_explicit(&ring.draining, memory_order_acquire)) {
+        return 0;
+    }
+    const log_deferred_sink sink = ring.sink ? ring.sink : log_default_sink;
+
+    const uint32_t dropped = atomic_exchange_explicit(&ring.dropped, 0, memory_order_relaxed);
+    if (dropped) {
+        const int len = snprintf(line, sizeof(line), "WARN - %" PRIu32 " log messages dropped\n", dropped);
+        sink(line, (len > 0 && (size_t)len < sizeof(line)) ? (size_t)len : strlen(line));
+    }
+
+    size_t count = 0;
+    while (count < max_records) {
+        const uint32_t pos = ring.tail;
+        log_record* slot = &ring.slots[pos % LOG_DEFERRED_RECORDS];
+        if (log_load_seq(slot, pos) != pos + 1) {
+            break;
+        }
+
+        /* Copy the message out so that the slot can be reused while formatting. */
+        record.fmt = slot->fmt;
+        record.level = slot->level;
+        record.size = slot->size;
+        record.truncated = slot->truncated;
+        memcpy(record.payload, slot->payload, slot->size);
+        log_store_seq(slot, pos, pos + LOG_DEFERRED_RECORDS);
+        ring.tail = pos + 1;
+
+        log_render(&record, line, sizeof(line));
+        sink(line, strlen(line));
+        ++count;
+    }
+
+    atomic_flag_clear_explicit(&ring.draining, memory_order_release);
+    return count;
+}
+
+void log_deferred_flush(void)
+{
+    while (log_deferred_drain(LOG_DEFERRED_RECORDS) != 0) {
+    }
+}
+
+void log_deferred_set_sink(log_deferred_sink sink)
+{
+    ring.sink = sink;
+}
+
+uint32_t log_deferred_get_dropped(void)
+{
+    return (uint32_t)atomic_load_explicit(&ring.dropped, memory_order_relaxed);
+}
@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates
+ * <open-source-office@arm.com> SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "log_trace.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef LOG_TRACE_EVENTS
+#define LOG_TRACE_EVENTS (1024)
+#endif /* LOG_TRACE_EVENTS */
+
+/* Positions wrap at 2^32, which keeps slot indices consistent only for powers of two. */
+_Static_assert((LOG_TRACE_EVENTS & (LOG_TRACE_EVENTS - 1)) == 0,
+               "LOG_TRACE_EVENTS must be a power of two");
+
+typedef struct {
+    atomic_uint_least32_t seq;  /* Position + 1 once the span is written. */
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint8_t track;
+} log_trace_record;
+
+/*
+ * Ring of the latest spans. Producers claim a position and mark the slot
+ * with it once written, so that the export can skip slots being written
+ * or overwritten. Spans before base were cleared.
+ */
+static struct {
+    log_trace_record slots[LOG_TRACE_EVENTS];
+    atomic_uint_least32_t head;
+    uint32_t base;
+    log_trace_clock clock;
+    uint32_t ticks_per_second;
+} ring;
+
+static const char* const track_names[LOG_TRACE_TRACKS] = {
+    "CPU", "Camera", "Audio", "NPU", "Display"
+};
+
+void log_trace_set_clock(log_trace_clock clock, uint32_t ticks_per_second)
+{
+    ring.ticks_per_second = ticks_per_second;
+    ring.clock = clock;
+}
+
+uint64_t log_trace_now(void)
+{
+    const log_trace_clock clock = ring.clock;
+    return clock ? clock() : 0;
+}
+
+void log_trace_span(log_trace_track track, const char* name, uint64_t start, uint64_t end)
+{
+    if (!ring.clock || (unsigned)track >= LOG_TRACE_TRACKS) {
+        return;
+    }
+
+    const uint32_t pos = (uint32_t)atomic_fetch_add_explicit(&ring.head, 1, memory_order_relaxed);
+    log_trace_record* record = &ring.slots[pos % LOG_TRACE_EVENTS];
+
+    /* Invalidate the slot while it is rewritten. */
+    atomic_store_explicit(&record->seq, 0, memory_order_relaxed);
+    atomic_signal_fence(memory_order_seq_cst);
+    record->name = name;
+    record->start = start;
+    record->end = end < start ? start : end;
+    record->track = (uint8_t)track;
+    atomic_store_explicit(&record->seq, pos + 1, memory_order_release);
+}
+
+/** Oldest position still held. */
+static uint32_t log_trace_first(uint32_t head)
+{
+    const uint32_t held = head - ring.base;
+    return held > LOG_TRACE_EVENTS ? head - LOG_TRACE_EVENTS : ring.base;
+}
+
+size_t log_trace_count(void)
+{
+    const uint32_t head = (uint32_t)atomic_load_explicit(&ring.head, memory_order_acquire);
+    return head - log_trace_first(head);
+}
+
+bool log_trace_full(void)
+{
+    return log_trace_count() == LOG_TRACE_EVENTS;
+}
+
+void log_trace_clear(void)
+{
+    ring.base = (uint32_t)atomic_load_explicit(&ring.head, memory_order_acquire);
+}
+
+/** Ticks to microseconds, the time unit of the trace format. */
+static double log_trace_us(uint64_t ticks)
+{
+    return ring.ticks_per_second ? (double)ticks * 1e6 / ring.ticks_per_second : 0.0;
+}
+
+/** Writes the part of a span name JSON can hold in a string as it is. */
+static void log_trace_copy_name(char* out, size_t size, const char* name)
+{
+    size_t n = 0;
+    for (; name && *name && n + 1 < size; ++name) {
+        out[n++] = (*name == '"' || *name == '\\' || (unsigned char)*name < ' ') ? '_' : *name;
+    }
+    out[n] = '\0';
+}
+
+size_t log_trace_export(log_trace_writer write, void* ctx)
+{
+    char buf[192];
+    char name[64];
+    int len;
+
+#define LOG_TRACE_WRITE(...)                                \
+    do {                                                    \
+        len = snprintf(buf, sizeof(buf), __VA_ARGS__);      \
+        if (len > (int)sizeof(buf) - 1) {                   \
+            len = (int)sizeof(buf) - 1;                     \
+        }                                                   \
+        if (len > 0) {                                      \
+            write(buf, (size_t)len, ctx);                   \
+        }                                                   \
+    } while (0)
+
+    LOG_TRACE_WRITE("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int track = 0; track < LOG_TRACE_TRACKS; ++track) {
+        LOG_TRACE_WRITE("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+                        "\"args\":{\"name\":\"%s\"}},\n"
+                        "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+                        "\"args\":{\"sort_index\":%d}}",
+                        track ? ",\n" : "", track, track_names[track], track, track);
+    }
+
+    const uint32_t head = (uint32_t)atomic_load_explicit(&ring.head, memory_order_acquire);
+    size_t written = 0;
+    for (uint32_t pos = log_trace_first(head); pos != head; ++pos) {
+        const log_trace_record* record = &ring.slots[pos % LOG_TRACE_EVENTS];
+        if ((uint32_t)atomic_load_explicit(&record->seq, memory_order_acquire) != pos + 1) {
+            continue;
+        }
+        log_trace_copy_name(name, sizeof(name), record->name);
+        LOG_TRACE_WRITE(",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                        name, (unsigned)record->track, log_trace_us(record->start),
+                        log_trace_us(record->end - record->start));
+        ++written;
+    }
+    LOG_TRACE_WRITE("\n]}\n");
+
+#undef LOG_TRACE_WRITE
+    return written;
+}
+
+static void log_trace_write_stream(const char* text, size_t len, void* ctx)
+{
+    fwrite(text, 1, len, (FILE*)ctx);
+}
+
+void log_trace_dump(void)
+{
+    printf("--- trace start ---\n");
+    log_trace_export(log_trace_write_stream, stdout);
+    printf("--- trace end ---\n");
+    fflush(stdout);
+}
+
+bool log_trace_write_file(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    log_trace_export(log_trace_write_stream, file);
+    return fclose(file) == 0;
+}
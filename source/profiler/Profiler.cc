@@ -17,40 +17,147 @@
 #include "Profiler.hpp"
 #include "log_macros.h"
 
+#include <algorithm>
 #include <cstring>
 
 namespace arm {
 namespace app {
+
+    bool Profiler::ms_pmuInitialised = false;
+    std::uint32_t Profiler::ms_pmuUsers = 0;
+
+    std::uint32_t ProfilingHistogram::BucketIndex(std::uint64_t value)
+    {
+        if (value < 2) {
+            return static_cast<std::uint32_t>(value);
+        }
+        /* Position of the leading one, then the bit below it picks the half octave. */
+        std::uint32_t octave = 63;
+        while (!(value & (1ULL << octave))) {
+            --octave;
+        }
+        const std::uint32_t index = 2 * octave + ((value >> (octave - 1)) & 1);
+        return std::min<std::uint32_t>(index, PROFILER_HISTOGRAM_BUCKETS - 1);
+    }
+
+    std::uint64_t ProfilingHistogram::BucketLow(std::uint32_t index)
+    {
+        if (index < 2) {
+            return index;
+        }
+        const std::uint32_t octave = index / 2;
+        return (1ULL << octave) + (index & 1) * (1ULL << (octave - 1));
+    }
+
+    void ProfilingHistogram::Add(std::uint64_t value)
+    {
+        auto& bucket = this->m_buckets[BucketIndex(value)];
+        if (bucket == UINT16_MAX) {
+            /* Halve everything rather than saturate, keeping the distribution's shape. */
+            this->m_count = 0;
+            for (auto& b : this->m_buckets) {
+                b = (b + 1) / 2;
+                this->m_count += b;
+            }
+        }
+        ++bucket;
+        ++this->m_count;
+    }
+
+    std::uint64_t ProfilingHistogram::Percentile(double percent, std::uint64_t min,
+                                                 std::uint64_t max) const
+    {
+        if (this->m_count == 0) {
+            return 0;
+        }
+
+        const double rank = (percent / 100.0) * this->m_count;
+        std::uint32_t cumulative = 0;
+        for (std::uint32_t i = 0; i < PROFILER_HISTOGRAM_BUCKETS; ++i) {
+            const std::uint32_t inBucket = this->m_buckets[i];
+            if (inBucket == 0 || cumulative + inBucket < rank) {
+                cumulative += inBucket;
+                continue;
+            }
+
+            /* Interpolate linearly within the bucket, bounded by the observed range. */
+            const std::uint64_t low = std::max(BucketLow(i), min);
+            const std::uint64_t high = (i + 1 < PROFILER_HISTOGRAM_BUCKETS) ?
+                    std::min(BucketLow(i + 1), max + 1) : max + 1;
+            const double fraction = std::max(0.0, rank - cumulative) / inBucket;
+            const auto value = static_cast<std::uint64_t>(low + fraction * (high - low));
+            return std::min(std::max(value, min), max);
+        }
+        return max;
+    }
+
+    void ProfilingHistogram::Clear()
+    {
+        std::memset(this->m_buckets, 0, sizeof(this->m_buckets));
+        this->m_count = 0;
+    }
+
     Profiler::Profiler()
         : Profiler("Unknown")
     {}
 
     Profiler::Profiler(const char* name)
-        : m_name(name)
-    {}
+    {
+        this->SetName(name);
+    }
+
+    ProfilingRegionId Profiler::RegisterRegion(const char* name)
+    {
+        for (std::uint32_t i = 0; i < this->m_numRegions; ++i) {
+            if (0 == std::strncmp(this->m_regions[i].name, name, PROFILER_REGION_NAME_LEN - 1)) {
+                return i;
+            }
+        }
+
+        if (this->m_numRegions == PROFILER_MAX_REGIONS) {
+            ++this->m_droppedRegions;
+            printf_err("No space to register profiling region %s: profiler %s is limited to "
+                       "%d regions, raise PROFILER_MAX_REGIONS\n",
+                       name, this->m_name, PROFILER_MAX_REGIONS);
+            return InvalidProfilingRegion;
+        }
+
+        Region& region = this->m_regions[this->m_numRegions];
+        region = Region{};
+        std::strncpy(region.name, name, PROFILER_REGION_NAME_LEN - 1);
+        return this->m_numRegions++;
+    }
 
     bool Profiler::StartProfiling(const char* name)
     {
         if (name) {
             this->SetName(name);
         }
+        return this->StartProfiling(this->RegisterRegion(this->m_name));
+    }
 
-        if (!this->m_started) {
-            hal_pmu_init();
+    bool Profiler::StartProfiling(ProfilingRegionId region)
+    {
+        if (!this->m_started && region < this->m_numRegions) {
+            /* Counters are initialised once, and only reset for a region
+             * when no other profiler is measuring with them. */
+            if (!ms_pmuInitialised) {
+                hal_pmu_init();
+                ms_pmuInitialised = true;
+            } else if (0 == ms_pmuUsers) {
+                hal_pmu_reset();
+            }
             this->m_tstampSt.initialised = false;
             hal_pmu_get_counters(&this->m_tstampSt);
             if (this->m_tstampSt.initialised) {
-                if (this->m_profStats.count(this->m_name) == 0) {
-                    this->m_profStats.insert(
-                            std::pair<std::string, std::vector<Statistics>>(
-                                    this->m_name, std::vector<Statistics>(this->m_tstampSt.num_counters))
-                                    );
-                }
+                this->m_current = region;
                 this->m_started = true;
+                ++ms_pmuUsers;
                 return true;
             }
         }
-        printf_err("Failed to start profiler %s\n", this->m_name.c_str());
+        printf_err("Failed to start profiler %s\n",
+                   region < this->m_numRegions ? this->m_regions[region].name : this->m_name);
         return false;
     }
 
@@ -59,17 +166,17 @@ namespace app {
         if (this->m_started) {
             this->m_tstampEnd.initialised = false;
             hal_pmu_get_counters(&this->m_tstampEnd);
-            hal_pmu_final();
             this->m_started = false;
+            --ms_pmuUsers;
             if (this->m_tstampEnd.initialised) {
                 this->UpdateRunningStats(
                     this->m_tstampSt,
                     this->m_tstampEnd,
-                    this->m_name);
+                    this->m_regions[this->m_current]);
                 return true;
             }
         }
-        printf_err("Failed to stop profiler %s\n", this->m_name.c_str());
+        printf_err("Failed to stop profiler %s\n", this->m_name);
         return false;
     }
 
@@ -79,36 +186,64 @@ namespace app {
             this->Reset();
             return true;
         }
-        printf_err("Failed to stop profiler %s\n", this->m_name.c_str());
+        printf_err("Failed to stop profiler %s\n", this->m_name);
         return false;
     }
 
     void Profiler::Reset()
     {
+        if (this->m_started) {
+            --ms_pmuUsers;
+        }
+        if (ms_pmuInitialised && 0 == ms_pmuUsers) {
+            hal_pmu_final();
+            ms_pmuInitialised = false;
+        }
         this->m_started = false;
-        this->m_profStats.clear();
+        this->m_current = InvalidProfilingRegion;
+        this->m_droppedRegions = 0;
+
+        /* Registered regions keep their IDs; only their statistics are cleared. */
+        for (std::uint32_t i = 0; i < this->m_numRegions; ++i) {
+            Region& region = this->m_regions[i];
+            region.numCounters = 0;
+            for (auto& stat : region.stats) {
+                stat = CounterStats{};
+            }
+        }
         memset(&this->m_tstampSt, 0, sizeof(this->m_tstampSt));
         memset(&this->m_tstampEnd, 0, sizeof(this->m_tstampEnd));
     }
 
-    void calcProfilingStat(uint64_t currentValue,
-                           Statistics& data)
-    {
-        data.total += currentValue;
-        data.min = std::min(data.min, currentValue);
-        data.max = std::max(data.max, currentValue);
-        data.avrg = (static_cast<double>(data.total) / data.samplesNum);
-    }
-
     void Profiler::GetAllResultsAndReset(std::vector<ProfileResult>& results)
     {
-        for (const auto& item: this->m_profStats) {
-            auto name = item.first;
-            std::vector<Statistics> series = item.second;
+        for (std::uint32_t r = 0; r < this->m_numRegions; ++r) {
+            const Region& region = this->m_regions[r];
+            if (region.numCounters == 0) {
+                continue;
+            }
             ProfileResult result{};
-            result.name = item.first;
+            result.name = region.name;
+
+            for (std::uint32_t i = 0; i < region.numCounters; ++i) {
+                const CounterStats& counter = region.stats[i];
+                Statistics stat{};
+                stat.name = region.counterNames[i];
+                stat.unit = region.counterUnits[i];
+                stat.total = counter.total;
+                stat.min = counter.min;
+                stat.max = counter.max;
+                stat.samplesNum = counter.samplesNum;
+                stat.avrg = counter.samplesNum ?
+                        static_cast<double>(counter.total) / counter.samplesNum : 0;
+#if defined(PROFILER_PERCENTILES)
+                stat.p50 = counter.histogram.Percentile(50, counter.min, counter.max);
+                stat.p99 = counter.histogram.Percentile(99, counter.min, counter.max);
+#else /* defined(PROFILER_PERCENTILES) */
+                stat.p50 = 0;
+                stat.p99 = 0;
+#endif /* defined(PROFILER_PERCENTILES) */
 
-            for (Statistics& stat : series) {
                 result.samplesNum = stat.samplesNum;
                 result.data.emplace_back(stat);
             }
@@ -121,12 +256,22 @@ namespace app {
 
     void printStatisticsHeader(uint32_t samplesNum) {
         info("Number of samples: %" PRIu32 "\n", samplesNum);
+#if defined(PROFILER_PERCENTILES)
+        info("%s\n", "Total / Avg./ Min / Max / P50 / P99");
+#else /* defined(PROFILER_PERCENTILES) */
         info("%s\n", "Total / Avg./ Min / Max");
+#endif /* defined(PROFILER_PERCENTILES) */
     }
 
     void Profiler::PrintProfilingResult(bool printFullStat) {
+        const std::uint32_t droppedRegions = this->m_droppedRegions;
         std::vector<ProfileResult> results{};
         GetAllResultsAndReset(results);
+        if (droppedRegions) {
+            printf_err("Profiler %s dropped %" PRIu32 " requests for regions beyond its %d, "
+                       "raise PROFILER_MAX_REGIONS\n",
+                       this->m_name, droppedRegions, PROFILER_MAX_REGIONS);
+        }
         for(ProfileResult& result: results) {
             if (!result.data.empty()) {
                 info("Profile for %s:\n", result.name.c_str());
@@ -137,9 +282,15 @@ namespace app {
 
             for (Statistics &stat: result.data) {
                 if (printFullStat) {
+#if defined(PROFILER_PERCENTILES)
+                    info("%s %s: %" PRIu64 "/ %.0f / %" PRIu64 " / %" PRIu64 " / %" PRIu64 " / %" PRIu64 " \n",
+                         stat.name.c_str(), stat.unit.c_str(),
+                         stat.total, stat.avrg, stat.min, stat.max, stat.p50, stat.p99);
+#else /* defined(PROFILER_PERCENTILES) */
                     info("%s %s: %" PRIu64 "/ %.0f / %" PRIu64 " / %" PRIu64 " \n",
                          stat.name.c_str(), stat.unit.c_str(),
                          stat.total, stat.avrg, stat.min, stat.max);
+#endif /* defined(PROFILER_PERCENTILES) */
                 } else {
                     info("%s: %.0f %s\n", stat.name.c_str(), stat.avrg, stat.unit.c_str());
                 }
@@ -147,50 +298,45 @@ namespace app {
         }
     }
 
-    void Profiler::SetName(const char* str)
+    std::uint32_t Profiler::GetDroppedRegionCount() const
     {
-        this->m_name = std::string(str);
+        return this->m_droppedRegions;
     }
 
-    void Profiler::UpdateRunningStats(pmu_counters start, pmu_counters end,
-                                      const std::string& name)
+    void Profiler::SetName(const char* str)
     {
-        struct ProfilingUnit unit = {
-            .counters = end
-        };
+        std::strncpy(this->m_name, str, PROFILER_REGION_NAME_LEN - 1);
+        this->m_name[PROFILER_REGION_NAME_LEN - 1] = '\0';
+    }
 
+    void Profiler::UpdateRunningStats(const pmu_counters& start, const pmu_counters& end,
+                                      Region& region)
+    {
         if (end.num_counters != start.num_counters ||
             !end.initialised || !start.initialised) {
             printf_err("Invalid start or end counters\n");
             return;
         }
 
-        for (size_t i = 0; i < unit.counters.num_counters; ++i) {
-            if (unit.counters.counters[i].value < start.counters[i].value) {
-                warn("Overflow detected for %s\n", unit.counters.counters[i].name);
-                unit.counters.counters[i].value = 0;
+        region.numCounters = end.num_counters;
+        for (std::uint32_t i = 0; i < end.num_counters; ++i) {
+            std::uint64_t value = 0;
+            if (end.counters[i].value < start.counters[i].value) {
+                warn("Overflow detected for %s\n", end.counters[i].name);
             } else {
-                unit.counters.counters[i].value -= start.counters[i].value;
+                value = end.counters[i].value - start.counters[i].value;
             }
-        }
-
-        for (size_t i = 0; i < this->m_profStats[name].size(); ++i) {
-            this->m_profStats[name][i].name = unit.counters.counters[i].name;
-            this->m_profStats[name][i].unit = unit.counters.counters[i].unit;
-            ++this->m_profStats[name][i].samplesNum;
-            calcProfilingStat(
-                    unit.counters.counters[i].value,
-                    this->m_profStats[name][i]);
-        }
-
-        ProfileResult result{};
-        result.name = this->m_name;
-        if (!this->m_profStats[name].empty()) {
-            result.samplesNum = this->m_profStats[name][0].samplesNum;
-        }
 
-        for (Statistics& stat : this->m_profStats[name]) {
-            result.data.emplace_back(stat);
+            CounterStats& stat = region.stats[i];
+            region.counterNames[i] = end.counters[i].name;
+            region.counterUnits[i] = end.counters[i].unit;
+            stat.min = stat.samplesNum ? std::min(stat.min, value) : value;
+            stat.max = std::max(stat.max, value);
+            stat.total += value;
+            ++stat.samplesNum;
+#if defined(PROFILER_PERCENTILES)
+            stat.histogram.Add(value);
+#endif /* defined(PROFILER_PERCENTILES) */
         }
     }
 
@@ -21,9 +21,15 @@
 
 #include <cstdint>
 #include <string>
-#include <map>
 #include <vector>
 
+#ifndef PROFILER_MAX_REGIONS
+#define PROFILER_MAX_REGIONS        (4)     /**< Maximum number of profiling regions per profiler; set by the PROFILER_MAX_REGIONS build option. */
+#endif /* PROFILER_MAX_REGIONS */
+
+#define PROFILER_REGION_NAME_LEN    (32)    /**< Maximum length of a region name, including terminator. */
+#define PROFILER_HISTOGRAM_BUCKETS  (64)    /**< Two buckets per octave, covering values up to 2^32. */
+
 namespace arm {
 namespace app {
 
@@ -35,6 +41,8 @@ namespace app {
         double avrg;
         std::uint64_t min;
         std::uint64_t max;
+        std::uint64_t p50;
+        std::uint64_t p99;
         std::uint32_t samplesNum = 0;
     };
 
@@ -50,12 +58,54 @@ namespace app {
         pmu_counters counters;
     };
 
-    /* A map for string identifiable profiling statistics. */
-    using ProfilingStats = std::map<std::string, std::vector<Statistics>>;
+    /** Identifier of a profiling region registered with a profiler. */
+    using ProfilingRegionId = std::uint32_t;
+
+    /** Returned when a region cannot be registered. */
+    constexpr ProfilingRegionId InvalidProfilingRegion = UINT32_MAX;
+
+    /**
+     * @brief   Fixed size histogram with logarithmic buckets, used to estimate
+     *          percentiles without storing individual samples. Values are
+     *          binned with two buckets per power of two, so estimates are
+     *          within about 25% of the true value.
+     */
+    class ProfilingHistogram {
+    public:
+        /** @brief  Adds a sample to the histogram. */
+        void Add(std::uint64_t value);
+
+        /**
+         * @brief       Estimates a percentile by interpolating within the bucket it
+         *              falls into.
+         * @param[in]   percent     Percentile to get, between 0 and 100.
+         * @param[in]   min         Smallest sample seen, used to bound the estimate.
+         * @param[in]   max         Largest sample seen, used to bound the estimate.
+         * @return      Estimated value, or 0 if the histogram is empty.
+         **/
+        std::uint64_t Percentile(double percent, std::uint64_t min, std::uint64_t max) const;
+
+        /** @brief  Clears all buckets. */
+        void Clear();
+
+    private:
+        std::uint16_t m_buckets[PROFILER_HISTOGRAM_BUCKETS]{};
+        std::uint32_t m_count = 0;
+
+        static std::uint32_t BucketIndex(std::uint64_t value);
+        static std::uint64_t BucketLow(std::uint32_t index);
+    };
 
     /**
      * @brief   A very simple profiler example using the platform timer
      *          implementation.
+     *
+     *          Profiling regions are kept in a fixed size table. Regions can be
+     *          registered up front with RegisterRegion and then started by ID,
+     *          which neither allocates nor looks up names. Statistics are only
+     *          formatted when results are collected or printed. P50 and P99 are
+     *          only kept when built with PROFILER_PERCENTILES, as the histograms
+     *          make the profiler several KiB larger; they read 0 otherwise.
      */
     class Profiler {
     public:
@@ -71,9 +121,20 @@ namespace app {
         /** Default destructor. */
         ~Profiler() = default;
 
+        /**
+         * @brief       Registers a profiling region, or finds an existing one
+         *              with the same name.
+         * @param[in]   name    Name of the region.
+         * @return      Region ID, or InvalidProfilingRegion if the table is full.
+         **/
+        ProfilingRegionId RegisterRegion(const char* name);
+
         /** @brief  Start profiling => get starting time-stamp. */
         bool StartProfiling(const char* name = nullptr);
 
+        /** @brief  Start profiling a registered region. */
+        bool StartProfiling(ProfilingRegionId region);
+
         /** @brief  Stop profiling => get the ending time-stamp. */
         bool StopProfiling();
 
@@ -81,7 +142,7 @@ namespace app {
          *          platform timers. */
         bool StopProfilingAndReset();
 
-        /** @brief  Reset the platform timers. */
+        /** @brief  Reset the platform timers and clear the statistics of all regions. */
         void Reset();
 
         /**
@@ -97,25 +158,58 @@ namespace app {
         /** @brief Set the profiler name. */
         void SetName(const char* str);
 
+        /**
+         * @brief   Gets the number of times a region could not be registered
+         *          since the last reset, as the region table was full.
+         **/
+        std::uint32_t GetDroppedRegionCount() const;
+
     private:
-        ProfilingStats     m_profStats;             /* Profiling stats map. */
+        /** Running statistics for one counter of a region. */
+        struct CounterStats {
+            std::uint64_t total;
+            std::uint64_t min;
+            std::uint64_t max;
+            std::uint32_t samplesNum;
+#if defined(PROFILER_PERCENTILES)
+            ProfilingHistogram histogram;
+#endif /* defined(PROFILER_PERCENTILES) */
+        };
+
+        /** Entry of the region table. */
+        struct Region {
+            char name[PROFILER_REGION_NAME_LEN];
+            const char* counterNames[NUM_PMU_COUNTERS];
+            const char* counterUnits[NUM_PMU_COUNTERS];
+            std::uint32_t numCounters;
+            CounterStats stats[NUM_PMU_COUNTERS];
+        };
+
+        Region             m_regions[PROFILER_MAX_REGIONS];
+        std::uint32_t      m_numRegions = 0;
+        std::uint32_t      m_droppedRegions = 0;    /* Regions refused as the table was full. */
+        ProfilingRegionId  m_current = InvalidProfilingRegion;  /* Region being profiled. */
         pmu_counters       m_tstampSt{};            /* Container for a current starting timestamp. */
         pmu_counters       m_tstampEnd{};           /* Container for a current ending timestamp. */
         bool               m_started = false;       /* Indicates profiler has been started. */
-        std::string        m_name;                  /* Name given to this profiler. */
+        char               m_name[PROFILER_REGION_NAME_LEN]{};  /* Name given to this profiler. */
+
+        /** Whether the platform counters have been initialised by any profiler. */
+        static bool ms_pmuInitialised;
 
+        /** Number of profilers currently profiling. The platform counters are
+         *  shared, so they are only reset or finalised when this is 0. */
+        static std::uint32_t ms_pmuUsers;
 
         /**
-         * @brief       Updates the running average stats with those computed
-         *              by the "start" and "end" timestamps for the profiling
-         *              stats identified by the name provided.
+         * @brief       Updates the running stats of a region with those computed
+         *              by the "start" and "end" timestamps.
          * @param[in]   start   Starting time-stamp.
          * @param[in]   end     Ending time-stamp.
-         * @param[in]   name    Name for the profiling running stats series to be
-         *                      updated.
+         * @param[in]   region  Region whose running stats are to be updated.
          **/
-        void UpdateRunningStats(pmu_counters start, pmu_counters end,
-                                const std::string& name);
+        void UpdateRunningStats(const pmu_counters& start, const pmu_counters& end,
+                                Region& region);
     };
 
 } /* namespace app */
@@ -137,6 +137,7 @@ namespace app {
             }
 
             profiler.PrintProfilingResult();
+            log_flush();
         }
 
         return true;
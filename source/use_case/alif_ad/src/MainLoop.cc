@@ -48,7 +48,7 @@ void MainLoop()
     /* Instantiate application context. */
     arm::app::ApplicationContext caseContext;
 
-    arm::app::Profiler profiler{"ad"};
+    static arm::app::Profiler profiler{"ad"};
     caseContext.Set<arm::app::Profiler&>("profiler", profiler);
     caseContext.Set<arm::app::Model&>("model", model);
     caseContext.Set<uint32_t>("index", 0);
@@ -64,5 +64,6 @@ void MainLoop()
      /* Loop. */
     do {
         alif::app::ClassifyVibrationHandler(caseContext);
+        log_flush();
     } while (1);
 }
@@ -30,11 +30,34 @@
 #define ALIF_IMG_CLASS_EVT_HANDLER_HPP
 
 #include "AppContext.hpp"
+#include "ClassificationResult.hpp"
+#include "Classifier.hpp"
 #include "MobileNetModel.hpp"
+#include "Profiler.hpp"
+
+#include <string>
+#include <vector>
 
 namespace alif {
 namespace app {
 
+    /* Entries of the image classification application context. */
+    namespace key {
+        using arm::app::ContextKey;
+
+        struct Profiler : ContextKey<arm::app::Profiler&> {};
+        struct Model : ContextKey<arm::app::Model&> {};
+        struct Classifier : ContextKey<arm::app::Classifier&> {};
+        struct Labels : ContextKey<const std::vector<std::string>&> {};
+        struct Results : ContextKey<std::vector<arm::app::ClassificationResult>> {}; /* Of the last frame. */
+    } /* namespace key */
+
+    using ImgClassContext = arm::app::TypedContext<key::Profiler,
+                                                   key::Model,
+                                                   key::Classifier,
+                                                   key::Labels,
+                                                   key::Results>;
+
     bool ClassifyImageInit(arm::app::MobileNetModel& model);
 
     /**
@@ -42,7 +65,7 @@ namespace app {
      * @param[in]   ctx        Pointer to the application context.
      * @return      true or false based on execution success.
      **/
-    bool ClassifyImageHandler(arm::app::ApplicationContext& ctx);
+    bool ClassifyImageHandler(ImgClassContext& ctx);
 
 } /* namespace app */
 } /* namespace alif */
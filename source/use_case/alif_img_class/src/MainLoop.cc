@@ -32,6 +32,8 @@
 #include "MobileNetModel.hpp"       /* Model class for running inference. */
 #include "UseCaseHandler.hpp"       /* Handlers for different user options. */
 #include "UseCaseCommonUtils.hpp"   /* Utils functions. */
+#include "log_macros.h"             /* Logging functions */
+#include "log_trace.h"              /* Timeline tracing */
 #include "BufAttributes.hpp"        /* Buffer attributes to be applied */
 
 namespace arm {
@@ -68,21 +70,25 @@ void MainLoop()
     }
 
     /* Instantiate application context. */
-    arm::app::ApplicationContext caseContext;
+    alif::app::ImgClassContext caseContext;
 
-    arm::app::Profiler profiler{"img_class"};
-    caseContext.Set<arm::app::Profiler&>("profiler", profiler);
-    caseContext.Set<arm::app::Model&>("model", model);
+    static arm::app::Profiler profiler{"img_class"};
+    caseContext.Set<alif::app::key::Profiler>(profiler);
+    caseContext.Set<alif::app::key::Model>(model);
 
     ImgClassClassifier classifier;  /* Classifier wrapper object. */
-    caseContext.Set<arm::app::Classifier&>("classifier", classifier);
+    caseContext.Set<alif::app::key::Classifier>(classifier);
 
     std::vector<std::string> labels;
     GetLabelsVector(labels);
-    caseContext.Set<const std::vector <std::string>&>("labels", labels);
+    caseContext.Set<alif::app::key::Labels>(labels);
 
     /* Loop. */
     do {
+        LOG_TRACE_BEGIN(frame);
         alif::app::ClassifyImageHandler(caseContext);
+        LOG_TRACE_END(frame, LOG_TRACE_TRACK_CPU, "frame");
+        log_flush();
+        LOG_TRACE_DUMP_WHEN_FULL();
     } while (1);
 }
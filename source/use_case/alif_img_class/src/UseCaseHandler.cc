@@ -47,7 +47,6 @@
 // Do we get LVGL to zoom the camera image, or do we double it up?
 #define USE_LVGL_ZOOM
 
-using ImgClassClassifier = arm::app::Classifier;
 
 #define MIMAGE_X 224
 #define MIMAGE_Y 224
@@ -105,21 +104,26 @@ namespace app {
             return false;
         }
 
-        auto bCamera = hal_camera_configure(nCols, nRows, HAL_CAMERA_MODE_SINGLE_FRAME, HAL_CAMERA_COLOUR_FORMAT_RGB888);
+        auto bCamera = hal_camera_configure(nCols, nRows, HAL_CAMERA_MODE_CONTINUOUS, HAL_CAMERA_COLOUR_FORMAT_RGB888);
         if (!bCamera) {
             printf_err("Failed to configure camera.\n");
             return false;
         }
 
+        if (!hal_camera_start()) {
+            printf_err("Failed to start camera.\n");
+            return false;
+        }
+
         return true;
     }
 
     /* Image classification inference handler. */
-    bool ClassifyImageHandler(ApplicationContext& ctx)
+    bool ClassifyImageHandler(ImgClassContext& ctx)
     {
 #if !SKIP_MODEL
-        auto& profiler = ctx.Get<Profiler&>("profiler");
-        auto& model = ctx.Get<Model&>("model");
+        auto& profiler = ctx.Get<key::Profiler>();
+        auto& model = ctx.Get<key::Model>();
 
         if (!model.IsInited()) {
             printf_err("Model is not initialised! Terminating processing.\n");
@@ -146,47 +150,50 @@ namespace app {
 
         std::vector<ClassificationResult> results;
         ImgClassPostProcess postProcess = ImgClassPostProcess(outputTensor,
-                ctx.Get<ImgClassClassifier&>("classifier"), ctx.Get<std::vector<std::string>&>("labels"),
+                ctx.Get<key::Classifier>(), ctx.Get<key::Labels>(),
                 results);
 #else
         const uint32_t nCols       = MIMAGE_X;
         const uint32_t nRows       = MIMAGE_Y;
 #endif
 
-        hal_camera_start();
-
-        uint32_t capturedFrameSize = 0;
-        const uint8_t* image_data = hal_camera_get_captured_frame(&capturedFrameSize);
-        if (!image_data || !capturedFrameSize) {
-            printf_err("hal_camera_get_captured_frame failed");
+        /* The camera keeps capturing the next frame while this one is processed. */
+        hal_camera_frame frame;
+        if (!hal_camera_get_frame(&frame) || !frame.size) {
+            printf_err("hal_camera_get_frame failed");
             return false;
         }
+        if (frame.dropped) {
+            debug("Frame %" PRIu32 ": %" PRIu32 " frames dropped\n", frame.sequence, frame.dropped);
+        }
+        const uint8_t* image_data = frame.data;
 
         uint32_t lv_lock_state = lv_port_lock();
         tprof5 = Get_SysTick_Cycle_Count32();
-        /* Display this image on the LCD. */
+        /* Display this image on the LCD, straight into the framebuffer when possible. */
+        if (!ScreenLayoutShowFrame(image_data, MIMAGE_X, MIMAGE_Y)) {
 #ifdef USE_LVGL_ZOOM
-        write_to_lvgl_buf(
+            write_to_lvgl_buf(
 #else
-        write_to_lvgl_buf_doubled(
+            write_to_lvgl_buf_doubled(
 #endif
-                MIMAGE_X, MIMAGE_Y, image_data, &lvgl_image[0][0]);
+                    MIMAGE_X, MIMAGE_Y, image_data, &lvgl_image[0][0]);
+            lv_obj_invalidate(ScreenLayoutImageObject());
+        }
         tprof5 = Get_SysTick_Cycle_Count32() - tprof5;
 
-        lv_obj_invalidate(ScreenLayoutImageObject());
-
         if (SKIP_MODEL || !run_requested()) {
 #if SHOW_PROFILING
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(0), "tprof1=%.3f ms", (double)tprof1 / SystemCoreClock * 1000);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(1), "tprof2=%.3f ms", (double)tprof2 / SystemCoreClock * 1000);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(2), "tprof3=%.3f ms", (double)tprof3 / SystemCoreClock * 1000);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(3), "tprof4=%.3f ms", (double)tprof4 / SystemCoreClock * 1000);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(4), "tprof5=%.3f ms", (double)tprof5 / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(0), "tprof1=%.3f ms", (double)tprof1 / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(1), "tprof2=%.3f ms", (double)tprof2 / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(2), "tprof3=%.3f ms", (double)tprof3 / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(3), "tprof4=%.3f ms", (double)tprof4 / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(4), "tprof5=%.3f ms", (double)tprof5 / SystemCoreClock * 1000);
 #endif
 #if SHOW_EXPOSURE
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(1), "low=%" PRIu32, exposure_low_count);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(2), "high=%" PRIu32, exposure_high_count);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(3), "gain=%.3f", get_image_gain());
+            ScreenLayoutSetText(ScreenLayoutLabelObject(1), "low=%" PRIu32, exposure_low_count);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(2), "high=%" PRIu32, exposure_high_count);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(3), "gain=%.3f", get_image_gain());
 #endif
             lv_led_off(ScreenLayoutLEDObject());
             lv_port_unlock(lv_lock_state);
@@ -224,12 +231,12 @@ namespace app {
 #endif
 
         /* Add results to context for access outside handler. */
-        ctx.Set<std::vector<ClassificationResult>>("results", results);
+        ctx.Set<key::Results>(results);
 
         lv_lock_state = lv_port_lock();
         for (int r = 0; r < 3; r++) {
             lv_obj_t *label = ScreenLayoutLabelObject(r);
-            lv_label_set_text_fmt(label, "%s (%d%%)", first_bit(results[r].m_label).c_str(), (int)(results[r].m_normalisedVal * 100));
+            ScreenLayoutSetText(label, "%s (%d%%)", first_bit(results[r].m_label).c_str(), (int)(results[r].m_normalisedVal * 100));
             if (results[r].m_normalisedVal >= 0.7) {
                 lv_obj_add_state(label, LV_STATE_USER_1);
             } else {
@@ -243,8 +250,8 @@ namespace app {
         }
 
 #if SHOW_INF_TIME
-        lv_label_set_text_fmt(ScreenLayoutHeaderObject(), "%s - %.2f FPS", "Image Classifier", (double) SystemCoreClock / inf_prof);
-        lv_label_set_text_fmt(ScreenLayoutTimeObject(), "%.3f ms", (double)inf_prof / SystemCoreClock * 1000);
+        ScreenLayoutSetText(ScreenLayoutHeaderObject(), "%s - %.2f FPS", "Image Classifier", (double) SystemCoreClock / inf_prof);
+        ScreenLayoutSetText(ScreenLayoutTimeObject(), "%.3f ms", (double)inf_prof / SystemCoreClock * 1000);
 #endif
         lv_port_unlock(lv_lock_state);
 
@@ -253,6 +260,7 @@ namespace app {
         }
 
         profiler.PrintProfilingResult();
+        ScreenLayoutPrintDisplayStats(SystemCoreClock);
 #endif
 
         return true;
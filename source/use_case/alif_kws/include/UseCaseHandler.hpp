@@ -30,16 +30,48 @@
 #define ALIF_KWS_EVT_HANDLER_HPP
 
 #include "AppContext.hpp"
+#include "KwsClassifier.hpp"
+#include "Model.hpp"
+#include "Profiler.hpp"
+#include "VoiceActivityDetector.hpp"
+
+#include <string>
+#include <vector>
 
 namespace alif {
 namespace app {
 
+    /* Entries of the KWS application context. */
+    namespace key {
+        using arm::app::ContextKey;
+
+        struct Profiler : ContextKey<arm::app::Profiler&> {};
+        struct Model : ContextKey<arm::app::Model&> {};
+        struct FrameLength : ContextKey<int> {};
+        struct FrameStride : ContextKey<int> {};
+        struct AudioRate : ContextKey<int> {};
+        struct ScoreThreshold : ContextKey<float> {};     /* Normalised score threshold. */
+        struct Classifier : ContextKey<arm::app::KwsClassifier&> {};
+        struct Labels : ContextKey<const std::vector<std::string>&> {};
+        struct Vad : ContextKey<arm::app::audio::VoiceActivityDetector&> {}; /* Optional. */
+    } /* namespace key */
+
+    using KwsContext = arm::app::TypedContext<key::Profiler,
+                                              key::Model,
+                                              key::FrameLength,
+                                              key::FrameStride,
+                                              key::AudioRate,
+                                              key::ScoreThreshold,
+                                              key::Classifier,
+                                              key::Labels,
+                                              key::Vad>;
+
     /**
      * @brief       Handles the inference event.
      * @param[in]   ctx         Pointer to the application context.
      * @return      true or false based on execution success.
      **/
-    bool ClassifyAudioHandler(arm::app::ApplicationContext& ctx, bool oneshot);
+    bool ClassifyAudioHandler(KwsContext& ctx, bool oneshot);
 
 } /* namespace app */
 } /* namespace alif */
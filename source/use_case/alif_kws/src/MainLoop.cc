@@ -34,6 +34,7 @@
 #include "UseCaseCommonUtils.hpp"   /* Utils functions. */
 #include "log_macros.h"             /* Logging functions */
 #include "BufAttributes.hpp"        /* Buffer attributes to be applied */
+#include "VoiceActivityDetector.hpp" /* Skips strides without voice. */
 
 namespace arm {
 namespace app {
@@ -79,23 +80,32 @@ void MainLoop()
     }
 
     /* Instantiate application context. */
-    arm::app::ApplicationContext caseContext;
+    alif::app::KwsContext caseContext;
 
-    arm::app::Profiler profiler{"kws"};
-    caseContext.Set<arm::app::Profiler&>("profiler", profiler);
-    caseContext.Set<arm::app::Model&>("model", model);
-    caseContext.Set<int>("frameLength", arm::app::kws::g_FrameLength);
-    caseContext.Set<int>("frameStride", arm::app::kws::g_FrameStride);
-    caseContext.Set<int>("audioRate", arm::app::kws::g_AudioRate);
-    caseContext.Set<float>("scoreThreshold", arm::app::kws::g_ScoreThreshold);  /* Normalised score threshold. */
+    static arm::app::Profiler profiler{"kws"};
+    caseContext.Set<alif::app::key::Profiler>(profiler);
+    caseContext.Set<alif::app::key::Model>(model);
+    caseContext.Set<alif::app::key::FrameLength>(arm::app::kws::g_FrameLength);
+    caseContext.Set<alif::app::key::FrameStride>(arm::app::kws::g_FrameStride);
+    caseContext.Set<alif::app::key::AudioRate>(arm::app::kws::g_AudioRate);
+    caseContext.Set<alif::app::key::ScoreThreshold>(arm::app::kws::g_ScoreThreshold);
 
     arm::app::KwsClassifier classifier;  /* classifier wrapper object. */
-    caseContext.Set<arm::app::KwsClassifier&>("classifier", classifier);
+    caseContext.Set<alif::app::key::Classifier>(classifier);
 
     std::vector <std::string> labels;
     GetLabelsVector(labels);
 
-    caseContext.Set<const std::vector <std::string>&>("labels", labels);
+    caseContext.Set<alif::app::key::Labels>(labels);
+
+#if defined(KWS_VAD_THRESHOLD_DB)
+    /* Strides without voice skip feature extraction and inference. */
+    arm::app::audio::VadConfig vadConfig;
+    vadConfig.thresholdDb = KWS_VAD_THRESHOLD_DB;
+    vadConfig.noiseMarginDb = KWS_VAD_NOISE_MARGIN_DB;
+    arm::app::audio::VoiceActivityDetector vad{vadConfig};
+    caseContext.Set<alif::app::key::Vad>(vad);
+#endif /* KWS_VAD_THRESHOLD_DB */
 
     bool executionSuccessful = true;
 
@@ -124,6 +134,7 @@ void MainLoop()
                 printf("Incorrect choice, try again.");
                 break;
         }
+        log_flush();
     } while (executionSuccessful || bUseMenu);
     info("Main loop terminated.\n");
 }
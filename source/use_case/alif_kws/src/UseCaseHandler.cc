@@ -37,7 +37,9 @@
 #include "UseCaseCommonUtils.hpp"
 #include "KwsResult.hpp"
 #include "log_macros.h"
+#include "log_trace.h"
 #include "KwsProcessing.hpp"
+#include "VoiceActivityDetector.hpp"
 #include "sys_utils.h"
 
 #include <vector>
@@ -45,6 +47,7 @@
 #ifdef SE_SERVICES_SUPPORT
 #include "services_lib_api.h"
 #include "services_main.h"
+#include "core_pipe_mhu.h"
 
 #if defined(M55_HE) || defined(RTSS_HE)
 // Use hp_comms_handle for sending MHU message to HP core
@@ -58,7 +61,6 @@ m55_data_payload_t mhu_data;
 using arm::app::KwsClassifier;
 using arm::app::Profiler;
 using arm::app::ClassificationResult;
-using arm::app::ApplicationContext;
 using arm::app::Model;
 using arm::app::KwsPreProcess;
 using arm::app::KwsPostProcess;
@@ -67,8 +69,29 @@ using arm::app::MicroNetKwsModel;
 #define AUDIO_SAMPLES 16000 // 16k samples/sec, 1sec sample
 #define AUDIO_STRIDE 8000 // 0.5 seconds
 #define RESULTS_MEMORY 8
+#define VAD_STATS_STRIDES 20 // Strides between printouts of the voice activity statistics
 
-static int16_t audio_inf[AUDIO_SAMPLES + AUDIO_STRIDE];
+// One extra stride is being captured while the window is processed
+#define AUDIO_RING_SLOTS (AUDIO_SAMPLES / AUDIO_STRIDE + 1)
+static_assert(AUDIO_SAMPLES % AUDIO_STRIDE == 0, "Audio window must be a whole number of strides");
+
+static int16_t audio_inf[AUDIO_RING_SLOTS * AUDIO_STRIDE];
+static audio_ring audio_inf_ring;
+
+#if defined(SE_SERVICES_SUPPORT) && KEYWORD_PIPE_SLOTS > 0
+static_assert((KEYWORD_PIPE_SLOTS & (KEYWORD_PIPE_SLOTS - 1)) == 0, "KEYWORD_PIPE_SLOTS must be a power of two");
+
+// Keywords go to the other core with the audio window they were spotted in
+#define KEYWORD_MSG_SIZE (sizeof(core_pipe_keyword) + AUDIO_SAMPLES * sizeof(int16_t))
+alignas(CORE_PIPE_LINE_SIZE) static uint8_t keyword_pipe_mem[CORE_PIPE_MEM_SIZE(KEYWORD_PIPE_SLOTS, KEYWORD_MSG_SIZE)];
+#endif
+
+// Time spent on strides since the voice activity statistics were last printed
+struct vad_accounting {
+    uint64_t period_start;
+    uint64_t busy;
+};
+static vad_accounting vad_acct;
 
 namespace alif {
 namespace app {
@@ -91,7 +114,43 @@ static bool PresentInferenceResult(const std::vector<arm::app::kws::KwsResult>&
 #ifdef SE_SERVICES_SUPPORT
 static std::string last_label;
 
-static void send_msg_if_needed(arm::app::kws::KwsResult &result)
+#if KEYWORD_PIPE_SLOTS > 0
+static void send_keyword_with_audio(const arm::app::ClassificationResult &classification,
+                                    const audio_ring_window &window, int audioRate, uint32_t index)
+{
+    core_pipe* pipe = core_pipe_mhu_tx();
+    if (!pipe) {
+        pipe = core_pipe_mhu_create_tx(keyword_pipe_mem, sizeof(keyword_pipe_mem),
+                                       KEYWORD_PIPE_SLOTS, KEYWORD_MSG_SIZE);
+        if (!pipe) {
+            return;
+        }
+    }
+
+    // Filled in place, so the audio is copied once
+    auto* payload = static_cast<uint8_t*>(core_pipe_acquire(pipe));
+    if (!payload) {
+        warn("Other core busy, keyword \"%s\" not sent\n", classification.m_label.c_str());
+        return;
+    }
+    auto* keyword = reinterpret_cast<core_pipe_keyword*>(payload);
+    memset(keyword->label, 0, sizeof(keyword->label));
+    strncpy(keyword->label, classification.m_label.c_str(), sizeof(keyword->label) - 1);
+    keyword->score = classification.m_normalisedVal;
+    keyword->sample_rate = audioRate;
+    keyword->num_samples = window.first_len + (window.second ? window.second_len : 0);
+
+    auto* samples = reinterpret_cast<int16_t*>(payload + sizeof(core_pipe_keyword));
+    memcpy(samples, window.first, window.first_len * sizeof(int16_t));
+    if (window.second) {
+        memcpy(samples + window.first_len, window.second, window.second_len * sizeof(int16_t));
+    }
+    core_pipe_publish(pipe, CORE_PIPE_MSG_KEYWORD,
+                      sizeof(core_pipe_keyword) + keyword->num_samples * sizeof(int16_t), index);
+}
+#endif /* KEYWORD_PIPE_SLOTS > 0 */
+
+static void send_msg_if_needed(arm::app::kws::KwsResult &result, const audio_ring_window &window, int audioRate)
 {
     mhu_data.id = 2; // id for M55_HE
     if (result.m_resultVec.empty()) {
@@ -102,6 +161,12 @@ static void send_msg_if_needed(arm::app::kws::KwsResult &result)
     arm::app::ClassificationResult classification = result.m_resultVec[0];
 
     if (classification.m_label != last_label) {
+#if KEYWORD_PIPE_SLOTS > 0
+        send_keyword_with_audio(classification, window, audioRate, result.m_inferenceNumber);
+#else
+        (void)window;
+        (void)audioRate;
+#endif /* KEYWORD_PIPE_SLOTS > 0 */
         if (classification.m_label == "go" || classification.m_label == "stop") {
             info("******************* send_msg_if_needed, FOUND \"%s\", copy data end send! ******************\n", classification.m_label.c_str());
             strcpy(mhu_data.msg, classification.m_label.c_str());
@@ -117,15 +182,47 @@ static void send_msg_if_needed(arm::app::kws::KwsResult &result)
 }
 #endif
 
+    /**
+     * @brief           Accounts for a stride, processed or skipped, and prints how
+     *                  many were skipped and the share of the time spent on them
+     *                  every VAD_STATS_STRIDES strides.
+     * @param[in,out]   vad             Voice activity detector.
+     * @param[in]       strideStart     Cycle count when the stride was received.
+     **/
+    static void AccountStride(arm::app::audio::VoiceActivityDetector& vad, uint64_t strideStart)
+    {
+        const uint64_t now = Get_SysTick_Cycle_Count();
+        if (!vad_acct.period_start) {
+            vad_acct.period_start = strideStart;
+        }
+        vad_acct.busy += now - strideStart;
+
+        const uint32_t processed = vad.GetActiveCount();
+        const uint32_t skipped = vad.GetSilentCount();
+        if (processed + skipped >= VAD_STATS_STRIDES) {
+            info("VAD: %" PRIu32 " strides processed, %" PRIu32 " skipped, busy %.1f%% of the time, noise floor %.1f dB\n",
+                 processed, skipped, (double) vad_acct.busy * 100 / (now - vad_acct.period_start),
+                 (double) vad.GetNoiseFloorDb());
+            vad.ResetCounters();
+            vad_acct = {};
+        }
+    }
+
     /* KWS inference handler. */
-    bool ClassifyAudioHandler(ApplicationContext& ctx, bool oneshot)
+    bool ClassifyAudioHandler(KwsContext& ctx, bool oneshot)
     {
-        auto& profiler = ctx.Get<Profiler&>("profiler");
-        auto& model = ctx.Get<Model&>("model");
-        const auto mfccFrameLength = ctx.Get<int>("frameLength");
-        const auto mfccFrameStride = ctx.Get<int>("frameStride");
-        const auto audioRate = ctx.Get<int>("audioRate");
-        const auto scoreThreshold = ctx.Get<float>("scoreThreshold");
+        auto& profiler = ctx.Get<key::Profiler>();
+        auto& model = ctx.Get<key::Model>();
+        const auto mfccFrameLength = ctx.Get<key::FrameLength>();
+        const auto mfccFrameStride = ctx.Get<key::FrameStride>();
+        const auto audioRate = ctx.Get<key::AudioRate>();
+        const auto scoreThreshold = ctx.Get<key::ScoreThreshold>();
+
+        /* Without voice activity detection every stride is processed. */
+        arm::app::audio::VoiceActivityDetector* vad = nullptr;
+        if (ctx.Has<key::Vad>()) {
+            vad = &ctx.Get<key::Vad>();
+        }
 
         constexpr int minTensorDims = static_cast<int>(
             (MicroNetKwsModel::ms_inputRowsIdx > MicroNetKwsModel::ms_inputColsIdx)?
@@ -161,8 +258,8 @@ static void send_msg_if_needed(arm::app::kws::KwsResult &result)
                                                  mfccFrameLength, mfccFrameStride);
 
         std::vector<ClassificationResult> singleInfResult;
-        KwsPostProcess postProcess = KwsPostProcess(outputTensor, ctx.Get<KwsClassifier &>("classifier"),
-                                                    ctx.Get<std::vector<std::string>&>("labels"),
+        KwsPostProcess postProcess = KwsPostProcess(outputTensor, ctx.Get<key::Classifier>(),
+                                                    ctx.Get<key::Labels>(),
                                                     singleInfResult);
 
         int index = 0;
@@ -174,51 +271,80 @@ static void send_msg_if_needed(arm::app::kws::KwsResult &result)
                 printf_err("hal_audio_alif_init failed with error: %d\n", err);
                 return false;
             }
+            hal_audio_ring_init(&audio_inf_ring, audio_inf, AUDIO_STRIDE, AUDIO_RING_SLOTS);
             audio_inited = true;
         }
 
-        // Start first fill of final stride section of buffer
-        hal_get_audio_data(audio_inf + AUDIO_SAMPLES, AUDIO_STRIDE);
+        // Start filling the next stride of the ring, unless still running from a previous call
+        hal_audio_ring_start(&audio_inf_ring);
 
         do {
-            // Wait until stride buffer is full - initiated above or by previous interation of loop
-            int err = hal_wait_for_audio();
+            // Wait until the stride is full, then immediately start receiving the next one
+            // before we start heavy processing, so as not to lose anything
+            int err = hal_audio_ring_wait(&audio_inf_ring);
             if (err) {
                 printf_err("hal_get_audio_data failed with error: %d\n", err);
                 return false;
             }
+            const uint64_t strideStart = Get_SysTick_Cycle_Count();
+
+            audio_stats stats;
+            hal_get_audio_stats(&stats);
+            debug("Audio stride: absmax %u -> %u, gain %.1f\n", stats.in_absmax, stats.out_absmax, (double) stats.gain);
+
+            if (vad) {
+                // The latest stride is a whole slot of the ring
+                audio_ring_window stride;
+                hal_audio_ring_get_window(&audio_inf_ring, AUDIO_STRIDE, &stride);
+                if (!vad->Process(stride.first, stride.first_len, stats.gain)) {
+                    debug("No voice: %.1f dB, zero crossing rate %.2f\n",
+                          (double) vad->GetLastFeatures().energyDb,
+                          (double) vad->GetLastFeatures().zeroCrossingRate);
+
+                    // The next window processed will not overlap the last one
+                    preProcess.InvalidateFeatureCache();
+#ifdef SE_SERVICES_SUPPORT
+                    last_label.clear();
+#endif
+                    AccountStride(*vad, strideStart);
+                    ++index;
+                    continue;
+                }
+            }
 
-            // move buffer down by one stride, clearing space at the end for the next stride
-            std::copy(audio_inf + AUDIO_STRIDE, audio_inf + AUDIO_STRIDE + AUDIO_SAMPLES, audio_inf);
-
-            // start receiving the next stride immediately before we start heavy processing, so as not to lose anything
-            hal_get_audio_data(audio_inf + AUDIO_SAMPLES, AUDIO_STRIDE);
-
-            hal_audio_alif_preprocessing(audio_inf + AUDIO_SAMPLES - AUDIO_STRIDE, AUDIO_STRIDE);
-
-            const int16_t* inferenceWindow = audio_inf;
+            // The window is read in place from the ring, wrapping around its end
+            audio_ring_window inferenceWindow;
+            if (!hal_audio_ring_get_window(&audio_inf_ring, AUDIO_SAMPLES, &inferenceWindow)) {
+                printf_err("Audio window does not fit the ring buffer\n");
+                return false;
+            }
 
             uint32_t start = Get_SysTick_Cycle_Count32();
+            LOG_TRACE_BEGIN(pre);
             /* Run the pre-processing, inference and post-processing. */
-            if (!preProcess.DoPreProcess(inferenceWindow, index)) {
+            if (!preProcess.DoPreProcess(inferenceWindow.first, inferenceWindow.first_len,
+                                         inferenceWindow.second, index)) {
                 printf_err("Pre-processing failed.");
                 return false;
             }
-            printf("Preprocessing time = %.3f ms\n", (double) (Get_SysTick_Cycle_Count32() - start) / SystemCoreClock * 1000);
+            LOG_TRACE_END(pre, LOG_TRACE_TRACK_CPU, "pre-processing");
+            info("Preprocessing time = %.3f ms\n", (double) (Get_SysTick_Cycle_Count32() - start) / SystemCoreClock * 1000);
 
             start = Get_SysTick_Cycle_Count32();
             if (!RunInference(model, profiler)) {
                 printf_err("Inference failed.");
                 return false;
             }
-            printf("Inference time = %.3f ms\n", (double) (Get_SysTick_Cycle_Count32() - start) / SystemCoreClock * 1000);
+            info("Inference time = %.3f ms\n", (double) (Get_SysTick_Cycle_Count32() - start) / SystemCoreClock * 1000);
 
             start = Get_SysTick_Cycle_Count32();
+            LOG_TRACE_BEGIN(post);
             if (!postProcess.DoPostProcess()) {
                 printf_err("Post-processing failed.");
                 return false;
             }
-            printf("Postprocessing time = %.3f ms\n", (double) (Get_SysTick_Cycle_Count32() - start) / SystemCoreClock * 1000);
+            LOG_TRACE_END(post, LOG_TRACE_TRACK_CPU, "post-processing");
+            info("Postprocessing time = %.3f ms\n", (double) (Get_SysTick_Cycle_Count32() - start) / SystemCoreClock * 1000);
 
             /* Add results from this window to our final results vector. */
             if (infResults.size() == RESULTS_MEMORY) {
@@ -228,21 +354,27 @@ static void send_msg_if_needed(arm::app::kws::KwsResult &result)
                     index * secondsPerSample * preProcess.m_audioDataStride,
                     index, scoreThreshold));
 #ifdef SE_SERVICES_SUPPORT
-            send_msg_if_needed(infResults.back());
+            send_msg_if_needed(infResults.back(), inferenceWindow, audioRate);
 #endif
 
 #if VERIFY_TEST_OUTPUT
             DumpTensor(outputTensor);
 #endif /* VERIFY_TEST_OUTPUT */
 
+            LOG_TRACE_BEGIN(present);
             hal_lcd_clear(COLOR_BLACK);
 
             if (!PresentInferenceResult(infResults)) {
                 return false;
             }
+            LOG_TRACE_END(present, LOG_TRACE_TRACK_DISPLAY, "results");
 
             profiler.PrintProfilingResult();
 
+            if (vad) {
+                AccountStride(*vad, strideStart);
+            }
+            LOG_TRACE_DUMP_WHEN_FULL();
             ++index;
         } while (!oneshot);
         return true;
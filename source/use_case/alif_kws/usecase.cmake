@@ -47,9 +47,28 @@ set(SE_SERVICES_SUPPORT ON CACHE BOOL "Enables SE Services initialization. Neede
 
 message(STATUS "alif_kws: SE_SERVICES_SUPPORT: ${SE_SERVICES_SUPPORT}")
 
+USER_OPTION(${use_case}_KEYWORD_PIPE_SLOTS "Keywords, with their audio, that can be in flight to the other core over shared memory, a power of two (0 sends only the go and stop labels)"
+    0
+    STRING)
+
+USER_OPTION(${use_case}_VAD "Skip feature extraction and inference for strides without voice"
+    OFF
+    BOOL)
+
+USER_OPTION(${use_case}_VAD_THRESHOLD_DB "Energy in dB relative to full scale, before gain, below which a stride has no voice"
+    -55
+    STRING)
+
+USER_OPTION(${use_case}_VAD_NOISE_MARGIN_DB "Energy in dB above the tracked noise floor a stride needs to have voice (0 does not track the floor)"
+    6
+    STRING)
+
 set(${use_case}_COMPILE_DEFS
     USE_APP_MENU=$<BOOL:${${use_case}_USE_APP_MENU}>
     $<$<BOOL:${SE_SERVICES_SUPPORT}>:SE_SERVICES_SUPPORT>
+    KEYWORD_PIPE_SLOTS=${${use_case}_KEYWORD_PIPE_SLOTS}
+    $<$<BOOL:${${use_case}_VAD}>:KWS_VAD_THRESHOLD_DB=${${use_case}_VAD_THRESHOLD_DB}>
+    $<$<BOOL:${${use_case}_VAD}>:KWS_VAD_NOISE_MARGIN_DB=${${use_case}_VAD_NOISE_MARGIN_DB}>
 )
 
 # Generate labels file
@@ -92,7 +92,7 @@ void MainLoop()
     /* Instantiate application context. */
     arm::app::ApplicationContext caseContext;
 
-    arm::app::Profiler profiler{"kws"};
+    static arm::app::Profiler profiler{"kws"};
     caseContext.Set<arm::app::Profiler&>("profiler", profiler);
     caseContext.Set<arm::app::Model&>("model", model);
     caseContext.Set<int>("frameLength", arm::app::kws::g_FrameLength);
@@ -116,6 +116,7 @@ void MainLoop()
         info("Going to chip STOP mode...\n");
         __disable_irq();
         while(1) {
+            log_flush();
             pm_core_enter_deep_sleep_request_subsys_off();
             __enable_irq();
             __ISB();
@@ -30,11 +30,31 @@
 #define ALIF_OBJ_DET_HANDLER_HPP
 
 #include "AppContext.hpp"
+#include "DetectionResult.hpp"
+#include "DetectorPostProcessing.hpp"
+#include "DetectorPreProcessing.hpp"
+#include "Profiler.hpp"
 #include "YoloFastestModel.hpp"
 
+#include <vector>
+
 namespace alif {
 namespace app {
 
+    /* Entries of the object detection application context. */
+    namespace key {
+        using arm::app::ContextKey;
+
+        struct Profiler : ContextKey<arm::app::Profiler&> {};
+        struct Model : ContextKey<arm::app::Model&> {};
+        struct PreProcess : ContextKey<arm::app::DetectorPreProcess&> {};
+        struct PostProcess : ContextKey<arm::app::DetectorPostProcess&> {};
+        struct Results : ContextKey<std::vector<arm::app::object_detection::DetectionResult>&> {};
+    } /* namespace key */
+
+    using ObjectDetectionContext = arm::app::TypedContext<key::Profiler, key::Model, key::PreProcess,
+                                                          key::PostProcess, key::Results>;
+
     bool ObjectDetectionInit(arm::app::YoloFastestModel& model);
 
     /**
@@ -42,7 +62,7 @@ namespace app {
      * @param[in]   ctx        Pointer to the application context.
      * @return      true or false based on execution success.
      **/
-    bool ObjectDetectionHandler(arm::app::ApplicationContext& ctx);
+    bool ObjectDetectionHandler(ObjectDetectionContext& ctx);
 
 } /* namespace app */
 } /* namespace alif */
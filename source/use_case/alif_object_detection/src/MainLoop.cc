@@ -31,11 +31,16 @@
 #include "UseCaseHandler.hpp"         /* Handlers for different user options. */
 #include "UseCaseCommonUtils.hpp"     /* Utils functions. */
 #include "log_macros.h"             /* Logging functions */
+#include "log_trace.h"              /* Timeline tracing */
 #include "BufAttributes.hpp"        /* Buffer attributes to be applied */
 
+#include <vector>
+
 namespace arm {
 namespace app {
     static uint8_t tensorArena[ACTIVATION_BUF_SZ] ACTIVATION_BUF_ATTRIBUTE;
+    /* Boxes kept for NMS in a frame, highest objectness first. */
+    static constexpr int maxDetections = 32;
     namespace object_detection {
         extern uint8_t* GetModelPointer();
         extern size_t GetModelLen();
@@ -49,6 +54,13 @@ void MainLoop()
 
     arm::app::YoloFastestModel model;  /* Model wrapper object. */
 
+#if defined(WEIGHT_STAGING_SZ)
+    /* Copy the hottest weights into the arena, away from slow model memory.
+     * The copies are read through the application's Ethos-U kernel. */
+    model.SetNpuBackend(arm::app::GetDefaultNpuBackend());
+    model.SetWeightStagingBudget(WEIGHT_STAGING_SZ);
+#endif /* WEIGHT_STAGING_SZ */
+
     /* Load the model. */
     if (!model.Init(arm::app::tensorArena,
                     sizeof(arm::app::tensorArena),
@@ -63,15 +75,37 @@ void MainLoop()
         return;
     }
 
+    /* Set up pre and post-processing once; they are reused for every frame. */
+    TfLiteIntArray* inputShape = model.GetInputShape(0);
+    arm::app::object_detection::PostProcessParams postProcessParams {
+        inputShape->data[arm::app::YoloFastestModel::ms_inputRowsIdx],
+        inputShape->data[arm::app::YoloFastestModel::ms_inputColsIdx],
+        arm::app::object_detection::originalImageSize,
+        arm::app::object_detection::anchor1, arm::app::object_detection::anchor2
+    };
+    postProcessParams.topN = arm::app::maxDetections;
+
+    std::vector<arm::app::object_detection::DetectionResult> results;
+    arm::app::DetectorPreProcess preProcess{model.GetInputTensor(0), true, model.IsDataSigned()};
+    arm::app::DetectorPostProcess postProcess{model.GetOutputTensor(0), model.GetOutputTensor(1),
+                                              results, postProcessParams};
+
     /* Instantiate application context. */
-    arm::app::ApplicationContext caseContext;
+    alif::app::ObjectDetectionContext caseContext;
 
-    arm::app::Profiler profiler{"object_detection"};
-    caseContext.Set<arm::app::Profiler&>("profiler", profiler);
-    caseContext.Set<arm::app::Model&>("model", model);
+    static arm::app::Profiler profiler{"object_detection"};
+    caseContext.Set<alif::app::key::Profiler>(profiler);
+    caseContext.Set<alif::app::key::Model>(model);
+    caseContext.Set<alif::app::key::PreProcess>(preProcess);
+    caseContext.Set<alif::app::key::PostProcess>(postProcess);
+    caseContext.Set<alif::app::key::Results>(results);
 
     /* Loop. */
     do {
+        LOG_TRACE_BEGIN(frame);
         alif::app::ObjectDetectionHandler(caseContext);
+        LOG_TRACE_END(frame, LOG_TRACE_TRACK_CPU, "frame");
+        log_flush();
+        LOG_TRACE_DUMP_WHEN_FULL();
     } while (1);
 }
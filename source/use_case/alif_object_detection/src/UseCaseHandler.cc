@@ -52,11 +52,8 @@ lvgl_pixel_t lvgl_image[LIMAGE_Y][LIMAGE_X] __attribute__((section(".bss.lcd_ima
 };
 
 using arm::app::Profiler;
-using arm::app::ApplicationContext;
 using arm::app::Model;
 using arm::app::YoloFastestModel;
-using arm::app::DetectorPreProcess;
-using arm::app::DetectorPostProcess;
 
 namespace alif {
 namespace app {
@@ -95,12 +92,17 @@ using namespace arm::app::object_detection;
         const int inputImgCols = inputShape->data[YoloFastestModel::ms_inputColsIdx];
         const int inputImgRows = inputShape->data[YoloFastestModel::ms_inputRowsIdx];
 
-        auto bCamera = hal_camera_configure(inputImgCols, inputImgRows, HAL_CAMERA_MODE_SINGLE_FRAME, HAL_CAMERA_COLOUR_FORMAT_RGB888);
+        auto bCamera = hal_camera_configure(inputImgCols, inputImgRows, HAL_CAMERA_MODE_CONTINUOUS, HAL_CAMERA_COLOUR_FORMAT_RGB888);
         if (!bCamera) {
             printf_err("Failed to configure camera.\n");
             return false;
         }
 
+        if (!hal_camera_start()) {
+            printf_err("Failed to start camera.\n");
+            return false;
+        }
+
         return true;
     }
 
@@ -122,10 +124,13 @@ using namespace arm::app::object_detection;
            int imgInputCols, int imgInputRows);
 
     /* Object detection inference handler. */
-    bool ObjectDetectionHandler(ApplicationContext& ctx)
+    bool ObjectDetectionHandler(ObjectDetectionContext& ctx)
     {
-        auto& profiler = ctx.Get<Profiler&>("profiler");
-        auto& model = ctx.Get<Model&>("model");
+        auto& profiler = ctx.Get<key::Profiler>();
+        auto& model = ctx.Get<key::Model>();
+        auto& preProcess = ctx.Get<key::PreProcess>();
+        auto& postProcess = ctx.Get<key::PostProcess>();
+        auto& results = ctx.Get<key::Results>();
 
         if (!model.IsInited()) {
             printf_err("Model is not initialised! Terminating processing.\n");
@@ -133,8 +138,6 @@ using namespace arm::app::object_detection;
         }
 
         TfLiteTensor* inputTensor = model.GetInputTensor(0);
-        TfLiteTensor* outputTensor0 = model.GetOutputTensor(0);
-        TfLiteTensor* outputTensor1 = model.GetOutputTensor(1);
 
         if (!inputTensor->dims) {
             printf_err("Invalid input tensor dims\n");
@@ -149,28 +152,16 @@ using namespace arm::app::object_detection;
         const int inputImgCols = inputShape->data[YoloFastestModel::ms_inputColsIdx];
         const int inputImgRows = inputShape->data[YoloFastestModel::ms_inputRowsIdx];
 
-        /* Set up pre and post-processing. */
-        DetectorPreProcess preProcess = DetectorPreProcess(inputTensor, true, model.IsDataSigned());
-
-        std::vector<object_detection::DetectionResult> results;
-        const object_detection::PostProcessParams postProcessParams {
-            inputImgRows, inputImgCols, object_detection::originalImageSize,
-            object_detection::anchor1, object_detection::anchor2
-        };
-        DetectorPostProcess postProcess = DetectorPostProcess(outputTensor0, outputTensor1,
-                results, postProcessParams);
-
-        /* Ensure there are no results leftover from previous inference when running all. */
-        results.clear();
-
-        hal_camera_start();
-
-        uint32_t capturedFrameSize = 0;
-        const uint8_t* currImage = hal_camera_get_captured_frame(&capturedFrameSize);
-        if (!currImage || !capturedFrameSize) {
-            printf_err("hal_camera_get_captured_frame failed");
+        /* The camera keeps capturing the next frame while this one is processed. */
+        hal_camera_frame frame;
+        if (!hal_camera_get_frame(&frame) || !frame.size) {
+            printf_err("hal_camera_get_frame failed");
             return false;
         }
+        if (frame.dropped) {
+            debug("Frame %" PRIu32 ": %" PRIu32 " frames dropped\n", frame.sequence, frame.dropped);
+        }
+        const uint8_t* currImage = frame.data;
 
         {
             ScopedLVGLLock lv_lock;
@@ -213,12 +204,12 @@ using namespace arm::app::object_detection;
 
 #if SHOW_INF_TIME
             inf_prof = Get_SysTick_Cycle_Count32() - inf_prof;
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(2), "Inference time: %.3f ms", (double)inf_prof / SystemCoreClock * 1000);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(3), "Inferences / sec: %.2f", (double) SystemCoreClock / inf_prof);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(2), "Inference time: %.3f ms", (double)inf_prof / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(3), "Inferences / sec: %.2f", (double) SystemCoreClock / inf_prof);
             //lv_label_set_text_fmt(ScreenLayoutLabelObject(3), "Inferences / second: %.2f", (double) SystemCoreClock / (inf_loop_time_end - inf_loop_time_start));
 #endif
 
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(0), "Faces Detected: %i", results.size());
+            ScreenLayoutSetText(ScreenLayoutLabelObject(0), "Faces Detected: %zu", results.size());
 
             /* Draw boxes. */
             DrawDetectionBoxes(results, inputImgCols, inputImgRows);
@@ -235,6 +226,7 @@ using namespace arm::app::object_detection;
         }
 
         profiler.PrintProfilingResult();
+        ScreenLayoutPrintDisplayStats(SystemCoreClock);
 
         return true;
     }
@@ -254,22 +246,27 @@ using namespace arm::app::object_detection;
         return true;
     }
 
-    static void DeleteBoxes(lv_obj_t *frame)
+    /* Boxes are kept from frame to frame, so that LVGL only redraws the ones
+     * that move. Moving or resizing an object to where it is does nothing. */
+    static void PlaceBox(lv_obj_t *frame, uint32_t index, int x0, int y0, int w, int h)
     {
         // Assume that child 0 of the frame is the image itself
-        int children = lv_obj_get_child_count(frame);
-        while (children > 1) {
-            lv_obj_del(lv_obj_get_child(frame, 1));
-            children--;
+        lv_obj_t *box = lv_obj_get_child(frame, index + 1);
+        if (!box) {
+            box = lv_obj_create(frame);
+            lv_obj_add_style(box, &boxStyle, LV_PART_MAIN);
         }
+        lv_obj_set_size(box, w, h);
+        lv_obj_set_pos(box, x0, y0);
+        lv_obj_remove_flag(box, LV_OBJ_FLAG_HIDDEN);
     }
 
-    static void CreateBox(lv_obj_t *frame, int x0, int y0, int w, int h)
+    static void HideBoxes(lv_obj_t *frame, uint32_t first)
     {
-        lv_obj_t *box = lv_obj_create(frame);
-        lv_obj_set_size(box, w, h);
-        lv_obj_add_style(box, &boxStyle, LV_PART_MAIN);
-        lv_obj_set_pos(box, x0, y0);
+        const uint32_t children = lv_obj_get_child_count(frame);
+        for (uint32_t i = first + 1; i < children; i++) {
+            lv_obj_add_flag(lv_obj_get_child(frame, i), LV_OBJ_FLAG_HIDDEN);
+        }
     }
 
     static void DrawDetectionBoxes(const std::vector<object_detection::DetectionResult>& results,
@@ -279,15 +276,15 @@ using namespace arm::app::object_detection;
         float xScale = (float) lv_obj_get_content_width(frame) / imgInputCols;
         float yScale = (float) lv_obj_get_content_height(frame) / imgInputRows;
 
-        DeleteBoxes(frame);
-
+        uint32_t boxes = 0;
         for (const auto& result: results) {
-            CreateBox(frame,
-                      floor(result.m_x0 * xScale),
-                      floor(result.m_y0 * yScale),
-                      ceil(result.m_w * xScale),
-                      ceil(result.m_h * yScale));
+            PlaceBox(frame, boxes++,
+                     floor(result.m_x0 * xScale),
+                     floor(result.m_y0 * yScale),
+                     ceil(result.m_w * xScale),
+                     ceil(result.m_h * yScale));
         }
+        HideBoxes(frame, boxes);
     }
 
 } /* namespace app */
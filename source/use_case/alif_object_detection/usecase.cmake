@@ -31,6 +31,10 @@ USER_OPTION(${use_case}_MODEL_IN_EXT_FLASH "Run model from external flash"
     OFF
     BOOL)
 
+USER_OPTION(${use_case}_WEIGHT_STAGING_SZ "Bytes of the activation buffer used to hold copies of the NPU weights (0 reads them in place)"
+    0
+    STRING)
+
 USER_OPTION(${use_case}_IMAGE_SIZE "Square image size in pixels. Images will be resized to this size."
     192
     STRING)
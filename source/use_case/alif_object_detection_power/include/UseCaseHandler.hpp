@@ -30,13 +30,26 @@
 #define ALIF_OBJ_DET_POWER_HANDLER_HPP
 
 #include "AppContext.hpp"
+#include "Cascade.hpp"
 #include "YoloFastestModel.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace alif {
 namespace app {
 
     bool ObjectDetectionInit(arm::app::YoloFastestModel& model);
 
+    /**
+     * @brief       Initialises the camera and display for images of the given
+     *              size, without needing an initialised model.
+     * @param[in]   imgCols     Image width in pixels.
+     * @param[in]   imgRows     Image height in pixels.
+     * @return      true if successful, false otherwise.
+     **/
+    bool ObjectDetectionInit(int imgCols, int imgRows);
+
     /**
      * @brief       Handles the inference event.
      * @param[in]   ctx        Pointer to the application context.
@@ -44,6 +57,40 @@ namespace app {
      **/
     bool ObjectDetectionHandler(arm::app::ApplicationContext& ctx);
 
+    /**
+     * @brief       Runs object detection on an image already captured.
+     * @param[in]   ctx         Pointer to the application context.
+     * @param[in]   image       RGB888 image of the model's input size.
+     * @return      true or false based on execution success.
+     **/
+    bool ObjectDetectionHandler(arm::app::ApplicationContext& ctx, const uint8_t* image);
+
+    /**
+     * @brief   First stage of a cascade: captures a camera frame and scores
+     *          the share of it that changed since the previous frame, from
+     *          0 (still) to 1. The first frame scores 1.
+     */
+    class MotionGate : public arm::app::CascadeStage {
+    public:
+        /**
+         * @param[in]   imgCols     Frame width in pixels.
+         * @param[in]   imgRows     Frame height in pixels.
+         **/
+        MotionGate(int imgCols, int imgRows);
+
+        bool Run(float& score) override;
+
+        /** @brief  Gets the frame captured by the last run. */
+        const uint8_t* GetFrame() const;
+
+    private:
+        int m_cols;
+        int m_rows;
+        const uint8_t* m_frame{nullptr};
+        bool m_havePrevious{false};
+        std::vector<uint8_t> m_previous;    /* Subsampled luma of the previous frame. */
+    };
+
 } /* namespace app */
 } /* namespace alif */
 
@@ -50,6 +50,48 @@ namespace app {
 } /* namespace arm */
 
 
+#if defined(MOTION_GATE_THRESHOLD)
+namespace {
+
+    /* Frames between printouts of the cascade accounting. */
+    constexpr uint32_t kCascadeStatsPeriods = 100;
+
+    /* Face detection on the frame captured by the motion gate. The model is
+     * loaded the first time the gate fires. */
+    class FaceDetectionStage : public arm::app::CascadeStage {
+    public:
+        FaceDetectionStage(arm::app::YoloFastestModel& model,
+                           arm::app::ApplicationContext& ctx,
+                           const alif::app::MotionGate& gate)
+        :   m_model{model},
+            m_ctx{ctx},
+            m_gate{gate}
+        {}
+
+        bool Init() override
+        {
+            return this->m_model.IsInited() ||
+                   this->m_model.Init(arm::app::tensorArena,
+                                      sizeof(arm::app::tensorArena),
+                                      arm::app::object_detection::GetModelPointer(),
+                                      arm::app::object_detection::GetModelLen());
+        }
+
+        bool Run(float& score) override
+        {
+            score = 0;
+            return alif::app::ObjectDetectionHandler(this->m_ctx, this->m_gate.GetFrame());
+        }
+
+    private:
+        arm::app::YoloFastestModel& m_model;
+        arm::app::ApplicationContext& m_ctx;
+        const alif::app::MotionGate& m_gate;
+    };
+
+} /* namespace */
+#endif /* MOTION_GATE_THRESHOLD */
+
 volatile bool obj_button_pressed = false;
 
 void button2_cb(uint32_t event)
@@ -85,6 +127,20 @@ void MainLoop()
 
     arm::app::YoloFastestModel model;  /* Model wrapper object. */
 
+#if defined(WEIGHT_STAGING_SZ)
+    /* Copy the hottest weights into the arena, away from slow model memory.
+     * The copies are read through the application's Ethos-U kernel. */
+    model.SetNpuBackend(arm::app::GetDefaultNpuBackend());
+    model.SetWeightStagingBudget(WEIGHT_STAGING_SZ);
+#endif /* WEIGHT_STAGING_SZ */
+
+#if defined(MOTION_GATE_THRESHOLD)
+    /* The model is loaded by the cascade once the camera sees motion. */
+    const int imageSize = arm::app::object_detection::originalImageSize;
+    if (!alif::app::ObjectDetectionInit(imageSize, imageSize)) {
+        printf_err("Failed to initialise use case handler\n");
+    }
+#else
     /* Load the model. */
     if (!model.Init(arm::app::tensorArena,
                     sizeof(arm::app::tensorArena),
@@ -97,21 +153,43 @@ void MainLoop()
     if (!alif::app::ObjectDetectionInit(model)) {
         printf_err("Failed to initialise use case handler\n");
     }
+#endif /* MOTION_GATE_THRESHOLD */
 
     /* Instantiate application context. */
     arm::app::ApplicationContext caseContext;
 
-    arm::app::Profiler profiler{"object_detection"};
+    static arm::app::Profiler profiler{"object_detection"};
     caseContext.Set<arm::app::Profiler&>("profiler", profiler);
     caseContext.Set<arm::app::Model&>("model", model);
 
+#if defined(MOTION_GATE_THRESHOLD)
+    alif::app::MotionGate gate{imageSize, imageSize};
+    FaceDetectionStage detection{model, caseContext, gate};
+
+    arm::app::CascadeConfig cascadeConfig;
+    cascadeConfig.threshold = MOTION_GATE_THRESHOLD;
+    cascadeConfig.holdCount = MOTION_GATE_HOLD;
+    arm::app::Cascade cascade{gate, detection, cascadeConfig,
+                              []() { return Get_SysTick_Cycle_Count(); }};
+#endif /* MOTION_GATE_THRESHOLD */
+
     /* Loop. */
     do {
+#if defined(MOTION_GATE_THRESHOLD)
+        cascade.Step();
+        if (cascade.GetPeriodCount() == kCascadeStatsPeriods) {
+            cascade.PrintStats(SystemCoreClock / 1000);
+            cascade.ResetStats();
+        }
+#else
         alif::app::ObjectDetectionHandler(caseContext);
+#endif /* MOTION_GATE_THRESHOLD */
+        log_flush();
 
         __disable_irq();
         while (obj_button_pressed) {
             info("Going to chip STOP mode...\n");
+            log_flush();
             pm_core_enter_deep_sleep_request_subsys_off();
             __enable_irq();
             __ISB();
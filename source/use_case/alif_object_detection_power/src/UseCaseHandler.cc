@@ -37,6 +37,7 @@
 
 #include <cinttypes>
 #include <cmath>
+#include <cstdlib>
 
 #ifdef SHOW_UI
 #include "ScreenLayout.hpp"
@@ -63,6 +64,16 @@ using arm::app::DetectorPostProcess;
 
 static int alive_counter = 0;
 const int kAliveCounterVal = 1000;
+
+/* The motion gate compares every kMotionGateStep-th pixel of every
+ * kMotionGateStep-th row; a pixel has changed if its luma moved by more
+ * than kMotionGatePixelDelta. */
+const int kMotionGateStep = 4;
+const int kMotionGatePixelDelta = 16;
+
+/* Boxes kept for NMS in a frame, highest objectness first. */
+const int kMaxDetections = 32;
+
 namespace alif {
 namespace app {
 
@@ -71,6 +82,16 @@ using namespace arm::app::object_detection;
 }
 
     bool ObjectDetectionInit(YoloFastestModel& model)
+    {
+        TfLiteIntArray* inputShape = model.GetInputShape(0);
+
+        const int inputImgCols = inputShape->data[YoloFastestModel::ms_inputColsIdx];
+        const int inputImgRows = inputShape->data[YoloFastestModel::ms_inputRowsIdx];
+
+        return ObjectDetectionInit(inputImgCols, inputImgRows);
+    }
+
+    bool ObjectDetectionInit(int inputImgCols, int inputImgRows)
     {
         uint32_t ret = enable_peripheral_clocks();
         if (ret)
@@ -105,11 +126,6 @@ using namespace arm::app::object_detection;
             return false;
         }
 
-        TfLiteIntArray* inputShape = model.GetInputShape(0);
-
-        const int inputImgCols = inputShape->data[YoloFastestModel::ms_inputColsIdx];
-        const int inputImgRows = inputShape->data[YoloFastestModel::ms_inputRowsIdx];
-
         auto bCamera = hal_camera_configure(inputImgCols, inputImgRows, HAL_CAMERA_MODE_SINGLE_FRAME, HAL_CAMERA_COLOUR_FORMAT_RGB888);
         if (!bCamera) {
             printf_err("Failed to configure camera.\n");
@@ -138,8 +154,34 @@ using namespace arm::app::object_detection;
            int imgInputCols, int imgInputRows);
 #endif // SHOW_UI
 
+    /**
+     * @brief           Captures a camera frame.
+     * @return          The frame, or nullptr on failure.
+     **/
+    static const uint8_t* CaptureFrame()
+    {
+        hal_camera_start();
+
+        uint32_t capturedFrameSize = 0;
+        const uint8_t* currImage = hal_camera_get_captured_frame(&capturedFrameSize);
+        if (!currImage || !capturedFrameSize) {
+            printf_err("hal_camera_get_captured_frame failed");
+            return nullptr;
+        }
+        return currImage;
+    }
+
     /* Object detection inference handler. */
     bool ObjectDetectionHandler(ApplicationContext& ctx)
+    {
+        const uint8_t* currImage = CaptureFrame();
+        if (!currImage) {
+            return false;
+        }
+        return ObjectDetectionHandler(ctx, currImage);
+    }
+
+    bool ObjectDetectionHandler(ApplicationContext& ctx, const uint8_t* currImage)
     {
         auto& profiler = ctx.Get<Profiler&>("profiler");
         auto& model = ctx.Get<Model&>("model");
@@ -166,28 +208,23 @@ using namespace arm::app::object_detection;
         const int inputImgCols = inputShape->data[YoloFastestModel::ms_inputColsIdx];
         const int inputImgRows = inputShape->data[YoloFastestModel::ms_inputRowsIdx];
 
-        /* Set up pre and post-processing. */
-        DetectorPreProcess preProcess = DetectorPreProcess(inputTensor, true, model.IsDataSigned());
-
-        std::vector<object_detection::DetectionResult> results;
-        const object_detection::PostProcessParams postProcessParams {
-            inputImgRows, inputImgCols, object_detection::originalImageSize,
-            object_detection::anchor1, object_detection::anchor2
-        };
-        DetectorPostProcess postProcess = DetectorPostProcess(outputTensor0, outputTensor1,
-                results, postProcessParams);
-
-        /* Ensure there are no results leftover from previous inference when running all. */
-        results.clear();
-
-        hal_camera_start();
-
-        uint32_t capturedFrameSize = 0;
-        const uint8_t* currImage = hal_camera_get_captured_frame(&capturedFrameSize);
-        if (!currImage || !capturedFrameSize) {
-            printf_err("hal_camera_get_captured_frame failed");
-            return false;
-        }
+        /* Set up pre and post-processing on the first frame, once the model
+         * is loaded, and reuse them for every frame after it. The
+         * post-processing keeps a reference to its parameters, so they are
+         * static too. */
+        static const object_detection::PostProcessParams postProcessParams = [&]() {
+            object_detection::PostProcessParams params {
+                inputImgRows, inputImgCols, object_detection::originalImageSize,
+                object_detection::anchor1, object_detection::anchor2
+            };
+            params.topN = kMaxDetections;
+            return params;
+        }();
+
+        static std::vector<object_detection::DetectionResult> results;
+        static DetectorPreProcess preProcess{inputTensor, true, model.IsDataSigned()};
+        static DetectorPostProcess postProcess{outputTensor0, outputTensor1,
+                                               results, postProcessParams};
 
         {
 #ifdef SHOW_UI
@@ -225,12 +262,12 @@ using namespace arm::app::object_detection;
 #ifdef SHOW_UI
 #if SHOW_INF_TIME
             inf_prof = Get_SysTick_Cycle_Count32() - inf_prof;
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(2), "Inference time: %.3f ms", (double)inf_prof / SystemCoreClock * 1000);
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(3), "Inferences / sec: %.2f", (double) SystemCoreClock / inf_prof);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(2), "Inference time: %.3f ms", (double)inf_prof / SystemCoreClock * 1000);
+            ScreenLayoutSetText(ScreenLayoutLabelObject(3), "Inferences / sec: %.2f", (double) SystemCoreClock / inf_prof);
             //lv_label_set_text_fmt(ScreenLayoutLabelObject(3), "Inferences / second: %.2f", (double) SystemCoreClock / (inf_loop_time_end - inf_loop_time_start));
 #endif
 
-            lv_label_set_text_fmt(ScreenLayoutLabelObject(0), "Faces Detected: %i", results.size());
+            ScreenLayoutSetText(ScreenLayoutLabelObject(0), "Faces Detected: %zu", results.size());
 
             /* Draw boxes. */
             DrawDetectionBoxes(results, inputImgCols, inputImgRows);
@@ -252,6 +289,43 @@ using namespace arm::app::object_detection;
         return true;
     }
 
+    MotionGate::MotionGate(int imgCols, int imgRows)
+    :   m_cols{imgCols},
+        m_rows{imgRows},
+        m_previous(((imgCols + kMotionGateStep - 1) / kMotionGateStep) *
+                   ((imgRows + kMotionGateStep - 1) / kMotionGateStep))
+    {}
+
+    bool MotionGate::Run(float& score)
+    {
+        this->m_frame = CaptureFrame();
+        if (!this->m_frame) {
+            return false;
+        }
+
+        uint32_t changed = 0;
+        uint8_t* previous = this->m_previous.data();
+        for (int y = 0; y < this->m_rows; y += kMotionGateStep) {
+            const uint8_t* pixel = this->m_frame + y * this->m_cols * 3;
+            for (int x = 0; x < this->m_cols; x += kMotionGateStep, pixel += kMotionGateStep * 3) {
+                const int luma = (pixel[0] + 2 * pixel[1] + pixel[2]) >> 2;
+                if (std::abs(luma - *previous) > kMotionGatePixelDelta) {
+                    ++changed;
+                }
+                *previous++ = static_cast<uint8_t>(luma);
+            }
+        }
+
+        score = this->m_havePrevious ? static_cast<float>(changed) / this->m_previous.size() : 1.f;
+        this->m_havePrevious = true;
+        return true;
+    }
+
+    const uint8_t* MotionGate::GetFrame() const
+    {
+        return this->m_frame;
+    }
+
     static bool PresentInferenceResult(const std::vector<object_detection::DetectionResult>& results)
     {
 
@@ -272,22 +346,27 @@ using namespace arm::app::object_detection;
         return true;
     }
 #ifdef SHOW_UI
-    static void DeleteBoxes(lv_obj_t *frame)
+    /* Boxes are kept from frame to frame, so that LVGL only redraws the ones
+     * that move. Moving or resizing an object to where it is does nothing. */
+    static void PlaceBox(lv_obj_t *frame, uint32_t index, int x0, int y0, int w, int h)
     {
         // Assume that child 0 of the frame is the image itself
-        int children = lv_obj_get_child_count(frame);
-        while (children > 1) {
-            lv_obj_del(lv_obj_get_child(frame, 1));
-            children--;
+        lv_obj_t *box = lv_obj_get_child(frame, index + 1);
+        if (!box) {
+            box = lv_obj_create(frame);
+            lv_obj_add_style(box, &boxStyle, LV_PART_MAIN);
         }
+        lv_obj_set_size(box, w, h);
+        lv_obj_set_pos(box, x0, y0);
+        lv_obj_remove_flag(box, LV_OBJ_FLAG_HIDDEN);
     }
 
-    static void CreateBox(lv_obj_t *frame, int x0, int y0, int w, int h)
+    static void HideBoxes(lv_obj_t *frame, uint32_t first)
     {
-        lv_obj_t *box = lv_obj_create(frame);
-        lv_obj_set_size(box, w, h);
-        lv_obj_add_style(box, &boxStyle, LV_PART_MAIN);
-        lv_obj_set_pos(box, x0, y0);
+        const uint32_t children = lv_obj_get_child_count(frame);
+        for (uint32_t i = first + 1; i < children; i++) {
+            lv_obj_add_flag(lv_obj_get_child(frame, i), LV_OBJ_FLAG_HIDDEN);
+        }
     }
 
     static void DrawDetectionBoxes(const std::vector<object_detection::DetectionResult>& results,
@@ -297,15 +376,15 @@ using namespace arm::app::object_detection;
         float xScale = (float) lv_obj_get_content_width(frame) / imgInputCols;
         float yScale = (float) lv_obj_get_content_height(frame) / imgInputRows;
 
-        DeleteBoxes(frame);
-
+        uint32_t boxes = 0;
         for (const auto& result: results) {
-            CreateBox(frame,
-                      floor(result.m_x0 * xScale),
-                      floor(result.m_y0 * yScale),
-                      ceil(result.m_w * xScale),
-                      ceil(result.m_h * yScale));
+            PlaceBox(frame, boxes++,
+                     floor(result.m_x0 * xScale),
+                     floor(result.m_y0 * yScale),
+                     ceil(result.m_w * xScale),
+                     ceil(result.m_h * yScale));
         }
+        HideBoxes(frame, boxes);
     }
 #endif // SHOW_UI
 
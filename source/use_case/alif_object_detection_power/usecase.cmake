@@ -31,6 +31,10 @@ USER_OPTION(${use_case}_MODEL_IN_EXT_FLASH "Run model from external flash"
     OFF
     BOOL)
 
+USER_OPTION(${use_case}_WEIGHT_STAGING_SZ "Bytes of the activation buffer used to hold copies of the NPU weights (0 reads them in place)"
+    0
+    STRING)
+
 USER_OPTION(${use_case}_IMAGE_SIZE "Square image size in pixels. Images will be resized to this size."
     192
     STRING)
@@ -55,6 +59,18 @@ USER_OPTION(SHOW_UI "Use the display to show camera and detection boxes."
     OFF
     BOOL)
 
+USER_OPTION(${use_case}_MOTION_GATE "Only run face detection when the camera image changes"
+    OFF
+    BOOL)
+
+USER_OPTION(${use_case}_MOTION_GATE_THRESHOLD "Share [0.0, 1.0] of the image that must change for face detection to run"
+    0.02
+    STRING)
+
+USER_OPTION(${use_case}_MOTION_GATE_HOLD "Frames face detection keeps running for after the image last changed"
+    10
+    STRING)
+
 set(SE_SERVICES_SUPPORT ON CACHE BOOL "Enables SE Services initialization. Needed for power examples and KWS MHU communication.")
 
 message(STATUS "alif_object_detection_power: SE_SERVICES_SUPPORT: ${SE_SERVICES_SUPPORT}")
@@ -63,6 +79,8 @@ set(${use_case}_COMPILE_DEFS
     SHOW_INF_TIME=$<BOOL:${${use_case}_SHOW_INF_TIME}>
     $<$<BOOL:${SHOW_UI}>:SHOW_UI>
     $<$<BOOL:${SE_SERVICES_SUPPORT}>:SE_SERVICES_SUPPORT>
+    $<$<BOOL:${${use_case}_MOTION_GATE}>:MOTION_GATE_THRESHOLD=${${use_case}_MOTION_GATE_THRESHOLD}>
+    $<$<BOOL:${${use_case}_MOTION_GATE}>:MOTION_GATE_HOLD=${${use_case}_MOTION_GATE_HOLD}>
 )
 
 if (ETHOS_U_NPU_ENABLED)
@@ -18,10 +18,33 @@
 #define VISUAL_WAKE_WORD_HANDLER_HPP
 
 #include "AppContext.hpp"
+#include "ClassificationResult.hpp"
+#include "Classifier.hpp"
+#include "Model.hpp"
+#include "Profiler.hpp"
+
+#include <string>
+#include <vector>
 
 namespace alif {
 namespace app {
 
+    /* Entries of the visual wake word application context. */
+    namespace key {
+        using arm::app::ContextKey;
+
+        struct Profiler : ContextKey<arm::app::Profiler&> {};
+        struct Model : ContextKey<arm::app::Model&> {};
+        struct Classifier : ContextKey<arm::app::Classifier&> {};
+        struct Labels : ContextKey<const std::vector<std::string>&> {};
+        struct Results : ContextKey<std::vector<arm::app::ClassificationResult>> {}; /* Of the last frame. */
+    } /* namespace key */
+
+    using VwwContext = arm::app::TypedContext<key::Profiler,
+                                              key::Model,
+                                              key::Classifier,
+                                              key::Labels,
+                                              key::Results>;
 
     bool ClassifyImageInit();
     /**
@@ -31,7 +54,7 @@ namespace app {
      * @param[in]   runAll     Flag to request classification of the available images.
      * @return      true or false based on execution success.
      **/
-    bool ClassifyImageHandler(arm::app::ApplicationContext &ctx);
+    bool ClassifyImageHandler(VwwContext& ctx);
 
 } /* namespace alif */
 } /* namespace arm */
@@ -21,6 +21,7 @@
 #include "UseCaseHandler.hpp"       /* Handlers for different user options. */
 #include "UseCaseCommonUtils.hpp"   /* Utils functions. */
 #include "log_macros.h"             /* Logging functions */
+#include "log_trace.h"              /* Timeline tracing */
 #include "BufAttributes.hpp"        /* Buffer attributes to be applied */
 
 namespace arm {
@@ -55,23 +56,26 @@ void MainLoop()
     }
 
     /* Instantiate application context. */
-    arm::app::ApplicationContext caseContext;
+    alif::app::VwwContext caseContext;
 
-    arm::app::Profiler profiler{"vww"};
-    caseContext.Set<arm::app::Profiler&>("profiler", profiler);
-    caseContext.Set<arm::app::Model&>("model", model);
-    caseContext.Set<uint32_t>("imgIndex", 0);
+    static arm::app::Profiler profiler{"vww"};
+    caseContext.Set<alif::app::key::Profiler>(profiler);
+    caseContext.Set<alif::app::key::Model>(model);
 
     ViusalWakeWordClassifier classifier;  /* Classifier wrapper object. */
-    caseContext.Set<arm::app::Classifier&>("classifier", classifier);
+    caseContext.Set<alif::app::key::Classifier>(classifier);
 
     std::vector <std::string> labels;
     GetLabelsVector(labels);
-    caseContext.Set<const std::vector <std::string>&>("labels", labels);
+    caseContext.Set<alif::app::key::Labels>(labels);
 
     /* Loop. */
     do {
+        LOG_TRACE_BEGIN(frame);
         alif::app::ClassifyImageHandler(caseContext);
+        LOG_TRACE_END(frame, LOG_TRACE_TRACK_CPU, "frame");
+        log_flush();
+        LOG_TRACE_DUMP_WHEN_FULL();
     } while (1);
 
 }
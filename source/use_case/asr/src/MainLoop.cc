@@ -40,6 +40,13 @@ void MainLoop()
 {
     arm::app::Wav2LetterModel model;  /* Model wrapper object. */
 
+#if defined(WEIGHT_STAGING_SZ)
+    /* Copy the hottest weights into the arena, away from slow model memory.
+     * The copies are read through the application's Ethos-U kernel. */
+    model.SetNpuBackend(arm::app::GetDefaultNpuBackend());
+    model.SetWeightStagingBudget(WEIGHT_STAGING_SZ);
+#endif /* WEIGHT_STAGING_SZ */
+
     /* Load the model. */
     if (!model.Init(arm::app::tensorArena,
                     sizeof(arm::app::tensorArena),
@@ -58,7 +65,7 @@ void MainLoop()
     GetLabelsVector(labels);
     arm::app::AsrClassifier classifier;  /* Classifier wrapper object. */
 
-    arm::app::Profiler profiler{"asr"};
+    static arm::app::Profiler profiler{"asr"};
     caseContext.Set<arm::app::Profiler&>("profiler", profiler);
     caseContext.Set<arm::app::Model&>("model", model);
     caseContext.Set<uint32_t>("frameLength", arm::app::asr::g_FrameLength);
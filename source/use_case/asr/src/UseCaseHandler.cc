@@ -189,6 +189,7 @@ namespace app {
             }
 
             profiler.PrintProfilingResult();
+            log_flush();
         }
 
         return true;
@@ -24,6 +24,10 @@ USER_OPTION(${use_case}_MODEL_IN_EXT_FLASH "Run model from external flash"
     ON
     BOOL)
 
+USER_OPTION(${use_case}_WEIGHT_STAGING_SZ "Bytes of the activation buffer used to hold copies of the NPU weights (0 reads them in place)"
+    0
+    STRING)
+
 USER_OPTION(${use_case}_LABELS_TXT_FILE "Labels' txt file for the chosen model."
     ${CMAKE_CURRENT_SOURCE_DIR}/resources/${use_case}/labels/labels_wav2letter.txt
     FILEPATH)
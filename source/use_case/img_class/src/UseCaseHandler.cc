@@ -147,6 +147,7 @@ namespace app {
             }
 
             profiler.PrintProfilingResult();
+            log_flush();
         }
 
         return true;
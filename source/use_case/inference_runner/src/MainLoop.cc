@@ -17,11 +17,16 @@
  */
 #include "hal.h"                    /* Brings in platform definitions. */
 #include "TestModel.hpp"            /* Model class for running inference. */
+#include "ModelOpsTestModel.hpp"    /* Model class registering only the model's operators. */
 #include "UseCaseHandler.hpp"       /* Handlers for different user options. */
 #include "UseCaseCommonUtils.hpp"   /* Utils functions. */
 #include "log_macros.h"             /* Logging functions */
 #include "BufAttributes.hpp"        /* Buffer attributes to be applied */
 
+#if defined(MODEL_OPS_ONLY)
+#include "ModelOpResolver.hpp"      /* Operators used by the model, generated at build time. */
+#endif /* MODEL_OPS_ONLY */
+
 namespace arm {
 namespace app {
     static uint8_t tensorArena[ACTIVATION_BUF_SZ] ACTIVATION_BUF_ATTRIBUTE;
@@ -54,7 +59,24 @@ extern size_t GetModelLen();
 
 void MainLoop()
 {
+#if defined(MODEL_OPS_ONLY)
+    /* Model wrapper object, registering only the operators the model uses. */
+    arm::app::ModelOpsTestModel<arm::app::inference_runner::kNumModelOperators> model{
+        arm::app::inference_runner::EnlistModelOperators};
+#else /* MODEL_OPS_ONLY */
     arm::app::TestModel model;  /* Model wrapper object. */
+#endif /* MODEL_OPS_ONLY */
+
+#if defined(WEIGHT_STAGING_SZ) || defined(ASYNC_OVERLAP_TEST)
+    /* Staged weights and asynchronous inference need the application's
+     * Ethos-U kernel rather than TFLM's. */
+    model.SetNpuBackend(arm::app::GetDefaultNpuBackend());
+#endif /* defined(WEIGHT_STAGING_SZ) || defined(ASYNC_OVERLAP_TEST) */
+
+#if defined(WEIGHT_STAGING_SZ)
+    /* Copy the hottest weights into the arena, away from slow model memory. */
+    model.SetWeightStagingBudget(WEIGHT_STAGING_SZ);
+#endif /* WEIGHT_STAGING_SZ */
 
     /* Load the model. */
     if (!model.Init(arm::app::tensorArena,
@@ -68,7 +90,7 @@ void MainLoop()
     /* Instantiate application context. */
     arm::app::ApplicationContext caseContext;
 
-    arm::app::Profiler profiler{"inference_runner"};
+    static arm::app::Profiler profiler{"inference_runner"};
     caseContext.Set<arm::app::Profiler&>("profiler", profiler);
     caseContext.Set<arm::app::Model&>("model", model);
 
@@ -22,6 +22,8 @@
 #include "log_macros.h"
 
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 namespace arm {
 namespace app {
@@ -114,6 +116,118 @@ static void DumpOutputs(const Model& model, const char* message)
 }
 #endif /* VERIFY_TEST_OUTPUT */
 
+#if defined(ASYNC_OVERLAP_TEST)
+/* Stand-in for the pre-processing of the next input: fills a staging buffer
+ * with random data, as PopulateInputTensor does for the tensors. */
+static void PrepareNextInput(std::vector<uint8_t>& staging)
+{
+    for (auto& byte : staging) {
+        byte = static_cast<uint8_t>(std::rand() & 0xFF);
+    }
+}
+
+static void CopyNextInput(const Model& model, const std::vector<uint8_t>& staging)
+{
+    size_t offset = 0;
+    for (size_t inputIndex = 0; inputIndex < model.GetNumInputs(); inputIndex++) {
+        TfLiteTensor* inputTensor = model.GetInputTensor(inputIndex);
+        memcpy(tflite::GetTensorData<uint8_t>(inputTensor), staging.data() + offset,
+               inputTensor->bytes);
+        offset += inputTensor->bytes;
+    }
+}
+
+/**
+ * Times the preparation of the next input run after the inference against
+ * the same work done while the NPU runs the inference.
+ */
+static bool RunOverlapTest(Model& model)
+{
+    constexpr int numIterations = 4;
+
+    /* Separate from the main profiler, which has no room for its regions. */
+    static Profiler profiler{"overlap"};
+
+    if (!model.SupportsAsyncInference()) {
+        info("Model does not support asynchronous inference, skipping overlap test\n");
+        return true;
+    }
+
+    size_t totalInputBytes = 0;
+    for (size_t inputIndex = 0; inputIndex < model.GetNumInputs(); inputIndex++) {
+        totalInputBytes += model.GetInputTensor(inputIndex)->bytes;
+    }
+    std::vector<uint8_t> staging(totalInputBytes);
+
+    for (int i = 0; i < numIterations; ++i) {
+        profiler.StartProfiling("Sequential");
+        const bool ok = model.RunInference();
+        PrepareNextInput(staging);
+        profiler.StopProfiling();
+        if (!ok) {
+            return false;
+        }
+        CopyNextInput(model, staging);
+    }
+
+    for (int i = 0; i < numIterations; ++i) {
+        profiler.StartProfiling("Overlapped");
+        if (!model.StartInference()) {
+            profiler.StopProfiling();
+            return false;
+        }
+        /* The input tensors are in use until the inference has finished. */
+        PrepareNextInput(staging);
+        const bool ok = model.WaitForInference();
+        profiler.StopProfiling();
+        if (!ok) {
+            return false;
+        }
+        CopyNextInput(model, staging);
+    }
+
+    info("CPU work overlapped with asynchronous inference:\n");
+    profiler.PrintProfilingResult();
+    return true;
+}
+#endif /* defined(ASYNC_OVERLAP_TEST) */
+
+#if defined(WEIGHT_STAGING_SZ)
+/**
+ * Times inferences reading the weights from where the model is stored
+ * against inferences reading the copies staged in the tensor arena.
+ */
+static bool RunWeightStagingTest(Model& model)
+{
+    constexpr int numIterations = 4;
+
+    /* Separate from the main profiler, which has no room for its regions. */
+    static Profiler profiler{"weight_staging"};
+
+    if (0 == model.GetStagedWeightsSize()) {
+        info("No weights staged, skipping weight staging test\n");
+        return true;
+    }
+
+    const char* names[] = {"Weights in place", "Weights staged"};
+    for (int staged = 0; staged < 2; ++staged) {
+        model.UseStagedWeights(1 == staged);
+        for (int i = 0; i < numIterations; ++i) {
+            profiler.StartProfiling(names[staged]);
+            const bool ok = model.RunInference();
+            profiler.StopProfiling();
+            if (!ok) {
+                return false;
+            }
+        }
+    }
+
+    info("Weights staged in SRAM: %zu bytes\n", model.GetStagedWeightsSize());
+    profiler.PrintProfilingResult();
+    return true;
+}
+#endif /* defined(WEIGHT_STAGING_SZ) */
+
 bool RunInferenceHandler(ApplicationContext& ctx)
 {
     auto& profiler = ctx.Get<Profiler&>("profiler");
@@ -167,6 +281,18 @@ bool RunInferenceHandler(ApplicationContext& ctx)
     PopulateDynamicOfm(model);
 #endif /* defined (DYNAMIC_OFM_BASE) && defined(DYNAMIC_OFM_SIZE) */
 
+#if defined(ASYNC_OVERLAP_TEST)
+    if (!RunOverlapTest(model)) {
+        return false;
+    }
+#endif /* defined(ASYNC_OVERLAP_TEST) */
+
+#if defined(WEIGHT_STAGING_SZ)
+    if (!RunWeightStagingTest(model)) {
+        return false;
+    }
+#endif /* defined(WEIGHT_STAGING_SZ) */
+
     return true;
 }
 
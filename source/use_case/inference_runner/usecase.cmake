@@ -22,6 +22,10 @@ USER_OPTION(${use_case}_ACTIVATION_BUF_SZ "Activation buffer size for the chosen
     0x00200000
     STRING)
 
+USER_OPTION(${use_case}_WEIGHT_STAGING_SZ "Bytes of the activation buffer used to hold copies of the NPU weights (0 reads them in place)"
+    0
+    STRING)
+
 if (ETHOS_U_NPU_ENABLED)
     set(DEFAULT_MODEL_PATH      ${DEFAULT_MODEL_DIR}/dnn_s_quantized_vela_${ETHOS_U_NPU_CONFIG_ID}.tflite)
 else()
@@ -72,4 +76,26 @@ else()
         MODEL_PATH ${${use_case}_MODEL_TFLITE_PATH}
         DESTINATION ${SRC_GEN_DIR}
         NAMESPACE   "arm" "app" "inference_runner")
+
+    USER_OPTION(${use_case}_MODEL_OPS_ONLY "Register only the operators the model uses, listed from it at build time, rather than every operator"
+        ON
+        BOOL)
+
+    if (${${use_case}_MODEL_OPS_ONLY})
+        generate_op_resolver_code(
+            MODEL_PATH ${${use_case}_MODEL_TFLITE_PATH}
+            DESTINATION ${INC_GEN_DIR}
+            OUTPUT_FILENAME "ModelOpResolver"
+            NAMESPACE   "arm" "app" "inference_runner")
+        list(APPEND ${use_case}_COMPILE_DEFS "MODEL_OPS_ONLY=1")
+    endif()
+endif()
+
+USER_OPTION(${use_case}_ASYNC_OVERLAP_TEST
+    "Also time CPU work overlapped with asynchronous inferences against the same work run after them"
+    OFF
+    BOOL)
+
+if (${${use_case}_ASYNC_OVERLAP_TEST})
+    list(APPEND ${use_case}_COMPILE_DEFS "ASYNC_OVERLAP_TEST=1")
 endif()
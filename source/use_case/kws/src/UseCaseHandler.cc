@@ -23,6 +23,7 @@
 #include "KwsProcessing.hpp"
 #include "KwsResult.hpp"
 #include "MicroNetKwsModel.hpp"
+#include "Pipeline.hpp"
 #include "UseCaseCommonUtils.hpp"
 #include "hal.h"
 #include "log_macros.h"
@@ -39,6 +40,88 @@ namespace app {
      **/
     static bool PresentInferenceResult(const std::vector<kws::KwsResult>& results);
 
+    /* Feeds the windows of an audio clip to the pipeline, with their index. */
+    class KwsWindowSource : public PipelineSource {
+    public:
+        explicit KwsWindowSource(size_t windowSize)
+        :   m_windowSize{windowSize}
+        {}
+
+        void SetClip(const audio::SlidingWindow<const int16_t>& slider)
+        {
+            this->m_slider = slider;
+        }
+
+        PipelineInput Next(const void*& data, size_t& size, size_t& index) override
+        {
+            if (!this->m_slider.HasNext()) {
+                return PipelineInput::End;
+            }
+            data = this->m_slider.Next();
+            size = this->m_windowSize * sizeof(int16_t);
+            index = this->m_slider.Index();
+            info("Inference %zu/%zu\n", this->m_slider.Index() + 1, this->m_slider.TotalStrides() + 1);
+            return PipelineInput::Ready;
+        }
+
+    private:
+        audio::SlidingWindow<const int16_t> m_slider;
+        size_t m_windowSize;
+    };
+
+    /* Pre-processes each window with its index, which lets KwsPreProcess
+     * reuse the features computed for the overlapping part of the last one. */
+    class KwsPreProcessStage : public PipelinePreProcess {
+    public:
+        explicit KwsPreProcessStage(KwsPreProcess& preProcess)
+        :   m_preProcess{preProcess}
+        {}
+
+        bool DoPreProcess(const void* data, size_t size, size_t index) override
+        {
+            UNUSED(size);
+            return this->m_preProcess.DoPreProcess(data, index);
+        }
+
+    private:
+        KwsPreProcess& m_preProcess;
+    };
+
+    /* Collects the result of each window. */
+    class KwsResultSink : public PipelineSink {
+    public:
+        KwsResultSink(const std::vector<ClassificationResult>& singleInfResult,
+                      std::vector<kws::KwsResult>& finalResults,
+                      TfLiteTensor* outputTensor, float secondsPerStride, float scoreThreshold)
+        :   m_singleInfResult{singleInfResult},
+            m_finalResults{finalResults},
+            m_outputTensor{outputTensor},
+            m_secondsPerStride{secondsPerStride},
+            m_scoreThreshold{scoreThreshold}
+        {}
+
+        bool Consume(uint32_t sequence) override
+        {
+            this->m_finalResults.emplace_back(kws::KwsResult(this->m_singleInfResult,
+                                                             sequence * this->m_secondsPerStride,
+                                                             sequence,
+                                                             this->m_scoreThreshold));
+#if VERIFY_TEST_OUTPUT
+            DumpTensor(this->m_outputTensor);
+#else
+            UNUSED(this->m_outputTensor);
+#endif /* VERIFY_TEST_OUTPUT */
+            return true;
+        }
+
+    private:
+        const std::vector<ClassificationResult>& m_singleInfResult;
+        std::vector<kws::KwsResult>& m_finalResults;
+        TfLiteTensor* m_outputTensor;
+        float m_secondsPerStride;
+        float m_scoreThreshold;
+    };
+
     /* KWS inference handler. */
     bool ClassifyAudioHandler(ApplicationContext& ctx)
     {
@@ -91,6 +174,23 @@ namespace app {
                                                     ctx.Get<std::vector<std::string>&>("labels"),
                                                     singleInfResult);
 
+        /* Windows are pre-processed and post-processed while the previous
+         * ones are being inferred. Each inference is profiled on its own. */
+#if defined(PIPELINE_THREADS)
+        ThreadedModelInference modelInference{model};
+#else
+        ModelInference modelInference{model};
+#endif /* PIPELINE_THREADS */
+        ProfilingInference inference{modelInference, profiler};
+
+        /* Container to hold results from across the whole audio clip. */
+        std::vector<kws::KwsResult> finalResults;
+        KwsWindowSource source{preProcess.m_audioDataWindowSize};
+        KwsPreProcessStage preProcessStage{preProcess};
+        KwsResultSink sink{singleInfResult, finalResults, outputTensor,
+                           secondsPerSample * preProcess.m_audioDataStride, scoreThreshold};
+        Pipeline pipeline{source, preProcessStage, inference, postProcess, sink};
+
         hal_audio_init();
         if (!hal_audio_configure(HAL_AUDIO_MODE_SINGLE_BURST,
                                  HAL_AUDIO_FORMAT_16KHZ_MONO_16BIT)) {
@@ -111,55 +211,24 @@ namespace app {
             }
 
             /* Creating a sliding window through the whole audio clip. */
-            auto audioDataSlider =
-                audio::SlidingWindow<const int16_t>(audioData,
-                                                    nElements,
-                                                    preProcess.m_audioDataWindowSize,
-                                                    preProcess.m_audioDataStride);
-
-            /* Declare a container to hold results from across the whole audio clip. */
-            std::vector<kws::KwsResult> finalResults;
+            source.SetClip(audio::SlidingWindow<const int16_t>(audioData,
+                                                               nElements,
+                                                               preProcess.m_audioDataWindowSize,
+                                                               preProcess.m_audioDataStride));
+            finalResults.clear();
+            pipeline.Reset();
+            pipeline.ResetStats();
 
             /* Display message on the LCD - inference running. */
             std::string str_inf{"Running inference... "};
             hal_lcd_display_text(
                 str_inf.c_str(), str_inf.size(), dataPsnTxtInfStartX, dataPsnTxtInfStartY, 0);
 
-            /* Start sliding through audio clip. */
-            while (audioDataSlider.HasNext()) {
-                const int16_t* inferenceWindow = audioDataSlider.Next();
-
-                info("Inference %zu/%zu\n",
-                     audioDataSlider.Index() + 1,
-                     audioDataSlider.TotalStrides() + 1);
-
-                /* Run the pre-processing, inference and post-processing. */
-                if (!preProcess.DoPreProcess(inferenceWindow, audioDataSlider.Index())) {
-                    printf_err("Pre-processing failed.");
-                    return false;
-                }
-
-                if (!RunInference(model, profiler)) {
-                    printf_err("Inference failed.");
-                    return false;
-                }
-
-                if (!postProcess.DoPostProcess()) {
-                    printf_err("Post-processing failed.");
-                    return false;
-                }
-
-                /* Add results from this window to our final results vector. */
-                finalResults.emplace_back(kws::KwsResult(
-                    singleInfResult,
-                    audioDataSlider.Index() * secondsPerSample * preProcess.m_audioDataStride,
-                    audioDataSlider.Index(),
-                    scoreThreshold));
-
-#if VERIFY_TEST_OUTPUT
-                DumpTensor(outputTensor);
-#endif        /* VERIFY_TEST_OUTPUT */
-            } /* while (audioDataSlider.HasNext()) */
+            /* Slide through the audio clip. */
+            if (!pipeline.Run()) {
+                return false;
+            }
+            pipeline.PrintStats();
 
             /* Erase. */
             str_inf = std::string(str_inf.size(), ' ');
@@ -173,6 +242,7 @@ namespace app {
             }
 
             profiler.PrintProfilingResult();
+            log_flush();
         }
 
         return true;
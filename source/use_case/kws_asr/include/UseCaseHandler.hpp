@@ -19,16 +19,58 @@
 #define KWS_ASR_EVT_HANDLER_HPP
 
 #include "AppContext.hpp"
+#include "AsrClassifier.hpp"
+#include "KwsClassifier.hpp"
+#include "Model.hpp"
+#include "Profiler.hpp"
+
+#include <string>
+#include <vector>
 
 namespace arm {
 namespace app {
 
+    /* Entries of the KWS and ASR application context. */
+    namespace key {
+        struct Profiler : ContextKey<arm::app::Profiler&> {};
+        struct KwsModel : ContextKey<arm::app::Model&> {};
+        struct KwsFrameLength : ContextKey<int> {};
+        struct KwsFrameStride : ContextKey<int> {};
+        struct KwsScoreThreshold : ContextKey<float> {};      /* Normalised score threshold. */
+        struct KwsClassifier : ContextKey<arm::app::KwsClassifier&> {};
+        struct KwsLabels : ContextKey<const std::vector<std::string>&> {};
+        struct TriggerKeyword : ContextKey<const std::string&> {}; /* KWS keyword that triggers ASR. */
+        struct AsrModel : ContextKey<arm::app::Model&> {};
+        struct AsrContextLength : ContextKey<uint32_t> {};    /* Left and right context length (MFCC feat vectors). */
+        struct AsrFrameLength : ContextKey<uint32_t> {};
+        struct AsrFrameStride : ContextKey<uint32_t> {};
+        struct AsrScoreThreshold : ContextKey<float> {};      /* Normalised score threshold. */
+        struct AsrClassifier : ContextKey<arm::app::AsrClassifier&> {};
+        struct AsrLabels : ContextKey<const std::vector<std::string>&> {};
+    } /* namespace key */
+
+    using KwsAsrContext = TypedContext<key::Profiler,
+                                       key::KwsModel,
+                                       key::KwsFrameLength,
+                                       key::KwsFrameStride,
+                                       key::KwsScoreThreshold,
+                                       key::KwsClassifier,
+                                       key::KwsLabels,
+                                       key::TriggerKeyword,
+                                       key::AsrModel,
+                                       key::AsrContextLength,
+                                       key::AsrFrameLength,
+                                       key::AsrFrameStride,
+                                       key::AsrScoreThreshold,
+                                       key::AsrClassifier,
+                                       key::AsrLabels>;
+
     /**
      * @brief       Handles the inference event.
      * @param[in]   ctx         Pointer to the application context.
      * @return      true or false based on execution success.
      **/
-    bool ClassifyAudioHandler(ApplicationContext& ctx);
+    bool ClassifyAudioHandler(KwsAsrContext& ctx);
 
 } /* namespace app */
 } /* namespace arm */
@@ -60,6 +60,14 @@ void MainLoop()
         return;
     }
 
+#if defined(WEIGHT_STAGING_SZ)
+    /* Copy the hottest ASR weights into the arena, away from slow model
+     * memory, read through the application's Ethos-U kernel. The KWS model
+     * is small enough to be read in place. */
+    asrModel.SetNpuBackend(arm::app::GetDefaultNpuBackend());
+    asrModel.SetWeightStagingBudget(WEIGHT_STAGING_SZ);
+#endif /* WEIGHT_STAGING_SZ */
+
     /* Initialise the asr model using the same allocator from KWS
      * to re-use the tensor arena. */
     if (!asrModel.Init(arm::app::tensorArena,
@@ -75,39 +83,37 @@ void MainLoop()
     }
 
     /* Instantiate application context. */
-    arm::app::ApplicationContext caseContext;
-
-    arm::app::Profiler profiler{"kws_asr"};
-    caseContext.Set<arm::app::Profiler&>("profiler", profiler);
-    caseContext.Set<arm::app::Model&>("kwsModel", kwsModel);
-    caseContext.Set<arm::app::Model&>("asrModel", asrModel);
-    caseContext.Set<uint32_t>("ctxLen", arm::app::asr::g_ctxLen);  /* Left and right context length (MFCC feat vectors). */
-    caseContext.Set<int>("kwsFrameLength", arm::app::kws::g_FrameLength);
-    caseContext.Set<int>("kwsFrameStride", arm::app::kws::g_FrameStride);
-    caseContext.Set<float>("kwsScoreThreshold", arm::app::kws::g_ScoreThreshold);  /* Normalised score threshold. */
-    caseContext.Set<uint32_t >("kwsNumMfcc", arm::app::kws::g_NumMfcc);
-    caseContext.Set<uint32_t >("kwsNumAudioWins", arm::app::kws::g_NumAudioWins);
-
-    caseContext.Set<int>("asrFrameLength", arm::app::asr::g_FrameLength);
-    caseContext.Set<int>("asrFrameStride", arm::app::asr::g_FrameStride);
-    caseContext.Set<float>("asrScoreThreshold", arm::app::asr::g_ScoreThreshold);  /* Normalised score threshold. */
+    arm::app::KwsAsrContext caseContext;
+
+    static arm::app::Profiler profiler{"kws_asr"};
+    caseContext.Set<arm::app::key::Profiler>(profiler);
+    caseContext.Set<arm::app::key::KwsModel>(kwsModel);
+    caseContext.Set<arm::app::key::AsrModel>(asrModel);
+    caseContext.Set<arm::app::key::AsrContextLength>(arm::app::asr::g_ctxLen);
+    caseContext.Set<arm::app::key::KwsFrameLength>(arm::app::kws::g_FrameLength);
+    caseContext.Set<arm::app::key::KwsFrameStride>(arm::app::kws::g_FrameStride);
+    caseContext.Set<arm::app::key::KwsScoreThreshold>(arm::app::kws::g_ScoreThreshold);
+
+    caseContext.Set<arm::app::key::AsrFrameLength>(arm::app::asr::g_FrameLength);
+    caseContext.Set<arm::app::key::AsrFrameStride>(arm::app::asr::g_FrameStride);
+    caseContext.Set<arm::app::key::AsrScoreThreshold>(arm::app::asr::g_ScoreThreshold);
 
     arm::app::KwsClassifier kwsClassifier;  /* Classifier wrapper object. */
     arm::app::AsrClassifier asrClassifier;  /* Classifier wrapper object. */
-    caseContext.Set<arm::app::KwsClassifier&>("kwsClassifier", kwsClassifier);
-    caseContext.Set<arm::app::AsrClassifier&>("asrClassifier", asrClassifier);
+    caseContext.Set<arm::app::key::KwsClassifier>(kwsClassifier);
+    caseContext.Set<arm::app::key::AsrClassifier>(asrClassifier);
 
     std::vector<std::string> asrLabels;
     arm::app::asr::GetLabelsVector(asrLabels);
     std::vector<std::string> kwsLabels;
     arm::app::kws::GetLabelsVector(kwsLabels);
-    caseContext.Set<const std::vector <std::string>&>("asrLabels", asrLabels);
-    caseContext.Set<const std::vector <std::string>&>("kwsLabels", kwsLabels);
+    caseContext.Set<arm::app::key::AsrLabels>(asrLabels);
+    caseContext.Set<arm::app::key::KwsLabels>(kwsLabels);
 
     /* KWS keyword that triggers ASR and associated checks */
     std::string triggerKeyword = std::string("no");
     if (std::find(kwsLabels.begin(), kwsLabels.end(), triggerKeyword) != kwsLabels.end()) {
-        caseContext.Set<const std::string &>("triggerKeyword", triggerKeyword);
+        caseContext.Set<arm::app::key::TriggerKeyword>(triggerKeyword);
     }
     else {
         printf_err("Selected trigger keyword not found in labels file\n");
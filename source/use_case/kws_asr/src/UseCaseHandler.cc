@@ -68,13 +68,14 @@ namespace app {
      * @return          struct containing pointer to audio data where ASR should begin
      *                  and how much data to process.
      **/
-    static KWSOutput doKws(ApplicationContext& ctx, const int16_t* audioBuffer, uint32_t nElements)
+    static KWSOutput doKws(KwsAsrContext& ctx, const int16_t* audioBuffer, uint32_t nElements)
     {
-        auto& profiler                = ctx.Get<Profiler&>("profiler");
-        auto& kwsModel                = ctx.Get<Model&>("kwsModel");
-        const auto kwsMfccFrameLength = ctx.Get<int>("kwsFrameLength");
-        const auto kwsMfccFrameStride = ctx.Get<int>("kwsFrameStride");
-        const auto kwsScoreThreshold  = ctx.Get<float>("kwsScoreThreshold");
+        auto& profiler                = ctx.Get<key::Profiler>();
+        auto& kwsModel                = ctx.Get<key::KwsModel>();
+        const auto kwsMfccFrameLength = ctx.Get<key::KwsFrameLength>();
+        const auto kwsMfccFrameStride = ctx.Get<key::KwsFrameStride>();
+        const auto kwsScoreThreshold  = ctx.Get<key::KwsScoreThreshold>();
+        const auto& triggerKeyword    = ctx.Get<key::TriggerKeyword>();
 
         constexpr uint32_t dataPsnTxtInfStartX = 20;
         constexpr uint32_t dataPsnTxtInfStartY = 40;
@@ -119,8 +120,8 @@ namespace app {
 
         std::vector<ClassificationResult> singleInfResult;
         KwsPostProcess postProcess = KwsPostProcess(kwsOutputTensor,
-                                                    ctx.Get<KwsClassifier&>("kwsClassifier"),
-                                                    ctx.Get<std::vector<std::string>&>("kwsLabels"),
+                                                    ctx.Get<key::KwsClassifier>(),
+                                                    ctx.Get<key::KwsLabels>(),
                                                     singleInfResult);
 
         /* Creating a sliding window through the whole audio clip. */
@@ -170,7 +171,7 @@ namespace app {
                                kwsScoreThreshold));
 
             /* Break out when trigger keyword is detected. */
-            if (singleInfResult[0].m_label == ctx.Get<const std::string&>("triggerKeyword") &&
+            if (singleInfResult[0].m_label == triggerKeyword &&
                 singleInfResult[0].m_normalisedVal > kwsScoreThreshold) {
                 output.asrAudioStart = inferenceWindow + preProcess.m_audioDataWindowSize;
                 output.asrAudioSamples =
@@ -208,14 +209,14 @@ namespace app {
      *                              and how much data to process.
      * @return          true if pipeline executed without failure.
      **/
-    static bool doAsr(ApplicationContext& ctx, const KWSOutput& kwsOutput)
+    static bool doAsr(KwsAsrContext& ctx, const KWSOutput& kwsOutput)
     {
-        auto& asrModel          = ctx.Get<Model&>("asrModel");
-        auto& profiler          = ctx.Get<Profiler&>("profiler");
-        auto asrMfccFrameLen    = ctx.Get<uint32_t>("asrFrameLength");
-        auto asrMfccFrameStride = ctx.Get<uint32_t>("asrFrameStride");
-        auto asrScoreThreshold  = ctx.Get<float>("asrScoreThreshold");
-        auto asrInputCtxLen     = ctx.Get<uint32_t>("ctxLen");
+        auto& asrModel          = ctx.Get<key::AsrModel>();
+        auto& profiler          = ctx.Get<key::Profiler>();
+        auto asrMfccFrameLen    = ctx.Get<key::AsrFrameLength>();
+        auto asrMfccFrameStride = ctx.Get<key::AsrFrameStride>();
+        auto asrScoreThreshold  = ctx.Get<key::AsrScoreThreshold>();
+        auto asrInputCtxLen     = ctx.Get<key::AsrContextLength>();
 
         constexpr uint32_t dataPsnTxtInfStartX = 20;
         constexpr uint32_t dataPsnTxtInfStartY = 40;
@@ -293,8 +294,8 @@ namespace app {
         const uint32_t outputCtxLen = AsrPostProcess::GetOutputContextLen(asrModel, asrInputCtxLen);
         AsrPostProcess asrPostProcess =
             AsrPostProcess(asrOutputTensor,
-                           ctx.Get<AsrClassifier&>("asrClassifier"),
-                           ctx.Get<std::vector<std::string>&>("asrLabels"),
+                           ctx.Get<key::AsrClassifier>(),
+                           ctx.Get<key::AsrLabels>(),
                            singleInfResult,
                            outputCtxLen,
                            Wav2LetterModel::ms_blankTokenIdx,
@@ -335,10 +336,10 @@ namespace app {
 
             /* Get results. */
             std::vector<ClassificationResult> asrClassificationResult;
-            auto& asrClassifier = ctx.Get<AsrClassifier&>("asrClassifier");
+            auto& asrClassifier = ctx.Get<key::AsrClassifier>();
             asrClassifier.GetClassificationResults(asrOutputTensor,
                                                    asrClassificationResult,
-                                                   ctx.Get<std::vector<std::string>&>("asrLabels"),
+                                                   ctx.Get<key::AsrLabels>(),
                                                    1);
 
             asrResults.emplace_back(
@@ -368,7 +369,7 @@ namespace app {
     }
 
     /* KWS and ASR inference handler. */
-    bool ClassifyAudioHandler(ApplicationContext& ctx)
+    bool ClassifyAudioHandler(KwsAsrContext& ctx)
     {
         hal_lcd_clear(COLOR_BLACK);
         hal_audio_init();
@@ -401,6 +402,7 @@ namespace app {
                     return false;
                 }
             }
+            log_flush();
         } /* while */
         return true;
     }
@@ -24,6 +24,10 @@ USER_OPTION(${use_case}_MODEL_IN_EXT_FLASH "Run model from external flash"
     ON
     BOOL)
 
+USER_OPTION(${use_case}_WEIGHT_STAGING_SZ "Bytes of the activation buffer used to hold copies of the NPU weights (0 reads them in place)"
+    0
+    STRING)
+
 USER_OPTION(${use_case}_AUDIO_RATE "Specify the target sampling rate. Default is 16000."
     16000
     STRING)
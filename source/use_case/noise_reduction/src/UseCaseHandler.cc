@@ -201,6 +201,7 @@ namespace app {
 
             info("All inferences for audio clip complete.\n");
             profiler.PrintProfilingResult();
+            log_flush();
 
             std::string clearString{' '};
             hal_lcd_display_text(clearString.c_str(),
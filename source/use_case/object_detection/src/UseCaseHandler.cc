@@ -176,6 +176,7 @@ namespace app {
             }
 
             profiler.PrintProfilingResult();
+            log_flush();
         }
 
         return true;
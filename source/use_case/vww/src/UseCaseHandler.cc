@@ -147,6 +147,7 @@ namespace app {
                 return false;
             }
             profiler.PrintProfilingResult();
+            log_flush();
 
         }
         return true;
@@ -60,4 +60,45 @@ TEST_CASE("Common: Application context")
         REQUIRE(vect == data);
         delete(vect);
     }
-}
\ No newline at end of file
+}
+
+namespace {
+    struct Count : arm::app::ContextKey<uint32_t> {};
+    struct Labels : arm::app::ContextKey<const std::vector<std::string>&> {};
+    struct Results : arm::app::ContextKey<std::vector<int>> {};
+
+    using TestContext = arm::app::TypedContext<Count, Labels, Results>;
+} /* namespace */
+
+TEST_CASE("Common: Typed application context")
+{
+    TestContext context;
+    REQUIRE_FALSE(context.Has<Count>());
+    REQUIRE_FALSE(context.Has<Labels>());
+
+    SECTION("Values are held by the context")
+    {
+        context.Set<Count>(3);
+        REQUIRE(context.Has<Count>());
+        REQUIRE(3 == context.Get<Count>());
+
+        ++context.Get<Count>();
+        REQUIRE(4 == context.Get<Count>());
+
+        context.Set<Results>({1, 2});
+        context.Get<Results>().push_back(3);
+        REQUIRE(std::vector<int>{1, 2, 3} == context.Get<Results>());
+    }
+
+    SECTION("References refer to the object set")
+    {
+        std::vector<std::string> labels{"a"};
+        context.Set<Labels>(labels);
+        REQUIRE(context.Has<Labels>());
+        REQUIRE(&labels == &context.Get<Labels>());
+
+        labels.emplace_back("b");
+        REQUIRE(2 == context.Get<Labels>().size());
+        REQUIRE_FALSE(context.Has<Count>());
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ArenaPlan.hpp"
+
+#include <catch.hpp>
+
+using arm::app::ArenaPlan;
+
+TEST_CASE("Common: Arena plan")
+{
+    ArenaPlan plan;
+
+    /* A chain of three operators: 0 -> 1 -> 2 -> 3, where the input of an
+     * operator and its output are needed at the same time. */
+    plan.Add({0, "input", 0, 100, 0, 0});
+    plan.Add({1, "a", 100, 50, 0, 1});
+    plan.Add({2, nullptr, 0, 80, 1, 2});
+    plan.Add({3, "output", 160, 40, 2, 2});
+
+    SECTION("Extent, peak and fragmentation") {
+        REQUIRE(plan.GetTensors().size() == 4);
+        REQUIRE(plan.GetTensors()[2].name[0] == '\0');
+        REQUIRE(plan.GetExtent() == 200);
+
+        int op = -1;
+        REQUIRE(plan.GetPeakLiveBytes(&op) == 150);
+        REQUIRE(op == 0);
+        REQUIRE(plan.GetFragmentation() == 50);
+
+        size_t first = 0;
+        size_t second = 0;
+        REQUIRE_FALSE(plan.FindOverlap(first, second));
+    }
+
+    SECTION("Tensors sharing memory while both are needed are found") {
+        plan.Add({4, "clash", 120, 10, 1, 1});
+        size_t first = 0;
+        size_t second = 0;
+        REQUIRE(plan.FindOverlap(first, second));
+        REQUIRE(plan.GetTensors()[first].index == 1);
+        REQUIRE(plan.GetTensors()[second].index == 4);
+    }
+
+    SECTION("Clearing") {
+        plan.Clear();
+        REQUIRE(plan.GetTensors().empty());
+        REQUIRE(plan.GetExtent() == 0);
+        REQUIRE(plan.GetPeakLiveBytes() == 0);
+    }
+}
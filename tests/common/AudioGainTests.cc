@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "audio_gain.h"
+
+#include <catch.hpp>
+
+TEST_CASE("Automatic audio gain")
+{
+    SECTION("Reduces at once to avoid clipping")
+    {
+        CHECK(audio_gain_auto(100.0f, 0.5f) == Approx(2.0f));
+        CHECK(audio_gain_auto(AUDIO_GAIN_MAX, 1.0f) == Approx(1.0f));
+    }
+
+    SECTION("Increases by at most one step per buffer")
+    {
+        float gain = 2.0f;
+        gain = audio_gain_auto(gain, 0.01f);
+        CHECK(gain == Approx(2.0f * AUDIO_GAIN_MAX_INC_PER_STRIDE));
+        for (int i = 0; i < 100; ++i) {
+            gain = audio_gain_auto(gain, 0.01f);
+        }
+        CHECK(gain == Approx(100.0f));
+    }
+
+    SECTION("Silence rises to the maximum gain")
+    {
+        float gain = 1.0f;
+        for (int i = 0; i < 200; ++i) {
+            const float next = audio_gain_auto(gain, 0.0f);
+            REQUIRE(next >= gain);
+            REQUIRE(next <= AUDIO_GAIN_MAX);
+            gain = next;
+        }
+        CHECK(gain == Approx(AUDIO_GAIN_MAX));
+    }
+}
+
+TEST_CASE("Audio buffer mean")
+{
+    CHECK(audio_gain_mean(-300, 3) == -100);
+    CHECK(audio_gain_mean(int64_t{1} << 40, 1 << 20) == (1 << 20));
+    CHECK(audio_gain_mean(123, 0) == 0);
+    CHECK(audio_gain_mean(0, 0) == 0);
+}
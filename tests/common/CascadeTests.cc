@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Cascade.hpp"
+
+#include <catch.hpp>
+#include <vector>
+
+namespace {
+
+    /* Time moves only when a stage says so. */
+    uint64_t g_now = 0;
+
+    /* Stage taking a fixed time per run, with scripted scores. */
+    struct MockStage : public arm::app::CascadeStage {
+        std::vector<float> scores;
+        uint64_t runTime{0};
+        uint64_t initTime{0};
+        int inits{0};
+        int runs{0};
+        int releases{0};
+        bool failInit{false};
+
+        bool Init() override
+        {
+            g_now += this->initTime;
+            ++this->inits;
+            return !this->failInit;
+        }
+
+        bool Run(float& score) override
+        {
+            g_now += this->runTime;
+            score = this->runs < static_cast<int>(this->scores.size()) ? this->scores[this->runs] : 0;
+            ++this->runs;
+            return true;
+        }
+
+        void Release() override
+        {
+            ++this->releases;
+        }
+    };
+
+    arm::app::Cascade::Clock FakeClock()
+    {
+        g_now = 1000;
+        return []() { return g_now; };
+    }
+
+    /* Runs the cascade and records which periods ran the second stage. */
+    std::vector<bool> RunPeriods(arm::app::Cascade& cascade, size_t periods)
+    {
+        std::vector<bool> ran;
+        for (size_t i = 0; i < periods; ++i) {
+            REQUIRE(cascade.Step());
+            ran.push_back(cascade.SecondStageRan());
+        }
+        return ran;
+    }
+
+} /* namespace */
+
+TEST_CASE("Common: Cascade gating")
+{
+    MockStage first;
+    MockStage second;
+    arm::app::CascadeConfig config;
+    config.threshold = 0.5f;
+
+    SECTION("Second stage runs only when the gate fires") {
+        first.scores = {0.1f, 0.6f, 0.4f, 0.5f, 0.0f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        CHECK(RunPeriods(cascade, 5) == std::vector<bool>{false, true, false, true, false});
+        CHECK(cascade.LastScore() == 0.0f);
+        CHECK(cascade.GetFireCount() == 2);
+        CHECK(cascade.GetPeriodCount() == 5);
+        CHECK(first.runs == 5);
+        CHECK(second.runs == 2);
+    }
+
+    SECTION("Second stage initialised when first needed") {
+        first.scores = {0.f, 0.f, 1.f, 1.f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        RunPeriods(cascade, 2);
+        CHECK(second.inits == 0);
+        RunPeriods(cascade, 2);
+        CHECK(second.inits == 1);
+        CHECK(second.runs == 2);
+    }
+
+    SECTION("Consecutive scores needed to fire") {
+        config.triggerCount = 2;
+        first.scores = {1.f, 0.f, 1.f, 1.f, 1.f, 0.f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        CHECK(RunPeriods(cascade, 6) == std::vector<bool>{false, false, false, true, true, false});
+        CHECK(cascade.GetFireCount() == 1);
+    }
+
+    SECTION("A run of scores fires once") {
+        config.holdCount = 1;
+        first.scores = {1.f, 1.f, 1.f, 0.f, 0.f, 1.f, 0.f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        CHECK(RunPeriods(cascade, 7) == std::vector<bool>{true, true, true, true, false, true, true});
+        CHECK(cascade.GetFireCount() == 2);
+        CHECK(second.runs == 6);
+    }
+
+    SECTION("Gate held open") {
+        config.holdCount = 2;
+        first.scores = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 1.f, 0.f, 0.f, 0.f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        CHECK(RunPeriods(cascade, 10) ==
+              std::vector<bool>{true, true, true, false, true, true, true, true, true, false});
+        CHECK(cascade.GetFireCount() == 3);
+    }
+
+    SECTION("Released when idle") {
+        config.releaseCount = 2;
+        first.scores = {1.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        RunPeriods(cascade, 7);
+        CHECK(second.inits == 2);
+        CHECK(second.releases == 1);
+        CHECK(cascade.GetSecondStats().inits == 2);
+    }
+
+    SECTION("Stage failures") {
+        second.failInit = true;
+        first.scores = {1.f, 1.f};
+        arm::app::Cascade cascade{first, second, config, FakeClock()};
+        CHECK_FALSE(cascade.Step());
+        CHECK_FALSE(cascade.SecondStageRan());
+        CHECK(second.runs == 0);
+
+        /* Tried again next time. */
+        second.failInit = false;
+        CHECK(cascade.Step());
+        CHECK(second.inits == 2);
+        CHECK(second.runs == 1);
+    }
+}
+
+TEST_CASE("Common: Cascade accounting")
+{
+    MockStage first;
+    MockStage second;
+    first.runTime = 2;
+    second.runTime = 30;
+    second.initTime = 50;
+
+    /* The gate fires once in ten periods of 100 ticks. */
+    first.scores = std::vector<float>(20, 0.f);
+    first.scores[3] = 1.f;
+    first.scores[13] = 1.f;
+
+    arm::app::CascadeConfig config;
+    arm::app::Cascade cascade{first, second, config, FakeClock()};
+    for (int i = 0; i < 20; ++i) {
+        const uint64_t start = g_now;
+        REQUIRE(cascade.Step());
+        g_now = start + 100;
+    }
+
+    const auto& firstStats = cascade.GetFirstStats();
+    const auto& secondStats = cascade.GetSecondStats();
+    CHECK(firstStats.runs == 20);
+    CHECK(firstStats.runTime == 40);
+    CHECK(firstStats.maxLatency == 2);
+    CHECK(secondStats.runs == 2);
+    CHECK(secondStats.inits == 1);
+    CHECK(secondStats.initTime == 50);
+    CHECK(secondStats.AverageLatency() == 30);
+    CHECK(secondStats.ActiveTime() == 110);
+
+    /* The last period ends after the first stage. */
+    REQUIRE(cascade.GetElapsedTime() == 19 * 100 + 2);
+    CHECK(cascade.DutyCycle(firstStats) == Approx(40.0 / 1902));
+    CHECK(cascade.DutyCycle(secondStats) == Approx(110.0 / 1902));
+
+    arm::app::CascadePower power;
+    power.idle = 1.f;
+    power.first = 10.f;
+    power.second = 100.f;
+    const double idle = 1.0 - 150.0 / 1902;
+    CHECK(cascade.EstimateAveragePower(power) == Approx((40.0 * 10 + 110.0 * 100) / 1902 + idle));
+
+    /* 30 ticks of the second stage every period. */
+    const double ungated = 20.0 * 30 / 1902;
+    CHECK(cascade.EstimateUngatedPower(power) == Approx(ungated * 100 + (1 - ungated)));
+    CHECK(cascade.EstimateAveragePower(power) < cascade.EstimateUngatedPower(power));
+
+    cascade.ResetStats();
+    CHECK(cascade.GetPeriodCount() == 0);
+    CHECK(cascade.GetElapsedTime() == 0);
+    CHECK(cascade.DutyCycle(cascade.GetFirstStats()) == 0.f);
+    CHECK(cascade.EstimateUngatedPower(power) == 0.f);
+
+    /* The second stage stays initialised. */
+    first.scores.push_back(1.f);
+    REQUIRE(cascade.Step());
+    CHECK(cascade.GetSecondStats().inits == 0);
+    CHECK(cascade.GetSecondStats().runs == 1);
+    CHECK(cascade.GetElapsedTime() == 32);
+}
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ccm.h"
+#include "demosaic.h"
+
+#include <catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+    const float identity[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    const float camera[3][3] = {
+        {+2.2583f, -0.1606f, -0.6317f},
+        {-0.5501f, +1.4318f, -0.0653f},
+        {-0.1248f, -0.5268f, +2.3735f},
+    };
+
+    std::vector<uint8_t> RandomBytes(size_t size, unsigned seed)
+    {
+        std::vector<uint8_t> bytes(size);
+        srand(seed);
+        for (auto& byte : bytes) {
+            byte = static_cast<uint8_t>(rand());
+        }
+        return bytes;
+    }
+} /* namespace */
+
+TEST_CASE("Common: Colour correction identity")
+{
+    ccm_params params;
+    ccm_init(&params, identity, nullptr, nullptr);
+
+    auto src = RandomBytes(37 * 3, 1);
+    std::vector<uint8_t> dst(src.size());
+    ccm_apply_rgb888(&params, src.data(), dst.data(), 37);
+    CHECK(dst == src);
+
+    /* RGB565 is expanded to the full 8-bit range. */
+    const uint16_t rgb565[] = {0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0x8410};
+    const uint8_t expected[] = {
+        0, 0, 0,  255, 255, 255,  255, 0, 0,  0, 255, 0,  0, 0, 255,  132, 130, 132};
+    uint8_t out[sizeof(expected)];
+    ccm_apply_rgb565(&params, rgb565, out, 6);
+    for (size_t i = 0; i < sizeof(expected); ++i) {
+        CHECK(out[i] == expected[i]);
+    }
+}
+
+TEST_CASE("Common: Colour correction matches float")
+{
+    const float gains[3] = {1.1f, 1.0f, 0.8f};
+    uint8_t lut[256];
+    for (int i = 0; i < 256; ++i) {
+        lut[i] = static_cast<uint8_t>(255 - i);
+    }
+    ccm_params params;
+    ccm_init(&params, camera, gains, lut);
+
+    const int pixels = 1000;
+    auto src = RandomBytes(pixels * 3, 2);
+    std::vector<uint8_t> dst(src.size());
+    ccm_apply_rgb888(&params, src.data(), dst.data(), pixels);
+
+    for (int i = 0; i < pixels; ++i) {
+        for (int out = 0; out < 3; ++out) {
+            float value = 0;
+            for (int in = 0; in < 3; ++in) {
+                value += camera[out][in] * gains[in] * src[i * 3 + in];
+            }
+            const float clamped = std::fmin(std::fmax(value, 0.0f), 255.0f);
+            /* The table reverses the order, so compare before it. */
+            const int corrected = 255 - dst[i * 3 + out];
+            REQUIRE(std::fabs(corrected - clamped) <= 1.0f);
+        }
+    }
+}
+
+TEST_CASE("Common: Colour correction matches reference")
+{
+    ccm_params params;
+    const float gains[3] = {1.3f, 0.9f, 1.6f};
+    ccm_init(&params, camera, gains, nullptr);
+
+    for (int pixels : {0, 1, 7, 8, 9, 33}) {
+        auto src = RandomBytes(pixels * 3, pixels);
+        std::vector<uint8_t> expected(src.size());
+        std::vector<uint8_t> dst(src.size());
+        ccm_apply_rgb888_reference(&params, src.data(), expected.data(), pixels);
+        ccm_apply_rgb888(&params, src.data(), dst.data(), pixels);
+        CHECK(dst == expected);
+
+        /* In place. */
+        ccm_apply_rgb888(&params, src.data(), src.data(), pixels);
+        CHECK(src == expected);
+
+        auto bytes = RandomBytes(pixels * 2, pixels + 100);
+        std::vector<uint16_t> rgb565(pixels);
+        for (int i = 0; i < pixels; ++i) {
+            rgb565[i] = static_cast<uint16_t>(bytes[i * 2] | (bytes[i * 2 + 1] << 8));
+        }
+        ccm_apply_rgb565_reference(&params, rgb565.data(), expected.data(), pixels);
+        ccm_apply_rgb565(&params, rgb565.data(), dst.data(), pixels);
+        CHECK(dst == expected);
+    }
+}
+
+TEST_CASE("Common: Colour correction during crop and resize")
+{
+    const int width = 40;
+    const int height = 30;
+    const int dst_size = 16;
+    auto bayer = RandomBytes(width * height, 3);
+    const demosaic_frame frame = {bayer.data(), width, height, DEMOSAIC_TILE_GRBG};
+
+    ccm_params params;
+    ccm_init(&params, camera, nullptr, nullptr);
+
+    std::vector<uint8_t> scratch((height + 1) * 6);
+    std::vector<uint8_t> expected(dst_size * dst_size * 3);
+    std::vector<uint8_t> fused(expected.size());
+    REQUIRE(demosaic_crop_resize(&frame, DEMOSAIC_BILINEAR, 5, 0, height, height,
+                                 expected.data(), dst_size, dst_size, nullptr, scratch.data()) == 0);
+    ccm_apply_rgb888(&params, expected.data(), expected.data(), dst_size * dst_size);
+    REQUIRE(demosaic_crop_resize(&frame, DEMOSAIC_BILINEAR, 5, 0, height, height,
+                                 fused.data(), dst_size, dst_size, &params, scratch.data()) == 0);
+    CHECK(fused == expected);
+}
@@ -0,0 +1,300 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core_pipe.h"
+
+#include <algorithm>
+#include <catch.hpp>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    constexpr uint32_t N_SLOTS = 4;
+    constexpr uint32_t SLOT_SIZE = 40;
+    constexpr size_t MEM_SIZE = CORE_PIPE_MEM_SIZE(N_SLOTS, SLOT_SIZE);
+
+    /**
+     * Two cores with write-back caches: each core works on its own copy of
+     * the shared memory, which only reaches the other core through clean
+     * and invalidate, a whole line at a time.
+     */
+    struct CachedCores {
+        alignas(CORE_PIPE_LINE_SIZE) uint8_t memory[MEM_SIZE]{};
+        alignas(CORE_PIPE_LINE_SIZE) uint8_t senderCache[MEM_SIZE]{};
+        alignas(CORE_PIPE_LINE_SIZE) uint8_t receiverCache[MEM_SIZE]{};
+    };
+
+    CachedCores* g_cores = nullptr;
+
+    void CopyLines(const uint8_t* from, uint8_t* to, const uint8_t* cache, const void* p, size_t bytes)
+    {
+        const auto offset = static_cast<size_t>(static_cast<const uint8_t*>(p) - cache);
+        REQUIRE(offset + bytes <= MEM_SIZE);
+        const size_t start = offset & ~static_cast<size_t>(CORE_PIPE_LINE_SIZE - 1);
+        const size_t end = (offset + bytes + CORE_PIPE_LINE_SIZE - 1) & ~static_cast<size_t>(CORE_PIPE_LINE_SIZE - 1);
+        std::memcpy(to + start, from + start, end - start);
+    }
+
+    const core_pipe_ops g_senderOps = {
+        [](const void* p, size_t bytes) {
+            CopyLines(g_cores->senderCache, g_cores->memory, g_cores->senderCache, p, bytes);
+        },
+        [](const void* p, size_t bytes) {
+            CopyLines(g_cores->memory, g_cores->senderCache, g_cores->senderCache, p, bytes);
+        },
+        nullptr,
+        nullptr,
+    };
+
+    const core_pipe_ops g_receiverOps = {
+        [](const void* p, size_t bytes) {
+            CopyLines(g_cores->receiverCache, g_cores->memory, g_cores->receiverCache, p, bytes);
+        },
+        [](const void* p, size_t bytes) {
+            CopyLines(g_cores->memory, g_cores->receiverCache, g_cores->receiverCache, p, bytes);
+        },
+        nullptr,
+        nullptr,
+    };
+
+    bool Send(core_pipe& pipe, uint32_t value, uint32_t size = SLOT_SIZE)
+    {
+        std::vector<uint8_t> payload(size, static_cast<uint8_t>(value));
+        return core_pipe_send(&pipe, 7, payload.data(), size, value);
+    }
+
+    void CheckReceive(core_pipe& pipe, uint32_t value, uint32_t seq, uint32_t size = SLOT_SIZE)
+    {
+        core_pipe_msg msg{};
+        REQUIRE(core_pipe_receive(&pipe, &msg));
+        CHECK(msg.type == 7);
+        CHECK(msg.arg == value);
+        CHECK(msg.seq == seq);
+        REQUIRE(msg.size == size);
+        const auto* data = static_cast<const uint8_t*>(msg.data);
+        CHECK(std::all_of(data, data + size, [value](uint8_t b) { return b == static_cast<uint8_t>(value); }));
+        core_pipe_release(&pipe);
+    }
+
+} /* namespace */
+
+TEST_CASE("Common: Core pipe")
+{
+    alignas(CORE_PIPE_LINE_SIZE) static uint8_t mem[MEM_SIZE];
+    std::memset(mem, 0xAA, sizeof(mem));
+    core_pipe sender{};
+    core_pipe receiver{};
+
+    SECTION("Memory checks") {
+        CHECK(core_pipe_create(&sender, mem + 4, MEM_SIZE - 4, N_SLOTS, SLOT_SIZE, nullptr) == -1);
+        CHECK(core_pipe_create(&sender, mem, MEM_SIZE - 1, N_SLOTS, SLOT_SIZE, nullptr) == -1);
+        CHECK(core_pipe_create(&sender, mem, MEM_SIZE, 0, SLOT_SIZE, nullptr) == -1);
+        CHECK(core_pipe_create(&sender, mem, MEM_SIZE, N_SLOTS - 1, SLOT_SIZE, nullptr) == -1);
+        CHECK_FALSE(core_pipe_is_pipe(mem, nullptr));
+        CHECK(core_pipe_attach(&receiver, mem, nullptr) == -1);
+
+        REQUIRE(core_pipe_create(&sender, mem, MEM_SIZE, N_SLOTS, SLOT_SIZE, nullptr) == 0);
+        CHECK(core_pipe_is_pipe(mem, nullptr));
+        REQUIRE(core_pipe_attach(&receiver, mem, nullptr) == 0);
+        CHECK(receiver.n_slots == N_SLOTS);
+        CHECK(receiver.slot_size == SLOT_SIZE);
+    }
+
+    REQUIRE(core_pipe_create(&sender, mem, MEM_SIZE, N_SLOTS, SLOT_SIZE, nullptr) == 0);
+    REQUIRE(core_pipe_attach(&receiver, mem, nullptr) == 0);
+
+    SECTION("Messages in order until full") {
+        core_pipe_msg msg{};
+        CHECK_FALSE(core_pipe_receive(&receiver, &msg));
+
+        for (uint32_t i = 0; i < N_SLOTS; ++i) {
+            REQUIRE(Send(sender, i));
+        }
+        CHECK(core_pipe_pending(&sender) == N_SLOTS);
+        CHECK_FALSE(Send(sender, 99));
+        CHECK(core_pipe_acquire(&sender) == nullptr);
+
+        /* A message can be read again until it is released. */
+        REQUIRE(core_pipe_receive(&receiver, &msg));
+        CHECK(msg.arg == 0);
+        CheckReceive(receiver, 0, 0);
+
+        REQUIRE(Send(sender, 4, 1));
+        for (uint32_t i = 1; i < N_SLOTS; ++i) {
+            CheckReceive(receiver, i, i);
+        }
+        CheckReceive(receiver, 4, 4, 1);
+        CHECK_FALSE(core_pipe_receive(&receiver, &msg));
+        CHECK(core_pipe_pending(&receiver) == 0);
+
+        /* Releasing an empty pipe does nothing. */
+        core_pipe_release(&receiver);
+        CHECK(core_pipe_pending(&receiver) == 0);
+    }
+
+    SECTION("Indexes wrap around") {
+        /* Head and tail indexes, on the lines after the header. */
+        const uint32_t start = UINT32_MAX - 1;
+        std::memcpy(mem + CORE_PIPE_LINE_SIZE, &start, sizeof(start));
+        std::memcpy(mem + 2 * CORE_PIPE_LINE_SIZE, &start, sizeof(start));
+
+        /* Slots before and after the wrap do not overlap. */
+        for (uint32_t i = 0; i < N_SLOTS; ++i) {
+            REQUIRE(Send(sender, i));
+        }
+        CHECK(core_pipe_pending(&sender) == N_SLOTS);
+        CHECK_FALSE(Send(sender, 99));
+        for (uint32_t i = 0; i < N_SLOTS; ++i) {
+            CheckReceive(receiver, i, start + i);
+        }
+        CHECK(core_pipe_pending(&receiver) == 0);
+    }
+
+    SECTION("Payloads larger than a slot") {
+        CHECK_FALSE(Send(sender, 1, SLOT_SIZE + 1));
+        CHECK_FALSE(core_pipe_publish(&sender, 1, SLOT_SIZE + 1, 0));
+        CHECK(core_pipe_pending(&sender) == 0);
+    }
+
+    SECTION("Filled in place") {
+        auto* payload = static_cast<uint8_t*>(core_pipe_acquire(&sender));
+        REQUIRE(payload != nullptr);
+        std::memset(payload, 3, 10);
+        REQUIRE(core_pipe_publish(&sender, 7, 10, 3));
+        CheckReceive(receiver, 3, 0, 10);
+    }
+
+    SECTION("Payload by reference") {
+        alignas(CORE_PIPE_LINE_SIZE) static const uint8_t buffer[1000] = {5};
+        REQUIRE(core_pipe_send_ref(&sender, 2, buffer, sizeof(buffer), 0));
+        core_pipe_msg msg{};
+        REQUIRE(core_pipe_receive(&receiver, &msg));
+        CHECK(msg.data == buffer);
+        CHECK(msg.size == sizeof(buffer));
+        CHECK_FALSE(core_pipe_send_ref(&sender, 2, nullptr, 0, 0));
+    }
+
+    SECTION("Doorbell") {
+        int rings = 0;
+        core_pipe_ops ops{};
+        ops.notify = [](void* shared, void* ctx) {
+            CHECK(core_pipe_is_pipe(shared, nullptr));
+            ++*static_cast<int*>(ctx);
+        };
+        ops.notify_ctx = &rings;
+        sender.ops = &ops;
+        REQUIRE(Send(sender, 1));
+        CHECK(rings == 1);
+        for (uint32_t i = 1; i < N_SLOTS; ++i) {
+            REQUIRE(Send(sender, i));
+        }
+        CHECK_FALSE(Send(sender, 9));
+        CHECK(rings == N_SLOTS);
+    }
+}
+
+TEST_CASE("Common: Core pipe with non-coherent caches")
+{
+    CachedCores cores;
+    g_cores = &cores;
+
+    core_pipe sender{};
+    core_pipe receiver{};
+    REQUIRE(core_pipe_create(&sender, cores.senderCache, MEM_SIZE, N_SLOTS, SLOT_SIZE, &g_senderOps) == 0);
+    REQUIRE(core_pipe_attach(&receiver, cores.receiverCache, &g_receiverOps) == 0);
+
+    /* Several trips round the ring, with the pipe full and empty. */
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    for (int round = 0; round < 5; ++round) {
+        while (Send(sender, sent)) {
+            ++sent;
+        }
+        CHECK(sent - received == N_SLOTS);
+        const uint32_t take = (round % 2) ? N_SLOTS : N_SLOTS - 1;
+        for (uint32_t i = 0; i < take; ++i, ++received) {
+            CheckReceive(receiver, received, received);
+        }
+    }
+    CHECK(core_pipe_pending(&receiver) == sent - received);
+    g_cores = nullptr;
+}
+
+TEST_CASE("Common: Core pipe between threads")
+{
+    constexpr uint32_t numMessages = 2000;
+    alignas(CORE_PIPE_LINE_SIZE) static uint8_t mem[MEM_SIZE];
+
+    struct Doorbell {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t rings{0};
+    } doorbell;
+
+    core_pipe_ops ops{};
+    ops.notify = [](void*, void* ctx) {
+        auto* bell = static_cast<Doorbell*>(ctx);
+        std::lock_guard<std::mutex> lock(bell->mutex);
+        ++bell->rings;
+        bell->cv.notify_one();
+    };
+    ops.notify_ctx = &doorbell;
+
+    core_pipe sender{};
+    core_pipe receiver{};
+    REQUIRE(core_pipe_create(&sender, mem, sizeof(mem), N_SLOTS, SLOT_SIZE, &ops) == 0);
+    REQUIRE(core_pipe_attach(&receiver, mem, nullptr) == 0);
+
+    std::thread producer([&sender]() {
+        for (uint32_t i = 0; i < numMessages; ++i) {
+            const uint32_t size = 1 + i % SLOT_SIZE;
+            std::vector<uint8_t> payload(size, static_cast<uint8_t>(i));
+            while (!core_pipe_send(&sender, 7, payload.data(), size, i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    /* Checked on this thread: Catch2 assertions are not thread safe. */
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    while (received < numMessages) {
+        {
+            std::unique_lock<std::mutex> lock(doorbell.mutex);
+            doorbell.cv.wait(lock, [&]() { return doorbell.rings > 0; });
+            doorbell.rings = 0;
+        }
+        core_pipe_msg msg{};
+        while (core_pipe_receive(&receiver, &msg)) {
+            const auto* data = static_cast<const uint8_t*>(msg.data);
+            if (msg.seq != received || msg.arg != received || msg.size != 1 + received % SLOT_SIZE ||
+                data[0] != static_cast<uint8_t>(received) || data[msg.size - 1] != static_cast<uint8_t>(received)) {
+                ++errors;
+            }
+            core_pipe_release(&receiver);
+            ++received;
+        }
+    }
+    producer.join();
+
+    CHECK(errors == 0);
+    CHECK(received == numMessages);
+    CHECK(core_pipe_pending(&receiver) == 0);
+}
@@ -0,0 +1,339 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "demosaic.h"
+
+#include <algorithm>
+#include <catch.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace {
+    const demosaic_tile tiles[] = {
+        DEMOSAIC_TILE_RGGB, DEMOSAIC_TILE_GBRG, DEMOSAIC_TILE_GRBG, DEMOSAIC_TILE_BGGR};
+    const demosaic_method methods[] = {
+        DEMOSAIC_SIMPLE, DEMOSAIC_BILINEAR, DEMOSAIC_EDGE_AWARE};
+
+    /* Colour channel (0 = R, 1 = G, 2 = B) sampled at (x, y). */
+    int SampleChannel(demosaic_tile tile, int x, int y)
+    {
+        static const int layout[4][4] = {
+            {0, 1, 1, 2}, /* RGGB */
+            {1, 2, 0, 1}, /* GBRG */
+            {1, 0, 2, 1}, /* GRBG */
+            {2, 1, 1, 0}, /* BGGR */
+        };
+        return layout[tile][(y & 1) * 2 + (x & 1)];
+    }
+
+    /* Samples an RGB scene through the colour filter array. */
+    std::vector<uint8_t> Mosaic(int width, int height, demosaic_tile tile,
+                                const std::function<int(int, int, int)>& scene)
+    {
+        std::vector<uint8_t> bayer(width * height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                bayer[y * width + x] = scene(x, y, SampleChannel(tile, x, y));
+            }
+        }
+        return bayer;
+    }
+
+    /* Sum of absolute errors against the scene, away from the borders. */
+    long InteriorError(const std::vector<uint8_t>& rgb, int width, int height,
+                       const std::function<int(int, int, int)>& scene)
+    {
+        long error = 0;
+        for (int y = 2; y < height - 2; ++y) {
+            for (int x = 2; x < width - 2; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    error += std::abs(rgb[(y * width + x) * 3 + c] - scene(x, y, c));
+                }
+            }
+        }
+        return error;
+    }
+} /* namespace */
+
+TEST_CASE("Common: Demosaic flat colour")
+{
+    const int width = 24;
+    const int height = 10;
+    auto scene = [](int, int, int c) { return 40 + 70 * c; };
+
+    for (auto tile : tiles) {
+        auto bayer = Mosaic(width, height, tile, scene);
+        const demosaic_frame frame = {bayer.data(), width, height, tile};
+        for (auto method : methods) {
+            std::vector<uint8_t> rgb(width * height * 3);
+            REQUIRE(demosaic_image(&frame, method, rgb.data()) == 0);
+
+            /* Simple leaves the last row and column black. */
+            const int valid_width = method == DEMOSAIC_SIMPLE ? width - 1 : width;
+            const int valid_height = method == DEMOSAIC_SIMPLE ? height - 1 : height;
+            for (int y = 0; y < valid_height; ++y) {
+                for (int x = 0; x < valid_width; ++x) {
+                    for (int c = 0; c < 3; ++c) {
+                        REQUIRE(rgb[(y * width + x) * 3 + c] == scene(x, y, c));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Common: Demosaic quality")
+{
+    const int width = 32;
+    const int height = 32;
+
+    SECTION("Bilinear is exact on a linear gradient")
+    {
+        auto scene = [](int x, int y, int c) { return 20 + 4 * x + 2 * y + c; };
+        for (auto tile : tiles) {
+            auto bayer = Mosaic(width, height, tile, scene);
+            const demosaic_frame frame = {bayer.data(), width, height, tile};
+            std::vector<uint8_t> rgb(width * height * 3);
+            REQUIRE(demosaic_image(&frame, DEMOSAIC_BILINEAR, rgb.data()) == 0);
+            CHECK(InteriorError(rgb, width, height, scene) == 0);
+        }
+    }
+
+    SECTION("Edge aware beats bilinear on an edge")
+    {
+        auto scene = [](int x, int y, int c) {
+            return (x + y / 3 < 16) ? 30 + 10 * c : 200 + 20 * c;
+        };
+        for (auto tile : tiles) {
+            auto bayer = Mosaic(width, height, tile, scene);
+            const demosaic_frame frame = {bayer.data(), width, height, tile};
+            std::vector<uint8_t> bilinear(width * height * 3);
+            std::vector<uint8_t> edge_aware(width * height * 3);
+            REQUIRE(demosaic_image(&frame, DEMOSAIC_BILINEAR, bilinear.data()) == 0);
+            REQUIRE(demosaic_image(&frame, DEMOSAIC_EDGE_AWARE, edge_aware.data()) == 0);
+            CHECK(InteriorError(edge_aware, width, height, scene) <
+                  InteriorError(bilinear, width, height, scene));
+        }
+    }
+}
+
+TEST_CASE("Common: Demosaic row matches reference")
+{
+    const int width = 53;
+    const int height = 7;
+    std::vector<uint8_t> bayer(width * height);
+    srand(7);
+    for (auto& sample : bayer) {
+        sample = static_cast<uint8_t>(rand());
+    }
+
+    for (auto tile : tiles) {
+        const demosaic_frame frame = {bayer.data(), width, height, tile};
+        for (auto method : methods) {
+            for (int y = 0; y < height; ++y) {
+                for (int x_start : {0, 1, 2, 5}) {
+                    std::vector<uint8_t> row(width * 3);
+                    std::vector<uint8_t> expected(width * 3);
+                    REQUIRE(demosaic_row(&frame, method, y, x_start, width, row.data()) == 0);
+                    REQUIRE(demosaic_row_reference(&frame, method, y, x_start, width,
+                                                   expected.data()) == 0);
+                    REQUIRE(row == expected);
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> row(width * 3);
+    const demosaic_frame frame = {bayer.data(), width, height, DEMOSAIC_TILE_RGGB};
+    CHECK(demosaic_row(&frame, DEMOSAIC_BILINEAR, height, 0, width, row.data()) == -1);
+    CHECK(demosaic_row(&frame, DEMOSAIC_BILINEAR, 0, 4, 2, row.data()) == -1);
+    CHECK(demosaic_row(nullptr, DEMOSAIC_BILINEAR, 0, 0, width, row.data()) == -1);
+}
+
+TEST_CASE("Common: Demosaic crop and resize")
+{
+    const int width = 64;
+    const int height = 48;
+    const int crop_x = 8;
+    const int crop_y = 0;
+    const int crop_width = 48;
+    const int crop_height = 48;
+    const int dst_size = 20;
+    std::vector<uint8_t> bayer(width * height);
+    srand(11);
+    for (auto& sample : bayer) {
+        sample = static_cast<uint8_t>(rand());
+    }
+
+    for (auto method : methods) {
+        const demosaic_frame frame = {bayer.data(), width, height, DEMOSAIC_TILE_GRBG};
+        std::vector<uint8_t> full(width * height * 3);
+        REQUIRE(demosaic_image(&frame, method, full.data()) == 0);
+
+        std::vector<uint8_t> scratch((crop_width + 1) * 6);
+        std::vector<uint8_t> rgb(dst_size * dst_size * 3);
+        REQUIRE(demosaic_crop_resize(&frame, method, crop_x, crop_y, crop_width, crop_height,
+                                     rgb.data(), dst_size, dst_size, nullptr,
+                                     scratch.data()) == 0);
+
+        /* Rounded bilinear resize in 14-bit fixed point, starting half a pixel in. */
+        const uint32_t one = 1 << 14;
+        const uint32_t step = (crop_width * one) / dst_size;
+        uint32_t sy = one / 2;
+        for (int y = 0; y < dst_size; ++y, sy += step) {
+            const int ty = crop_y + static_cast<int>(sy >> 14);
+            const int ty1 = std::min(ty + 1, height - 1);
+            const uint32_t fy = sy & (one - 1);
+            uint32_t sx = one / 2;
+            for (int x = 0; x < dst_size; ++x, sx += step) {
+                const int tx = crop_x + static_cast<int>(sx >> 14);
+                const int tx1 = std::min(tx + 1, width - 1);
+                const uint32_t fx = sx & (one - 1);
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t p00 = full[(ty * width + tx) * 3 + c];
+                    const uint32_t p10 = full[(ty * width + tx1) * 3 + c];
+                    const uint32_t p01 = full[(ty1 * width + tx) * 3 + c];
+                    const uint32_t p11 = full[(ty1 * width + tx1) * 3 + c];
+                    const uint32_t top = (p00 * (one - fx) + p10 * fx + one / 2) >> 14;
+                    const uint32_t bottom = (p01 * (one - fx) + p11 * fx + one / 2) >> 14;
+                    const uint32_t expected = (top * (one - fy) + bottom * fy + one / 2) >> 14;
+                    REQUIRE(rgb[(y * dst_size + x) * 3 + c] == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Common: Demosaic crop and resize matches the full frame pipeline")
+{
+    /* The camera pipeline without CIMAGE_ROI_DEMOSAIC: demosaic the frame,
+     * crop the centre to the output aspect ratio (calculate_crop_dims and
+     * frame_crop), then scale the cropped copy as resize_image_A does.
+     * Sizes are downscales, as on the device, so that the filter never
+     * reads past the right or bottom edge of the crop. */
+    struct Size {
+        int src_width, src_height, dst_width, dst_height;
+    };
+    const Size sizes[] = {
+        {64, 48, 20, 20},
+        {60, 60, 24, 24},
+        {80, 48, 24, 24},
+        {112, 112, 64, 64},
+        {96, 64, 48, 32},
+        {70, 90, 28, 30},
+    };
+    srand(5);
+
+    for (const auto& size : sizes) {
+        const int width = size.src_width;
+        const int height = size.src_height;
+        std::vector<uint8_t> bayer(width * height);
+        for (auto& sample : bayer) {
+            sample = static_cast<uint8_t>(rand());
+        }
+
+        int crop_width = width;
+        int crop_height = height;
+        if (width > height) {
+            crop_width = (size.dst_width * height) / size.dst_height;
+        } else {
+            crop_height = (size.dst_height * width) / size.dst_width;
+        }
+        const int crop_x = (width - crop_width) / 2;
+        const int crop_y = (height - crop_height) / 2;
+
+        for (auto tile : tiles) {
+            for (auto method : methods) {
+                INFO("Size " << width << "x" << height << " to " << size.dst_width << "x"
+                     << size.dst_height << ", tile " << tile << ", method " << method);
+                const demosaic_frame frame = {bayer.data(), width, height, tile};
+                std::vector<uint8_t> full(width * height * 3);
+                REQUIRE(demosaic_image(&frame, method, full.data()) == 0);
+
+                std::vector<uint8_t> cropped(crop_width * crop_height * 3);
+                for (int y = 0; y < crop_height; ++y) {
+                    std::copy_n(&full[((crop_y + y) * width + crop_x) * 3], crop_width * 3,
+                                &cropped[y * crop_width * 3]);
+                }
+
+                std::vector<uint8_t> scratch((crop_width + 1) * 6);
+                std::vector<uint8_t> rgb(size.dst_width * size.dst_height * 3);
+                REQUIRE(demosaic_crop_resize(&frame, method, crop_x, crop_y, crop_width, crop_height,
+                                             rgb.data(), size.dst_width, size.dst_height, nullptr,
+                                             scratch.data()) == 0);
+
+                const uint32_t one = 1 << 14;
+                const uint32_t step_x = (crop_width * one) / size.dst_width;
+                const uint32_t step_y = (crop_height * one) / size.dst_height;
+                uint32_t sy = one / 2;
+                for (int y = 0; y < size.dst_height; ++y, sy += step_y) {
+                    const int ty = static_cast<int>(sy >> 14);
+                    REQUIRE(ty + 1 < crop_height);
+                    const uint32_t fy = sy & (one - 1);
+                    const uint8_t* s = &cropped[ty * crop_width * 3];
+                    uint32_t sx = one / 2;
+                    for (int x = 0; x < size.dst_width; ++x, sx += step_x) {
+                        const int tx = static_cast<int>(sx >> 14);
+                        REQUIRE(tx + 1 < crop_width);
+                        const uint32_t fx = sx & (one - 1);
+                        for (int c = 0; c < 3; ++c) {
+                            const uint32_t p00 = s[tx * 3 + c];
+                            const uint32_t p10 = s[(tx + 1) * 3 + c];
+                            const uint32_t p01 = s[(crop_width + tx) * 3 + c];
+                            const uint32_t p11 = s[(crop_width + tx + 1) * 3 + c];
+                            const uint32_t top = (p00 * (one - fx) + p10 * fx + one / 2) >> 14;
+                            const uint32_t bottom = (p01 * (one - fx) + p11 * fx + one / 2) >> 14;
+                            const uint32_t expected = (top * (one - fy) + bottom * fy + one / 2) >> 14;
+                            REQUIRE(rgb[(y * size.dst_width + x) * 3 + c] == expected);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Common: Demosaic exposure statistics")
+{
+    const int width = 40;
+    const int height = 6;
+    std::vector<uint8_t> bayer(width * height, 100);
+
+    /* One pair of each kind on row 1; the second pair straddles the window edge. */
+    bayer[1 * width + 4] = 0;
+    bayer[1 * width + 7] = 5;
+    bayer[1 * width + 8] = 200;
+    bayer[1 * width + 11] = 255;
+    bayer[1 * width + 30] = 0;
+
+    const demosaic_frame frame = {bayer.data(), width, height, DEMOSAIC_TILE_RGGB};
+    demosaic_exposure stats;
+    demosaic_exposure_stats(&frame, 0, 0, width, height, 9, 154, &stats);
+    CHECK(stats.pixels == width * height);
+    CHECK(stats.under == 4);
+    CHECK(stats.low == 6);
+    CHECK(stats.high == 4);
+    CHECK(stats.over == 2);
+
+    demosaic_exposure_stats(&frame, 0, 1, 24, 2, 9, 154, &stats);
+    CHECK(stats.pixels == 48);
+    CHECK(stats.under == 2);
+    CHECK(stats.low == 4);
+    CHECK(stats.high == 4);
+    CHECK(stats.over == 2);
+}
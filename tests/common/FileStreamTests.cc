@@ -0,0 +1,308 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "frame_file.h"
+#include "wav_reader.h"
+
+#include <catch.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /** File in the temporary directory, removed when it goes out of scope. */
+    class TempFile {
+    public:
+        TempFile(const std::string& name, const std::vector<uint8_t>& contents)
+            : m_path{(std::filesystem::temp_directory_path() / name).string()}
+        {
+            FILE* f = std::fopen(m_path.c_str(), "wb");
+            REQUIRE(f != nullptr);
+            if (!contents.empty()) {
+                REQUIRE(std::fwrite(contents.data(), 1, contents.size(), f) == contents.size());
+            }
+            std::fclose(f);
+        }
+
+        ~TempFile()
+        {
+            std::remove(m_path.c_str());
+        }
+
+        const char* Path() const
+        {
+            return m_path.c_str();
+        }
+
+    private:
+        std::string m_path;
+    };
+
+    void Append(std::vector<uint8_t>& v, const std::string& s)
+    {
+        v.insert(v.end(), s.begin(), s.end());
+    }
+
+    void AppendLe(std::vector<uint8_t>& v, uint32_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i) {
+            v.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    /**
+     * Builds a 16-bit PCM WAV file. dataBytes overrides the size in the data
+     * chunk header, to describe more data than the file holds.
+     */
+    std::vector<uint8_t> MakeWav(uint32_t channels, const std::vector<int16_t>& samples,
+                                 int64_t dataBytes = -1)
+    {
+        const auto size = static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+        std::vector<uint8_t> v;
+        Append(v, "RIFF");
+        AppendLe(v, 36 + size, 4);
+        Append(v, "WAVE");
+        /* An unknown chunk before the format is skipped. */
+        Append(v, "LIST");
+        AppendLe(v, 3, 4);
+        v.insert(v.end(), {'a', 'b', 'c', 0});
+        Append(v, "fmt ");
+        AppendLe(v, 16, 4);
+        AppendLe(v, 1, 2);
+        AppendLe(v, channels, 2);
+        AppendLe(v, 16000, 4);
+        AppendLe(v, 16000 * channels * 2, 4);
+        AppendLe(v, channels * 2, 2);
+        AppendLe(v, 16, 2);
+        Append(v, "data");
+        AppendLe(v, dataBytes < 0 ? size : static_cast<uint32_t>(dataBytes), 4);
+        for (const int16_t s : samples) {
+            AppendLe(v, static_cast<uint16_t>(s), 2);
+        }
+        return v;
+    }
+
+    std::vector<uint8_t> MakePpm(const std::string& header, size_t pixelBytes, uint8_t value)
+    {
+        std::vector<uint8_t> v;
+        Append(v, header);
+        v.insert(v.end(), pixelBytes, value);
+        return v;
+    }
+
+} /* namespace */
+
+TEST_CASE("WAV reader parses the header")
+{
+    TempFile wav{"mlek_wav_header.wav", MakeWav(2, {100, 300, -100, -300, 7, 9})};
+    wav_reader reader;
+    REQUIRE(wav_reader_open(&reader, wav.Path()));
+    CHECK(reader.sampling_rate == 16000);
+    CHECK(reader.num_channels == 2);
+    CHECK(reader.total_frames == 3);
+
+    SECTION("Down-mixes to mono")
+    {
+        int16_t mono[4] = {};
+        CHECK(wav_reader_read_mono(&reader, mono, 4) == 3);
+        CHECK(mono[0] == 200);
+        CHECK(mono[1] == -200);
+        CHECK(mono[2] == 8);
+    }
+
+    SECTION("Rewinds to the start of the data")
+    {
+        int16_t frames[6] = {};
+        CHECK(wav_reader_read_interleaved(&reader, frames, 3) == 3);
+        CHECK(wav_reader_read_interleaved(&reader, frames, 3) == 0);
+        REQUIRE(wav_reader_seek(&reader, 0));
+        CHECK(reader.position == 0);
+        CHECK(wav_reader_read_interleaved(&reader, frames, 1) == 1);
+        CHECK(frames[0] == 100);
+        CHECK(frames[1] == 300);
+
+        /* Seeking past the end clamps to it. */
+        REQUIRE(wav_reader_seek(&reader, 10));
+        CHECK(reader.position == 3);
+        CHECK(wav_reader_read_interleaved(&reader, frames, 1) == 0);
+    }
+    wav_reader_close(&reader);
+}
+
+TEST_CASE("WAV reader rejects invalid files")
+{
+    wav_reader reader;
+
+    SECTION("Empty data chunk")
+    {
+        TempFile wav{"mlek_wav_empty.wav", MakeWav(1, {})};
+        CHECK_FALSE(wav_reader_open(&reader, wav.Path()));
+        CHECK(reader.file == nullptr);
+    }
+
+    SECTION("Empty file")
+    {
+        TempFile wav{"mlek_wav_zero.wav", {}};
+        CHECK_FALSE(wav_reader_open(&reader, wav.Path()));
+    }
+
+    SECTION("Truncated header")
+    {
+        auto bytes = MakeWav(1, {1, 2});
+        bytes.resize(30);
+        TempFile wav{"mlek_wav_short.wav", bytes};
+        CHECK_FALSE(wav_reader_open(&reader, wav.Path()));
+    }
+
+    SECTION("Not 16-bit PCM")
+    {
+        auto bytes = MakeWav(1, {1, 2});
+        bytes[12 + 8 + 4 + 8 + 14] = 8;     /* Bits per sample. */
+        TempFile wav{"mlek_wav_8bit.wav", bytes};
+        CHECK_FALSE(wav_reader_open(&reader, wav.Path()));
+    }
+}
+
+TEST_CASE("WAV reader stops at truncated data")
+{
+    /* The data chunk claims four samples but the file holds two. */
+    TempFile wav{"mlek_wav_truncated.wav", MakeWav(1, {5, 6}, 8)};
+    wav_reader reader;
+    REQUIRE(wav_reader_open(&reader, wav.Path()));
+    CHECK(reader.total_frames == 4);
+
+    int16_t samples[4] = {};
+    CHECK(wav_reader_read_mono(&reader, samples, 4) == 2);
+    CHECK(samples[0] == 5);
+    CHECK(samples[1] == 6);
+    CHECK(wav_reader_read_mono(&reader, samples, 4) == 0);
+    wav_reader_close(&reader);
+}
+
+TEST_CASE("Frame file patterns")
+{
+    SECTION("Plain paths and escapes")
+    {
+        CHECK(frame_file_pattern_check("frames/img.ppm") == 0);
+        CHECK(frame_file_pattern_check("frames/100%%.ppm") == 0);
+
+        char name[32];
+        REQUIRE(frame_file_pattern_name(name, sizeof(name), "frames/100%%.ppm", 7));
+        CHECK(std::string{name} == "frames/100%.ppm");
+    }
+
+    SECTION("One index conversion")
+    {
+        CHECK(frame_file_pattern_check("img_%u.ppm") == 1);
+        CHECK(frame_file_pattern_check("img_%04d.ppm") == 1);
+        CHECK(frame_file_pattern_check("%%_%-3i.ppm") == 1);
+
+        char name[32];
+        REQUIRE(frame_file_pattern_name(name, sizeof(name), "img_%04d.ppm", 12));
+        CHECK(std::string{name} == "img_0012.ppm");
+        REQUIRE(frame_file_pattern_name(name, sizeof(name), "%%_%-3i.ppm", 5));
+        CHECK(std::string{name} == "%_5  .ppm");
+        REQUIRE(frame_file_pattern_name(name, sizeof(name), "img_%2u", 12345));
+        CHECK(std::string{name} == "img_12345");
+    }
+
+    SECTION("Unsupported conversions")
+    {
+        CHECK(frame_file_pattern_check("img_%s.ppm") == -1);
+        CHECK(frame_file_pattern_check("img_%n.ppm") == -1);
+        CHECK(frame_file_pattern_check("img_%ld.ppm") == -1);
+        CHECK(frame_file_pattern_check("img_%*d.ppm") == -1);
+        CHECK(frame_file_pattern_check("img_%d_%d.ppm") == -1);
+        CHECK(frame_file_pattern_check("100%.ppm") == -1);
+        CHECK(frame_file_pattern_check("img_%") == -1);
+    }
+
+    SECTION("Names that do not fit")
+    {
+        char name[8];
+        CHECK_FALSE(frame_file_pattern_name(name, sizeof(name), "img_%04d.ppm", 1));
+        CHECK(frame_file_pattern_name(name, sizeof(name), "i_%04d", 1));
+        CHECK(std::string{name} == "i_0001");
+    }
+}
+
+TEST_CASE("PPM frame headers")
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    SECTION("Consecutive images, then rewind")
+    {
+        auto bytes = MakePpm("P6\n# comment\n2 1\n255\n", 6, 0x11);
+        const auto second = MakePpm("P6 1 2 255\n", 6, 0x22);
+        bytes.insert(bytes.end(), second.begin(), second.end());
+        TempFile ppm{"mlek_frames.ppm", bytes};
+        FILE* f = std::fopen(ppm.Path(), "rb");
+        REQUIRE(f != nullptr);
+
+        uint8_t pixels[6];
+        REQUIRE(frame_file_read_ppm_header(f, &width, &height) == FRAME_FILE_PPM_OK);
+        CHECK(width == 2);
+        CHECK(height == 1);
+        REQUIRE(std::fread(pixels, 1, sizeof(pixels), f) == sizeof(pixels));
+        CHECK(pixels[0] == 0x11);
+
+        REQUIRE(frame_file_read_ppm_header(f, &width, &height) == FRAME_FILE_PPM_OK);
+        CHECK(width == 1);
+        CHECK(height == 2);
+        REQUIRE(std::fread(pixels, 1, sizeof(pixels), f) == sizeof(pixels));
+        CHECK(pixels[5] == 0x22);
+
+        CHECK(frame_file_read_ppm_header(f, &width, &height) == FRAME_FILE_PPM_END);
+
+        std::rewind(f);
+        REQUIRE(frame_file_read_ppm_header(f, &width, &height) == FRAME_FILE_PPM_OK);
+        CHECK(width == 2);
+        std::fclose(f);
+    }
+
+    SECTION("Empty file")
+    {
+        TempFile ppm{"mlek_empty.ppm", {}};
+        FILE* f = std::fopen(ppm.Path(), "rb");
+        REQUIRE(f != nullptr);
+        CHECK(frame_file_read_ppm_header(f, &width, &height) == FRAME_FILE_PPM_END);
+        std::fclose(f);
+    }
+
+    SECTION("Invalid headers")
+    {
+        const char* headers[] = {
+            "P",                    /* Truncated magic. */
+            "P6\n2 1\n",            /* Truncated header. */
+            "P5\n2 1\n255\n",       /* Greyscale. */
+            "P6\n2 1\n65535\n",     /* 16-bit. */
+            "P6\n0 1\n255\n",       /* No pixels. */
+            "P6\n99999999999 1\n255\n",
+        };
+        for (const char* header : headers) {
+            TempFile ppm{"mlek_invalid.ppm", MakePpm(header, 0, 0)};
+            FILE* f = std::fopen(ppm.Path(), "rb");
+            REQUIRE(f != nullptr);
+            INFO(header);
+            CHECK(frame_file_read_ppm_header(f, &width, &height) == FRAME_FILE_PPM_INVALID);
+            std::fclose(f);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ImageInputAdapter.hpp"
+#include "ImageUtils.hpp"
+
+#include <catch.hpp>
+#include <vector>
+
+using arm::app::QuantParams;
+using arm::app::image::InputAdapter;
+using arm::app::image::PixelMapping;
+
+namespace {
+
+    std::vector<uint8_t> AllPixels()
+    {
+        std::vector<uint8_t> pixels(256);
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            pixels[i] = static_cast<uint8_t>(i);
+        }
+        return pixels;
+    }
+
+    /* Normalise to [0, 1] and quantise, one pixel at a time. */
+    int8_t QuantiseReference(uint8_t pixel, const QuantParams& params)
+    {
+        const float value = (static_cast<float>(pixel) / 255.0f) / params.scale + params.offset;
+        if (value >= INT8_MAX) {
+            return INT8_MAX;
+        }
+        if (value <= INT8_MIN) {
+            return INT8_MIN;
+        }
+        return static_cast<int8_t>(value);
+    }
+
+} /* namespace */
+
+TEST_CASE("Common: Image input adapter")
+{
+    const std::vector<uint8_t> pixels = AllPixels();
+    std::vector<uint8_t> tensor(pixels.size());
+
+    SECTION("Copying leaves pixels as they are") {
+        const InputAdapter adapter{PixelMapping::Copy, QuantParams{}, false};
+        REQUIRE(adapter.Write(pixels.data(), pixels.size(), tensor.data(), tensor.size()) == pixels.size());
+        REQUIRE(tensor == pixels);
+    }
+
+    SECTION("Converting to int8 matches ConvertImgToInt8") {
+        const InputAdapter adapter{PixelMapping::ToInt8, QuantParams{}, false};
+        std::vector<uint8_t> expected = pixels;
+        arm::app::image::ConvertImgToInt8(expected.data(), expected.size());
+
+        REQUIRE(adapter.Write(pixels.data(), pixels.size(), tensor.data(), tensor.size()) == pixels.size());
+        REQUIRE(tensor == expected);
+    }
+
+    SECTION("Quantising matches the float computation") {
+        for (const QuantParams params : {QuantParams{1.0f / 255, -128},
+                                         QuantParams{0.0078125f, 0},
+                                         QuantParams{0.002f, -100}}) {
+            const InputAdapter adapter{PixelMapping::Quantise, params, false};
+            adapter.Write(pixels.data(), pixels.size(), tensor.data(), tensor.size());
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                REQUIRE(static_cast<int8_t>(tensor[i]) == QuantiseReference(pixels[i], params));
+            }
+        }
+    }
+
+    SECTION("Grayscale conversion is done in the same pass") {
+        const QuantParams params{1.0f / 255, -128};
+        const InputAdapter adapter{PixelMapping::Quantise, params, true};
+
+        std::vector<uint8_t> rgb;
+        for (size_t i = 0; i < 64; ++i) {
+            rgb.push_back(static_cast<uint8_t>(i * 4));
+            rgb.push_back(static_cast<uint8_t>(255 - i));
+            rgb.push_back(static_cast<uint8_t>(i * 7));
+        }
+        std::vector<uint8_t> gray(64);
+        arm::app::image::RgbToGrayscale(rgb.data(), gray.data(), gray.size());
+
+        REQUIRE(adapter.Write(rgb.data(), rgb.size(), tensor.data(), tensor.size()) == 64);
+        for (size_t i = 0; i < gray.size(); ++i) {
+            REQUIRE(static_cast<int8_t>(tensor[i]) == QuantiseReference(gray[i], params));
+        }
+    }
+
+    SECTION("Writes stop at the smaller of the image and the tensor") {
+        const InputAdapter adapter{PixelMapping::ToInt8, QuantParams{}, false};
+        std::vector<uint8_t> small(16, 0xAA);
+        REQUIRE(adapter.Write(pixels.data(), pixels.size(), small.data(), small.size()) == 16);
+        REQUIRE(adapter.Write(pixels.data(), 8, tensor.data(), tensor.size()) == 8);
+        REQUIRE(adapter.Map(0) == 0x80);
+        REQUIRE(adapter.Map(255) == 0x7F);
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "log_deferred.h"
+#include "log_macros.h"
+
+#include <catch.hpp>
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<std::string> lines;
+
+    void CaptureSink(const char* text, size_t len)
+    {
+        lines.emplace_back(text, len);
+    }
+
+    /* Empties the ring buffer and starts capturing. */
+    void StartCapture()
+    {
+        log_deferred_set_sink(CaptureSink);
+        log_deferred_flush();
+        lines.clear();
+    }
+} /* namespace */
+
+TEST_CASE("Common: Deferred log formatting")
+{
+    StartCapture();
+
+    char transient[] = "kws";
+    log_deferred_write(LOG_LEVEL_INFO, "Inference took %" PRIu32 " ms\n", static_cast<uint32_t>(12));
+    log_deferred_write(LOG_LEVEL_DEBUG, "%s: %-6.2f|%*d|%.*s|%%|%lld|%zu|%x\n",
+                       transient, 3.14159, 5, -42, 2, "abc", -1234567890123LL,
+                       static_cast<size_t>(77), 0xbeefu);
+    log_deferred_write(LOG_LEVEL_WARN, "no arguments\n");
+    log_deferred_write(LOG_LEVEL_ERROR, "%c%c\n", 'o', 'k');
+
+    /* Strings are copied when the message is recorded. */
+    transient[0] = 'X';
+
+    REQUIRE(lines.empty());
+    REQUIRE(log_deferred_drain(2) == 2);
+    REQUIRE(log_deferred_drain(10) == 2);
+    REQUIRE(log_deferred_drain(10) == 0);
+
+    REQUIRE(lines.size() == 4);
+    CHECK(lines[0] == "INFO - Inference took 12 ms\n");
+    CHECK(lines[1] == "DEBUG - kws: 3.14  |  -42|ab|%|-1234567890123|77|beef\n");
+    CHECK(lines[2] == "WARN - no arguments\n");
+    CHECK(lines[3] == "ERROR - ok\n");
+
+    log_deferred_set_sink(nullptr);
+}
+
+TEST_CASE("Common: Deferred log truncates oversized arguments")
+{
+    StartCapture();
+
+    const std::string longText(200, 'a');
+    log_deferred_write(LOG_LEVEL_INFO, "%s\n", longText.c_str());
+    log_deferred_write(LOG_LEVEL_INFO, "%s %d\n", longText.c_str(), 5);
+    log_deferred_flush();
+
+    REQUIRE(lines.size() == 2);
+    /* The cut string is marked, the rest of the line is kept. */
+    CHECK(lines[0].rfind("...\n") == lines[0].size() - 4);
+    CHECK(lines[0].size() < longText.size());
+    /* Arguments after the cut are not rendered. */
+    CHECK(lines[1].find(" 5") == std::string::npos);
+    CHECK(lines[1].rfind("...\n") == lines[1].size() - 4);
+
+    log_deferred_set_sink(nullptr);
+}
+
+TEST_CASE("Common: Deferred log holds a full Profiler statistics line")
+{
+    StartCapture();
+
+    /* Longest counter name and unit, with the percentile columns. */
+    const std::string name = "NPU ETHOSU_PMU_SRAM_RD_DATA_BEAT_RECEIVED";
+    const uint64_t big = UINT64_C(18446744073709551615);
+    log_deferred_write(LOG_LEVEL_INFO,
+                       "%s %s: %" PRIu64 "/ %.0f / %" PRIu64 " / %" PRIu64 " / %" PRIu64 " / %" PRIu64 " \n",
+                       name.c_str(), "milliseconds", big, 12.0, big, big, big, big);
+    log_deferred_flush();
+
+    REQUIRE(lines.size() == 1);
+    const std::string value = std::to_string(big);
+    CHECK(lines[0] == "INFO - " + name + " milliseconds: " + value + "/ 12 / " + value + " / " + value +
+                          " / " + value + " / " + value + " \n");
+
+    log_deferred_set_sink(nullptr);
+}
+
+TEST_CASE("Common: Deferred log drops messages when full")
+{
+    StartCapture();
+
+    size_t written = 0;
+    while (log_deferred_get_dropped() == 0) {
+        log_deferred_write(LOG_LEVEL_INFO, "message %zu\n", written);
+        ++written;
+        REQUIRE(written < 100000);
+    }
+    log_deferred_write(LOG_LEVEL_INFO, "message %zu\n", written);
+    REQUIRE(log_deferred_get_dropped() == 2);
+
+    log_deferred_flush();
+    REQUIRE(log_deferred_get_dropped() == 0);
+
+    /* The drop is reported first, followed by the messages that fitted, in order. */
+    REQUIRE(lines.size() == written);
+    CHECK(lines[0] == "WARN - 2 log messages dropped\n");
+    for (size_t i = 1; i < lines.size(); ++i) {
+        CHECK(lines[i] == "INFO - message " + std::to_string(i - 1) + "\n");
+    }
+
+    /* Space is reclaimed once drained. */
+    lines.clear();
+    log_deferred_write(LOG_LEVEL_INFO, "after\n");
+    REQUIRE(log_deferred_drain(1) == 1);
+    CHECK(lines.back() == "INFO - after\n");
+
+    log_deferred_set_sink(nullptr);
+}
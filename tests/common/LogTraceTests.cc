@@ -0,0 +1,129 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "log_trace.h"
+
+#include <catch.hpp>
+#include <string>
+
+namespace {
+    uint64_t now;
+
+    uint64_t FakeClock()
+    {
+        return now;
+    }
+
+    void Append(const char* text, size_t len, void* ctx)
+    {
+        static_cast<std::string*>(ctx)->append(text, len);
+    }
+
+    std::string Export(size_t* spans = nullptr)
+    {
+        std::string json;
+        const size_t n = log_trace_export(Append, &json);
+        if (spans) {
+            *spans = n;
+        }
+        return json;
+    }
+
+    size_t Occurrences(const std::string& text, const std::string& what)
+    {
+        size_t n = 0;
+        for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1)) {
+            ++n;
+        }
+        return n;
+    }
+} /* namespace */
+
+TEST_CASE("Common: Trace spans")
+{
+    log_trace_set_clock(nullptr, 0);
+    log_trace_clear();
+
+    SECTION("Nothing is recorded without a clock") {
+        log_trace_span(LOG_TRACE_TRACK_CPU, "ignored", 0, 10);
+        REQUIRE(log_trace_now() == 0);
+        REQUIRE(log_trace_count() == 0);
+    }
+
+    /* 2 MHz: each tick is half a microsecond. */
+    log_trace_set_clock(FakeClock, 2000000);
+
+    SECTION("Spans are exported as Chrome trace events") {
+        now = 1000;
+        {
+            const LogTraceScope scope{"inference"};
+            now = 1500;
+        }
+        log_trace_span(LOG_TRACE_TRACK_CAMERA, "frame \"1\"", 200, 1200);
+        REQUIRE(log_trace_count() == 2);
+
+        size_t spans = 0;
+        const std::string json = Export(&spans);
+        REQUIRE(spans == 2);
+        REQUIRE(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+        REQUIRE(json.find("\n]}\n") == json.size() - 4);
+        REQUIRE(Occurrences(json, "\"name\":\"thread_name\"") == LOG_TRACE_TRACKS);
+        REQUIRE(json.find("\"args\":{\"name\":\"Camera\"}") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"inference\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":500.000,\"dur\":250.000}")
+                != std::string::npos);
+
+        /* Quotes would end the JSON string. */
+        REQUIRE(json.find("{\"name\":\"frame _1_\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":100.000,\"dur\":500.000}")
+                != std::string::npos);
+    }
+
+    SECTION("The ring buffer keeps the latest spans") {
+        size_t capacity = 0;
+        while (!log_trace_full()) {
+            log_trace_span(LOG_TRACE_TRACK_CPU, "old", capacity, capacity + 1);
+            REQUIRE(log_trace_count() == ++capacity);
+        }
+        REQUIRE(capacity >= 2);
+
+        log_trace_span(LOG_TRACE_TRACK_NPU, "new", 5000, 5002);
+        REQUIRE(log_trace_count() == capacity);
+
+        size_t spans = 0;
+        const std::string json = Export(&spans);
+        REQUIRE(spans == capacity);
+        REQUIRE(Occurrences(json, "\"name\":\"old\"") == capacity - 1);
+        REQUIRE(json.find("\"name\":\"old\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":0.000,") == std::string::npos);
+        REQUIRE(json.find("{\"name\":\"new\",\"ph\":\"X\",\"pid\":0,\"tid\":3,\"ts\":2500.000,\"dur\":1.000}")
+                != std::string::npos);
+    }
+
+    SECTION("Clearing forgets recorded spans") {
+        log_trace_span(LOG_TRACE_TRACK_DISPLAY, "flush", 0, 4);
+        log_trace_clear();
+        REQUIRE(log_trace_count() == 0);
+
+        size_t spans = 1;
+        Export(&spans);
+        REQUIRE(spans == 0);
+
+        log_trace_span(LOG_TRACE_TRACK_DISPLAY, "flush", 8, 4);
+        REQUIRE(log_trace_count() == 1);
+        REQUIRE(Export().find("\"ts\":4.000,\"dur\":0.000}") != std::string::npos);
+    }
+
+    log_trace_set_clock(nullptr, 0);
+    log_trace_clear();
+}
@@ -0,0 +1,331 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Model.hpp"
+#include "NpuAsync.hpp"
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    constexpr int TENSOR_SIZE = 4;
+    constexpr int8_t CMS_OFFSET = 3;
+
+    /**
+     * Stands in for the NPU: the "command stream" holds a value that the job
+     * adds to its input tensor to produce its output tensor. The job finishes
+     * after a number of polls.
+     */
+    class MockNpuBackend : public arm::app::NpuBackend {
+    public:
+        bool Start(const arm::app::NpuJob& job) override
+        {
+            ++this->starts;
+            if (this->failStart || this->running) {
+                return false;
+            }
+            this->job = job;
+            this->running = true;
+            this->pollsLeft = this->pollsToFinish;
+            return true;
+        }
+
+        arm::app::InferenceStatus Wait(bool block) override
+        {
+            if (!this->running) {
+                return arm::app::InferenceStatus::Idle;
+            }
+            if (!block && this->pollsLeft-- > 0) {
+                return arm::app::InferenceStatus::Running;
+            }
+            this->running = false;
+            if (this->failJob) {
+                return arm::app::InferenceStatus::Error;
+            }
+
+            /* Base addresses: weights, arena, fast scratch and input, then output. */
+            const int8_t offset = *static_cast<const int8_t*>(this->job.commandStream);
+            const auto* in = reinterpret_cast<const int8_t*>(
+                static_cast<uintptr_t>(this->job.baseAddr[0]));
+            auto* out = reinterpret_cast<int8_t*>(
+                static_cast<uintptr_t>(this->job.baseAddr[this->job.numBaseAddr - 1]));
+            for (int i = 0; i < TENSOR_SIZE; ++i) {
+                out[i] = in[i] + offset;
+            }
+            return arm::app::InferenceStatus::Done;
+        }
+
+        arm::app::NpuJob job{};
+        bool running{false};
+        bool failStart{false};
+        bool failJob{false};
+        int pollsToFinish{2};
+        int pollsLeft{0};
+        int starts{0};
+    };
+
+    /**
+     * Builds a model with a RESHAPE and an Ethos-U operator, with the
+     * RESHAPE either before or after the Ethos-U operator.
+     */
+    std::vector<uint8_t> BuildModel(bool ethosULast)
+    {
+        flatbuffers::FlatBufferBuilder builder;
+
+        flexbuffers::Builder fbb;
+        fbb.Int(1);
+        fbb.Finish();
+
+        const uint8_t cms[] = {static_cast<uint8_t>(CMS_OFFSET), 0, 0, 0};
+        const std::vector<flatbuffers::Offset<tflite::Buffer>> buffers = {
+            tflite::CreateBuffer(builder),
+            tflite::CreateBuffer(builder, builder.CreateVector(cms, sizeof(cms))),
+        };
+
+        const std::vector<int32_t> shape = {1, TENSOR_SIZE};
+        const std::vector<int32_t> cmsShape = {sizeof(cms)};
+        const std::vector<flatbuffers::Offset<tflite::Tensor>> tensors = {
+            tflite::CreateTensor(builder, builder.CreateVector(shape), tflite::TensorType_INT8, 0),
+            tflite::CreateTensor(builder, builder.CreateVector(shape), tflite::TensorType_INT8, 0),
+            tflite::CreateTensor(builder, builder.CreateVector(cmsShape), tflite::TensorType_UINT8, 1),
+            tflite::CreateTensor(builder, builder.CreateVector(shape), tflite::TensorType_INT8, 0),
+        };
+
+        const std::vector<flatbuffers::Offset<tflite::OperatorCode>> opcodes = {
+            tflite::CreateOperatorCode(builder, tflite::BuiltinOperator_RESHAPE, 0, 1,
+                                       tflite::BuiltinOperator_RESHAPE),
+            tflite::CreateOperatorCode(builder, tflite::BuiltinOperator_CUSTOM,
+                                       builder.CreateString("ethos-u"), 1,
+                                       tflite::BuiltinOperator_CUSTOM),
+        };
+
+        /* Tensor 0 is the model input, tensor 3 the output and tensor 1 sits between the two operators. */
+        const std::vector<int32_t> reshapeIn = {ethosULast ? 0 : 1};
+        const std::vector<int32_t> reshapeOut = {ethosULast ? 1 : 3};
+        const std::vector<int32_t> ethosUIn = {2, ethosULast ? 1 : 0};
+        const std::vector<int32_t> ethosUOut = {ethosULast ? 3 : 1};
+
+        const auto reshape = tflite::CreateOperator(
+            builder, 0, builder.CreateVector(reshapeIn), builder.CreateVector(reshapeOut));
+        const auto ethosU = tflite::CreateOperator(
+            builder, 1, builder.CreateVector(ethosUIn), builder.CreateVector(ethosUOut),
+            tflite::BuiltinOptions_NONE, 0, builder.CreateVector(fbb.GetBuffer()));
+
+        const std::vector<flatbuffers::Offset<tflite::Operator>> operators =
+            ethosULast ? std::vector<flatbuffers::Offset<tflite::Operator>>{reshape, ethosU}
+                       : std::vector<flatbuffers::Offset<tflite::Operator>>{ethosU, reshape};
+
+        const std::vector<int32_t> inputs = {0};
+        const std::vector<int32_t> outputs = {3};
+        const std::vector<flatbuffers::Offset<tflite::SubGraph>> subgraphs = {
+            tflite::CreateSubGraph(builder,
+                                   builder.CreateVector(tensors),
+                                   builder.CreateVector(inputs),
+                                   builder.CreateVector(outputs),
+                                   builder.CreateVector(operators))};
+
+        builder.Finish(tflite::CreateModel(builder,
+                                           TFLITE_SCHEMA_VERSION,
+                                           builder.CreateVector(opcodes),
+                                           builder.CreateVector(subgraphs),
+                                           builder.CreateString("async_test"),
+                                           builder.CreateVector(buffers)));
+
+        return std::vector<uint8_t>(builder.GetBufferPointer(),
+                                    builder.GetBufferPointer() + builder.GetSize());
+    }
+
+    class TestModel : public arm::app::Model {
+    protected:
+        const tflite::MicroOpResolver& GetOpResolver() override
+        {
+            return this->m_opResolver;
+        }
+
+        bool EnlistOperations() override
+        {
+            this->m_opResolver.AddReshape();
+            return true;
+        }
+
+    private:
+        tflite::MicroMutableOpResolver<1> m_opResolver;
+    };
+
+    struct AsyncFixture {
+        explicit AsyncFixture(bool ethosULast, size_t stagingBudget = 0)
+            : modelData(BuildModel(ethosULast))
+        {
+            model.SetNpuBackend(&backend);
+            model.SetWeightStagingBudget(stagingBudget);
+            REQUIRE(model.Init(arena, sizeof(arena), modelData.data(), modelData.size()));
+
+            const int8_t input[TENSOR_SIZE] = {1, -2, 30, -40};
+            std::memcpy(model.GetInputTensor(0)->data.int8, input, sizeof(input));
+        }
+
+        bool CommandStreamInArena() const
+        {
+            const auto* cms = static_cast<const uint8_t*>(backend.job.commandStream);
+            return cms >= arena && cms < arena + sizeof(arena);
+        }
+
+        void CheckOutput() const
+        {
+            const int8_t* input = model.GetInputTensor(0)->data.int8;
+            const int8_t* output = model.GetOutputTensor(0)->data.int8;
+            for (int i = 0; i < TENSOR_SIZE; ++i) {
+                CHECK(output[i] == input[i] + CMS_OFFSET);
+            }
+        }
+
+        alignas(16) uint8_t arena[16 * 1024]{};
+        std::vector<uint8_t> modelData;
+        MockNpuBackend backend;
+        TestModel model;
+    };
+
+} /* namespace */
+
+TEST_CASE("Common: Asynchronous inference")
+{
+    AsyncFixture fixture(true);
+    auto& model = fixture.model;
+    REQUIRE(model.SupportsAsyncInference());
+
+    SECTION("Poll until done") {
+        int calls = 0;
+        bool result = false;
+        REQUIRE(model.StartInference([&](bool success) {
+            ++calls;
+            result = success;
+        }));
+        CHECK(fixture.backend.starts == 1);
+
+        /* The NPU is still busy: no new inference, no callback yet. */
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Running);
+        CHECK_FALSE(model.StartInference());
+        CHECK_FALSE(model.RunInference());
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Running);
+        CHECK(calls == 0);
+
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Done);
+        CHECK(calls == 1);
+        CHECK(result);
+        fixture.CheckOutput();
+
+        /* Polling again does not call the callback again. */
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Done);
+        CHECK(calls == 1);
+    }
+
+    SECTION("Wait") {
+        REQUIRE(model.StartInference());
+        CHECK(model.WaitForInference());
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Done);
+        fixture.CheckOutput();
+
+        /* A synchronous inference still runs to completion. */
+        std::memset(model.GetOutputTensor(0)->data.int8, 0, TENSOR_SIZE);
+        CHECK(model.RunInference());
+        fixture.CheckOutput();
+    }
+
+    SECTION("Callback starts the next inference") {
+        int calls = 0;
+        REQUIRE(model.StartInference([&](bool) {
+            ++calls;
+            REQUIRE(model.StartInference([&](bool) { ++calls; }));
+        }));
+        CHECK(model.WaitForInference());
+        CHECK(calls == 1);
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Running);
+        CHECK(model.WaitForInference());
+        CHECK(calls == 2);
+    }
+
+    SECTION("Job fails to start") {
+        fixture.backend.failStart = true;
+        bool result = true;
+        CHECK_FALSE(model.StartInference([&](bool success) { result = success; }));
+        CHECK_FALSE(result);
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Error);
+    }
+
+    SECTION("Job fails") {
+        fixture.backend.failJob = true;
+        bool result = true;
+        REQUIRE(model.StartInference([&](bool success) { result = success; }));
+        CHECK_FALSE(model.WaitForInference());
+        CHECK_FALSE(result);
+        CHECK(model.PollInference() == arm::app::InferenceStatus::Error);
+    }
+}
+
+TEST_CASE("Common: Asynchronous inference with trailing CPU operators")
+{
+    AsyncFixture fixture(false);
+    auto& model = fixture.model;
+    CHECK_FALSE(model.SupportsAsyncInference());
+
+    /* The whole inference runs before StartInference returns. */
+    bool called = false;
+    REQUIRE(model.StartInference([&](bool success) { called = success; }));
+    CHECK(called);
+    CHECK_FALSE(fixture.backend.running);
+    CHECK(model.PollInference() == arm::app::InferenceStatus::Done);
+    fixture.CheckOutput();
+}
+
+TEST_CASE("Common: Weight staging")
+{
+    SECTION("Command stream copied into the arena") {
+        AsyncFixture fixture(true, 64);
+        auto& model = fixture.model;
+        CHECK(model.GetStagedWeightsSize() == 4);
+
+        REQUIRE(model.RunInference());
+        CHECK(fixture.CommandStreamInArena());
+        fixture.CheckOutput();
+
+        /* The original command stream gives the same result. */
+        std::memset(model.GetOutputTensor(0)->data.int8, 0, TENSOR_SIZE);
+        model.UseStagedWeights(false);
+        REQUIRE(model.RunInference());
+        CHECK_FALSE(fixture.CommandStreamInArena());
+        fixture.CheckOutput();
+    }
+
+    SECTION("Budget too small") {
+        AsyncFixture fixture(true, 8);
+        CHECK(fixture.model.GetStagedWeightsSize() == 0);
+        REQUIRE(fixture.model.RunInference());
+        CHECK_FALSE(fixture.CommandStreamInArena());
+        fixture.CheckOutput();
+    }
+
+    SECTION("Disabled") {
+        AsyncFixture fixture(true);
+        CHECK(fixture.model.GetStagedWeightsSize() == 0);
+        REQUIRE(fixture.model.RunInference());
+        CHECK_FALSE(fixture.CommandStreamInArena());
+    }
+}
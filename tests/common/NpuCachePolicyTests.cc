@@ -0,0 +1,226 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ethosu_cache_policy.h"
+
+#include <catch.hpp>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Range = std::pair<uintptr_t, size_t>;
+
+    /* Records the operations instead of touching a cache. */
+    struct MockCache {
+        std::vector<Range> cleaned;
+        std::vector<Range> invalidated;
+        int cleanAll{0};
+        int invalidateAll{0};
+        uintptr_t uncachedBase{0};      /* Areas starting here need no maintenance. */
+    };
+
+    MockCache g_cache;
+
+    bool NeedsMaintenance(const void* p, size_t)
+    {
+        return reinterpret_cast<uintptr_t>(p) < g_cache.uncachedBase || 0 == g_cache.uncachedBase;
+    }
+
+    const ethosu_cache_ops g_ops = {
+        NeedsMaintenance,
+        NeedsMaintenance,
+        [](const void* p, size_t bytes) { g_cache.cleaned.emplace_back(reinterpret_cast<uintptr_t>(p), bytes); },
+        [](const void* p, size_t bytes) { g_cache.invalidated.emplace_back(reinterpret_cast<uintptr_t>(p), bytes); },
+        []() { ++g_cache.cleanAll; },
+        []() { ++g_cache.invalidateAll; },
+    };
+
+    /* Layout of a model running only on the NPU. */
+    constexpr uintptr_t WEIGHTS = 0x80000000;
+    constexpr size_t WEIGHTS_SIZE = 0x40000;
+    constexpr uintptr_t ARENA = 0x20000000;
+    constexpr size_t ARENA_SIZE = 0x30000;
+    constexpr uintptr_t SCRATCH = ARENA;
+    constexpr size_t SCRATCH_SIZE = 0x20000;
+    constexpr uintptr_t INPUT = ARENA + 0x20000;
+    constexpr size_t INPUT_SIZE = 1000;
+    constexpr uintptr_t OUTPUT = ARENA + 0x20400;
+    constexpr size_t OUTPUT_SIZE = 12;
+
+    /* Areas passed by the driver: weights, scratch, fast scratch, input, output. */
+    const uint64_t g_baseAddr[] = {WEIGHTS, SCRATCH, 0, INPUT, OUTPUT};
+    const size_t g_baseAddrSize[] = {WEIGHTS_SIZE, SCRATCH_SIZE, 0, INPUT_SIZE, OUTPUT_SIZE};
+    constexpr int NUM_BASE_ADDR = 5;
+
+    int g_model;    /* Owner of the regions added by AddModel. */
+
+    void AddModel(ethosu_cache_policy& policy, uint32_t arenaAccess = 0)
+    {
+        const ethosu_cache_region regions[] = {
+            {WEIGHTS, WEIGHTS_SIZE, 0},
+            {ARENA, ARENA_SIZE, arenaAccess},
+            {INPUT, INPUT_SIZE, ETHOSU_CACHE_CPU_WRITES},
+            {OUTPUT, OUTPUT_SIZE, ETHOSU_CACHE_CPU_READS},
+        };
+        REQUIRE(ethosu_cache_policy_add_regions(&policy, &g_model, regions, 4));
+    }
+
+} /* namespace */
+
+TEST_CASE("Common: NPU cache policy")
+{
+    g_cache = MockCache{};
+    ethosu_cache_policy policy;
+    ethosu_cache_policy_init(&policy, 32 * 1024);
+
+    SECTION("Whole cache without regions") {
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, g_baseAddr, g_baseAddrSize, NUM_BASE_ADDR) ==
+              ETHOSU_CACHE_ACTION_WHOLE_CACHE);
+        CHECK(ethosu_cache_policy_invalidate(&policy, &g_ops, g_baseAddr, g_baseAddrSize, NUM_BASE_ADDR) ==
+              ETHOSU_CACHE_ACTION_WHOLE_CACHE);
+        CHECK(g_cache.cleanAll == 1);
+        CHECK(g_cache.invalidateAll == 1);
+        CHECK(g_cache.cleaned.empty());
+        CHECK(g_cache.invalidated.empty());
+    }
+
+    SECTION("Only the input is cleaned and the output invalidated") {
+        AddModel(policy);
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, g_baseAddr, g_baseAddrSize, NUM_BASE_ADDR) ==
+              ETHOSU_CACHE_ACTION_BY_ADDRESS);
+        CHECK(ethosu_cache_policy_invalidate(&policy, &g_ops, g_baseAddr, g_baseAddrSize, NUM_BASE_ADDR) ==
+              ETHOSU_CACHE_ACTION_BY_ADDRESS);
+
+        /* Extended to whole lines. */
+        REQUIRE(g_cache.cleaned.size() == 1);
+        CHECK(g_cache.cleaned[0] == Range(INPUT, 1024));
+        REQUIRE(g_cache.invalidated.size() == 1);
+        CHECK(g_cache.invalidated[0] == Range(OUTPUT, 32));
+        CHECK(g_cache.cleanAll == 0);
+        CHECK(g_cache.invalidateAll == 0);
+    }
+
+    SECTION("Unaligned tensors") {
+        const ethosu_cache_region regions[] = {
+            {ARENA, ARENA_SIZE, 0},
+            {ARENA + 40, 30, ETHOSU_CACHE_CPU_WRITES},
+        };
+        REQUIRE(ethosu_cache_policy_add_regions(&policy, &g_model, regions, 2));
+        const uint64_t addr[] = {ARENA + 40};
+        const size_t size[] = {30};
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, addr, size, 1) == ETHOSU_CACHE_ACTION_BY_ADDRESS);
+        REQUIRE(g_cache.cleaned.size() == 1);
+        CHECK(g_cache.cleaned[0] == Range(ARENA + 32, 64));
+    }
+
+    SECTION("Areas needing nothing") {
+        AddModel(policy);
+        const uint64_t addr[] = {WEIGHTS, SCRATCH};
+        const size_t size[] = {WEIGHTS_SIZE, SCRATCH_SIZE};
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, addr, size, 2) == ETHOSU_CACHE_ACTION_NONE);
+        CHECK(ethosu_cache_policy_invalidate(&policy, &g_ops, addr, size, 2) == ETHOSU_CACHE_ACTION_NONE);
+        CHECK(g_cache.cleaned.empty());
+        CHECK(g_cache.invalidated.empty());
+        CHECK(g_cache.cleanAll == 0);
+        CHECK(g_cache.invalidateAll == 0);
+    }
+
+    SECTION("Unknown areas fall back to the whole cache") {
+        AddModel(policy);
+        const uint64_t addr[] = {INPUT, ARENA + ARENA_SIZE - 16};
+        const size_t size[] = {INPUT_SIZE, 32};
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, addr, size, 2) == ETHOSU_CACHE_ACTION_WHOLE_CACHE);
+        CHECK(g_cache.cleanAll == 1);
+        CHECK(g_cache.cleaned.empty());
+    }
+
+    SECTION("CPU operators share the arena") {
+        AddModel(policy, ETHOSU_CACHE_CPU_WRITES | ETHOSU_CACHE_CPU_READS);
+
+        /* The scratch is above the limit. */
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, g_baseAddr, g_baseAddrSize, NUM_BASE_ADDR) ==
+              ETHOSU_CACHE_ACTION_WHOLE_CACHE);
+
+        /* Small areas are still maintained by address. */
+        const uint64_t addr[] = {WEIGHTS, ARENA + 0x100, OUTPUT};
+        const size_t size[] = {WEIGHTS_SIZE, 0x100, OUTPUT_SIZE};
+        CHECK(ethosu_cache_policy_invalidate(&policy, &g_ops, addr, size, 3) == ETHOSU_CACHE_ACTION_BY_ADDRESS);
+        REQUIRE(g_cache.invalidated.size() == 3);
+        CHECK(g_cache.invalidated[0] == Range(ARENA + 0x100, 0x100));
+        /* The output is in the arena and its own region. */
+        CHECK(g_cache.invalidated[1] == Range(OUTPUT, 32));
+        CHECK(g_cache.invalidated[2] == Range(OUTPUT, 32));
+    }
+
+    SECTION("Platform pre-check") {
+        AddModel(policy);
+        g_cache.uncachedBase = ARENA;
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, g_baseAddr, g_baseAddrSize, NUM_BASE_ADDR) ==
+              ETHOSU_CACHE_ACTION_NONE);
+        CHECK(g_cache.cleaned.empty());
+    }
+
+    SECTION("Regions") {
+        AddModel(policy);
+        CHECK(policy.num_regions == 4);
+
+        /* The same model again. */
+        AddModel(policy);
+        CHECK(policy.num_regions == 4);
+
+        /* All or nothing. */
+        std::vector<ethosu_cache_region> regions(ETHOSU_CACHE_MAX_REGIONS - 3);
+        for (size_t i = 0; i < regions.size(); ++i) {
+            regions[i] = {0x10000000 + i * 0x100, 0x100, 0};
+        }
+        CHECK_FALSE(ethosu_cache_policy_add_regions(&policy, &g_model, regions.data(), regions.size()));
+        CHECK(policy.num_regions == 4);
+        CHECK(ethosu_cache_policy_add_regions(&policy, &g_model, regions.data(), regions.size() - 1));
+        CHECK(policy.num_regions == ETHOSU_CACHE_MAX_REGIONS);
+    }
+
+    SECTION("Regions are removed with their owner") {
+        /* A second model in the same arena, with the input where the
+         * first model had its scratch. */
+        int otherModel;
+        const ethosu_cache_region other[] = {
+            {ARENA, ARENA_SIZE, 0},
+            {SCRATCH, 64, ETHOSU_CACHE_CPU_WRITES},
+        };
+        AddModel(policy);
+        REQUIRE(ethosu_cache_policy_add_regions(&policy, &otherModel, other, 2));
+        CHECK(policy.num_regions == 6);
+
+        const uint64_t addr[] = {SCRATCH};
+        const size_t size[] = {64};
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, addr, size, 1) == ETHOSU_CACHE_ACTION_BY_ADDRESS);
+
+        /* The first model's regions go; the input is still cleaned. */
+        CHECK(ethosu_cache_policy_remove_regions(&policy, &g_model) == 4);
+        CHECK(policy.num_regions == 2);
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, addr, size, 1) == ETHOSU_CACHE_ACTION_BY_ADDRESS);
+        REQUIRE(g_cache.cleaned.size() == 2);
+        CHECK(g_cache.cleaned[1] == Range(SCRATCH, 64));
+        CHECK(ethosu_cache_policy_remove_regions(&policy, &g_model) == 0);
+
+        /* Once the input is no longer registered, its area is not known. */
+        CHECK(ethosu_cache_policy_remove_regions(&policy, &otherModel) == 2);
+        CHECK(policy.num_regions == 0);
+        CHECK(ethosu_cache_policy_flush(&policy, &g_ops, addr, size, 1) == ETHOSU_CACHE_ACTION_WHOLE_CACHE);
+        CHECK(g_cache.cleanAll == 1);
+    }
+}
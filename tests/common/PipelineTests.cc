@@ -0,0 +1,278 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "Pipeline.hpp"
+
+#include <catch.hpp>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    using arm::app::InferenceStatus;
+    using arm::app::PipelineInput;
+    using arm::app::PipelineStatus;
+
+    /* Time moves only when the mock inference runs. */
+    uint64_t g_now = 0;
+
+    /* One int32 in, one int32 out: the output is the input plus 100. The
+     * inference takes a number of polls to finish, like an NPU job. */
+    struct MockInference : public arm::app::PipelineInference {
+        int32_t inputData{0};
+        int32_t outputData{0};
+        TfLiteTensor input{};
+        TfLiteTensor output{};
+        int pollsPerInference{2};
+        int pollsLeft{0};
+        bool running{false};
+        int failOn{-1};
+        int started{0};
+        std::vector<int32_t> seen;
+
+        MockInference()
+        {
+            this->input.bytes = sizeof(int32_t);
+            this->input.data.data = &this->inputData;
+            this->output.bytes = sizeof(int32_t);
+            this->output.data.data = &this->outputData;
+        }
+
+        size_t GetNumInputs() const override { return 1; }
+        size_t GetNumOutputs() const override { return 1; }
+        TfLiteTensor* GetInputTensor(size_t) const override { return const_cast<TfLiteTensor*>(&this->input); }
+        TfLiteTensor* GetOutputTensor(size_t) const override { return const_cast<TfLiteTensor*>(&this->output); }
+
+        bool Start() override
+        {
+            REQUIRE_FALSE(this->running);
+            /* The pipeline hands the real buffers to the model. */
+            REQUIRE(this->input.data.data == &this->inputData);
+            this->seen.push_back(this->inputData);
+            this->running = true;
+            this->pollsLeft = this->pollsPerInference;
+            ++this->started;
+            return true;
+        }
+
+        InferenceStatus Poll(bool block) override
+        {
+            REQUIRE(this->running);
+            if (!block && --this->pollsLeft > 0) {
+                return InferenceStatus::Running;
+            }
+            this->running = false;
+            g_now += 10;
+            if (this->started - 1 == this->failOn) {
+                return InferenceStatus::Error;
+            }
+            this->outputData = this->inputData + 100;
+            return InferenceStatus::Done;
+        }
+    };
+
+    struct MockSource : public arm::app::PipelineSource {
+        std::vector<int32_t> values;
+        size_t next{0};
+        int readyEvery{1};      /* Only every nth call has an input ready. */
+        int calls{0};
+        size_t firstIndex{0};   /* Index given to the first input; 0 leaves the pipeline's. */
+
+        PipelineInput Next(const void*& data, size_t& size, size_t& index) override
+        {
+            ++this->calls;
+            if (0 != this->calls % this->readyEvery) {
+                return PipelineInput::NotYet;
+            }
+            if (this->next == this->values.size()) {
+                return PipelineInput::End;
+            }
+            if (this->firstIndex) {
+                index = this->firstIndex + this->next;
+            }
+            data = &this->values[this->next++];
+            size = sizeof(int32_t);
+            return PipelineInput::Ready;
+        }
+    };
+
+    struct MockPreProcess : public arm::app::BasePreProcess {
+        MockInference& inference;
+        int runs{0};
+
+        explicit MockPreProcess(MockInference& inf) : inference{inf} {}
+
+        bool DoPreProcess(const void* input, size_t inputSize) override
+        {
+            REQUIRE(inputSize == sizeof(int32_t));
+            /* Writes through the tensor, as pre-processing does. */
+            int32_t value;
+            std::memcpy(&value, input, sizeof(value));
+            value *= 2;
+            std::memcpy(this->inference.input.data.data, &value, sizeof(value));
+            ++this->runs;
+            return true;
+        }
+    };
+
+    /* Records the index of each input, and pre-processes it with a BasePreProcess. */
+    struct MockIndexedPreProcess : public arm::app::PipelinePreProcess {
+        arm::app::BasePreProcessStage stage;
+        std::vector<size_t> indices;
+
+        explicit MockIndexedPreProcess(arm::app::BasePreProcess& pre) : stage{pre} {}
+
+        bool DoPreProcess(const void* data, size_t size, size_t index) override
+        {
+            this->indices.push_back(index);
+            return this->stage.DoPreProcess(data, size, index);
+        }
+    };
+
+    struct MockPostProcess : public arm::app::BasePostProcess {
+        MockInference& inference;
+        int32_t result{0};
+        bool overlapped{false};     /* Ran while an inference was in flight. */
+
+        explicit MockPostProcess(MockInference& inf) : inference{inf} {}
+
+        bool DoPostProcess() override
+        {
+            std::memcpy(&this->result, this->inference.output.data.data, sizeof(this->result));
+            this->overlapped |= this->inference.running;
+            return true;
+        }
+    };
+
+    struct MockSink : public arm::app::PipelineSink {
+        MockPostProcess& postProcess;
+        std::vector<uint32_t> sequences;
+        std::vector<int32_t> results;
+
+        explicit MockSink(MockPostProcess& post) : postProcess{post} {}
+
+        bool Consume(uint32_t sequence) override
+        {
+            this->sequences.push_back(sequence);
+            this->results.push_back(this->postProcess.result);
+            return true;
+        }
+    };
+
+} /* namespace */
+
+TEST_CASE("Common: Pipeline")
+{
+    g_now = 0;
+    MockInference inference;
+    MockSource source;
+    MockPreProcess basePreProcess{inference};
+    MockIndexedPreProcess preProcess{basePreProcess};
+    MockPostProcess postProcess{inference};
+    MockSink sink{postProcess};
+    source.values = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    const std::vector<uint32_t> expectedSequences = {0, 1, 2, 3, 4, 5, 6, 7};
+    const std::vector<int32_t> expectedResults = {102, 104, 106, 108, 110, 112, 114, 116};
+
+    SECTION("Results come out in order, with the CPU stages overlapping inferences") {
+        arm::app::Pipeline pipeline{source, preProcess, inference, postProcess, sink,
+                                    arm::app::PipelineConfig{}, []() { return g_now; }};
+        REQUIRE(pipeline.Run());
+
+        REQUIRE(sink.sequences == expectedSequences);
+        REQUIRE(sink.results == expectedResults);
+        REQUIRE(inference.seen == std::vector<int32_t>{2, 4, 6, 8, 10, 12, 14, 16});
+        REQUIRE(postProcess.overlapped);
+        REQUIRE(pipeline.GetInputCount() == 8);
+
+        /* Tensors are left pointing at the model's buffers. */
+        REQUIRE(inference.input.data.data == &inference.inputData);
+        REQUIRE(inference.output.data.data == &inference.outputData);
+
+        const arm::app::PipelineStats& stats = pipeline.GetStats();
+        REQUIRE(stats.preProcess.runs == 8);
+        REQUIRE(stats.inference.runs == 8);
+        REQUIRE(stats.postProcess.runs == 8);
+        REQUIRE(stats.inference.busyTime == 80);
+        REQUIRE(stats.maxInputQueue <= 2);
+        REQUIRE(stats.maxOutputQueue <= 2);
+
+        /* Without an index from the source, inputs get their position in the stream. */
+        REQUIRE(preProcess.indices == std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7});
+        REQUIRE(basePreProcess.runs == 8);
+
+        /* The pipeline stays done once the source has ended. */
+        REQUIRE(pipeline.Step() == PipelineStatus::Done);
+    }
+
+    SECTION("Inputs are pre-processed with the index the source gave them") {
+        source.firstIndex = 10;
+        arm::app::Pipeline pipeline{source, preProcess, inference, postProcess, sink};
+        REQUIRE(pipeline.Run());
+
+        REQUIRE(preProcess.indices == std::vector<size_t>{10, 11, 12, 13, 14, 15, 16, 17});
+        REQUIRE(sink.sequences == expectedSequences);
+        REQUIRE(sink.results == expectedResults);
+    }
+
+    SECTION("A full input queue holds the source back") {
+        inference.pollsPerInference = 10;
+        arm::app::Pipeline pipeline{source, preProcess, inference, postProcess, sink,
+                                    arm::app::PipelineConfig{1}};
+        REQUIRE(pipeline.Run());
+
+        REQUIRE(sink.sequences == expectedSequences);
+        REQUIRE(sink.results == expectedResults);
+        REQUIRE(pipeline.GetStats().backpressure > 0);
+        REQUIRE(pipeline.GetStats().maxInputQueue == 1);
+        REQUIRE(pipeline.GetStats().maxOutputQueue == 1);
+    }
+
+    SECTION("Steps wait while the source has no input ready") {
+        source.readyEvery = 4;
+        inference.pollsPerInference = 1;
+        arm::app::Pipeline pipeline{source, preProcess, inference, postProcess, sink};
+
+        bool waited = false;
+        PipelineStatus status;
+        while ((status = pipeline.Step()) != PipelineStatus::Done) {
+            REQUIRE(status != PipelineStatus::Error);
+            waited |= PipelineStatus::Waiting == status;
+        }
+        REQUIRE(waited);
+        REQUIRE(pipeline.GetStats().sourceWaits > 0);
+        REQUIRE(sink.results == expectedResults);
+    }
+
+    SECTION("A failed inference stops the pipeline") {
+        inference.failOn = 3;
+        arm::app::Pipeline pipeline{source, preProcess, inference, postProcess, sink};
+        REQUIRE_FALSE(pipeline.Run());
+        REQUIRE(sink.sequences.size() <= 3);
+        REQUIRE(pipeline.Step() == PipelineStatus::Error);
+
+        /* Resetting starts on a new stream. */
+        inference.failOn = -1;
+        source.next = 0;
+        sink.sequences.clear();
+        sink.results.clear();
+        pipeline.Reset();
+        REQUIRE(pipeline.Run());
+        REQUIRE(sink.sequences == expectedSequences);
+        REQUIRE(sink.results == expectedResults);
+    }
+}
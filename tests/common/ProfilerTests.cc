@@ -99,4 +99,123 @@ TEST_CASE("Common: Test Profiler")
         REQUIRE(foundCPU_ACTIVE);
     }
 #endif /* defined (CPU_PROFILE_ENABLED) */
-}
\ No newline at end of file
+}
+
+TEST_CASE("Common: Test Profiler regions")
+{
+    hal_platform_init();
+
+    arm::app::Profiler profiler{"regions"};
+
+    SECTION("Registering the same name gives the same region") {
+        const auto first = profiler.RegisterRegion("pre");
+        REQUIRE(first != arm::app::InvalidProfilingRegion);
+        REQUIRE(first == profiler.RegisterRegion("pre"));
+        REQUIRE(first != profiler.RegisterRegion("post"));
+    }
+
+    SECTION("Region table is fixed size") {
+        for (int i = 0; i < PROFILER_MAX_REGIONS; ++i) {
+            const std::string name = "region" + std::to_string(i);
+            REQUIRE(profiler.RegisterRegion(name.c_str()) != arm::app::InvalidProfilingRegion);
+        }
+        REQUIRE(profiler.RegisterRegion("one too many") == arm::app::InvalidProfilingRegion);
+        REQUIRE(false == profiler.StartProfiling("one too many"));
+        REQUIRE(false == profiler.StartProfiling(arm::app::InvalidProfilingRegion));
+
+        /* Refused regions are counted until the profiler is reset. */
+        REQUIRE(profiler.GetDroppedRegionCount() == 2);
+        profiler.Reset();
+        REQUIRE(profiler.GetDroppedRegionCount() == 0);
+    }
+
+    SECTION("Profilers can overlap") {
+        arm::app::Profiler other{"other"};
+        const auto outer = profiler.RegisterRegion("outer");
+        const auto inner = other.RegisterRegion("inner");
+
+        REQUIRE(true == profiler.StartProfiling(outer));
+        for (int i = 0; i < 2; ++i) {
+            REQUIRE(true == other.StartProfiling(inner));
+            REQUIRE(true == other.StopProfiling());
+        }
+        /* Resetting one profiler leaves the other's measurement going. */
+        other.Reset();
+        REQUIRE(true == profiler.StopProfiling());
+
+        std::vector<arm::app::ProfileResult> results;
+        profiler.GetAllResultsAndReset(results);
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].samplesNum == 1);
+    }
+
+    SECTION("Profiling by ID") {
+        const auto region = profiler.RegisterRegion("by id");
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(true == profiler.StartProfiling(region));
+            REQUIRE(true == profiler.StopProfiling());
+        }
+
+        std::vector<arm::app::ProfileResult> results;
+        profiler.GetAllResultsAndReset(results);
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].name == "by id");
+        REQUIRE(results[0].samplesNum == 3);
+        for (const auto& stat : results[0].data) {
+            REQUIRE(stat.min <= stat.max);
+#if defined(PROFILER_PERCENTILES)
+            REQUIRE(stat.min <= stat.p50);
+            REQUIRE(stat.p50 <= stat.p99);
+            REQUIRE(stat.p99 <= stat.max);
+#else /* defined(PROFILER_PERCENTILES) */
+            REQUIRE(stat.p50 == 0);
+            REQUIRE(stat.p99 == 0);
+#endif /* defined(PROFILER_PERCENTILES) */
+        }
+    }
+}
+
+TEST_CASE("Common: Test profiling histogram")
+{
+    arm::app::ProfilingHistogram histogram;
+    REQUIRE(histogram.Percentile(50, 0, 0) == 0);
+
+    SECTION("Uniform distribution") {
+        for (uint64_t value = 1; value <= 1000; ++value) {
+            histogram.Add(value);
+        }
+        const auto p50 = histogram.Percentile(50, 1, 1000);
+        const auto p99 = histogram.Percentile(99, 1, 1000);
+        REQUIRE(p50 >= 375);
+        REQUIRE(p50 <= 625);
+        REQUIRE(p99 >= 750);
+        REQUIRE(p99 <= 1000);
+    }
+
+    SECTION("Long tail") {
+        for (int i = 0; i < 980; ++i) {
+            histogram.Add(100);
+        }
+        for (int i = 0; i < 20; ++i) {
+            histogram.Add(10000);
+        }
+        const auto p50 = histogram.Percentile(50, 100, 10000);
+        REQUIRE(p50 >= 100);
+        REQUIRE(p50 < 128);
+        const auto p99 = histogram.Percentile(99, 100, 10000);
+        REQUIRE(p99 >= 8192);
+        REQUIRE(p99 <= 10000);
+    }
+
+    SECTION("Counts beyond bucket capacity keep their proportions") {
+        for (int i = 0; i < 99000; ++i) {
+            histogram.Add(1000);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            histogram.Add(1000000);
+        }
+        REQUIRE(histogram.Percentile(50, 1000, 1000000) < 1024);
+        REQUIRE(histogram.Percentile(99.5, 1000, 1000000) >= 524288);
+    }
+}
+
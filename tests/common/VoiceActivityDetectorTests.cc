@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "VoiceActivityDetector.hpp"
+
+#include <catch.hpp>
+#include <cmath>
+#include <vector>
+
+using arm::app::audio::VadConfig;
+using arm::app::audio::VadFeatures;
+using arm::app::audio::VoiceActivityDetector;
+
+namespace {
+
+    constexpr size_t numSamples = 8000;
+    constexpr double pi = 3.14159265358979323846;
+
+    /* Sine at 16 kHz sampling, amplitude relative to full scale. */
+    std::vector<int16_t> Sine(double frequency, double amplitude, int offset = 0)
+    {
+        std::vector<int16_t> samples(numSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            samples[i] = static_cast<int16_t>(
+                std::lround(offset + 32767 * amplitude * std::sin(2 * pi * frequency * i / 16000)));
+        }
+        return samples;
+    }
+
+    VadFeatures Block(float energyDb, float zeroCrossingRate = 0.1f)
+    {
+        VadFeatures features;
+        features.energyDb = energyDb;
+        features.zeroCrossingRate = zeroCrossingRate;
+        return features;
+    }
+
+} /* namespace */
+
+TEST_CASE("Common: VAD features")
+{
+    SECTION("Silence") {
+        const std::vector<int16_t> zeros(numSamples, 0);
+        const VadFeatures features = VoiceActivityDetector::ComputeFeatures(zeros.data(), zeros.size());
+        CHECK(features.energyDb == -120.f);
+        CHECK(features.zeroCrossingRate == 0.f);
+    }
+
+    SECTION("Sine") {
+        /* A sine's power is half its squared amplitude. */
+        const auto quiet = Sine(200, 0.01);
+        const VadFeatures features = VoiceActivityDetector::ComputeFeatures(quiet.data(), quiet.size());
+        CHECK(features.energyDb == Approx(10 * std::log10(0.5 * 0.01 * 0.01)).margin(0.1));
+        CHECK(features.zeroCrossingRate == Approx(400.0 / numSamples * 0.5).epsilon(0.05));
+    }
+
+    SECTION("Gain is taken out") {
+        const auto loud = Sine(200, 0.1);
+        const VadFeatures features = VoiceActivityDetector::ComputeFeatures(loud.data(), loud.size(), 10.f);
+        CHECK(features.energyDb == Approx(10 * std::log10(0.5 * 0.01 * 0.01)).margin(0.1));
+    }
+
+    SECTION("DC offset is ignored") {
+        const auto centred = Sine(1000, 0.05);
+        const auto offset = Sine(1000, 0.05, 3000);
+        const VadFeatures a = VoiceActivityDetector::ComputeFeatures(centred.data(), centred.size());
+        const VadFeatures b = VoiceActivityDetector::ComputeFeatures(offset.data(), offset.size());
+        CHECK(a.energyDb == Approx(b.energyDb).margin(0.01));
+        CHECK(a.zeroCrossingRate == Approx(b.zeroCrossingRate));
+    }
+
+    SECTION("Noise crosses often") {
+        std::vector<int16_t> alternating(numSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            alternating[i] = (i % 2) ? 100 : -100;
+        }
+        const VadFeatures features = VoiceActivityDetector::ComputeFeatures(alternating.data(), alternating.size());
+        CHECK(features.zeroCrossingRate == 1.f);
+    }
+}
+
+TEST_CASE("Common: VAD decisions")
+{
+    VadConfig config;
+    config.thresholdDb = -50.f;
+    config.noiseMarginDb = 0.f;
+    config.hangover = 0;
+
+    SECTION("Fixed threshold") {
+        VoiceActivityDetector vad{config};
+        CHECK_FALSE(vad.Process(Block(-60.f)));
+        CHECK(vad.Process(Block(-50.f)));
+        CHECK(vad.Process(Block(-20.f)));
+        CHECK_FALSE(vad.Process(Block(-120.f)));
+        CHECK(vad.GetActiveCount() == 2);
+        CHECK(vad.GetSilentCount() == 2);
+        CHECK(vad.GetLastFeatures().energyDb == -120.f);
+
+        vad.ResetCounters();
+        CHECK(vad.GetActiveCount() == 0);
+        CHECK(vad.GetSilentCount() == 0);
+    }
+
+    SECTION("Broadband noise") {
+        VoiceActivityDetector vad{config};
+        CHECK(vad.Process(Block(-20.f, 0.3f)));
+        CHECK_FALSE(vad.Process(Block(-20.f, 0.8f)));
+    }
+
+    SECTION("Hangover") {
+        config.hangover = 2;
+        VoiceActivityDetector vad{config};
+        CHECK(vad.Process(Block(-20.f)));
+        CHECK(vad.Process(Block(-90.f)));
+        CHECK(vad.Process(Block(-90.f)));
+        CHECK_FALSE(vad.Process(Block(-90.f)));
+        CHECK(vad.GetActiveCount() == 3);
+    }
+
+    SECTION("Noise floor") {
+        config.noiseMarginDb = 6.f;
+        config.noiseFloorRiseDb = 1.f;
+        VoiceActivityDetector vad{config};
+        CHECK(vad.GetNoiseFloorDb() == -50.f);
+
+        /* Steady noise above the threshold is learnt as the floor. */
+        int active = 0;
+        for (int i = 0; i < 30; ++i) {
+            active += vad.Process(Block(-35.f));
+        }
+        CHECK(active == 10);
+        CHECK(vad.GetNoiseFloorDb() == -35.f);
+        CHECK_FALSE(vad.Process(Block(-35.f)));
+
+        /* Speech stands out of it. */
+        CHECK(vad.Process(Block(-25.f)));
+        CHECK_FALSE(vad.Process(Block(-30.f)));
+
+        /* The floor drops at once, but not below where the threshold decides. */
+        vad.Process(Block(-120.f));
+        CHECK(vad.GetNoiseFloorDb() == -56.f);
+        CHECK(vad.Process(Block(-45.f)));
+
+        vad.Reset();
+        CHECK(vad.GetNoiseFloorDb() == -50.f);
+        CHECK(vad.GetActiveCount() == 0);
+    }
+}
@@ -42,3 +42,35 @@ TEST_CASE("Testing Init failure due to insufficient tensor arena inf runner", "[
                              arm::app::inference_runner::GetModelLen()));
     REQUIRE_FALSE(model.IsInited());
 }
+
+TEST_CASE("Testing the arena plan of the model inf runner", "[inf runner]")
+{
+    arm::app::TestModel model{};
+    arm::app::ArenaPlan plan;
+    REQUIRE_FALSE(model.GetArenaPlan(plan));
+
+    REQUIRE(model.Init(arm::app::tensorArena,
+                       sizeof(arm::app::tensorArena),
+                       arm::app::inference_runner::GetModelPointer(),
+                       arm::app::inference_runner::GetModelLen()));
+    REQUIRE(model.GetArenaPlan(plan));
+    REQUIRE_FALSE(plan.GetTensors().empty());
+
+    size_t first = 0;
+    size_t second = 0;
+    REQUIRE_FALSE(plan.FindOverlap(first, second));
+    REQUIRE(plan.GetPeakLiveBytes() <= plan.GetExtent());
+    REQUIRE(plan.GetExtent() <= model.GetArenaUsedBytes());
+
+    /* The input tensor is in the plan where the interpreter put it. */
+    const auto inputOffset = static_cast<size_t>(
+        static_cast<uint8_t*>(model.GetInputTensor(0)->data.data) - arm::app::tensorArena);
+    bool found = false;
+    for (const arm::app::ArenaTensor& tensor : plan.GetTensors()) {
+        if (tensor.offset == inputOffset && 0 == tensor.firstOp) {
+            REQUIRE(tensor.bytes == model.GetInputTensor(0)->bytes);
+            found = true;
+        }
+    }
+    REQUIRE(found);
+}
@@ -0,0 +1,120 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its
+ * affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "KwsProcessing.hpp"
+
+#include <catch.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr size_t numFeatures = 10;
+    constexpr size_t numFrames = 49;
+    constexpr int frameLength = 640;
+    constexpr int frameStride = 320;
+
+    TfLiteTensor MakeFloatTensor(std::vector<float>& data)
+    {
+        TfLiteTensor tensor{};
+        tensor.type = kTfLiteFloat32;
+        tensor.data.f = data.data();
+        tensor.bytes = data.size() * sizeof(float);
+        tensor.quantization.type = kTfLiteNoQuantization;
+        return tensor;
+    }
+
+    std::vector<int16_t> RandomAudio(size_t n)
+    {
+        std::mt19937 gen(1234);
+        std::uniform_int_distribution<int> dist(-8000, 8000);
+        std::vector<int16_t> audio(n);
+        for (auto& sample : audio) {
+            sample = static_cast<int16_t>(dist(gen));
+        }
+        return audio;
+    }
+} /* namespace */
+
+TEST_CASE("KWS pre-processing of a wrapped window")
+{
+    std::vector<float> expected(numFeatures * numFrames);
+    TfLiteTensor expectedTensor = MakeFloatTensor(expected);
+    arm::app::KwsPreProcess contiguous(&expectedTensor, numFeatures, numFrames, frameLength, frameStride);
+
+    const auto audio = RandomAudio(contiguous.m_audioDataWindowSize);
+    REQUIRE(contiguous.DoPreProcess(audio.data(), 0));
+
+    /* Split on a frame boundary, inside a frame and at the very ends. */
+    const size_t splits[] = {0, 1, 5000, 8000, audio.size() - 1, audio.size()};
+    for (const size_t split : splits) {
+        DYNAMIC_SECTION("Split at " << split) {
+            std::vector<float> actual(numFeatures * numFrames);
+            TfLiteTensor actualTensor = MakeFloatTensor(actual);
+            arm::app::KwsPreProcess wrapped(&actualTensor, numFeatures, numFrames, frameLength, frameStride);
+
+            /* Lay the window out as a circular buffer would, with the tail first. */
+            std::vector<int16_t> ring(audio.begin() + split, audio.end());
+            ring.insert(ring.end(), audio.begin(), audio.begin() + split);
+            const int16_t* first = ring.data() + (audio.size() - split);
+            const int16_t* second = ring.data();
+
+            if (split == 0) {
+                REQUIRE(wrapped.DoPreProcess(ring.data(), ring.size(), nullptr, 0));
+            } else {
+                REQUIRE(wrapped.DoPreProcess(first, split, second, 0));
+            }
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("KWS pre-processing rejects a short window")
+{
+    std::vector<float> data(numFeatures * numFrames);
+    TfLiteTensor tensor = MakeFloatTensor(data);
+    arm::app::KwsPreProcess preProcess(&tensor, numFeatures, numFrames, frameLength, frameStride);
+
+    std::vector<int16_t> audio(preProcess.m_audioDataWindowSize - 1);
+    REQUIRE_FALSE(preProcess.DoPreProcess(audio.data(), audio.size(), nullptr, 0));
+}
+
+TEST_CASE("KWS pre-processing after skipped strides")
+{
+    std::vector<float> data(numFeatures * numFrames);
+    TfLiteTensor tensor = MakeFloatTensor(data);
+    arm::app::KwsPreProcess preProcess(&tensor, numFeatures, numFrames, frameLength, frameStride);
+
+    const size_t window = preProcess.m_audioDataWindowSize;
+    const size_t stride = preProcess.m_audioDataStride;
+    const auto audio = RandomAudio(window + 2 * stride);
+
+    /* Features of the third window computed from scratch. */
+    std::vector<float> expected(numFeatures * numFrames);
+    TfLiteTensor expectedTensor = MakeFloatTensor(expected);
+    arm::app::KwsPreProcess fresh(&expectedTensor, numFeatures, numFrames, frameLength, frameStride);
+    REQUIRE(fresh.DoPreProcess(audio.data() + 2 * stride, window, nullptr, 0));
+
+    /* The second window is skipped, so the first one's features do not belong in the third. */
+    REQUIRE(preProcess.DoPreProcess(audio.data(), window, nullptr, 0));
+    REQUIRE(preProcess.DoPreProcess(audio.data() + 2 * stride, window, nullptr, 2));
+    REQUIRE(data != expected);
+
+    REQUIRE(preProcess.DoPreProcess(audio.data(), window, nullptr, 0));
+    preProcess.InvalidateFeatureCache();
+    REQUIRE(preProcess.DoPreProcess(audio.data() + 2 * stride, window, nullptr, 2));
+    REQUIRE(data == expected);
+}
@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2024 Arm Limited and/or its affiliates <open-source-office@arm.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "DetectorPostProcessing.hpp"
+
+#include <algorithm>
+#include <catch.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+/* Counting allocator: every allocation in the test executable goes through here. */
+static size_t s_allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++s_allocations;
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+using arm::app::DetectorPostProcess;
+using arm::app::object_detection::DetectionResult;
+using arm::app::object_detection::PostProcessParams;
+
+namespace {
+
+    constexpr int inputSize = 64;
+    constexpr int numBox = 3;
+    constexpr int boxValues = 5 + 1;        /* x, y, w, h, objectness and one class score. */
+    const float anchors[] = {16, 16, 16, 16, 16, 16};
+
+    /* A quantised output of the network, set up the way TensorFlow Lite Micro lays it out. */
+    struct NetworkOutput {
+        explicit NetworkOutput(int resolution)
+        :   resolution{resolution},
+            data(resolution * resolution * numBox * boxValues, INT8_MIN)
+        {
+            const float scale = 1.0f / 16;
+            scaleArray[0] = 1;
+            std::memcpy(&scaleArray[1], &scale, sizeof(scale));
+            zeroPointArray[0] = 1;
+            zeroPointArray[1] = 0;
+
+            quantization.scale = reinterpret_cast<TfLiteFloatArray*>(scaleArray);
+            quantization.zero_point = reinterpret_cast<TfLiteIntArray*>(zeroPointArray);
+            quantization.quantized_dimension = 0;
+
+            tensor.type = kTfLiteInt8;
+            tensor.data.int8 = data.data();
+            tensor.bytes = data.size();
+            tensor.quantization.type = kTfLiteAffineQuantization;
+            tensor.quantization.params = &quantization;
+        }
+
+        /* Places a box of the size of its anchor in the middle of a cell. */
+        void SetBox(int row, int col, int anchor, int8_t objectness, int8_t score)
+        {
+            int8_t* box = &data[((row * resolution + col) * numBox + anchor) * boxValues];
+            box[0] = box[1] = box[2] = box[3] = 0;
+            box[4] = objectness;
+            box[5] = score;
+        }
+
+        int resolution;
+        std::vector<int8_t> data;
+        int32_t scaleArray[2]{};
+        int zeroPointArray[2]{};
+        TfLiteAffineQuantization quantization{};
+        TfLiteTensor tensor{};
+    };
+
+} /* namespace */
+
+TEST_CASE("Detector post-processing")
+{
+    NetworkOutput output0{inputSize / 32};
+    NetworkOutput output1{inputSize / 16};
+
+    /* Two boxes over the same area, of which NMS keeps the more confident one,
+     * and a third box elsewhere. */
+    output0.SetBox(0, 0, 0, 64, 64);
+    output0.SetBox(0, 0, 1, 48, 64);
+    output1.SetBox(3, 3, 0, 32, 64);
+
+    PostProcessParams params{inputSize, inputSize, inputSize, anchors, anchors};
+    std::vector<DetectionResult> results;
+
+    SECTION("Boxes are found and suppressed") {
+        DetectorPostProcess postProcess{&output0.tensor, &output1.tensor, results, params};
+        REQUIRE(postProcess.GetMaxResults() == (2 * 2 + 4 * 4) * numBox);
+        REQUIRE(postProcess.DoPostProcess());
+
+        REQUIRE(results.size() == 2);
+        REQUIRE(results[0].m_normalisedVal > results[1].m_normalisedVal);
+        REQUIRE(results[0].m_x0 == 8);
+        REQUIRE(results[0].m_y0 == 8);
+        REQUIRE(results[0].m_w == 16);
+        REQUIRE(results[0].m_h == 16);
+        REQUIRE(results[1].m_x0 == 48);
+        REQUIRE(results[1].m_y0 == 48);
+        REQUIRE(results[1].m_w == 16);
+        REQUIRE(results[1].m_h == 16);
+    }
+
+    SECTION("Only the top N boxes are kept") {
+        params.topN = 1;
+        DetectorPostProcess postProcess{&output0.tensor, &output1.tensor, results, params};
+        REQUIRE(postProcess.GetMaxResults() == 1);
+        REQUIRE(postProcess.DoPostProcess());
+
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].m_x0 == 8);
+    }
+
+    SECTION("Reused across inferences without allocating") {
+        DetectorPostProcess postProcess{&output0.tensor, &output1.tensor, results, params};
+        const size_t capacity = results.capacity();
+        REQUIRE(capacity >= postProcess.GetMaxResults());
+
+        const size_t allocations = s_allocations;
+        bool ok = true;
+        for (int i = 0; i < 10; ++i) {
+            /* Change the boxes from frame to frame, up to every box being found. */
+            if (i == 5) {
+                std::fill(output0.data.begin(), output0.data.end(), 64);
+                std::fill(output1.data.begin(), output1.data.end(), 64);
+            }
+            ok = postProcess.DoPostProcess() && ok;
+        }
+        const size_t allocated = s_allocations - allocations;
+
+        REQUIRE(ok);
+        REQUIRE(allocated == 0);
+        REQUIRE(results.capacity() == capacity);
+        REQUIRE_FALSE(results.empty());
+    }
+}